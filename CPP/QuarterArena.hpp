@@ -0,0 +1,87 @@
+// QuarterArena.hpp
+// Bump allocator for AST nodes, shared by the transpiler front end, the Pratt
+// expression parser and the binder.
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator that owns every AST node of one compilation unit. Nodes are
+// carved out of large blocks and referenced by raw pointer; dropping the arena
+// releases the whole tree at once. Trivially destructible nodes (the
+// transpiler AST) need no per-node work at all; other node types get a
+// finalizer recorded so their destructors still run on reset.
+class ASTArena {
+public:
+    explicit ASTArena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+    ASTArena(const ASTArena&) = delete;
+    ASTArena& operator=(const ASTArena&) = delete;
+    ~ASTArena() { reset(); }
+
+    void* allocate(size_t size, size_t align) {
+        uintptr_t p = (reinterpret_cast<uintptr_t>(cursor) + align - 1) & ~(uintptr_t)(align - 1);
+        if (!cursor || p + size > reinterpret_cast<uintptr_t>(limit)) {
+            newBlock(size + align);
+            p = (reinterpret_cast<uintptr_t>(cursor) + align - 1) & ~(uintptr_t)(align - 1);
+        }
+        cursor = reinterpret_cast<char*>(p + size);
+        used += size;
+        return reinterpret_cast<void*>(p);
+    }
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        T* obj = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            finalizers.push_back({ [](void* p) { static_cast<T*>(p)->~T(); }, obj });
+        }
+        return obj;
+    }
+
+    // Copies text into the arena so nodes can hold string_views that outlive
+    // the DCIL/token buffers they were built from.
+    std::string_view copyString(std::string_view text) {
+        if (text.empty()) return {};
+        char* dst = static_cast<char*>(allocate(text.size(), 1));
+        std::memcpy(dst, text.data(), text.size());
+        return std::string_view(dst, text.size());
+    }
+
+    void reset() {
+        for (auto it = finalizers.rbegin(); it != finalizers.rend(); ++it) it->destroy(it->object);
+        finalizers.clear();
+        blocks.clear();
+        cursor = limit = nullptr;
+        used = 0;
+    }
+
+    size_t bytesUsed() const { return used; }
+    size_t blockCount() const { return blocks.size(); }
+
+private:
+    void newBlock(size_t minSize) {
+        size_t size = std::max(blockSize, minSize);
+        blocks.emplace_back(new char[size]);
+        cursor = blocks.back().get();
+        limit = cursor + size;
+    }
+
+    struct Finalizer {
+        void (*destroy)(void*);
+        void* object;
+    };
+
+    size_t blockSize;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::vector<Finalizer> finalizers;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    size_t used = 0;
+};
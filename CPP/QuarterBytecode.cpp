@@ -0,0 +1,296 @@
+// QuarterBytecode.cpp
+#include "QuarterBytecode.hpp"
+#include <cstdlib>
+#include <deque>
+#include <unordered_map>
+
+static QLOpcode qlOpcodeFromName(std::string_view name) {
+    for (const auto& info : QL_OPCODE_TABLE)
+        if (info.op != QLOpcode::EXT && info.name == name) return info.op;
+    return QLOpcode::EXT;
+}
+
+UICLOp makeUICLOp(std::string_view name, std::vector<std::string> operands) {
+    QLOpcode op = qlOpcodeFromName(name);
+    return { op, std::move(operands), op == QLOpcode::EXT ? std::string(name) : std::string() };
+}
+
+std::string_view uiclOpName(const UICLOp& op) {
+    return op.opcode == QLOpcode::EXT ? std::string_view(op.extName) : QL_OPCODE_TABLE[static_cast<uint8_t>(op.opcode)].name;
+}
+
+bool sameUICLOp(const UICLOp& a, const UICLOp& b) {
+    return a.opcode == b.opcode && a.extName == b.extName && a.operands == b.operands;
+}
+
+int convertDG12(std::string_view dg) {
+    int result = 0;
+    for (char c : dg) {
+        int digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c == 'X' || c == 'A') digit = 10;
+        else if (c == 'Y' || c == 'B') digit = 11;
+        else return -1;
+        result = result * 12 + digit;
+    }
+    return result;
+}
+
+bool parseDG12(std::string_view dg, int64_t& value) {
+    uint64_t result = 0;
+    for (char c : dg) {
+        uint64_t digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c == 'X' || c == 'A') digit = 10;
+        else if (c == 'Y' || c == 'B') digit = 11;
+        else return false;
+        if (result > (uint64_t(INT64_MAX) - digit) / 12) return false;
+        result = result * 12 + digit;
+    }
+    value = static_cast<int64_t>(result);
+    return !dg.empty();
+}
+
+static void writeULEB128(std::vector<uint8_t>& out, uint64_t value) {
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out.push_back(value ? byte | 0x80 : byte);
+    } while (value);
+}
+
+bool readULEB128(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (p == end) return false;
+        uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static uint64_t zigzagEncode(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+int64_t zigzagDecode(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+// Only spellings that print back identically are immediates, so "007" or
+// "+3" stay strings and round-trip unchanged.
+static bool parseCanonicalInt(std::string_view s, int64_t& value) {
+    bool negative = !s.empty() && s[0] == '-';
+    std::string_view digits = negative ? s.substr(1) : s;
+    if (digits.empty() || digits.size() > 18) return false;
+    if (digits[0] == '0' && (digits.size() > 1 || negative)) return false;
+    int64_t v = 0;
+    for (char c : digits) {
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + (c - '0');
+    }
+    value = negative ? -v : v;
+    return true;
+}
+
+QLConstTag classifyConstant(std::string_view s) {
+    bool dg = !s.empty();
+    for (char c : s) dg = dg && ((c >= '0' && c <= '9') || c == 'X' || c == 'Y');
+    if (dg) return QLConstTag::DG;
+    // The lexer's identifier classes: a letter or '_', then letters, digits or '_'.
+    auto letter = [](char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; };
+    bool ident = !s.empty() && letter(s[0]);
+    for (char c : s) ident = ident && (letter(c) || (c >= '0' && c <= '9'));
+    return ident ? QLConstTag::IDENT : QLConstTag::STRING;
+}
+
+Bytecode compileUICLToBytecode(const std::vector<UICLOp>& uicl) {
+    std::vector<std::string_view> constants;
+    std::unordered_map<std::string_view, uint32_t> constantIndex;
+    auto intern = [&](std::string_view s) {
+        auto it = constantIndex.find(s);
+        if (it != constantIndex.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(constants.size());
+        constants.push_back(s);
+        constantIndex.emplace(s, id);
+        return id;
+    };
+
+    std::vector<uint8_t> code;
+    code.reserve(uicl.size() * 4);
+    for (const auto& op : uicl) {
+        code.push_back(static_cast<uint8_t>(op.opcode));
+        if (op.opcode == QLOpcode::EXT) writeULEB128(code, intern(op.extName));
+        writeULEB128(code, op.operands.size());
+        for (const auto& arg : op.operands) {
+            int64_t value;
+            if (parseCanonicalInt(arg, value)) writeULEB128(code, zigzagEncode(value) << 1);
+            else writeULEB128(code, (static_cast<uint64_t>(intern(arg)) << 1) | 1);
+        }
+    }
+
+    Bytecode bc;
+    bc.code.assign(QL_BYTECODE_MAGIC, QL_BYTECODE_MAGIC + 4);
+    bc.code.push_back(QL_BYTECODE_VERSION);
+    writeULEB128(bc.code, constants.size());
+    for (std::string_view c : constants) {
+        bc.code.push_back(static_cast<uint8_t>(classifyConstant(c)));
+        writeULEB128(bc.code, c.size());
+        bc.code.insert(bc.code.end(), c.begin(), c.end());
+    }
+    writeULEB128(bc.code, uicl.size());
+    bc.code.insert(bc.code.end(), code.begin(), code.end());
+    return bc;
+}
+
+bool decodeBytecodeToUICL(const Bytecode& bc, std::vector<UICLOp>& uicl, std::string& error) {
+    return decodeBytecode(bc, [&](QLOpcode opcode, std::string_view name, const std::vector<QLOperand>& operands) {
+        UICLOp op{ opcode, {}, opcode == QLOpcode::EXT ? std::string(name) : std::string() };
+        op.operands.reserve(operands.size());
+        for (const auto& o : operands) {
+            if (o.isConstant) op.operands.emplace_back(o.text);
+            else op.operands.push_back(std::to_string(o.value));
+        }
+        uicl.push_back(std::move(op));
+    }, error);
+}
+
+bool sameUICL(const std::vector<UICLOp>& a, const std::vector<UICLOp>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i)
+        if (!sameUICLOp(a[i], b[i])) return false;
+    return true;
+}
+
+std::vector<UICLOp> synthesizeCapsulePipeline(size_t ops) {
+    std::vector<UICLOp> uicl;
+    uicl.reserve(ops);
+    for (size_t i = 0; i < ops; ++i) {
+        switch (i % 4) {
+        case 0: uicl.push_back({ QLOpcode::FOLD_ADD, { std::to_string(i % 1000), std::to_string(i % 37) } }); break;
+        case 1: uicl.push_back({ QLOpcode::REC_FOLD, { std::to_string(i % 12) } }); break;
+        case 2: uicl.push_back({ QLOpcode::COMPARE, { "capsule_" + std::to_string(i % 64), "capsule_" + std::to_string(i % 48) } }); break;
+        default: uicl.push_back({ QLOpcode::CALL, { "capsule_pipeline_stage_" + std::to_string(i % 512) } }); break;
+        }
+    }
+    return uicl;
+}
+
+// stoi-compatible prefix parse without exceptions; non-numeric text reads as 0.
+static int64_t parseOperandInt(std::string_view s) {
+    std::string tmp(s);
+    return std::strtoll(tmp.c_str(), nullptr, 10);
+}
+
+int64_t foldFactorial(int64_t depth) {
+    if (depth >= 66) return 0;
+    uint64_t result = 1;
+    for (int64_t i = 1; i <= depth; ++i) result *= static_cast<uint64_t>(i);
+    return static_cast<int64_t>(result);
+}
+
+// Shared by both front doors: UICL text operands arrive as constants, bytecode
+// immediates arrive already parsed.
+class QLProgramBuilder {
+public:
+    void add(QLOpcode op, std::string_view name, const std::vector<QLOperand>& operands) {
+        QLInstr in{ op };
+        auto asInt = [&](size_t i) { return operands[i].isConstant ? parseOperandInt(operands[i].text) : operands[i].value; };
+        auto asText = [&](size_t i) {
+            return operands[i].isConstant ? intern(operands[i].text) : intern(std::to_string(operands[i].value));
+        };
+        switch (op) {
+        case QLOpcode::CALL:
+            in.s0 = operands.empty() ? intern("") : asText(0);
+            break;
+        case QLOpcode::FOLD_ADD:
+            if (operands.size() < 2) in.op = QLOpcode::NOP;
+            else { in.a = asInt(0); in.b = asInt(1); }
+            break;
+        case QLOpcode::REC_FOLD:
+            if (operands.empty()) in.op = QLOpcode::NOP;
+            else { in.a = asInt(0); in.b = foldFactorial(in.a); }
+            break;
+        case QLOpcode::COMPARE:
+            if (operands.size() < 2) in.op = QLOpcode::NOP;
+            else { in.s0 = asText(0); in.s1 = asText(1); }
+            break;
+        default:
+            // Stack-machine code runs on QLVM (--run-vm); the capsule trace skips it.
+            if (op >= QLOpcode::PUSH && op < QLOpcode::COUNT) {
+                in.op = QLOpcode::NOP;
+                break;
+            }
+            in.op = QLOpcode::EXT;
+            in.s0 = intern(name);
+            break;
+        }
+        program.code.push_back(in);
+    }
+
+    QLProgram finish() {
+        program.strings.assign(std::make_move_iterator(strings.begin()), std::make_move_iterator(strings.end()));
+        return std::move(program);
+    }
+
+private:
+    uint32_t intern(std::string_view s) {
+        auto it = index.find(s);
+        if (it != index.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(strings.size());
+        strings.emplace_back(s);
+        index.emplace(strings.back(), id);
+        return id;
+    }
+
+    QLProgram program;
+    std::deque<std::string> strings; // stable storage for the index keys
+    std::unordered_map<std::string_view, uint32_t> index;
+};
+
+QLProgram predecodeUICL(const std::vector<UICLOp>& uicl) {
+    QLProgramBuilder builder;
+    std::vector<QLOperand> operands;
+    for (const auto& op : uicl) {
+        operands.clear();
+        for (const auto& arg : op.operands) operands.push_back({ true, 0, arg, QLConstTag::STRING });
+        builder.add(op.opcode, uiclOpName(op), operands);
+    }
+    return builder.finish();
+}
+
+bool predecodeBytecode(const Bytecode& bc, QLProgram& program, std::string& error) {
+    QLProgramBuilder builder;
+    bool ok = decodeBytecode(bc, [&](QLOpcode op, std::string_view name, const std::vector<QLOperand>& operands) {
+        builder.add(op, name, operands);
+    }, error);
+    program = builder.finish();
+    return ok;
+}
+
+int64_t runProgram(const QLProgram& program, std::ostream* out) {
+    int64_t ACC = 0;
+    const auto& strings = program.strings;
+    for (const QLInstr& in : program.code) {
+        switch (in.op) {
+        case QLOpcode::CALL:
+            if (out) *out << "[CALL] Function: " << strings[in.s0] << "\n";
+            break;
+        case QLOpcode::FOLD_ADD:
+            ACC = in.a + in.b;
+            if (out) *out << "[Δ] Fold Add: " << in.a << " + " << in.b << " = " << ACC << "\n";
+            break;
+        case QLOpcode::REC_FOLD:
+            ACC = in.b;
+            if (out) *out << "[Ψ] Rec Fold Factorial(" << in.a << ") = " << in.b << "\n";
+            break;
+        case QLOpcode::COMPARE:
+            if (out) *out << "[Ξ] Compare: " << strings[in.s0] << " == " << strings[in.s1] << " -> "
+                          << (in.s0 == in.s1 ? "true" : "false") << "\n";
+            break;
+        case QLOpcode::NOP:
+            break;
+        default:
+            if (out) *out << "[UICL] Unknown op: " << strings[in.s0] << "\n";
+            break;
+        }
+    }
+    if (out) *out << "\n[REGISTER] ACC = " << ACC << "\n";
+    return ACC;
+}
@@ -0,0 +1,273 @@
+// QuarterBytecode.hpp
+// UICL opcodes, the portable bytecode format and the pre-decoded
+// interpreter core shared by every execution tier.
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// UICL and bytecode share one opcode set; see Step 5 for the encoding.
+enum class QLOpcode : uint8_t {
+    NOP,
+    CALL,
+    FOLD_ADD,  // Δ
+    REC_FOLD,  // Ψ
+    COMPARE,   // Ξ
+    IF,
+    UNLESS,
+    LOOP,      // 🔁
+    EXT,       // opcode spelled by a constant (plugins, unknown glyphs)
+    // Stack machine instructions executed by QLVM; operands are immediates.
+    PUSH,      // value
+    LOAD,      // frame slot, or a variable name resolved to one at load
+    STORE,     // frame slot, or a variable name resolved to one at load
+    POP,
+    ADD,
+    SUB,
+    MUL,
+    LT,
+    LE,
+    EQ,
+    JMP,       // instruction index
+    JZ,        // instruction index
+    RET,
+    HALT,
+    FUNC,      // name, parameter count, slot count, [parameter names]; starts a function body
+    FNREF,     // name; pushes a callee for CALLI
+    CALLI,     // argument count; calls the callee on top of the stack
+    COUNT
+};
+
+struct QLOpcodeInfo {
+    QLOpcode op;
+    std::string_view name;
+    uint8_t minOperands = 0;    // operand counts the VM loader accepts
+    uint8_t maxOperands = 255;
+};
+
+// Indexed by opcode value; EXT has no fixed spelling.
+constexpr QLOpcodeInfo QL_OPCODE_TABLE[] = {
+    { QLOpcode::NOP, "NOP" },
+    { QLOpcode::CALL, "CALL", 0, 2 },
+    { QLOpcode::FOLD_ADD, "Δ", 2, 2 },
+    { QLOpcode::REC_FOLD, "Ψ", 1, 1 },
+    { QLOpcode::COMPARE, "Ξ", 2, 2 },
+    { QLOpcode::IF, "if" },
+    { QLOpcode::UNLESS, "unless" },
+    { QLOpcode::LOOP, "🔁" },
+    { QLOpcode::EXT, "" },
+    { QLOpcode::PUSH, "PUSH", 1, 1 },
+    { QLOpcode::LOAD, "LOAD", 1, 1 },
+    { QLOpcode::STORE, "STORE", 1, 1 },
+    { QLOpcode::POP, "POP", 0, 0 },
+    { QLOpcode::ADD, "ADD", 0, 0 },
+    { QLOpcode::SUB, "SUB", 0, 0 },
+    { QLOpcode::MUL, "MUL", 0, 0 },
+    { QLOpcode::LT, "LT", 0, 0 },
+    { QLOpcode::LE, "LE", 0, 0 },
+    { QLOpcode::EQ, "EQ", 0, 0 },
+    { QLOpcode::JMP, "JMP", 1, 1 },
+    { QLOpcode::JZ, "JZ", 1, 1 },
+    { QLOpcode::RET, "RET", 0, 0 },
+    { QLOpcode::HALT, "HALT", 0, 0 },
+    { QLOpcode::FUNC, "FUNC", 3 },
+    { QLOpcode::FNREF, "FNREF", 1, 1 },
+    { QLOpcode::CALLI, "CALLI", 1, 1 },
+};
+static_assert(sizeof(QL_OPCODE_TABLE) / sizeof(QL_OPCODE_TABLE[0]) == static_cast<size_t>(QLOpcode::COUNT),
+              "QL_OPCODE_TABLE must cover every opcode");
+
+struct UICLOp {
+    UICLOp() = default;
+    UICLOp(QLOpcode opcode, std::vector<std::string> operands = {}, std::string extName = {})
+        : opcode(opcode), operands(std::move(operands)), extName(std::move(extName)) {}
+
+    QLOpcode opcode = QLOpcode::NOP;
+    std::vector<std::string> operands;
+    std::string extName; // spelling of an EXT opcode (plugins, unknown glyphs)
+};
+
+// Builds an op from its spelling, as text UICL and plugin glyphs arrive.
+UICLOp makeUICLOp(std::string_view name, std::vector<std::string> operands = {});
+
+// Spelling for traces and the text/legacy encodings.
+std::string_view uiclOpName(const UICLOp& op);
+
+bool sameUICLOp(const UICLOp& a, const UICLOp& b);
+
+int convertDG12(std::string_view dg);
+
+// Dozenal digits (X/A ten, Y/B eleven) to int64. Returns false on an empty
+// spelling, a non-digit or a value above INT64_MAX.
+bool parseDG12(std::string_view dg, int64_t& value);
+
+// ======== Step 5: Portable Bytecode Generation ========
+// Module layout, every integer an unsigned LEB128 varint unless noted:
+//   "QLBC" | version (u8) | constant count | constants | instruction count | instructions
+//   constant:    tag (u8, QLConstTag) | byte length | bytes
+//   instruction: opcode (u8, QLOpcode) | [name constant, EXT only] | operand count | operands
+//   operand:     (payload << 1) | isConstant, payload = zigzag integer or constant index
+// Operands that are canonical decimal integers become immediates; everything
+// else (identifiers, strings, DG spellings) is stored once in the constant
+// pool. Nothing refers forward, so a module decodes in one pass.
+enum class QLConstTag : uint8_t { STRING, IDENT, DG };
+
+constexpr uint8_t QL_BYTECODE_VERSION = 1;
+constexpr char QL_BYTECODE_MAGIC[4] = { 'Q', 'L', 'B', 'C' };
+
+struct Bytecode {
+    std::vector<uint8_t> code;
+};
+
+// Returns false on truncation or on a varint longer than 64 bits.
+bool readULEB128(const uint8_t*& p, const uint8_t* end, uint64_t& value);
+
+int64_t zigzagDecode(uint64_t v);
+
+QLConstTag classifyConstant(std::string_view s);
+
+Bytecode compileUICLToBytecode(const std::vector<UICLOp>& uicl);
+
+// Single forward pass over a module. Calls onInstruction(opcode, name,
+// operands) with operands as QLOperand values; string operands are views
+// into the module buffer. Returns false with error set on malformed input.
+struct QLOperand {
+    bool isConstant;
+    int64_t value;           // immediate when !isConstant
+    std::string_view text;   // constant pool entry when isConstant
+    QLConstTag tag;
+};
+
+template <typename OnInstruction>
+bool decodeBytecode(const Bytecode& bc, OnInstruction&& onInstruction, std::string& error) {
+    const uint8_t* p = bc.code.data();
+    const uint8_t* end = p + bc.code.size();
+    if (bc.code.size() < 5 || std::memcmp(p, QL_BYTECODE_MAGIC, 4) != 0) {
+        error = "bad magic";
+        return false;
+    }
+    if (p[4] != QL_BYTECODE_VERSION) {
+        error = "unsupported version " + std::to_string(p[4]);
+        return false;
+    }
+    p += 5;
+
+    uint64_t constantCount;
+    if (!readULEB128(p, end, constantCount) || constantCount > static_cast<uint64_t>(end - p)) {
+        error = "truncated constant pool";
+        return false;
+    }
+    std::vector<std::pair<std::string_view, QLConstTag>> constants;
+    constants.reserve(constantCount);
+    for (uint64_t i = 0; i < constantCount; ++i) {
+        uint64_t length;
+        if (p == end || *p > static_cast<uint8_t>(QLConstTag::DG)) {
+            error = "bad constant tag";
+            return false;
+        }
+        QLConstTag tag = static_cast<QLConstTag>(*p++);
+        if (!readULEB128(p, end, length) || length > static_cast<uint64_t>(end - p)) {
+            error = "truncated constant";
+            return false;
+        }
+        constants.emplace_back(std::string_view(reinterpret_cast<const char*>(p), length), tag);
+        p += length;
+    }
+
+    uint64_t instructionCount;
+    if (!readULEB128(p, end, instructionCount)) {
+        error = "truncated instruction count";
+        return false;
+    }
+    std::vector<QLOperand> operands;
+    for (uint64_t i = 0; i < instructionCount; ++i) {
+        if (p == end || *p >= static_cast<uint8_t>(QLOpcode::COUNT)) {
+            error = "bad opcode at instruction " + std::to_string(i);
+            return false;
+        }
+        QLOpcode opcode = static_cast<QLOpcode>(*p++);
+        std::string_view name = QL_OPCODE_TABLE[static_cast<uint8_t>(opcode)].name;
+        uint64_t word, operandCount;
+        if (opcode == QLOpcode::EXT) {
+            if (!readULEB128(p, end, word) || word >= constants.size()) {
+                error = "bad opcode name constant";
+                return false;
+            }
+            name = constants[word].first;
+        }
+        if (!readULEB128(p, end, operandCount) || operandCount > static_cast<uint64_t>(end - p)) {
+            error = "truncated operands";
+            return false;
+        }
+        operands.clear();
+        for (uint64_t k = 0; k < operandCount; ++k) {
+            if (!readULEB128(p, end, word)) {
+                error = "truncated operand";
+                return false;
+            }
+            if (word & 1) {
+                if ((word >> 1) >= constants.size()) {
+                    error = "constant index out of range";
+                    return false;
+                }
+                const auto& c = constants[word >> 1];
+                operands.push_back({ true, 0, c.first, c.second });
+            }
+            else {
+                operands.push_back({ false, zigzagDecode(word >> 1), {}, QLConstTag::STRING });
+            }
+        }
+        onInstruction(opcode, name, operands);
+    }
+    if (p != end) {
+        error = "trailing bytes after last instruction";
+        return false;
+    }
+    return true;
+}
+
+bool decodeBytecodeToUICL(const Bytecode& bc, std::vector<UICLOp>& uicl, std::string& error);
+
+bool sameUICL(const std::vector<UICLOp>& a, const std::vector<UICLOp>& b);
+
+// Capsule pipeline shaped like the REPL/unit-test programs, used by the
+// bytecode and interpreter benchmarks.
+std::vector<UICLOp> synthesizeCapsulePipeline(size_t ops);
+
+// ======== UICL Interpreter (pre-decoded) ========
+// interpretUICL used to compare opcode strings and stoi its operands on every
+// step. Programs are now decoded once into fixed-size QLInstr records: the
+// opcode is an enum, integers are already parsed, Ψ's factorial is folded at
+// decode time and string operands are indices into the program's string table
+// (equal strings share an index, so Ξ compares two integers).
+constexpr uint32_t QL_NO_STRING = 0xFFFFFFFFu;
+
+struct QLInstr {
+    QLOpcode op;
+    uint32_t s0 = QL_NO_STRING;  // CALL target / Ξ lhs / EXT name
+    uint32_t s1 = QL_NO_STRING;  // Ξ rhs
+    int64_t a = 0;               // Δ lhs / Ψ depth
+    int64_t b = 0;               // Δ rhs / Ψ folded factorial
+};
+
+struct QLProgram {
+    std::vector<QLInstr> code;
+    std::vector<std::string> strings;
+};
+
+// 66! holds 64 factors of two, so from there on the product is 0 mod 2^64;
+// returning early keeps a huge Ψ depth from spinning the loader.
+int64_t foldFactorial(int64_t depth);
+
+QLProgram predecodeUICL(const std::vector<UICLOp>& uicl);
+
+// Loads a program straight from a bytecode module; immediates are already integers.
+bool predecodeBytecode(const Bytecode& bc, QLProgram& program, std::string& error);
+
+// Runs a pre-decoded program and returns the accumulator. Trace lines go to
+// out when it is non-null, in the same format as the string interpreter.
+int64_t runProgram(const QLProgram& program, std::ostream* out);
@@ -0,0 +1,1505 @@
+// QuarterIR.cpp
+#include "QuarterIR.hpp"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+bool buildIRModule(const QLRegModule& module, QLIRModule& out, std::string& error) {
+    out = {};
+    out.callSites = module.callSites;
+    out.strings = module.strings;
+    const size_t n = module.code.size();
+    std::vector<uint32_t> blockAt(n + 1, UINT32_MAX);
+    for (size_t r = 0; r <= module.functions.size(); ++r) {
+        size_t begin = r == 0 ? 0 : module.functions[r - 1].entry;
+        size_t end = r < module.functions.size() ? module.functions[r].entry : n;
+        QLIRFunction fn;
+        if (r == 0) fn = { 0, module.topSlots, module.topFrameSize, {} };
+        else fn = { module.functions[r - 1].params, module.functions[r - 1].slots, module.functions[r - 1].frameSize, {} };
+        if (begin >= end) {
+            error = "region " + std::to_string(r) + " has no code";
+            return false;
+        }
+        std::vector<bool> leader(end - begin, false);
+        leader[0] = true;
+        for (size_t pc = begin; pc < end; ++pc) {
+            const QLRegInstr& in = module.code[pc];
+            if (irIsJump(in.op)) {
+                if (in.imm < static_cast<int64_t>(begin) || in.imm >= static_cast<int64_t>(end)) {
+                    error = "instruction " + std::to_string(pc) + ": jump leaves its function";
+                    return false;
+                }
+                leader[static_cast<size_t>(in.imm) - begin] = true;
+            }
+            if ((irIsJump(in.op) || irEndsFlow(in.op)) && pc + 1 < end) leader[pc + 1 - begin] = true;
+        }
+        for (size_t pc = begin; pc < end; ++pc) {
+            if (leader[pc - begin]) {
+                blockAt[pc] = static_cast<uint32_t>(fn.blocks.size());
+                fn.blocks.emplace_back();
+            }
+            fn.blocks.back().code.push_back(module.code[pc]);
+        }
+        for (uint32_t b = 0; b < fn.blocks.size(); ++b) {
+            QLIRBlock& block = fn.blocks[b];
+            QLRegInstr& last = block.code.back();
+            if (irIsJump(last.op)) last.imm = blockAt[static_cast<size_t>(last.imm)];
+            if (!irEndsFlow(last.op)) {
+                if (b + 1 == fn.blocks.size()) {
+                    error = "region " + std::to_string(r) + " falls off its end";
+                    return false;
+                }
+                block.next = b + 1;
+            }
+        }
+        out.regions.push_back(std::move(fn));
+    }
+    return true;
+}
+
+static size_t irInstructionCount(const QLIRModule& module) {
+    size_t count = 0;
+    for (const QLIRFunction& fn : module.regions)
+        for (const QLIRBlock& block : fn.blocks)
+            if (block.live) count += block.code.size();
+    return count;
+}
+
+void lowerIRModule(const QLIRModule& module, QLRegModule& out) {
+    out = {};
+    out.callSites = module.callSites;
+    out.strings = module.strings;
+    for (size_t r = 0; r < module.regions.size(); ++r) {
+        const QLIRFunction& fn = module.regions[r];
+        std::vector<uint32_t> order;
+        for (uint32_t b = 0; b < fn.blocks.size(); ++b)
+            if (fn.blocks[b].live) order.push_back(b);
+        std::vector<uint32_t> start(fn.blocks.size(), 0);
+        std::vector<std::pair<size_t, uint32_t>> fixups;
+        for (size_t i = 0; i < order.size(); ++i) {
+            const QLIRBlock& block = fn.blocks[order[i]];
+            uint32_t following = i + 1 < order.size() ? order[i + 1] : UINT32_MAX;
+            start[order[i]] = static_cast<uint32_t>(out.code.size());
+            size_t count = block.code.size();
+            if (count && block.code.back().op == QLRegOp::JMP && block.code.back().imm == following) --count;
+            for (size_t k = 0; k < count; ++k) {
+                if (irIsJump(block.code[k].op)) fixups.emplace_back(out.code.size(), static_cast<uint32_t>(block.code[k].imm));
+                out.code.push_back(block.code[k]);
+            }
+            if (block.next != UINT32_MAX && block.next != following) {
+                fixups.emplace_back(out.code.size(), block.next);
+                out.code.push_back({ 0, 0, 0, 0, QLRegOp::JMP });
+            }
+        }
+        for (auto [at, b] : fixups) out.code[at].imm = start[b];
+        if (r == 0) {
+            out.topSlots = fn.slots;
+            out.topFrameSize = fn.frameSize;
+        }
+        else {
+            out.functions.push_back({ start[0], fn.params, fn.slots, fn.frameSize });
+        }
+    }
+}
+
+// Sparse conditional constant propagation over frame registers. Every
+// block's entry state is the meet of its executable predecessors' exits;
+// the lattice is three levels deep, so a block is revisited at most twice
+// per register. Parameters enter varying and the rest of the slots enter
+// as 0 (frames are zeroed on entry). A JZ on a known condition makes only
+// one edge executable, and blocks never made executable are dropped.
+// Instructions then become MOVI where their result is known, or take
+// known operands as immediates.
+enum class QLIRLattice : uint8_t { Undefined, Constant, Varying };
+
+struct QLIRValue {
+    QLIRLattice kind = QLIRLattice::Undefined;
+    int64_t value = 0;
+    bool operator==(const QLIRValue& o) const { return kind == o.kind && (kind != QLIRLattice::Constant || value == o.value); }
+};
+
+static void irPropagateConstants(const QLIRModule& module, QLIRFunction& fn) {
+    const size_t blocks = fn.blocks.size(), width = fn.frameSize;
+    if (blocks * width > (size_t(1) << 24)) return;  // state would not fit comfortably; leave the region as is
+    std::vector<QLIRValue> entry(blocks * width);
+    std::vector<bool> executable(blocks, false), queued(blocks, false);
+    for (uint32_t r = 0; r < width; ++r)
+        entry[r] = r < fn.params ? QLIRValue{ QLIRLattice::Varying, 0 } : r < fn.slots ? QLIRValue{ QLIRLattice::Constant, 0 } : QLIRValue{};
+    std::vector<QLIRValue> state(width);
+    auto constant = [](int64_t v) { return QLIRValue{ QLIRLattice::Constant, v }; };
+    auto transfer = [&](const QLRegInstr& in) {
+        if (in.op == QLRegOp::MOV) state[in.d] = state[in.a];
+        else if (in.op == QLRegOp::MOVI) state[in.d] = constant(in.imm);
+        else if (irIsPure(in.op)) {
+            bool immediate = irIsImmediateBinary(in.op);
+            QLIRValue x = state[in.a], y = immediate ? constant(in.imm) : state[in.b];
+            QLRegOp base = immediate ? static_cast<QLRegOp>(static_cast<uint8_t>(in.op) - 1) : in.op;
+            if (!immediate && in.a == in.b && base != QLRegOp::ADD && base != QLRegOp::MUL)
+                state[in.d] = constant(base == QLRegOp::LE || base == QLRegOp::EQ);
+            else if (base == QLRegOp::MUL && ((x.kind == QLIRLattice::Constant && x.value == 0) || (y.kind == QLIRLattice::Constant && y.value == 0)))
+                state[in.d] = constant(0);
+            else if (x.kind == QLIRLattice::Varying || y.kind == QLIRLattice::Varying) state[in.d] = { QLIRLattice::Varying, 0 };
+            else if (x.kind == QLIRLattice::Undefined || y.kind == QLIRLattice::Undefined) state[in.d] = {};
+            else state[in.d] = constant(irFold(base, x.value, y.value));
+        }
+        else if (in.op == QLRegOp::CALL || in.op == QLRegOp::CALL_DYN) {
+            for (size_t r = in.d; r < width; ++r) state[r] = { QLIRLattice::Varying, 0 };
+        }
+        else if (in.op == QLRegOp::CALL_EXT && module.callSites[in.imm].pushesResult) {
+            state[in.d] = { QLIRLattice::Varying, 0 };
+        }
+    };
+    // Which ways a JZ on `c` can go: bit 0 falls through, bit 1 jumps.
+    auto branches = [](const QLIRValue& c) {
+        if (c.kind != QLIRLattice::Constant) return 3;
+        return c.value != 0 ? 1 : 2;
+    };
+
+    std::vector<uint32_t> work{ 0 };
+    executable[0] = queued[0] = true;
+    auto reach = [&](uint32_t s) {
+        QLIRValue* into = &entry[s * width];
+        bool changed = !executable[s];
+        executable[s] = true;
+        for (size_t r = 0; r < width; ++r) {
+            QLIRValue m = into[r];
+            if (m.kind == QLIRLattice::Undefined) m = state[r];
+            else if (state[r].kind != QLIRLattice::Undefined && !(m == state[r])) m = { QLIRLattice::Varying, 0 };
+            if (!(m == into[r])) {
+                into[r] = m;
+                changed = true;
+            }
+        }
+        if (changed && !queued[s]) {
+            queued[s] = true;
+            work.push_back(s);
+        }
+    };
+    while (!work.empty()) {
+        uint32_t b = work.back();
+        work.pop_back();
+        queued[b] = false;
+        const QLIRBlock& block = fn.blocks[b];
+        std::copy(entry.begin() + b * width, entry.begin() + (b + 1) * width, state.begin());
+        for (const QLRegInstr& in : block.code) transfer(in);
+        const QLRegInstr& last = block.code.back();
+        int ways = last.op == QLRegOp::JZ ? branches(state[last.a]) : 3;
+        if (irIsJump(last.op) && (ways & 2)) reach(static_cast<uint32_t>(last.imm));
+        if (block.next != UINT32_MAX && (ways & 1)) reach(block.next);
+    }
+
+    for (uint32_t b = 0; b < blocks; ++b) {
+        QLIRBlock& block = fn.blocks[b];
+        if (!executable[b]) {
+            block = {};
+            block.live = false;
+            continue;
+        }
+        std::copy(entry.begin() + b * width, entry.begin() + (b + 1) * width, state.begin());
+        std::vector<QLRegInstr> code;
+        code.reserve(block.code.size());
+        for (QLRegInstr in : block.code) {
+            if (irIsPure(in.op)) {
+                QLIRValue x = state[in.a], y = irIsRegisterBinary(in.op) ? state[in.b] : QLIRValue{};
+                transfer(in);
+                const QLIRValue& result = state[in.d];
+                if (result.kind == QLIRLattice::Constant) {
+                    if (in.op != QLRegOp::MOVI || in.imm != result.value) in = { result.value, in.d, 0, 0, QLRegOp::MOVI };
+                }
+                else if (irIsRegisterBinary(in.op)) {
+                    bool commutative = in.op == QLRegOp::ADD || in.op == QLRegOp::MUL || in.op == QLRegOp::EQ;
+                    if (y.kind == QLIRLattice::Constant) in = { y.value, in.d, in.a, 0, irImmediateForm(in.op) };
+                    else if (x.kind == QLIRLattice::Constant && commutative) in = { x.value, in.d, in.b, 0, irImmediateForm(in.op) };
+                }
+                code.push_back(in);
+                continue;
+            }
+            QLIRValue c = in.op == QLRegOp::JZ || in.op == QLRegOp::RET || in.op == QLRegOp::HALT ? state[in.a] : QLIRValue{};
+            if (in.op == QLRegOp::JZ && c.kind == QLIRLattice::Constant) {
+                if (c.value != 0) continue;
+                in = { in.imm, 0, 0, 0, QLRegOp::JMP };
+                block.next = UINT32_MAX;
+            }
+            else if ((in.op == QLRegOp::RET || in.op == QLRegOp::HALT) && c.kind == QLIRLattice::Constant) {
+                in = { c.value, 0, 0, 0, in.op == QLRegOp::RET ? QLRegOp::RETI : QLRegOp::HALTI };
+            }
+            transfer(in);
+            code.push_back(in);
+        }
+        block.code = std::move(code);
+    }
+}
+
+// Local algebraic identities and copy propagation. Within a block, reads of
+// a register copied by MOV read the source instead while neither has been
+// written since, which leaves the copies for dead-store elimination.
+static void irSimplify(const QLIRModule& module, QLIRFunction& fn) {
+    const size_t width = fn.frameSize;
+    std::vector<uint32_t> version(width, 0);
+    struct Copy {
+        int32_t source;
+        uint32_t version;
+    };
+    std::vector<Copy> copies(width);
+    for (QLIRBlock& block : fn.blocks) {
+        if (!block.live) continue;
+        std::fill(copies.begin(), copies.end(), Copy{ -1, 0 });
+        auto resolve = [&](uint16_t r) -> uint16_t {
+            const Copy& c = copies[r];
+            return c.source >= 0 && version[c.source] == c.version ? static_cast<uint16_t>(c.source) : r;
+        };
+        auto define = [&](uint16_t r) {
+            ++version[r];
+            copies[r] = { -1, 0 };
+        };
+        std::vector<QLRegInstr> code;
+        code.reserve(block.code.size());
+        for (QLRegInstr in : block.code) {
+            if ((irIsPure(in.op) && in.op != QLRegOp::MOVI) || in.op == QLRegOp::JZ || in.op == QLRegOp::RET ||
+                in.op == QLRegOp::HALT || in.op == QLRegOp::CALL_DYN) {
+                in.a = resolve(in.a);
+                if (irIsRegisterBinary(in.op)) in.b = resolve(in.b);
+            }
+            if (irIsRegisterBinary(in.op) && in.a == in.b) {
+                if (in.op == QLRegOp::SUB || in.op == QLRegOp::LT) in = { 0, in.d, 0, 0, QLRegOp::MOVI };
+                else if (in.op == QLRegOp::LE || in.op == QLRegOp::EQ) in = { 1, in.d, 0, 0, QLRegOp::MOVI };
+            }
+            else if ((in.op == QLRegOp::ADDI || in.op == QLRegOp::SUBI) && in.imm == 0) in = { 0, in.d, in.a, 0, QLRegOp::MOV };
+            else if (in.op == QLRegOp::MULI && in.imm == 1) in = { 0, in.d, in.a, 0, QLRegOp::MOV };
+            else if (in.op == QLRegOp::MULI && in.imm == 0) in = { 0, in.d, 0, 0, QLRegOp::MOVI };
+            if (in.op == QLRegOp::MOV && in.d == in.a) continue;
+
+            if (in.op == QLRegOp::CALL || in.op == QLRegOp::CALL_DYN) {
+                for (size_t r = in.d; r < width; ++r) define(static_cast<uint16_t>(r));
+            }
+            else if (irIsPure(in.op) || (in.op == QLRegOp::CALL_EXT && module.callSites[in.imm].pushesResult)) {
+                define(in.d);
+                if (in.op == QLRegOp::MOV) copies[in.d] = { in.a, version[in.a] };
+            }
+            code.push_back(in);
+        }
+        block.code = std::move(code);
+    }
+}
+
+// Backward liveness over the CFG (worklist, bitsets per block), then a
+// sweep that drops pure instructions whose result is never read. A MOV
+// whose source dies there is folded into the instruction that produced the
+// source when nothing in between touches either register, which turns
+// "t = a + b; x = t" into "x = a + b".
+static void irEliminateDeadStores(const QLIRModule& module, QLIRFunction& fn) {
+    const size_t blocks = fn.blocks.size(), width = fn.frameSize, words = (width + 63) / 64;
+    if (words == 0) return;
+    std::vector<uint64_t> gen(blocks * words, 0), kill(blocks * words, 0), liveIn(blocks * words, 0);
+    std::vector<std::vector<uint32_t>> preds(blocks);
+    auto bit = [](std::vector<uint64_t>& set, size_t base, uint16_t r) -> uint64_t& { return set[base + r / 64]; };
+    for (uint32_t b = 0; b < blocks; ++b) {
+        const QLIRBlock& block = fn.blocks[b];
+        if (!block.live) continue;
+        irForEachSuccessor(block, [&](uint32_t s) { preds[s].push_back(b); });
+        for (auto it = block.code.rbegin(); it != block.code.rend(); ++it) {
+            int32_t d = irOperands(module, *it, [](uint16_t) {});
+            if (d >= 0) {
+                bit(kill, b * words, static_cast<uint16_t>(d)) |= uint64_t(1) << (d % 64);
+                bit(gen, b * words, static_cast<uint16_t>(d)) &= ~(uint64_t(1) << (d % 64));
+            }
+            irOperands(module, *it, [&](uint16_t u) { bit(gen, b * words, u) |= uint64_t(1) << (u % 64); });
+        }
+    }
+    std::vector<uint32_t> work;
+    std::vector<bool> queued(blocks, false);
+    for (uint32_t b = static_cast<uint32_t>(blocks); b-- > 0;)
+        if (fn.blocks[b].live) {
+            work.push_back(b);
+            queued[b] = true;
+        }
+    std::vector<uint64_t> live(words);
+    auto liveOut = [&](uint32_t b) {
+        std::fill(live.begin(), live.end(), 0);
+        irForEachSuccessor(fn.blocks[b], [&](uint32_t s) {
+            for (size_t w = 0; w < words; ++w) live[w] |= liveIn[s * words + w];
+        });
+    };
+    while (!work.empty()) {
+        uint32_t b = work.back();
+        work.pop_back();
+        queued[b] = false;
+        liveOut(b);
+        bool changed = false;
+        for (size_t w = 0; w < words; ++w) {
+            uint64_t in = gen[b * words + w] | (live[w] & ~kill[b * words + w]);
+            if (in != liveIn[b * words + w]) {
+                liveIn[b * words + w] = in;
+                changed = true;
+            }
+        }
+        if (changed)
+            for (uint32_t p : preds[b])
+                if (!queued[p]) {
+                    queued[p] = true;
+                    work.push_back(p);
+                }
+    }
+
+    std::vector<int32_t> lastDef(width), lastTouch(width);
+    for (uint32_t b = 0; b < blocks; ++b) {
+        QLIRBlock& block = fn.blocks[b];
+        if (!block.live) continue;
+        liveOut(b);
+        auto isLive = [&](uint16_t r) { return (live[r / 64] >> (r % 64)) & 1; };
+        std::vector<QLRegInstr> kept;
+        std::vector<bool> sourceDies;
+        for (auto it = block.code.rbegin(); it != block.code.rend(); ++it) {
+            const QLRegInstr& in = *it;
+            if (irIsPure(in.op) && !isLive(in.d)) continue;
+            sourceDies.push_back(in.op == QLRegOp::MOV && !isLive(in.a));
+            int32_t d = irOperands(module, in, [](uint16_t) {});
+            if (d >= 0) live[d / 64] &= ~(uint64_t(1) << (d % 64));
+            irOperands(module, in, [&](uint16_t u) { live[u / 64] |= uint64_t(1) << (u % 64); });
+            kept.push_back(in);
+        }
+        std::reverse(kept.begin(), kept.end());
+        std::reverse(sourceDies.begin(), sourceDies.end());
+
+        std::fill(lastDef.begin(), lastDef.end(), -1);
+        std::fill(lastTouch.begin(), lastTouch.end(), -1);
+        int32_t lastCall = -1;
+        std::vector<bool> removed(kept.size(), false);
+        for (int32_t j = 0; j < static_cast<int32_t>(kept.size()); ++j) {
+            QLRegInstr& in = kept[j];
+            if (in.op == QLRegOp::MOV && sourceDies[j]) {
+                int32_t i = lastDef[in.a];
+                if (i >= 0 && !removed[i] && irIsPure(kept[i].op) && kept[i].d == in.a && lastTouch[in.a] <= i &&
+                    lastTouch[in.d] <= i && lastCall < i) {
+                    kept[i].d = in.d;
+                    removed[j] = true;
+                    lastDef[in.d] = i;
+                    lastTouch[in.d] = i;
+                    continue;
+                }
+            }
+            int32_t d = irOperands(module, in, [&](uint16_t u) { lastTouch[u] = j; });
+            if (d >= 0) lastDef[d] = lastTouch[d] = j;
+            if (in.op == QLRegOp::CALL || in.op == QLRegOp::CALL_DYN || in.op == QLRegOp::CALL_EXT) lastCall = j;
+        }
+        block.code.clear();
+        for (size_t k = 0; k < kept.size(); ++k)
+            if (!removed[k]) block.code.push_back(kept[k]);
+    }
+}
+
+// Jumps to blocks that only jump on are retargeted, a JZ whose two ways
+// meet is dropped, a block whose single successor has no other
+// predecessor absorbs it, and blocks the entry no longer reaches go.
+static void irSimplifyCFG(QLIRFunction& fn) {
+    const uint32_t blocks = static_cast<uint32_t>(fn.blocks.size());
+    auto forward = [&](uint32_t b) {
+        for (uint32_t steps = 0; steps < blocks; ++steps) {
+            const QLIRBlock& block = fn.blocks[b];
+            if (block.code.empty() && block.next != UINT32_MAX) b = block.next;
+            else if (block.code.size() == 1 && block.code[0].op == QLRegOp::JMP) b = static_cast<uint32_t>(block.code[0].imm);
+            else break;
+        }
+        return b;
+    };
+    for (QLIRBlock& block : fn.blocks) {
+        if (!block.live) continue;
+        if (block.next != UINT32_MAX) block.next = forward(block.next);
+        if (!block.code.empty() && irIsJump(block.code.back().op)) {
+            QLRegInstr& last = block.code.back();
+            last.imm = forward(static_cast<uint32_t>(last.imm));
+            if (last.op == QLRegOp::JZ && static_cast<uint32_t>(last.imm) == block.next) block.code.pop_back();
+        }
+    }
+
+    std::vector<uint32_t> predCount(blocks, 0);
+    std::vector<bool> reached(blocks, false);
+    std::vector<uint32_t> work{ 0 };
+    reached[0] = true;
+    while (!work.empty()) {
+        uint32_t b = work.back();
+        work.pop_back();
+        irForEachSuccessor(fn.blocks[b], [&](uint32_t s) {
+            ++predCount[s];
+            if (!reached[s]) {
+                reached[s] = true;
+                work.push_back(s);
+            }
+        });
+    }
+    for (uint32_t b = 0; b < blocks; ++b)
+        if (!reached[b]) {
+            fn.blocks[b] = {};
+            fn.blocks[b].live = false;
+        }
+
+    for (uint32_t b = 0; b < blocks; ++b) {
+        QLIRBlock& block = fn.blocks[b];
+        while (block.live) {
+            uint32_t s = UINT32_MAX;
+            if (!block.code.empty() && block.code.back().op == QLRegOp::JMP) s = static_cast<uint32_t>(block.code.back().imm);
+            else if (block.code.empty() || !irIsJump(block.code.back().op)) s = block.next;
+            if (s == UINT32_MAX || s == b || s == 0 || predCount[s] != 1) break;
+            if (!block.code.empty() && block.code.back().op == QLRegOp::JMP) block.code.pop_back();
+            QLIRBlock& absorbed = fn.blocks[s];
+            block.code.insert(block.code.end(), absorbed.code.begin(), absorbed.code.end());
+            block.next = absorbed.next;
+            absorbed = {};
+            absorbed.live = false;
+        }
+    }
+}
+
+void buildIRGraph(std::vector<std::vector<uint32_t>> succs, uint32_t entry, QLIRGraph& g) {
+    const uint32_t n = static_cast<uint32_t>(succs.size());
+    g = {};
+    g.succs = std::move(succs);
+    g.rpoIndex.assign(n, UINT32_MAX);
+    std::vector<uint32_t> post;
+    std::vector<std::pair<uint32_t, size_t>> stack{ { entry, 0 } };
+    std::vector<bool> seen(n, false);
+    seen[entry] = true;
+    while (!stack.empty()) {
+        auto& [b, i] = stack.back();
+        if (i < g.succs[b].size()) {
+            uint32_t s = g.succs[b][i++];
+            if (!seen[s]) {
+                seen[s] = true;
+                stack.push_back({ s, 0 });
+            }
+            continue;
+        }
+        post.push_back(b);
+        stack.pop_back();
+    }
+    g.rpo.assign(post.rbegin(), post.rend());
+    for (uint32_t i = 0; i < g.rpo.size(); ++i) g.rpoIndex[g.rpo[i]] = i;
+    g.preds.assign(n, {});
+    for (uint32_t b : g.rpo)
+        for (uint32_t s : g.succs[b]) g.preds[s].push_back(b);
+
+    g.idom.assign(n, UINT32_MAX);
+    g.idom[entry] = entry;
+    auto intersect = [&](uint32_t a, uint32_t b) {
+        while (a != b) {
+            while (g.rpoIndex[a] > g.rpoIndex[b]) a = g.idom[a];
+            while (g.rpoIndex[b] > g.rpoIndex[a]) b = g.idom[b];
+        }
+        return a;
+    };
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = 1; i < g.rpo.size(); ++i) {
+            uint32_t b = g.rpo[i], idom = UINT32_MAX;
+            for (uint32_t p : g.preds[b])
+                if (g.idom[p] != UINT32_MAX) idom = idom == UINT32_MAX ? p : intersect(p, idom);
+            if (g.idom[b] != idom) {
+                g.idom[b] = idom;
+                changed = true;
+            }
+        }
+    }
+
+    g.children.assign(n, {});
+    g.frontier.assign(n, {});
+    for (size_t i = 1; i < g.rpo.size(); ++i) g.children[g.idom[g.rpo[i]]].push_back(g.rpo[i]);
+    for (uint32_t b : g.rpo) {
+        // The entry has an implicit edge in, so any predecessor makes it a
+        // join, and its runners walk up to and including the entry itself.
+        if (g.preds[b].size() < (b == entry ? 1u : 2u)) continue;
+        uint32_t stop = b == entry ? UINT32_MAX : g.idom[b];
+        for (uint32_t p : g.preds[b])
+            for (uint32_t runner = p; runner != stop; runner = g.idom[runner]) {
+                if (!g.frontier[runner].empty() && g.frontier[runner].back() == b) break;
+                g.frontier[runner].push_back(b);
+                if (runner == entry) break;
+            }
+    }
+    g.preorder.assign(n, UINT32_MAX);
+    g.postorder.assign(n, 0);
+    uint32_t pre = 0, postCount = 0;
+    std::vector<std::pair<uint32_t, size_t>> walk{ { entry, 0 } };
+    g.preorder[entry] = pre++;
+    while (!walk.empty()) {
+        auto& [b, i] = walk.back();
+        if (i < g.children[b].size()) {
+            uint32_t c = g.children[b][i++];
+            g.preorder[c] = pre++;
+            walk.push_back({ c, 0 });
+            continue;
+        }
+        g.postorder[b] = postCount++;
+        walk.pop_back();
+    }
+}
+
+std::vector<std::vector<uint32_t>> irSuccessors(const QLIRFunction& fn) {
+    std::vector<std::vector<uint32_t>> succs(fn.blocks.size());
+    for (uint32_t b = 0; b < fn.blocks.size(); ++b)
+        if (fn.blocks[b].live)
+            irForEachSuccessor(fn.blocks[b], [&](uint32_t s) {
+                if (succs[b].empty() || succs[b].back() != s) succs[b].push_back(s);
+            });
+    return succs;
+}
+
+bool buildSSA(const QLIRModule& module, const QLIRFunction& fn, QLSSAFunction& ssa) {
+    const uint32_t width = fn.frameSize, blocks = static_cast<uint32_t>(fn.blocks.size()) + 1;
+    if (static_cast<size_t>(blocks) * std::max<uint32_t>(width, 1) > (size_t(1) << 24)) return false;
+    ssa = {};
+    ssa.params = fn.params;
+    ssa.slots = fn.slots;
+    ssa.frameSize = fn.frameSize;
+    ssa.blocks.resize(blocks);
+    ssa.blocks[0].next = 1;
+    std::vector<std::vector<uint32_t>> succs(blocks);
+    succs[0].push_back(1);
+    std::vector<std::vector<uint32_t>> irSuccs = irSuccessors(fn);
+    for (uint32_t b = 1; b < blocks; ++b) {
+        const QLIRBlock& block = fn.blocks[b - 1];
+        if (!block.live) continue;
+        ssa.blocks[b].next = block.next == UINT32_MAX ? UINT32_MAX : block.next + 1;
+        for (uint32_t s : irSuccs[b - 1]) succs[b].push_back(s + 1);
+    }
+    buildIRGraph(std::move(succs), 0, ssa.graph);
+    const QLIRGraph& g = ssa.graph;
+
+    // Definition sites and registers live across blocks.
+    std::vector<std::vector<uint32_t>> defSites(width);
+    std::vector<uint32_t> definedIn(width, UINT32_MAX);
+    std::vector<bool> global(width, false);
+    for (uint32_t r = 0; r < width; ++r) defSites[r].push_back(0);
+    for (uint32_t b : g.rpo) {
+        if (b == 0) continue;
+        for (const QLRegInstr& in : fn.blocks[b - 1].code) {
+            QLIRAccess x = irAccess(module, in);
+            auto read = [&](uint32_t r) { if (definedIn[r] != b) global[r] = true; };
+            if (x.readsA) read(in.a);
+            if (x.readsB) read(in.b);
+            for (uint32_t k = 0; k < x.argc; ++k) read(in.d + k);
+            auto write = [&](uint32_t r) {
+                if (definedIn[r] != b) {
+                    definedIn[r] = b;
+                    defSites[r].push_back(b);
+                }
+            };
+            if (x.writes) write(in.d);
+            if (x.clobbers)
+                for (uint32_t r = in.d + 1u; r < width; ++r) write(r);
+        }
+    }
+
+    ssa.values.push_back({ QLSSAKind::Undefined, 0, 0 });
+    std::vector<uint32_t> phiAt(blocks, UINT32_MAX), queuedAt(blocks, UINT32_MAX);
+    for (uint32_t r = 0; r < width; ++r) {
+        if (!global[r]) continue;
+        std::vector<uint32_t> work = defSites[r];
+        for (uint32_t b : work) queuedAt[b] = r;
+        while (!work.empty()) {
+            uint32_t b = work.back();
+            work.pop_back();
+            for (uint32_t f : g.frontier[b]) {
+                if (phiAt[f] == r) continue;
+                phiAt[f] = r;
+                ssa.blocks[f].phis.push_back({ static_cast<uint32_t>(ssa.values.size()), std::vector<uint32_t>(g.preds[f].size(), 0) });
+                ssa.values.push_back({ QLSSAKind::Phi, static_cast<uint16_t>(r), f });
+                if (queuedAt[f] != r) {
+                    queuedAt[f] = r;
+                    work.push_back(f);
+                }
+            }
+        }
+    }
+
+    std::vector<uint32_t> current(width, 0);
+    for (uint32_t r = 0; r < std::min(width, fn.slots); ++r) {
+        current[r] = static_cast<uint32_t>(ssa.values.size());
+        ssa.values.push_back({ QLSSAKind::Entry, static_cast<uint16_t>(r), 0 });
+    }
+    std::vector<std::pair<uint16_t, uint32_t>> undo;
+    auto set = [&](uint32_t r, uint32_t value) {
+        undo.push_back({ static_cast<uint16_t>(r), current[r] });
+        current[r] = value;
+    };
+    struct Visit {
+        uint32_t block;
+        size_t undoMark;
+        size_t child;
+    };
+    std::vector<Visit> walk{ { 0, 0, 0 } };
+    bool entered = false;
+    while (!walk.empty()) {
+        Visit& v = walk.back();
+        uint32_t b = v.block;
+        if (!entered) {
+            v.undoMark = undo.size();
+            QLSSABlock& block = ssa.blocks[b];
+            for (const QLSSAPhi& phi : block.phis) set(ssa.values[phi.value].reg, phi.value);
+            if (b > 0) {
+                block.code.reserve(fn.blocks[b - 1].code.size());
+                for (const QLRegInstr& in : fn.blocks[b - 1].code) {
+                    QLIRAccess x = irAccess(module, in);
+                    QLSSAInstr s{ in };
+                    if (irIsJump(in.op)) s.in.imm += 1;
+                    if (x.readsA) s.a = current[in.a];
+                    if (x.readsB) s.b = current[in.b];
+                    s.args = static_cast<uint32_t>(ssa.argPool.size());
+                    s.argCount = x.argc;
+                    for (uint32_t k = 0; k < x.argc; ++k) ssa.argPool.push_back(current[in.d + k]);
+                    if (x.clobbers)
+                        for (uint32_t r = in.d + 1u; r < width; ++r) set(r, 0);
+                    if (x.writes) {
+                        s.def = static_cast<uint32_t>(ssa.values.size());
+                        ssa.values.push_back({ QLSSAKind::Instr, in.d, b });
+                        set(in.d, s.def);
+                    }
+                    block.code.push_back(s);
+                }
+            }
+            for (uint32_t s : g.succs[b]) {
+                size_t j = std::find(g.preds[s].begin(), g.preds[s].end(), b) - g.preds[s].begin();
+                for (QLSSAPhi& phi : ssa.blocks[s].phis) phi.args[j] = current[ssa.values[phi.value].reg];
+            }
+        }
+        if (v.child < g.children[b].size()) {
+            uint32_t c = g.children[b][v.child++];
+            walk.push_back({ c, 0, 0 });
+            entered = false;
+            continue;
+        }
+        while (undo.size() > v.undoMark) {
+            current[undo.back().first] = undo.back().second;
+            undo.pop_back();
+        }
+        walk.pop_back();
+        entered = true;
+    }
+    return true;
+}
+
+bool verifySSA(const QLSSAFunction& ssa, std::string& error) {
+    const QLIRGraph& g = ssa.graph;
+    std::vector<uint32_t> defBlock(ssa.values.size(), UINT32_MAX), defPos(ssa.values.size(), 0);
+    auto define = [&](uint32_t value, uint32_t block, uint32_t pos) {
+        if (defBlock[value] != UINT32_MAX) {
+            error = "value " + std::to_string(value) + " is defined twice";
+            return false;
+        }
+        defBlock[value] = block;
+        defPos[value] = pos;
+        return true;
+    };
+    for (uint32_t v = 1; v < ssa.values.size(); ++v)
+        if (ssa.values[v].kind == QLSSAKind::Entry && !define(v, 0, 0)) return false;
+    for (uint32_t b : g.rpo) {
+        for (const QLSSAPhi& phi : ssa.blocks[b].phis)
+            if (!define(phi.value, b, 0)) return false;
+        for (uint32_t i = 0; i < ssa.blocks[b].code.size(); ++i)
+            if (ssa.blocks[b].code[i].def && !define(ssa.blocks[b].code[i].def, b, i + 1)) return false;
+    }
+    auto available = [&](uint32_t value, uint32_t block, uint32_t pos) {
+        if (value == 0) return true;
+        if (value >= ssa.values.size() || defBlock[value] == UINT32_MAX) return false;
+        if (defBlock[value] == block) return defPos[value] < pos;
+        return g.dominates(defBlock[value], block);
+    };
+    for (uint32_t b : g.rpo) {
+        for (const QLSSAPhi& phi : ssa.blocks[b].phis) {
+            if (phi.args.size() != g.preds[b].size()) {
+                error = "phi " + std::to_string(phi.value) + " has the wrong number of arguments";
+                return false;
+            }
+            for (size_t i = 0; i < phi.args.size(); ++i)
+                if (!available(phi.args[i], g.preds[b][i], UINT32_MAX)) {
+                    error = "phi " + std::to_string(phi.value) + " argument " + std::to_string(phi.args[i]) + " is not available";
+                    return false;
+                }
+        }
+        for (uint32_t i = 0; i < ssa.blocks[b].code.size(); ++i) {
+            const QLSSAInstr& s = ssa.blocks[b].code[i];
+            bool ok = available(s.a, b, i + 1) && available(s.b, b, i + 1);
+            for (uint32_t k = 0; k < s.argCount; ++k) ok = ok && available(ssa.argPool[s.args + k], b, i + 1);
+            if (!ok) {
+                error = "block " + std::to_string(b) + " instruction " + std::to_string(i) + " reads a value not available there";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void ssaValueNumber(QLSSAFunction& ssa) {
+    const QLIRGraph& g = ssa.graph;
+    std::vector<uint32_t> replace(ssa.values.size());
+    for (uint32_t v = 0; v < replace.size(); ++v) replace[v] = v;
+    auto find = [&](uint32_t v) {
+        uint32_t root = v;
+        while (replace[root] != root) root = replace[root];
+        while (replace[v] != root) {
+            uint32_t up = replace[v];
+            replace[v] = root;
+            v = up;
+        }
+        return root;
+    };
+    struct Key {
+        QLRegOp op;
+        int64_t imm;
+        uint32_t a, b;
+        bool operator==(const Key& o) const { return op == o.op && imm == o.imm && a == o.a && b == o.b; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            uint64_t h = static_cast<uint64_t>(k.imm) * 0x9E3779B97F4A7C15ull;
+            h ^= (static_cast<uint64_t>(k.a) << 32 | k.b) + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+            return static_cast<size_t>(h ^ static_cast<uint8_t>(k.op));
+        }
+    };
+    std::unordered_map<Key, uint32_t, KeyHash> table;
+    std::vector<Key> scope;
+    std::vector<std::pair<uint32_t, size_t>> walk{ { 0, 0 } };
+    std::vector<size_t> marks;
+    bool entered = false;
+    while (!walk.empty()) {
+        auto& [b, child] = walk.back();
+        if (!entered) {
+            marks.push_back(scope.size());
+            std::vector<QLSSAInstr>& code = ssa.blocks[b].code;
+            size_t kept = 0;
+            for (QLSSAInstr s : code) {
+                s.a = find(s.a);
+                s.b = find(s.b);
+                for (uint32_t k = 0; k < s.argCount; ++k) ssa.argPool[s.args + k] = find(ssa.argPool[s.args + k]);
+                if (s.in.op == QLRegOp::MOV && s.a != 0) {
+                    replace[s.def] = s.a;
+                    continue;
+                }
+                if (irIsPure(s.in.op) && s.in.op != QLRegOp::MOVI && s.a != 0 && (s.b != 0 || !irIsRegisterBinary(s.in.op))) {
+                    Key key{ s.in.op, irIsRegisterBinary(s.in.op) ? 0 : s.in.imm, s.a, s.b };
+                    bool commutative = s.in.op == QLRegOp::ADD || s.in.op == QLRegOp::MUL || s.in.op == QLRegOp::EQ;
+                    if (commutative && key.a > key.b) std::swap(key.a, key.b);
+                    auto [it, inserted] = table.emplace(key, s.def);
+                    if (!inserted) {
+                        replace[s.def] = it->second;
+                        continue;
+                    }
+                    scope.push_back(key);
+                }
+                code[kept++] = s;
+            }
+            code.resize(kept);
+        }
+        if (child < g.children[b].size()) {
+            uint32_t c = g.children[b][child++];
+            walk.push_back({ c, 0 });
+            entered = false;
+            continue;
+        }
+        while (scope.size() > marks.back()) {
+            table.erase(scope.back());
+            scope.pop_back();
+        }
+        marks.pop_back();
+        walk.pop_back();
+        entered = true;
+    }
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (uint32_t b : g.rpo) {
+            std::vector<QLSSAPhi>& phis = ssa.blocks[b].phis;
+            for (size_t i = 0; i < phis.size();) {
+                uint32_t same = UINT32_MAX;
+                bool trivial = true;
+                for (uint32_t& arg : phis[i].args) {
+                    arg = find(arg);
+                    if (arg == phis[i].value || arg == same) continue;
+                    if (same != UINT32_MAX || arg == 0) trivial = false;
+                    same = arg;
+                }
+                if (trivial && same != UINT32_MAX) {
+                    replace[phis[i].value] = same;
+                    phis.erase(phis.begin() + static_cast<std::ptrdiff_t>(i));
+                    changed = true;
+                    continue;
+                }
+                ++i;
+            }
+        }
+    }
+    for (uint32_t b : g.rpo) {
+        for (QLSSAPhi& phi : ssa.blocks[b].phis)
+            for (uint32_t& arg : phi.args) arg = find(arg);
+        for (QLSSAInstr& s : ssa.blocks[b].code) {
+            s.a = find(s.a);
+            s.b = find(s.b);
+        }
+    }
+    for (uint32_t& arg : ssa.argPool) arg = find(arg);
+}
+
+// Emits copies that together act as one parallel assignment dst <- src:
+// a copy goes out once nothing still pending reads its destination, and
+// a cycle is broken by saving one destination in `scratch`.
+static void emitParallelCopy(std::vector<std::pair<uint16_t, uint16_t>> copies, uint16_t scratch, std::vector<QLRegInstr>& out,
+                      bool& usedScratch) {
+    copies.erase(std::remove_if(copies.begin(), copies.end(), [](const auto& c) { return c.first == c.second; }), copies.end());
+    while (!copies.empty()) {
+        bool emitted = false;
+        for (size_t i = 0; i < copies.size(); ++i) {
+            uint16_t dst = copies[i].first;
+            bool read = false;
+            for (size_t j = 0; j < copies.size() && !read; ++j) read = j != i && copies[j].second == dst;
+            if (read) continue;
+            out.push_back({ 0, dst, copies[i].second, 0, QLRegOp::MOV });
+            copies.erase(copies.begin() + static_cast<std::ptrdiff_t>(i));
+            emitted = true;
+            break;
+        }
+        if (emitted) continue;
+        uint16_t saved = copies[0].first;
+        out.push_back({ 0, scratch, saved, 0, QLRegOp::MOV });
+        usedScratch = true;
+        for (auto& c : copies)
+            if (c.second == saved) c.second = scratch;
+    }
+}
+
+bool lowerSSA(const QLIRModule& module, const QLSSAFunction& ssa, QLIRFunction& out) {
+    const QLIRGraph& g = ssa.graph;
+    const size_t valueCount = ssa.values.size();
+    const uint32_t blocks = static_cast<uint32_t>(ssa.blocks.size());
+
+    // Liveness by exploring backwards from each use to the definition.
+    std::vector<std::vector<uint32_t>> liveIn(blocks), liveOut(blocks);
+    std::vector<uint32_t> markIn(blocks, UINT32_MAX), markOut(blocks, UINT32_MAX);
+    // Uses grouped by value: (block, predecessor for a phi argument or UINT32_MAX).
+    std::vector<uint32_t> useStart(valueCount + 1, 0);
+    std::vector<std::pair<uint32_t, uint32_t>> uses;
+    for (int pass = 0; pass < 2; ++pass) {
+        auto use = [&](uint32_t v, uint32_t b, uint32_t pred) {
+            if (v == 0) return;
+            if (pass == 0) ++useStart[v + 1];
+            else uses[useStart[v]++] = { b, pred };
+        };
+        for (uint32_t b : g.rpo) {
+            for (const QLSSAPhi& phi : ssa.blocks[b].phis)
+                for (size_t i = 0; i < phi.args.size(); ++i) use(phi.args[i], b, g.preds[b][i]);
+            for (const QLSSAInstr& s : ssa.blocks[b].code) {
+                use(s.a, b, UINT32_MAX);
+                use(s.b, b, UINT32_MAX);
+                for (uint32_t k = 0; k < s.argCount; ++k) use(ssa.argPool[s.args + k], b, UINT32_MAX);
+            }
+        }
+        if (pass == 0) {
+            for (size_t v = 0; v < valueCount; ++v) useStart[v + 1] += useStart[v];
+            uses.resize(useStart[valueCount]);
+        } else {
+            for (size_t v = valueCount; v-- > 0;) useStart[v + 1] = useStart[v];
+            useStart[0] = 0;
+        }
+    }
+    std::vector<uint32_t> work;
+    for (uint32_t v = 1; v < valueCount; ++v) {
+        uint32_t home = ssa.values[v].block;
+        auto liveOutOf = [&](uint32_t p) {
+            if (markOut[p] == v) return;
+            markOut[p] = v;
+            liveOut[p].push_back(v);
+            if (p != home) work.push_back(p);
+        };
+        for (uint32_t u = useStart[v]; u < useStart[v + 1]; ++u) {
+            auto [b, pred] = uses[u];
+            if (pred != UINT32_MAX) liveOutOf(pred);
+            else if (b != home) work.push_back(b);
+        }
+        while (!work.empty()) {
+            uint32_t b = work.back();
+            work.pop_back();
+            if (markIn[b] == v) continue;
+            markIn[b] = v;
+            liveIn[b].push_back(v);
+            for (uint32_t p : g.preds[b]) liveOutOf(p);
+        }
+    }
+
+    // Values that cannot stay in the register they rename.
+    const uint32_t width = ssa.frameSize;
+    std::vector<bool> moved(valueCount, false), alive(valueCount, false);
+    std::vector<uint32_t> count(width, 0);
+    std::vector<uint32_t> aliveList;
+    auto add = [&](uint32_t v) {
+        if (v == 0 || alive[v]) return;
+        alive[v] = true;
+        aliveList.push_back(v);
+        ++count[ssa.values[v].reg];
+    };
+    auto kill = [&](uint32_t v) {
+        if (!alive[v]) {
+            if (count[ssa.values[v].reg] > 0) moved[v] = true;  // defined while another value holds its register
+            return;
+        }
+        alive[v] = false;
+        aliveList.erase(std::find(aliveList.begin(), aliveList.end(), v));
+        if (--count[ssa.values[v].reg] > 0) moved[v] = true;
+    };
+    for (uint32_t b : g.rpo) {
+        for (uint32_t v : liveOut[b]) add(v);
+        const std::vector<QLSSAInstr>& code = ssa.blocks[b].code;
+        for (size_t i = code.size(); i-- > 0;) {
+            const QLSSAInstr& s = code[i];
+            if (s.def) kill(s.def);
+            if (s.in.op == QLRegOp::CALL || s.in.op == QLRegOp::CALL_DYN)
+                for (uint32_t v : aliveList)
+                    if (ssa.values[v].reg >= s.in.d) moved[v] = true;
+            if (s.in.op == QLRegOp::CALL_EXT)
+                for (uint32_t v : aliveList) {
+                    uint32_t k = ssa.values[v].reg - s.in.d;
+                    if (ssa.values[v].reg >= s.in.d && k < s.argCount && ssa.argPool[s.args + k] != v) moved[v] = true;
+                }
+            add(s.a);
+            add(s.b);
+            for (uint32_t k = 0; k < s.argCount; ++k) add(ssa.argPool[s.args + k]);
+        }
+        for (const QLSSAPhi& phi : ssa.blocks[b].phis) kill(phi.value);
+        if (b == 0)
+            for (uint32_t v = 1; v < valueCount; ++v)
+                if (ssa.values[v].kind == QLSSAKind::Entry) kill(v);
+        for (uint32_t v : aliveList) {
+            alive[v] = false;
+            count[ssa.values[v].reg] = 0;
+        }
+        aliveList.clear();
+    }
+
+    std::vector<uint32_t> home(valueCount, 0);
+    uint32_t fresh = 0;
+    for (uint32_t v = 1; v < valueCount; ++v)
+        if (moved[v]) home[v] = ssa.slots + fresh++;
+    if (static_cast<size_t>(width) + fresh + 1 > 0xFFFF) return false;
+    auto map = [&](uint32_t r) { return static_cast<uint16_t>(r < ssa.slots ? r : r + fresh); };
+    for (uint32_t v = 1; v < valueCount; ++v)
+        if (!moved[v]) home[v] = map(ssa.values[v].reg);
+    const uint16_t scratch = static_cast<uint16_t>(width + fresh);
+    bool usedScratch = false;
+    auto reg = [&](uint32_t value, uint16_t original) { return value ? static_cast<uint16_t>(home[value]) : map(original); };
+
+    out = {};
+    out.params = ssa.params;
+    out.slots = ssa.slots;
+    out.blocks.resize(blocks);
+    for (uint32_t b = 0; b < blocks; ++b) {
+        QLIRBlock& block = out.blocks[b];
+        if (!g.reachable(b)) {
+            block.live = false;
+            continue;
+        }
+        block.next = ssa.blocks[b].next;
+        block.code.reserve(ssa.blocks[b].code.size());
+        if (b == 0)
+            for (uint32_t v = 1; v < valueCount; ++v)
+                if (ssa.values[v].kind == QLSSAKind::Entry && moved[v])
+                    block.code.push_back({ 0, static_cast<uint16_t>(home[v]), map(ssa.values[v].reg), 0, QLRegOp::MOV });
+        for (const QLSSAInstr& s : ssa.blocks[b].code) {
+            QLRegInstr in = s.in;
+            bool call = in.op == QLRegOp::CALL || in.op == QLRegOp::CALL_EXT || in.op == QLRegOp::CALL_DYN;
+            if (call) {
+                uint16_t base = map(in.d);
+                std::vector<std::pair<uint16_t, uint16_t>> copies;
+                for (uint32_t k = 0; k < s.argCount; ++k)
+                    if (ssa.argPool[s.args + k]) copies.push_back({ static_cast<uint16_t>(base + k), reg(ssa.argPool[s.args + k], 0) });
+                if (in.op == QLRegOp::CALL_DYN) {
+                    copies.push_back({ static_cast<uint16_t>(base + s.argCount), reg(s.a, in.a) });
+                    in.a = static_cast<uint16_t>(base + s.argCount);
+                }
+                emitParallelCopy(std::move(copies), scratch, block.code, usedScratch);
+                in.d = base;
+                block.code.push_back(in);
+                if (s.def && home[s.def] != base) block.code.push_back({ 0, static_cast<uint16_t>(home[s.def]), base, 0, QLRegOp::MOV });
+                continue;
+            }
+            QLIRAccess x = irAccess(module, in);
+            if (x.readsA) in.a = reg(s.a, in.a);
+            if (x.readsB) in.b = reg(s.b, in.b);
+            if (x.writes) in.d = reg(s.def, in.d);
+            block.code.push_back(in);
+        }
+    }
+    for (uint32_t b : g.rpo) {
+        const std::vector<uint32_t>& preds = g.preds[b];
+        if (ssa.blocks[b].phis.empty()) continue;
+        for (size_t i = 0; i < preds.size(); ++i) {
+            std::vector<std::pair<uint16_t, uint16_t>> copies;
+            for (const QLSSAPhi& phi : ssa.blocks[b].phis)
+                if (phi.args[i]) copies.push_back({ static_cast<uint16_t>(home[phi.value]), static_cast<uint16_t>(home[phi.args[i]]) });
+            std::vector<QLRegInstr> seq;
+            emitParallelCopy(std::move(copies), scratch, seq, usedScratch);
+            if (seq.empty()) continue;
+            uint32_t p = preds[i];
+            QLIRBlock& pred = out.blocks[p];
+            if (g.succs[p].size() == 1) {
+                if (!pred.code.empty() && pred.code.back().op == QLRegOp::JZ) pred.code.pop_back();  // both edges lead to b
+                auto at = pred.code.end();
+                if (!pred.code.empty() && pred.code.back().op == QLRegOp::JMP) --at;
+                pred.code.insert(at, seq.begin(), seq.end());
+                continue;
+            }
+            uint32_t split = static_cast<uint32_t>(out.blocks.size());
+            QLIRBlock edge;
+            edge.code = std::move(seq);
+            edge.next = b;
+            out.blocks.push_back(std::move(edge));
+            QLIRBlock& from = out.blocks[p];
+            if (!from.code.empty() && irIsJump(from.code.back().op) && from.code.back().imm == b) from.code.back().imm = split;
+            if (from.next == b) from.next = split;
+        }
+    }
+    out.frameSize = width + fresh + (usedScratch ? 1 : 0);
+    return true;
+}
+
+// SSA round trip used as a pass: value numbering between construction and
+// destruction. Regions without registers, and those that fail either way,
+// are left as they were.
+static void irValueNumber(const QLIRModule& module, QLIRFunction& fn) {
+    QLSSAFunction ssa;
+    if (fn.frameSize == 0 || !buildSSA(module, fn, ssa)) return;
+    ssaValueNumber(ssa);
+    QLIRFunction lowered;
+    if (lowerSSA(module, ssa, lowered)) fn = std::move(lowered);
+}
+
+// ---- Loop optimization ----
+// Natural loops: an edge whose target dominates its source is a back edge,
+// and the loop is its target (the header) plus every block that reaches
+// the source without passing the header. Back edges to one header make one
+// loop. Loops come out ordered by header in reverse postorder, so a loop
+// precedes the loops nested in it.
+struct QLLoop {
+    uint32_t header = 0;
+    uint32_t parent = UINT32_MAX;   // innermost enclosing loop
+    std::vector<uint32_t> blocks;   // in reverse postorder, header first
+    std::vector<uint32_t> latches;  // the header's predecessors inside the loop
+    bool innermost = true;
+};
+
+static std::vector<QLLoop> findLoops(const QLIRGraph& g) {
+    std::vector<QLLoop> loops;
+    std::vector<uint32_t> loopOf(g.succs.size(), UINT32_MAX), mark(g.succs.size(), UINT32_MAX);
+    for (uint32_t h : g.rpo) {
+        QLLoop loop;
+        loop.header = h;
+        for (uint32_t p : g.preds[h])
+            if (g.dominates(h, p)) loop.latches.push_back(p);
+        if (loop.latches.empty()) continue;
+        const uint32_t id = static_cast<uint32_t>(loops.size());
+        loop.parent = loopOf[h];
+        loop.blocks.push_back(h);
+        mark[h] = id;
+        std::vector<uint32_t> work = loop.latches;
+        while (!work.empty()) {
+            uint32_t b = work.back();
+            work.pop_back();
+            if (mark[b] == id) continue;
+            mark[b] = id;
+            loop.blocks.push_back(b);
+            for (uint32_t p : g.preds[b]) work.push_back(p);
+        }
+        std::sort(loop.blocks.begin(), loop.blocks.end(), [&](uint32_t a, uint32_t b) { return g.rpoIndex[a] < g.rpoIndex[b]; });
+        for (uint32_t b : loop.blocks) loopOf[b] = id;
+        if (loop.parent != UINT32_MAX) loops[loop.parent].innermost = false;
+        loops.push_back(std::move(loop));
+    }
+    return loops;
+}
+
+// The block every entry into `loop` comes through, when there is exactly
+// one and the header is its only successor; UINT32_MAX otherwise.
+static uint32_t loopPreheader(const QLIRGraph& g, const QLLoop& loop) {
+    uint32_t pre = UINT32_MAX;
+    for (uint32_t p : g.preds[loop.header]) {
+        if (std::find(loop.latches.begin(), loop.latches.end(), p) != loop.latches.end()) continue;
+        if (pre != UINT32_MAX) return UINT32_MAX;
+        pre = p;
+    }
+    return pre != UINT32_MAX && g.succs[pre].size() == 1 ? pre : UINT32_MAX;
+}
+
+// Inserts `count` empty blocks at index `at`, renumbering the blocks from
+// there up. Layout follows block order, so new blocks land where they run.
+static void irInsertBlocks(QLIRFunction& fn, uint32_t at, uint32_t count) {
+    auto shift = [&](uint32_t b) { return b != UINT32_MAX && b >= at ? b + count : b; };
+    for (QLIRBlock& block : fn.blocks) {
+        block.next = shift(block.next);
+        if (!block.code.empty() && irIsJump(block.code.back().op))
+            block.code.back().imm = shift(static_cast<uint32_t>(block.code.back().imm));
+    }
+    fn.blocks.insert(fn.blocks.begin() + at, count, QLIRBlock{});
+}
+
+void irInsertPreheaders(QLIRFunction& fn) {
+    for (;;) {
+        QLIRGraph g;
+        buildIRGraph(irSuccessors(fn), 0, g);
+        const QLLoop* missing = nullptr;
+        std::vector<QLLoop> loops = findLoops(g);
+        for (const QLLoop& loop : loops)
+            if (loopPreheader(g, loop) == UINT32_MAX) {
+                missing = &loop;
+                break;
+            }
+        if (!missing) return;
+        const uint32_t h = missing->header;
+        irInsertBlocks(fn, h, 1);
+        fn.blocks[h].next = h + 1;
+        for (uint32_t p : g.preds[h]) {
+            if (std::find(missing->latches.begin(), missing->latches.end(), p) != missing->latches.end()) continue;
+            QLIRBlock& from = fn.blocks[p >= h ? p + 1 : p];
+            if (!from.code.empty() && irIsJump(from.code.back().op) && from.code.back().imm == h + 1) from.code.back().imm = h;
+            if (from.next == h + 1) from.next = h;
+        }
+    }
+}
+
+void ssaOptimizeLoops(QLSSAFunction& ssa, QLLoopStats& stats) {
+    const QLIRGraph& g = ssa.graph;
+    std::vector<QLLoop> loops = findLoops(g);
+    stats.loops += loops.size();
+    std::vector<uint32_t> replace(ssa.values.size());
+    for (uint32_t v = 0; v < replace.size(); ++v) replace[v] = v;
+    auto find = [&](uint32_t v) {
+        while (replace[v] != v) v = replace[v];
+        return v;
+    };
+    std::vector<bool> known(ssa.values.size(), false), removed(ssa.values.size(), false), inLoop(ssa.blocks.size(), false);
+    std::vector<int64_t> constant(ssa.values.size(), 0);
+    for (uint32_t v = 1; v < ssa.values.size(); ++v)
+        known[v] = ssa.values[v].kind == QLSSAKind::Entry && ssa.values[v].reg >= ssa.params;  // zeroed slots
+    for (const QLSSABlock& block : ssa.blocks)
+        for (const QLSSAInstr& s : block.code)
+            if (s.in.op == QLRegOp::MOVI) {
+                known[s.def] = true;
+                constant[s.def] = s.in.imm;
+            }
+    auto newValue = [&](QLSSAKind kind, uint32_t block) {
+        uint32_t v = static_cast<uint32_t>(ssa.values.size());
+        ssa.values.push_back({ kind, static_cast<uint16_t>(ssa.frameSize), block });
+        replace.push_back(v);
+        known.push_back(false);
+        constant.push_back(0);
+        removed.push_back(false);
+        return v;
+    };
+    auto append = [&](uint32_t b, std::vector<QLSSAInstr> code) {
+        std::vector<QLSSAInstr>& into = ssa.blocks[b].code;
+        auto at = into.end();
+        if (!into.empty() && irIsJump(into.back().in.op)) --at;
+        into.insert(at, code.begin(), code.end());
+    };
+    auto instr = [&](QLRegOp op, uint32_t def, uint32_t a, uint32_t b, int64_t imm) {
+        QLSSAInstr s{ { imm, ssa.values[def].reg, ssa.values[a].reg, ssa.values[b].reg, op } };
+        s.def = def;
+        s.a = a;
+        s.b = b;
+        return s;
+    };
+
+    for (size_t l = loops.size(); l-- > 0;) {
+        const QLLoop& loop = loops[l];
+        const uint32_t pre = loopPreheader(g, loop), h = loop.header;
+        if (pre == UINT32_MAX || ssa.frameSize + 2 > 0xFFFF) continue;
+        for (uint32_t b : loop.blocks) inLoop[b] = true;
+        auto invariant = [&](uint32_t v) { return v != 0 && !inLoop[ssa.values[v].block]; };
+
+        std::vector<QLSSAInstr> hoisted;
+        for (uint32_t b : loop.blocks) {
+            std::vector<QLSSAInstr>& code = ssa.blocks[b].code;
+            size_t kept = 0;
+            for (QLSSAInstr& s : code) {
+                s.a = find(s.a);
+                s.b = find(s.b);
+                if (irIsPure(s.in.op) && s.in.op != QLRegOp::MOVI && invariant(s.a) && (!irIsRegisterBinary(s.in.op) || invariant(s.b))) {
+                    ssa.values[s.def].block = pre;
+                    hoisted.push_back(s);
+                    continue;
+                }
+                code[kept++] = s;
+            }
+            code.resize(kept);
+        }
+        stats.hoisted += hoisted.size();
+        append(pre, std::move(hoisted));
+
+        // Basic induction variables: phi value -> step.
+        std::unordered_map<uint32_t, int64_t> steps;
+        std::unordered_map<uint32_t, uint32_t> starts;
+        for (const QLSSAPhi& phi : ssa.blocks[h].phis) {
+            uint32_t next = UINT32_MAX, start = 0;
+            for (size_t i = 0; i < phi.args.size(); ++i) {
+                uint32_t arg = find(phi.args[i]);
+                if (g.preds[h][i] == pre) start = arg;
+                else if (next == UINT32_MAX || next == arg) next = arg;
+                else next = 0;
+            }
+            if (start == 0 || next == 0 || next == UINT32_MAX) continue;
+            for (uint32_t b : loop.blocks)
+                for (const QLSSAInstr& s : ssa.blocks[b].code)
+                    if (s.def == next && s.a == phi.value && (s.in.op == QLRegOp::ADDI || s.in.op == QLRegOp::SUBI)) {
+                        steps[phi.value] = s.in.op == QLRegOp::ADDI ? s.in.imm : irFold(QLRegOp::SUB, 0, s.in.imm);
+                        starts[phi.value] = start;
+                    }
+        }
+        // Uses of each value, to find products read only by an add.
+        std::vector<uint32_t> uses(ssa.values.size(), 0);
+        for (uint32_t b : g.rpo) {
+            for (const QLSSAPhi& phi : ssa.blocks[b].phis)
+                for (uint32_t arg : phi.args) ++uses[find(arg)];
+            for (const QLSSAInstr& s : ssa.blocks[b].code) {
+                ++uses[find(s.a)];
+                ++uses[find(s.b)];
+                for (uint32_t k = 0; k < s.argCount; ++k) ++uses[find(ssa.argPool[s.args + k])];
+            }
+        }
+        struct Candidate {
+            uint32_t def, product, iv;
+            uint32_t factor, offset;  // invariant values, 0 for the immediates
+            int64_t imm, addend;
+        };
+        std::vector<Candidate> candidates;
+        std::unordered_map<uint32_t, Candidate> products;
+        for (uint32_t b : loop.blocks)
+            for (const QLSSAInstr& s : ssa.blocks[b].code) {
+                if (s.in.op == QLRegOp::MULI && steps.count(s.a) && s.in.imm != 0 && s.in.imm != 1)
+                    products[s.def] = { s.def, s.def, s.a, 0, 0, s.in.imm, 0 };
+                else if (s.in.op == QLRegOp::MUL && steps.count(s.a) && invariant(s.b)) products[s.def] = { s.def, s.def, s.a, s.b, 0, 0, 0 };
+                else if (s.in.op == QLRegOp::MUL && steps.count(s.b) && invariant(s.a)) products[s.def] = { s.def, s.def, s.b, s.a, 0, 0, 0 };
+            }
+        for (uint32_t b : loop.blocks)
+            for (const QLSSAInstr& s : ssa.blocks[b].code) {
+                auto it = products.find(s.a);
+                if (s.in.op == QLRegOp::ADD && it == products.end() && invariant(s.a)) it = products.find(s.b);
+                if (it == products.end() || uses[it->first] != 1) continue;
+                Candidate c = it->second;
+                c.def = s.def;
+                if (s.in.op == QLRegOp::ADDI || s.in.op == QLRegOp::SUBI)
+                    c.addend = s.in.op == QLRegOp::ADDI ? s.in.imm : irFold(QLRegOp::SUB, 0, s.in.imm);
+                else if (s.in.op == QLRegOp::ADD && s.a != s.b && invariant(s.a == it->first ? s.b : s.a))
+                    c.offset = s.a == it->first ? s.b : s.a;
+                else continue;
+                candidates.push_back(c);
+            }
+        std::vector<QLSSAInstr> setup;
+        std::vector<std::vector<QLSSAInstr>> increments(loop.latches.size());
+        for (const Candidate& c : candidates) {
+            const uint32_t start = starts[c.iv];
+            const int64_t step = steps[c.iv];
+            if (ssa.frameSize + 2 > 0xFFFF) break;
+            uint32_t first = newValue(QLSSAKind::Instr, pre), by = c.factor;
+            const uint16_t reg = ssa.values[first].reg;
+            ++ssa.frameSize;
+            auto then = [&](QLRegOp op, uint32_t b, int64_t imm) {
+                uint32_t v = newValue(QLSSAKind::Instr, pre);
+                ssa.values[v].reg = reg;
+                setup.push_back(instr(op, v, first, b, imm));
+                first = v;
+            };
+            if (c.factor == 0 && known[start] && c.offset == 0)
+                setup.push_back(instr(QLRegOp::MOVI, first, 0, 0, irFold(QLRegOp::ADD, irFold(QLRegOp::MUL, constant[start], c.imm), c.addend)));
+            else {
+                if (c.factor == 0 && known[start]) setup.push_back(instr(QLRegOp::MOVI, first, 0, 0, irFold(QLRegOp::MUL, constant[start], c.imm)));
+                else if (c.factor == 0) setup.push_back(instr(QLRegOp::MULI, first, start, 0, c.imm));
+                else if (known[start]) setup.push_back(instr(QLRegOp::MULI, first, c.factor, 0, constant[start]));
+                else setup.push_back(instr(QLRegOp::MUL, first, start, c.factor, 0));
+                if (c.offset != 0) then(QLRegOp::ADD, c.offset, 0);
+                else if (c.addend != 0) then(QLRegOp::ADDI, 0, c.addend);
+            }
+            if (c.factor != 0 && step != 1) {
+                by = newValue(QLSSAKind::Instr, pre);
+                setup.push_back(instr(QLRegOp::MULI, by, c.factor, 0, step));
+                ++ssa.frameSize;
+            }
+            uint32_t iv = newValue(QLSSAKind::Phi, h);
+            QLSSAPhi phi{ iv, std::vector<uint32_t>(g.preds[h].size(), first) };
+            ssa.values[iv].reg = reg;
+            for (size_t i = 0; i < loop.latches.size(); ++i) {
+                uint32_t next = newValue(QLSSAKind::Instr, loop.latches[i]);
+                ssa.values[next].reg = reg;
+                if (c.factor == 0) increments[i].push_back(instr(QLRegOp::ADDI, next, iv, 0, irFold(QLRegOp::MUL, step, c.imm)));
+                else increments[i].push_back(instr(QLRegOp::ADD, next, iv, by, 0));
+                size_t j = std::find(g.preds[h].begin(), g.preds[h].end(), loop.latches[i]) - g.preds[h].begin();
+                phi.args[j] = next;
+            }
+            ssa.blocks[h].phis.push_back(std::move(phi));
+            replace[c.def] = iv;
+            removed[c.product] = true;
+            ++stats.reduced;
+        }
+        if (!candidates.empty()) {
+            for (uint32_t b : loop.blocks) {
+                std::vector<QLSSAInstr>& code = ssa.blocks[b].code;
+                code.erase(std::remove_if(code.begin(), code.end(), [&](const QLSSAInstr& s) { return s.def && (removed[s.def] || find(s.def) != s.def); }),
+                           code.end());
+            }
+            append(pre, std::move(setup));
+            for (size_t i = 0; i < loop.latches.size(); ++i) append(loop.latches[i], std::move(increments[i]));
+        }
+        for (uint32_t b : loop.blocks) inLoop[b] = false;
+    }
+
+    for (QLSSABlock& block : ssa.blocks) {
+        for (QLSSAPhi& phi : block.phis)
+            for (uint32_t& arg : phi.args) arg = find(arg);
+        for (QLSSAInstr& s : block.code) {
+            s.a = find(s.a);
+            s.b = find(s.b);
+        }
+    }
+    for (uint32_t& arg : ssa.argPool) arg = find(arg);
+}
+
+// `growth` is the module's remaining budget; the instructions added are taken from it.
+static bool irUnrollLoop(const QLIRModule& module, QLIRFunction& fn, const QLIRGraph& g, const QLLoop& loop, size_t& growth) {
+    const uint32_t h = loop.header, pre = loopPreheader(g, loop);
+    if (!loop.innermost || pre == UINT32_MAX || loop.latches.size() != 1 || fn.frameSize + 1 > 0xFFFF) return false;
+    const QLIRBlock& head = fn.blocks[h];
+    if (head.code.size() != 2 || head.code[1].op != QLRegOp::JZ || head.code[1].a != head.code[0].d) return false;
+    const QLRegInstr test = head.code[0];
+    const bool immediate = test.op == QLRegOp::LTI || test.op == QLRegOp::LEI;
+    if (!immediate && test.op != QLRegOp::LT && test.op != QLRegOp::LE) return false;
+    std::vector<bool> inLoop(fn.blocks.size(), false);
+    for (uint32_t b : loop.blocks) inLoop[b] = true;
+    const uint32_t exit = static_cast<uint32_t>(head.code[1].imm), first = head.next, latch = loop.latches[0];
+    const uint16_t i = test.a, c = test.d, n = test.b;
+    if (inLoop[exit] || first == UINT32_MAX || !inLoop[first] || i == c || (!immediate && (n == i || n == c))) return false;
+
+    size_t size = 0;
+    int64_t step = 0;
+    uint32_t writes = 0;
+    for (uint32_t b : loop.blocks) {
+        if (b == h) continue;
+        const std::vector<QLRegInstr>& code = fn.blocks[b].code;
+        for (size_t k = 0; k < code.size(); ++k) {
+            const QLRegInstr& in = code[k];
+            if (in.op == QLRegOp::CALL || in.op == QLRegOp::CALL_EXT || in.op == QLRegOp::CALL_DYN) return false;
+            if (!(b == latch && k + 1 == code.size() && in.op == QLRegOp::JMP)) ++size;
+            int32_t d = irOperands(module, in, [](uint16_t) {});
+            if (d == i) {
+                if (in.op != QLRegOp::ADDI || in.a != i || in.imm <= 0 || in.imm > (1 << 16) || !g.dominates(b, latch)) return false;
+                step = in.imm;
+                ++writes;
+            }
+            if (!immediate && d == n) return false;
+        }
+    }
+    // Each copy also keeps its latch's jump; the fast loop's test and the
+    // preheader's guard against an underflowed bound add up to five more.
+    const size_t fixed = immediate ? 2 : 5;
+    const size_t room = growth > fixed ? (growth - fixed) / (size + 1) : 0;
+    const uint32_t factor = static_cast<uint32_t>(std::min<size_t>({ QL_UNROLL_MAX_FACTOR, QL_UNROLL_BUDGET / std::max<size_t>(size, 1), room }));
+    if (writes != 1 || factor < 2) return false;
+    const int64_t span = step * (factor - 1);
+    if (immediate && test.imm < std::numeric_limits<int64_t>::min() + span) return false;
+
+    std::vector<uint32_t> body;
+    for (uint32_t b : loop.blocks)
+        if (b != h) body.push_back(b);
+    std::vector<QLIRBlock> original;
+    for (uint32_t b : body) original.push_back(fn.blocks[b]);
+    const uint32_t added = 1 + factor * static_cast<uint32_t>(body.size());
+    auto shift = [&](uint32_t b) { return b != UINT32_MAX && b >= h ? b + added : b; };
+    auto copyOf = [&](uint32_t m, uint32_t b) {
+        return h + 1 + m * static_cast<uint32_t>(body.size()) + static_cast<uint32_t>(std::find(body.begin(), body.end(), b) - body.begin());
+    };
+    auto target = [&](uint32_t m, uint32_t t) {
+        if (t == UINT32_MAX) return t;
+        if (t == h) return m + 1 < factor ? copyOf(m + 1, first) : h;
+        return inLoop[t] ? copyOf(m, t) : shift(t);
+    };
+    irInsertBlocks(fn, h, added);
+
+    const uint16_t bound = static_cast<uint16_t>(fn.frameSize);
+    QLIRBlock& entry = fn.blocks[shift(pre)];
+    if (!entry.code.empty() && irIsJump(entry.code.back().op)) entry.code.pop_back();
+    if (!immediate) {
+        ++fn.frameSize;
+        entry.code.push_back({ span, bound, n, 0, QLRegOp::SUBI });
+        entry.code.push_back({ 0, c, bound, n, QLRegOp::LT });
+        entry.code.push_back({ static_cast<int64_t>(shift(h)), 0, c, 0, QLRegOp::JZ });
+    }
+    entry.next = h;
+    QLIRBlock& fast = fn.blocks[h];
+    fast.code.push_back(immediate ? QLRegInstr{ test.imm - span, c, i, 0, test.op } : QLRegInstr{ 0, c, i, bound, test.op });
+    fast.code.push_back({ static_cast<int64_t>(shift(h)), 0, c, 0, QLRegOp::JZ });
+    fast.next = copyOf(0, first);
+    for (uint32_t m = 0; m < factor; ++m)
+        for (size_t k = 0; k < body.size(); ++k) {
+            QLIRBlock& copy = fn.blocks[copyOf(m, body[k])];
+            copy = original[k];
+            copy.next = target(m, copy.next);
+            if (!copy.code.empty() && irIsJump(copy.code.back().op))
+                copy.code.back().imm = target(m, static_cast<uint32_t>(copy.code.back().imm));
+        }
+    growth -= fixed + factor * (size + 1);
+    return true;
+}
+
+static void irUnrollLoops(const QLIRModule& module, QLIRFunction& fn, QLLoopStats& stats, size_t& growth) {
+    QLIRGraph g;
+    buildIRGraph(irSuccessors(fn), 0, g);
+    // Unrolling renumbers blocks, so the graph is rebuilt after each loop;
+    // the loops it creates never qualify, which bounds the rounds.
+    for (size_t rounds = findLoops(g).size(); rounds-- > 0;) {
+        bool changed = false;
+        for (const QLLoop& loop : findLoops(g))
+            if (irUnrollLoop(module, fn, g, loop, growth)) {
+                changed = true;
+                ++stats.unrolled;
+                break;
+            }
+        if (!changed) return;
+        buildIRGraph(irSuccessors(fn), 0, g);
+    }
+}
+
+// The loop passes: preheaders, then an SSA round trip for invariant code
+// motion and strength reduction. Unrolling runs after it on the result.
+static void irOptimizeLoops(const QLIRModule& module, QLIRFunction& fn, QLLoopStats& stats) {
+    if (fn.frameSize == 0) return;
+    irInsertPreheaders(fn);
+    QLSSAFunction ssa;
+    if (!buildSSA(module, fn, ssa)) return;
+    ssaValueNumber(ssa);
+    ssaOptimizeLoops(ssa, stats);
+    QLIRFunction lowered;
+    if (lowerSSA(module, ssa, lowered)) fn = std::move(lowered);
+}
+
+bool optimizeRegisterModule(QLRegModule& module, std::string& error, QLOptReport* report, bool loopPasses) {
+    QLIRModule ir;
+    if (!buildIRModule(module, ir, error)) return false;
+    QLOptReport local;
+    QLOptReport& r = report ? *report : local;
+    r = {};
+    r.input = module.code.size();
+    auto run = [&](const char* name, auto pass) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (QLIRFunction& fn : ir.regions) pass(fn);
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+        r.passes.push_back({ name, irInstructionCount(ir), micros });
+    };
+    run("constprop", [&](QLIRFunction& fn) { irPropagateConstants(ir, fn); });
+    run("gvn", [&](QLIRFunction& fn) { irValueNumber(ir, fn); });
+    if (loopPasses) {
+        run("loops", [&](QLIRFunction& fn) { irOptimizeLoops(ir, fn, r.loops); });
+        size_t growth = irInstructionCount(ir) * QL_UNROLL_GROWTH_PERCENT / 100;
+        run("unroll", [&](QLIRFunction& fn) { irUnrollLoops(ir, fn, r.loops, growth); });
+    }
+    run("simplify", [&](QLIRFunction& fn) { irSimplify(ir, fn); });
+    run("dse", [&](QLIRFunction& fn) { irEliminateDeadStores(ir, fn); });
+    run("cfg", [&](QLIRFunction& fn) { irSimplifyCFG(fn); });
+    lowerIRModule(ir, module);
+    r.output = module.code.size();
+    return true;
+}
@@ -0,0 +1,303 @@
+// QuarterIR.hpp
+// Optimizing IR over register-VM code: SSA, constant propagation, value
+// numbering, loop passes and the optimizeRegisterModule pipeline.
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "QuarterVM.hpp"
+
+// ======== Optimizing IR ========
+// Register code as a control-flow graph per region (the top level, then each
+// function), rewritten by optimization passes and laid back out as register
+// code, so the register VM and the baseline JIT run the result unchanged.
+// Blocks hold QLRegInstr with JMP/JZ targets rewritten to block indices;
+// `next` is the block control falls into when the last instruction does not
+// transfer it (UINT32_MAX after JMP, RET and HALT).
+//
+// Registers keep their frame-layout numbering, so every pass works within
+// the call convention: CALL and CALL_DYN hand the callee the window starting
+// at `d`, which clobbers every register from `d` up.
+struct QLIRBlock {
+    std::vector<QLRegInstr> code;
+    uint32_t next = UINT32_MAX;
+    bool live = true;  // cleared once no path from the entry reaches the block
+};
+
+struct QLIRFunction {
+    uint32_t params = 0;
+    uint32_t slots = 0;
+    uint32_t frameSize = 0;
+    std::vector<QLIRBlock> blocks;  // blocks[0] is the entry
+};
+
+struct QLIRModule {
+    std::vector<QLIRFunction> regions;  // [0] is the top level, [f + 1] function f
+    std::vector<QLCallSite> callSites;
+    std::vector<std::string> strings;
+};
+
+inline bool irIsJump(QLRegOp op) { return op == QLRegOp::JMP || op == QLRegOp::JZ; }
+
+inline bool irEndsFlow(QLRegOp op) {
+    return op == QLRegOp::JMP || op == QLRegOp::RET || op == QLRegOp::RETI || op == QLRegOp::HALT ||
+           op == QLRegOp::HALTI || op == QLRegOp::HALT_ACC;
+}
+
+// MOV through EQI: writes d from registers and immediates, nothing else.
+inline bool irIsPure(QLRegOp op) { return op <= QLRegOp::EQI; }
+
+// ADD, SUB, MUL, LT, LE and EQ; the immediate form of each follows it.
+inline bool irIsRegisterBinary(QLRegOp op) {
+    return op >= QLRegOp::ADD && op <= QLRegOp::EQI && (static_cast<uint8_t>(op) - static_cast<uint8_t>(QLRegOp::ADD)) % 2 == 0;
+}
+
+inline bool irIsImmediateBinary(QLRegOp op) { return irIsPure(op) && op > QLRegOp::MOVI && !irIsRegisterBinary(op); }
+
+inline QLRegOp irImmediateForm(QLRegOp op) { return static_cast<QLRegOp>(static_cast<uint8_t>(op) + 1); }
+
+inline int64_t irFold(QLRegOp op, int64_t x, int64_t y) {
+    switch (op) {
+    case QLRegOp::ADD: case QLRegOp::ADDI: return static_cast<int64_t>(static_cast<uint64_t>(x) + static_cast<uint64_t>(y));
+    case QLRegOp::SUB: case QLRegOp::SUBI: return static_cast<int64_t>(static_cast<uint64_t>(x) - static_cast<uint64_t>(y));
+    case QLRegOp::MUL: case QLRegOp::MULI: return static_cast<int64_t>(static_cast<uint64_t>(x) * static_cast<uint64_t>(y));
+    case QLRegOp::LT: case QLRegOp::LTI: return x < y;
+    case QLRegOp::LE: case QLRegOp::LEI: return x <= y;
+    default: return x == y;
+    }
+}
+
+template <class Visit>
+void irForEachSuccessor(const QLIRBlock& block, Visit&& visit) {
+    if (!block.code.empty() && irIsJump(block.code.back().op)) visit(static_cast<uint32_t>(block.code.back().imm));
+    if (block.next != UINT32_MAX) visit(block.next);
+}
+
+// What an instruction reads and writes: a and b when flagged, `argc` call
+// arguments from d on, and d when `writes` is set. CALL and CALL_DYN also
+// clobber every register above d.
+struct QLIRAccess {
+    bool readsA = false, readsB = false, writes = false, clobbers = false;
+    uint32_t argc = 0;
+};
+
+template <class ParamsOf>
+QLIRAccess qlRegAccess(const std::vector<QLCallSite>& callSites, const QLRegInstr& in, ParamsOf&& paramsOf) {
+    QLIRAccess x;
+    switch (in.op) {
+    case QLRegOp::MOVI: x.writes = true; break;
+    case QLRegOp::JZ: case QLRegOp::RET: case QLRegOp::HALT: x.readsA = true; break;
+    case QLRegOp::CALL:
+        x.argc = paramsOf(in.imm);
+        x.writes = x.clobbers = true;
+        break;
+    case QLRegOp::CALL_EXT:
+        x.argc = callSites[in.imm].argc;
+        x.writes = callSites[in.imm].pushesResult;
+        break;
+    case QLRegOp::CALL_DYN:
+        x.readsA = true;
+        x.argc = callSites[in.imm].argc;
+        x.writes = x.clobbers = true;
+        break;
+    default:
+        if (irIsPure(in.op)) {
+            x.readsA = x.writes = true;
+            x.readsB = irIsRegisterBinary(in.op);
+        }
+        break;
+    }
+    return x;
+}
+
+inline QLIRAccess irAccess(const QLIRModule& module, const QLRegInstr& in) {
+    return qlRegAccess(module.callSites, in, [&](int64_t f) { return module.regions[f + 1].params; });
+}
+
+// Calls `use` for each register `in` reads (call arguments are the
+// registers from d on) and returns the one it writes, or -1.
+template <class Use>
+int32_t irOperands(const QLIRModule& module, const QLRegInstr& in, Use&& use) {
+    QLIRAccess x = irAccess(module, in);
+    if (x.readsA) use(in.a);
+    if (x.readsB) use(in.b);
+    for (uint32_t k = 0; k < x.argc; ++k) use(static_cast<uint16_t>(in.d + k));
+    return x.writes ? in.d : -1;
+}
+
+// Splits each region of `module` at jump targets and after transfers.
+bool buildIRModule(const QLRegModule& module, QLIRModule& out, std::string& error);
+
+// Lays live blocks out in index order. A jump to the block laid out next is
+// dropped, and a fall-through to any other block becomes a JMP.
+void lowerIRModule(const QLIRModule& module, QLRegModule& out);
+
+// ---- SSA form ----
+// A vector-indexed control-flow graph with Cooper, Harvey and Kennedy's
+// dominators: immediate dominators intersected in reverse postorder until
+// nothing changes, which on reducible graphs settles in two sweeps.
+// Frontiers come from walking each join's predecessors up to its idom.
+// The dominator tree is numbered in pre/postorder, so a dominance query
+// is two comparisons.
+struct QLIRGraph {
+    std::vector<std::vector<uint32_t>> succs, preds;  // preds only from reachable blocks
+    std::vector<uint32_t> rpo;                        // reachable blocks, entry first
+    std::vector<uint32_t> rpoIndex;                   // UINT32_MAX when unreachable
+    std::vector<uint32_t> idom;                       // idom[entry] == entry
+    std::vector<std::vector<uint32_t>> children, frontier;
+    std::vector<uint32_t> preorder, postorder;        // dominator tree numbering
+
+    bool reachable(uint32_t b) const { return rpoIndex[b] != UINT32_MAX; }
+    bool dominates(uint32_t a, uint32_t b) const { return preorder[a] <= preorder[b] && postorder[b] <= postorder[a]; }
+};
+
+void buildIRGraph(std::vector<std::vector<uint32_t>> succs, uint32_t entry, QLIRGraph& g);
+
+// Successor lists of an IR function's live blocks, duplicates removed.
+std::vector<std::vector<uint32_t>> irSuccessors(const QLIRFunction& fn);
+
+// SSA over frame registers. Each block's instructions keep their register
+// operands (which out-of-SSA rewrites) next to the values they read and
+// write. Value 0 is undefined: what a register holds before its first
+// write, or after a call clobbered it. Block 0 is an empty entry that
+// defines the incoming values (parameters, and zero for the other
+// slots), so the first IR block, block 1, may be a loop header.
+enum class QLSSAKind : uint8_t { Undefined, Entry, Phi, Instr };
+
+struct QLSSAValue {
+    QLSSAKind kind;
+    uint16_t reg;    // the frame register it renames
+    uint32_t block;
+};
+
+struct QLSSAInstr {
+    QLRegInstr in;
+    uint32_t def = 0;                 // value written, 0 for none
+    uint32_t a = 0, b = 0;            // values read through in.a and in.b
+    uint32_t args = 0, argCount = 0;  // call arguments, argPool[args, args + argCount)
+};
+
+struct QLSSAPhi {
+    uint32_t value;
+    std::vector<uint32_t> args;  // args[i] comes from graph.preds[block][i]
+};
+
+struct QLSSABlock {
+    std::vector<QLSSAPhi> phis;
+    std::vector<QLSSAInstr> code;
+    uint32_t next = UINT32_MAX;
+};
+
+struct QLSSAFunction {
+    uint32_t params = 0;
+    uint32_t slots = 0;
+    uint32_t frameSize = 0;
+    std::vector<QLSSABlock> blocks;  // IR block i is blocks[i + 1]
+    QLIRGraph graph;
+    std::vector<QLSSAValue> values;
+    std::vector<uint32_t> argPool;
+};
+
+// Semi-pruned SSA: only registers read in some block before being written
+// there get phis, placed on the iterated dominance frontier of their
+// definitions and then renamed along the dominator tree. Fails (leaving
+// the region to the non-SSA passes) when the per-register tables would be
+// too large.
+bool buildSSA(const QLIRModule& module, const QLIRFunction& fn, QLSSAFunction& ssa);
+
+// Checks that every value read is defined once, on every path, before the
+// read: in an earlier instruction of the same block, or in a block that
+// dominates it (the predecessor's end, for phi arguments).
+bool verifySSA(const QLSSAFunction& ssa, std::string& error);
+
+// Dominator-scoped value numbering: a pure instruction computing what a
+// dominating one already did is dropped and its value replaced, copies
+// are propagated, and phis whose arguments agree (ignoring themselves)
+// collapse. Constants are left to rematerialize where they are.
+void ssaValueNumber(QLSSAFunction& ssa);
+
+// Out of SSA. Each value goes back to the register it renames unless it
+// would clash there: another value of that register is live at its
+// definition, or it is live across a call that clobbers the register.
+// Clashing values get fresh registers just above the slots, with the
+// operand-stack registers shifted up past them, so they sit below every
+// call window. Phis become parallel copies at the end of each predecessor,
+// on split edges where a predecessor has other successors. Call arguments
+// are copied into place before the call.
+bool lowerSSA(const QLIRModule& module, const QLSSAFunction& ssa, QLIRFunction& out);
+
+struct QLLoopStats {
+    size_t loops = 0;     // natural loops found
+    size_t hoisted = 0;   // invariant instructions moved to a preheader
+    size_t reduced = 0;   // multiplications replaced by an induction variable
+    size_t unrolled = 0;  // counted loops given an unrolled copy
+
+    void add(const QLLoopStats& o) {
+        loops += o.loops;
+        hoisted += o.hoisted;
+        reduced += o.reduced;
+        unrolled += o.unrolled;
+    }
+};
+
+// Gives every loop a preheader, an empty block placed just before the
+// header that the header's outside predecessors now lead to. A loop headed
+// by the entry block gets a new entry.
+void irInsertPreheaders(QLIRFunction& fn);
+
+// Loop-invariant code motion and strength reduction on SSA, innermost
+// loops first, for loops with a preheader.
+//
+// A pure instruction whose operands are all defined outside the loop moves
+// to the end of the preheader. Pure instructions cannot trap, so running
+// one the loop would have skipped is harmless. Constants stay put, as in
+// value numbering.
+//
+// A basic induction variable is a header phi that every back edge steps by
+// the same ADDI or SUBI of itself. "i * k + c", with k and c constants or
+// invariants, becomes a new phi: it starts at the value for i's start, and
+// each latch adds k times the step. A multiply and an add turn into one
+// add, where reducing the multiply alone would only trade it for the
+// increment: the register VM dispatches both at the same cost, and the new
+// variable holds a register across the loop. The product must have no
+// other use. New values get registers above the frame, so their copies
+// vanish where they do not clash.
+void ssaOptimizeLoops(QLSSAFunction& ssa, QLLoopStats& stats);
+
+// Bounded unrolling of counted loops. An innermost loop qualifies when its
+// header is just "c = i < n" (or <=, or against a constant) and a JZ out of
+// the loop, its one latch closes it, and the only write to i is one
+// "i = i + step" on every iteration's path, with n unchanged and no calls
+// inside. The cost model takes the largest factor up to
+// QL_UNROLL_MAX_FACTOR whose copies of the body fit in QL_UNROLL_BUDGET
+// instructions, and whose copies, guard and test fit in what is left of
+// the module's growth budget: QL_UNROLL_GROWTH_PERCENT of its instructions
+// before unrolling, shared by every loop unrolled.
+//
+// The unrolled loop runs before the original, on "i < n - (factor - 1) *
+// step", which guarantees the next `factor` iterations all pass the
+// header; its copies of the body drop the test. The original loop finishes
+// the remaining iterations. The preheader computes the adjusted bound once
+// and skips the unrolled loop if it underflowed.
+constexpr size_t QL_UNROLL_BUDGET = 64;
+constexpr uint32_t QL_UNROLL_MAX_FACTOR = 4;
+constexpr size_t QL_UNROLL_GROWTH_PERCENT = 100;
+
+// Instruction counts after each pass, for reporting what each one removed.
+struct QLOptPass {
+    const char* name;
+    size_t instructions;
+    double micros;
+};
+
+struct QLOptReport {
+    size_t input = 0;   // register code before optimization
+    std::vector<QLOptPass> passes;
+    size_t output = 0;  // register code after lowering
+    QLLoopStats loops;
+};
+
+// Runs the IR pipeline over a compiled register module and replaces its
+// code. Call sites and strings are unchanged; frames grow only by the
+// registers the loop passes add. `loopPasses` off leaves loops as they are.
+bool optimizeRegisterModule(QLRegModule& module, std::string& error, QLOptReport* report = nullptr, bool loopPasses = true);
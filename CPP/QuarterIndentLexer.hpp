@@ -0,0 +1,746 @@
+// QuarterIndentLexer.hpp
+// Indentation-aware lexer (INDENT/DEDENT tokens) with vectorized line, indent
+// and identifier scanning and a parallel mode, shared by the star-block driver
+// and the transpiler's --bench-scan / --test-parallel-lexer entry points.
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stack>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "QuarterKeywords.hpp"
+#include "QuarterSource.hpp"
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#define QL_SCAN_X86 1
+#endif
+
+namespace QuarterIndentLexer {
+
+    enum class TokenType {
+        STAR, END, VAL, VAR, ENUM, STRUCT, FUNC, DEFINE, LOOP, MATCH,
+        CASE, WHEN, RETURN, EXTERN, ASM, PLUGIN, IDENTIFIER,
+        INT_LITERAL, STRING_LITERAL, DG_LITERAL,
+        INDENT, DEDENT, NEWLINE, EOF_TOKEN,
+        PLUS, MINUS, MUL, DIV, LT, GT, EQ, NEQ, AND, OR,
+        COLON, COMMA, LPAREN, RPAREN, LBRACE, RBRACE,
+        UNKNOWN
+    };
+
+    struct Token {
+        TokenType type;
+        std::string text;
+        int line, col;
+    };
+
+    // ======== Vectorized Line Scanning ========
+    // Byte-run kernels used by Lexer: find the end of a line, measure an indent
+    // run and skip identifier/digit runs. Each returns the first byte in
+    // [p, end) that does NOT belong to the run (or end). The scalar versions are
+    // the reference; SSE2 and AVX2 variants handle 16/32 bytes per step.
+    struct ScanKernels {
+        const char* name;
+        const char* (*findNewline)(const char* p, const char* end);
+        const char* (*skipSpaces)(const char* p, const char* end);
+        const char* (*skipIdentChars)(const char* p, const char* end);
+        const char* (*skipDigits)(const char* p, const char* end);
+    };
+
+    inline bool isIdentByte(unsigned char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    namespace scalar_scan {
+        inline const char* findNewline(const char* p, const char* end) {
+            const void* nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+            return nl ? static_cast<const char*>(nl) : end;
+        }
+        inline const char* skipSpaces(const char* p, const char* end) {
+            while (p < end && *p == ' ') ++p;
+            return p;
+        }
+        inline const char* skipIdentChars(const char* p, const char* end) {
+            while (p < end && isIdentByte(static_cast<unsigned char>(*p))) ++p;
+            return p;
+        }
+        inline const char* skipDigits(const char* p, const char* end) {
+            while (p < end && *p >= '0' && *p <= '9') ++p;
+            return p;
+        }
+    }
+
+#ifdef QL_SCAN_X86
+#if defined(__GNUC__) || defined(__clang__)
+#define QL_TARGET_AVX2 __attribute__((target("avx2")))
+#define QL_CTZ(x) __builtin_ctz(x)
+#else
+#define QL_TARGET_AVX2
+    inline int QL_CTZ(unsigned x) { unsigned long i; _BitScanForward(&i, x); return static_cast<int>(i); }
+#endif
+
+    namespace sse2_scan {
+        // Unsigned "lo <= v <= hi" per byte using the wrap-around + min trick.
+        inline __m128i inRange(__m128i v, char lo, char hi) {
+            __m128i t = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+            __m128i bound = _mm_set1_epi8(static_cast<char>(hi - lo));
+            return _mm_cmpeq_epi8(_mm_min_epu8(t, bound), t);
+        }
+        inline __m128i identMask(__m128i v) {
+            __m128i alpha = inRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+            __m128i digit = inRange(v, '0', '9');
+            __m128i under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+            return _mm_or_si128(_mm_or_si128(alpha, digit), under);
+        }
+        // Scan while `member(v)` holds; the run ends at the first zero bit.
+        template <typename Member>
+        inline const char* skipRun(const char* p, const char* end, Member member, const char* (*tail)(const char*, const char*)) {
+            while (end - p >= 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(member(v))) & 0xFFFFu;
+                if (stop) return p + QL_CTZ(stop);
+                p += 16;
+            }
+            return tail(p, end);
+        }
+        inline const char* findNewline(const char* p, const char* end) {
+            const __m128i nl = _mm_set1_epi8('\n');
+            while (end - p >= 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                unsigned hit = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)));
+                if (hit) return p + QL_CTZ(hit);
+                p += 16;
+            }
+            return scalar_scan::findNewline(p, end);
+        }
+        inline const char* skipSpaces(const char* p, const char* end) {
+            return skipRun(p, end, [](__m128i v) { return _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')); }, scalar_scan::skipSpaces);
+        }
+        inline const char* skipIdentChars(const char* p, const char* end) {
+            return skipRun(p, end, identMask, scalar_scan::skipIdentChars);
+        }
+        inline const char* skipDigits(const char* p, const char* end) {
+            return skipRun(p, end, [](__m128i v) { return inRange(v, '0', '9'); }, scalar_scan::skipDigits);
+        }
+    }
+
+    namespace avx2_scan {
+        QL_TARGET_AVX2 inline __m256i inRange(__m256i v, char lo, char hi) {
+            __m256i t = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+            __m256i bound = _mm256_set1_epi8(static_cast<char>(hi - lo));
+            return _mm256_cmpeq_epi8(_mm256_min_epu8(t, bound), t);
+        }
+        // 32 bytes at a time; anything shorter is finished by the SSE2 kernel.
+        QL_TARGET_AVX2 inline const char* findNewline(const char* p, const char* end) {
+            const __m256i nl = _mm256_set1_epi8('\n');
+            while (end - p >= 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                unsigned hit = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl)));
+                if (hit) return p + QL_CTZ(hit);
+                p += 32;
+            }
+            return sse2_scan::findNewline(p, end);
+        }
+        QL_TARGET_AVX2 inline const char* skipSpaces(const char* p, const char* end) {
+            const __m256i sp = _mm256_set1_epi8(' ');
+            while (end - p >= 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, sp)));
+                if (stop) return p + QL_CTZ(stop);
+                p += 32;
+            }
+            return sse2_scan::skipSpaces(p, end);
+        }
+        QL_TARGET_AVX2 inline const char* skipIdentChars(const char* p, const char* end) {
+            while (end - p >= 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                __m256i alpha = inRange(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+                __m256i digit = inRange(v, '0', '9');
+                __m256i under = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+                __m256i ident = _mm256_or_si256(_mm256_or_si256(alpha, digit), under);
+                unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(ident));
+                if (stop) return p + QL_CTZ(stop);
+                p += 32;
+            }
+            return sse2_scan::skipIdentChars(p, end);
+        }
+        QL_TARGET_AVX2 inline const char* skipDigits(const char* p, const char* end) {
+            while (end - p >= 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(inRange(v, '0', '9')));
+                if (stop) return p + QL_CTZ(stop);
+                p += 32;
+            }
+            return sse2_scan::skipDigits(p, end);
+        }
+    }
+#endif // QL_SCAN_X86
+
+    inline const ScanKernels SCALAR_SCAN_KERNELS = {
+        "scalar", scalar_scan::findNewline, scalar_scan::skipSpaces, scalar_scan::skipIdentChars, scalar_scan::skipDigits
+    };
+#ifdef QL_SCAN_X86
+    inline const ScanKernels SSE2_SCAN_KERNELS = {
+        "sse2", sse2_scan::findNewline, sse2_scan::skipSpaces, sse2_scan::skipIdentChars, sse2_scan::skipDigits
+    };
+    inline const ScanKernels AVX2_SCAN_KERNELS = {
+        "avx2", avx2_scan::findNewline, avx2_scan::skipSpaces, avx2_scan::skipIdentChars, avx2_scan::skipDigits
+    };
+#endif
+
+    inline bool cpuHasAVX2() {
+#if defined(QL_SCAN_X86) && (defined(__GNUC__) || defined(__clang__))
+        return __builtin_cpu_supports("avx2");
+#elif defined(QL_SCAN_X86) && defined(_MSC_VER)
+        int regs[4];
+        __cpuid(regs, 0);
+        if (regs[0] < 7) return false;
+        __cpuid(regs, 1);
+        bool osxsave = (regs[2] & (1 << 27)) != 0;
+        if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+        __cpuidex(regs, 7, 0);
+        return (regs[1] & (1 << 5)) != 0;
+#else
+        return false;
+#endif
+    }
+
+    // Picked once per process: AVX2 if CPUID reports it, else SSE2 (always
+    // present on x86-64), else scalar. Each slot takes the kernel that won its
+    // own row of --bench-scan on the repo corpus: identifiers are mostly under
+    // 16 bytes, so the 16-byte kernel beats the 32-byte one, and digit runs
+    // average about one byte, so no vector load pays for itself there.
+    inline const ScanKernels& scanKernels() {
+#ifdef QL_SCAN_X86
+        static const ScanKernels avx2 = {
+            "avx2", avx2_scan::findNewline, avx2_scan::skipSpaces, sse2_scan::skipIdentChars, scalar_scan::skipDigits
+        };
+        static const ScanKernels sse2 = {
+            "sse2", sse2_scan::findNewline, sse2_scan::skipSpaces, sse2_scan::skipIdentChars, scalar_scan::skipDigits
+        };
+        static const ScanKernels& kernels = cpuHasAVX2() ? avx2 : sse2;
+        return kernels;
+#else
+        return SCALAR_SCAN_KERNELS;
+#endif
+    }
+
+    // Every complete kernel implementation this CPU can run, scalar first.
+    inline std::vector<const ScanKernels*> availableScanKernels() {
+        std::vector<const ScanKernels*> sets{ &SCALAR_SCAN_KERNELS };
+#ifdef QL_SCAN_X86
+        sets.push_back(&SSE2_SCAN_KERNELS);
+        if (cpuHasAVX2()) sets.push_back(&AVX2_SCAN_KERNELS);
+#endif
+        return sets;
+    }
+
+    class Lexer {
+        std::string owned;
+        std::string_view source;
+        const ScanKernels& scan;
+        std::string_view currentLine;
+        int lineNum = 0;
+        int pos = 0;
+        std::stack<int> indentStack;
+
+        // Output of lexing one line-aligned slice without an indent stack:
+        // every line's leading indent width and where its tokens start.
+        struct LineRecord {
+            int indent;
+            uint32_t firstToken;
+        };
+        struct LexedChunk {
+            std::vector<Token> tokens;
+            std::vector<LineRecord> lines;
+        };
+
+        // Worker over a slice of a parent's buffer (parallel lexing).
+        Lexer(std::string_view slice, const ScanKernels& kernels)
+            : source(slice), scan(kernels) {
+            indentStack.push(0);
+        }
+
+    public:
+        // The whole input is pulled into one buffer up front so line splitting
+        // and run skipping can use the vector kernels instead of std::getline.
+        Lexer(std::istream& in, const ScanKernels& kernels = scanKernels())
+            : owned(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()), source(owned), scan(kernels) {
+            indentStack.push(0);
+        }
+        Lexer(std::string src, const ScanKernels& kernels = scanKernels())
+            : owned(std::move(src)), source(owned), scan(kernels) {
+            indentStack.push(0);
+        }
+        Lexer(const Lexer&) = delete;
+        Lexer& operator=(const Lexer&) = delete;
+
+        std::vector<Token> tokenize() {
+            std::vector<Token> tokens;
+            const char* p = source.data();
+            const char* end = p + source.size();
+            while (p < end) {
+                p = nextLine(p, end);
+                pos = countIndent(currentLine);
+                handleIndentation(pos, tokens);
+                lexLineBody(tokens);
+            }
+            while (indentStack.size() > 1) {
+                indentStack.pop();
+                tokens.push_back({ TokenType::DEDENT, "", lineNum, 0 });
+            }
+            tokens.push_back({ TokenType::EOF_TOKEN, "", lineNum, 0 });
+            return tokens;
+        }
+
+        // ======== Parallel Lexing ========
+        // Splits the buffer at line boundaries, lexes the slices on separate
+        // threads without indentation tracking, then replays the recorded
+        // per-line indent widths through one indent stack to place INDENT /
+        // DEDENT exactly where tokenize() would. The output is identical to
+        // the serial lexer for any thread count.
+        std::vector<Token> tokenizeParallel(unsigned threads = std::thread::hardware_concurrency(),
+                                            size_t minChunkBytes = 64 * 1024) {
+            minChunkBytes = std::max<size_t>(minChunkBytes, 1);
+            threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(source.size() / minChunkBytes)));
+            if (threads <= 1) return tokenize();
+
+            // 1. Line-aligned slice boundaries.
+            const char* begin = source.data();
+            const char* end = begin + source.size();
+            std::vector<const char*> cuts{ begin };
+            for (unsigned k = 1; k < threads; ++k) {
+                const char* guess = std::max(cuts.back(), begin + source.size() * k / threads);
+                const char* eol = scan.findNewline(guess, end);
+                cuts.push_back(eol < end ? eol + 1 : end);
+            }
+            cuts.push_back(end);
+
+            // 2. Lex slices concurrently.
+            std::vector<LexedChunk> chunks(threads);
+            {
+                std::vector<std::thread> workers;
+                for (unsigned k = 0; k < threads; ++k) {
+                    workers.emplace_back([&, k] {
+                        Lexer worker(std::string_view(cuts[k], static_cast<size_t>(cuts[k + 1] - cuts[k])), scan);
+                        chunks[k] = worker.lexChunk();
+                    });
+                }
+                for (auto& w : workers) w.join();
+            }
+
+            // 3. Serial indent replay: O(lines), decides how many INDENT (+1)
+            //    or DEDENT (-n) tokens precede each line and where every chunk
+            //    lands in the output.
+            std::vector<std::vector<int>> indentDeltas(threads);
+            std::vector<size_t> outOffset(threads + 1, 0);
+            std::vector<int> lineBase(threads + 1, 0);
+            for (unsigned k = 0; k < threads; ++k) {
+                size_t emitted = 0;
+                indentDeltas[k].reserve(chunks[k].lines.size());
+                for (const LineRecord& line : chunks[k].lines) {
+                    int delta = 0;
+                    if (line.indent > indentStack.top()) {
+                        indentStack.push(line.indent);
+                        delta = 1;
+                    }
+                    else {
+                        while (line.indent < indentStack.top()) {
+                            indentStack.pop();
+                            --delta;
+                        }
+                    }
+                    indentDeltas[k].push_back(delta);
+                    emitted += static_cast<size_t>(delta < 0 ? -delta : delta);
+                }
+                outOffset[k + 1] = outOffset[k] + emitted + chunks[k].tokens.size();
+                lineBase[k + 1] = lineBase[k] + static_cast<int>(chunks[k].lines.size());
+            }
+            lineNum = lineBase[threads];
+
+            // 4. Scatter every chunk into its final position concurrently.
+            std::vector<Token> tokens(outOffset[threads]);
+            {
+                std::vector<std::thread> workers;
+                for (unsigned k = 0; k < threads; ++k) {
+                    workers.emplace_back([&, k] {
+                        LexedChunk& chunk = chunks[k];
+                        size_t out = outOffset[k];
+                        for (size_t i = 0; i < chunk.lines.size(); ++i) {
+                            int line = lineBase[k] + static_cast<int>(i) + 1;
+                            int delta = indentDeltas[k][i];
+                            for (int d = 0; d < (delta < 0 ? -delta : delta); ++d) {
+                                tokens[out++] = { delta > 0 ? TokenType::INDENT : TokenType::DEDENT, "", line, 0 };
+                            }
+                            size_t first = chunk.lines[i].firstToken;
+                            size_t last = i + 1 < chunk.lines.size() ? chunk.lines[i + 1].firstToken : chunk.tokens.size();
+                            for (size_t t = first; t < last; ++t) {
+                                tokens[out] = std::move(chunk.tokens[t]);
+                                tokens[out++].line = line;
+                            }
+                        }
+                    });
+                }
+                for (auto& w : workers) w.join();
+            }
+
+            while (indentStack.size() > 1) {
+                indentStack.pop();
+                tokens.push_back({ TokenType::DEDENT, "", lineNum, 0 });
+            }
+            tokens.push_back({ TokenType::EOF_TOKEN, "", lineNum, 0 });
+            return tokens;
+        }
+
+    private:
+        // Makes the line starting at p current and returns the start of the next one.
+        const char* nextLine(const char* p, const char* end) {
+            const char* eol = scan.findNewline(p, end);
+            currentLine = std::string_view(p, static_cast<size_t>(eol - p));
+            lineNum++;
+            return eol < end ? eol + 1 : end;
+        }
+
+        // Lexes currentLine from pos to the end, followed by its NEWLINE.
+        void lexLineBody(std::vector<Token>& tokens) {
+            while (pos < (int)currentLine.size()) {
+                if (isspace(static_cast<unsigned char>(currentLine[pos]))) { pos++; continue; }
+                Token tok = nextToken();
+                tokens.push_back(tok);
+            }
+            tokens.push_back({ TokenType::NEWLINE, "\n", lineNum, pos });
+        }
+
+        LexedChunk lexChunk() {
+            LexedChunk chunk;
+            chunk.tokens.reserve(source.size() / 4);
+            const char* p = source.data();
+            const char* end = p + source.size();
+            while (p < end) {
+                p = nextLine(p, end);
+                pos = countIndent(currentLine);
+                chunk.lines.push_back({ pos, static_cast<uint32_t>(chunk.tokens.size()) });
+                lexLineBody(chunk.tokens);
+            }
+            return chunk;
+        }
+
+        int countIndent(std::string_view line) {
+            return static_cast<int>(scan.skipSpaces(line.data(), line.data() + line.size()) - line.data());
+        }
+
+        // Advance pos past the run the kernel accepts and return its length.
+        int skipWith(const char* (*kernel)(const char*, const char*)) {
+            const char* lineEnd = currentLine.data() + currentLine.size();
+            const char* stop = kernel(currentLine.data() + pos, lineEnd);
+            int start = pos;
+            pos = static_cast<int>(stop - currentLine.data());
+            return pos - start;
+        }
+
+        static TokenType keywordType(std::string_view word) {
+            using QuarterKeywords::id;
+            switch (QuarterKeywords::lookup(word)) {
+            case id("star"): return TokenType::STAR;
+            case id("end"): return TokenType::END;
+            case id("val"): return TokenType::VAL;
+            case id("var"): return TokenType::VAR;
+            case id("enum"): return TokenType::ENUM;
+            case id("struct"): return TokenType::STRUCT;
+            case id("func"):
+            case id("define"): return TokenType::FUNC;
+            case id("loop"): return TokenType::LOOP;
+            case id("match"): return TokenType::MATCH;
+            case id("case"): return TokenType::CASE;
+            case id("when"): return TokenType::WHEN;
+            case id("return"): return TokenType::RETURN;
+            case id("extern"): return TokenType::EXTERN;
+            case id("asm"): return TokenType::ASM;
+            case id("plugin"): return TokenType::PLUGIN;
+            default: return TokenType::IDENTIFIER;
+            }
+        }
+
+        void handleIndentation(int indent, std::vector<Token>& tokens) {
+            if (indent > indentStack.top()) {
+                indentStack.push(indent);
+                tokens.push_back({ TokenType::INDENT, "", lineNum, 0 });
+            }
+            else {
+                while (indent < indentStack.top()) {
+                    indentStack.pop();
+                    tokens.push_back({ TokenType::DEDENT, "", lineNum, 0 });
+                }
+            }
+        }
+
+        Token nextToken() {
+            char c = currentLine[pos];
+            int start = pos;
+
+            // Single char tokens
+            switch (c) {
+            case '+': pos++; return { TokenType::PLUS, "+", lineNum, start };
+            case '-': pos++; return { TokenType::MINUS, "-", lineNum, start };
+            case '*': pos++; return { TokenType::MUL, "*", lineNum, start };
+            case '/': pos++; return { TokenType::DIV, "/", lineNum, start };
+            case '(': pos++; return { TokenType::LPAREN, "(", lineNum, start };
+            case ')': pos++; return { TokenType::RPAREN, ")", lineNum, start };
+            case ':': pos++; return { TokenType::COLON, ":", lineNum, start };
+            case ',': pos++; return { TokenType::COMMA, ",", lineNum, start };
+            case '<': pos++; return { TokenType::LT, "<", lineNum, start };
+            case '>': pos++; return { TokenType::GT, ">", lineNum, start };
+            case '=':
+                pos++;
+                if (pos < (int)currentLine.size() && currentLine[pos] == '=') {
+                    pos++;
+                    return { TokenType::EQ, "==", lineNum, start };
+                }
+                return { TokenType::EQ, "=", lineNum, start };
+            default:
+                break;
+            }
+
+            // Identifiers or keywords
+            if (isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                skipWith(scan.skipIdentChars);
+                std::string_view word = currentLine.substr(start, pos - start);
+                return { keywordType(word), std::string(word), lineNum, start };
+            }
+
+            // Integer literals
+            if (isdigit(static_cast<unsigned char>(c))) {
+                skipWith(scan.skipDigits);
+                return { TokenType::INT_LITERAL, std::string(currentLine.substr(start, pos - start)), lineNum, start };
+            }
+
+            // String literal: "..."
+            if (c == '"') {
+                pos++;
+                std::string str;
+                while (pos < (int)currentLine.size() && currentLine[pos] != '"') {
+                    if (currentLine[pos] == '\\' && pos + 1 < (int)currentLine.size()) {
+                        pos++;
+                        switch (currentLine[pos]) {
+                        case 'n': str += '\n'; break;
+                        case 't': str += '\t'; break;
+                        default: str += currentLine[pos]; break;
+                        }
+                    }
+                    else {
+                        str += currentLine[pos];
+                    }
+                    pos++;
+                }
+                pos++; // consume closing "
+                return { TokenType::STRING_LITERAL, str, lineNum, start };
+            }
+
+            // DG literals (Hex base-12: digits 0-9,X,Y)
+            if ((c >= '0' && c <= '9') || c == 'X' || c == 'Y') {
+                while (pos < (int)currentLine.size() &&
+                    (isdigit(static_cast<unsigned char>(currentLine[pos])) || currentLine[pos] == 'X' || currentLine[pos] == 'Y')) {
+                    pos++;
+                }
+                return { TokenType::DG_LITERAL, std::string(currentLine.substr(start, pos - start)), lineNum, start };
+            }
+
+            pos++;
+            return { TokenType::UNKNOWN, std::string(1,c), lineNum, start };
+        }
+    };
+
+    // ======== Lexer Scan Microbenchmark ========
+    // QuarterLang_SyntaxHighlighter.qtr + recursion.qtr repeated `copies` times.
+    inline bool loadScanCorpus(const std::string& repoRoot, int copies, std::string& corpus) {
+        std::string unit, text;
+        for (const char* file : { "QuarterLang_SyntaxHighlighter.qtr", "recursion.qtr" }) {
+            if (!QuarterSource::readFile(repoRoot + "/" + file, text)) {
+                std::cerr << "[BENCH] missing corpus file: " << file << std::endl;
+                return false;
+            }
+            unit += text;
+            unit += '\n';
+        }
+        corpus.clear();
+        corpus.reserve(unit.size() * copies);
+        for (int i = 0; i < copies; ++i) corpus += unit;
+        return true;
+    }
+
+    // Times each kernel on its own, replaying the exact calls the lexer makes
+    // with it (every line end, indent run, identifier run and digit run), for
+    // every implementation the CPU supports, then the whole lexer with the
+    // scalar and the selected kernels. The end-to-end line is the one that
+    // matters: the lexer spends its time building Token strings, so kernel
+    // gains only show up there in proportion to the bytes they skip.
+    inline bool runLexerScanBenchmark(const std::string& repoRoot, int copies, int reps = 5) {
+        std::string corpus;
+        if (!loadScanCorpus(repoRoot, copies, corpus)) return false;
+        using Clock = std::chrono::steady_clock;
+        using Ms = std::chrono::duration<double, std::milli>;
+
+        struct Call {
+            const char* p;
+            const char* end;
+        };
+        std::vector<Call> newlines, indents, idents, digits;
+        const char* p = corpus.data();
+        const char* end = p + corpus.size();
+        while (p < end) {
+            const char* eol = scalar_scan::findNewline(p, end);
+            newlines.push_back({ p, end });
+            indents.push_back({ p, eol });
+            for (const char* q = scalar_scan::skipSpaces(p, eol); q < eol;) {
+                unsigned char c = static_cast<unsigned char>(*q);
+                if (c >= '0' && c <= '9') {
+                    digits.push_back({ q, eol });
+                    q = scalar_scan::skipDigits(q, eol);
+                }
+                else if (isIdentByte(c)) {
+                    idents.push_back({ q, eol });
+                    q = scalar_scan::skipIdentChars(q, eol);
+                }
+                else {
+                    ++q;
+                }
+            }
+            p = eol < end ? eol + 1 : end;
+        }
+
+        using Kernel = const char* (*)(const char*, const char*);
+        struct KernelCase {
+            const char* name;
+            Kernel ScanKernels::*kernel;
+            const std::vector<Call>* calls;
+        };
+        const KernelCase cases[] = {
+            { "findNewline   ", &ScanKernels::findNewline, &newlines },
+            { "skipSpaces    ", &ScanKernels::skipSpaces, &indents },
+            { "skipIdentChars", &ScanKernels::skipIdentChars, &idents },
+            { "skipDigits    ", &ScanKernels::skipDigits, &digits },
+        };
+
+        bool ok = true;
+        std::vector<const ScanKernels*> sets = availableScanKernels();
+        std::cout << "[BENCH] corpus: " << corpus.size() << " bytes (" << copies << " copies), selected kernels: "
+                  << scanKernels().name << "\n";
+        for (const KernelCase& kc : cases) {
+            double scalarMs = 0;
+            size_t scalarBytes = 0;
+            std::cout << "[BENCH] " << kc.name << " (" << kc.calls->size() << " calls):";
+            for (const ScanKernels* set : sets) {
+                Kernel kernel = set->*kc.kernel;
+                double best = 0;
+                size_t bytes = 0;
+                for (int r = 0; r < reps; ++r) {
+                    bytes = 0;
+                    auto start = Clock::now();
+                    for (const Call& call : *kc.calls) bytes += static_cast<size_t>(kernel(call.p, call.end) - call.p);
+                    double ms = Ms(Clock::now() - start).count();
+                    best = r == 0 ? ms : std::min(best, ms);
+                }
+                if (set == sets.front()) {
+                    scalarMs = best;
+                    scalarBytes = bytes;
+                }
+                ok = ok && bytes == scalarBytes;
+                std::cout << " " << set->name << " " << best << " ms";
+                if (set != sets.front()) std::cout << " (" << scalarMs / std::max(best, 1e-9) << "x)";
+            }
+            std::cout << ", " << scalarBytes << " bytes skipped\n";
+        }
+
+        auto timeLexer = [&](const ScanKernels& kernels, size_t& tokenCount) {
+            double best = 0;
+            for (int r = 0; r < 3; ++r) {
+                auto start = Clock::now();
+                Lexer lexer(corpus, kernels);
+                tokenCount = lexer.tokenize().size();
+                double ms = Ms(Clock::now() - start).count();
+                best = r == 0 ? ms : std::min(best, ms);
+            }
+            return (corpus.size() / (1024.0 * 1024.0)) / std::max(best / 1000.0, 1e-9);
+        };
+        size_t scalarTokens = 0, vectorTokens = 0;
+        double scalarMBs = timeLexer(SCALAR_SCAN_KERNELS, scalarTokens);
+        double vectorMBs = timeLexer(scanKernels(), vectorTokens);
+        ok = ok && scalarTokens == vectorTokens;
+        std::cout << "[BENCH] lexer end to end: scalar " << scalarMBs << " MB/s, " << scanKernels().name << " " << vectorMBs
+                  << " MB/s (" << vectorMBs / std::max(scalarMBs, 1e-9) << "x, " << vectorTokens << " tokens)\n";
+        std::cout << "[BENCH] kernels agree: " << (ok ? "yes" : "NO") << "\n";
+        return ok;
+    }
+
+    // ======== Parallel Lexer Determinism Test ========
+    // tokenizeParallel must reproduce tokenize() exactly (type, text, line,
+    // col) for every thread count, including slices that start mid-block.
+    inline bool sameTokens(const std::vector<Token>& a, const std::vector<Token>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].type != b[i].type || a[i].text != b[i].text || a[i].line != b[i].line || a[i].col != b[i].col) return false;
+        }
+        return true;
+    }
+
+    inline bool runParallelLexerDeterminismTest(const std::string& repoRoot) {
+        std::vector<std::pair<std::string, std::string>> inputs;
+        for (const char* file : { "QuarterLang_SyntaxHighlighter.qtr", "recursion.qtr", "utils.qtr" }) {
+            std::string text;
+            if (QuarterSource::readFile(repoRoot + "/" + file, text)) inputs.emplace_back(file, std::move(text));
+        }
+        // Synthetic indent stress: deep nests, partial dedents, blank lines,
+        // and no trailing newline.
+        std::string nested;
+        unsigned seed = 12345;
+        for (int i = 0; i < 4000; ++i) {
+            seed = seed * 1103515245u + 12345u;
+            int depth = static_cast<int>((seed >> 16) % 7);
+            if ((seed >> 8) % 11 == 0) { nested += "\n"; continue; }
+            nested += std::string(depth * 2 + ((seed >> 4) % 3 == 0 ? 1 : 0), ' ') + "val x" + std::to_string(i) + " = " + std::to_string(i % 97) + "\n";
+        }
+        nested += "end";
+        inputs.emplace_back("synthetic-indent", nested);
+
+        bool ok = true;
+        for (const auto& [name, text] : inputs) {
+            std::vector<Token> serial = Lexer(text).tokenize();
+            for (unsigned threads = 1; threads <= 8; ++threads) {
+                std::vector<Token> parallel = Lexer(text).tokenizeParallel(threads, 1);
+                if (!sameTokens(serial, parallel)) {
+                    std::cout << "[TEST] FAIL parallel lexer: " << name << " with " << threads << " threads\n";
+                    ok = false;
+                }
+            }
+        }
+        std::cout << "[TEST] parallel lexer determinism: " << (ok ? "PASS" : "FAIL") << " (" << inputs.size() << " inputs, 1-8 threads)\n";
+        return ok;
+    }
+
+    // ======== Parallel Lexer Scaling Benchmark ========
+    inline bool runParallelLexerBenchmark(const std::string& repoRoot, int copies, unsigned maxThreads) {
+        std::string corpus;
+        if (!loadScanCorpus(repoRoot, copies, corpus)) return false;
+
+        std::cout << "[BENCH] parallel lexer corpus: " << corpus.size() << " bytes, "
+                  << std::thread::hardware_concurrency() << " hardware threads\n";
+        double baseline = 0;
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+            Lexer lexer(corpus);
+            auto start = std::chrono::steady_clock::now();
+            size_t count = lexer.tokenizeParallel(threads).size();
+            std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+            if (threads == 1) baseline = secs.count();
+            std::cout << "[BENCH] threads=" << threads << ": " << (corpus.size() / (1024.0 * 1024.0)) / secs.count()
+                      << " MB/s, speedup " << baseline / secs.count() << "x (" << count << " tokens)\n";
+        }
+        return true;
+    }
+}
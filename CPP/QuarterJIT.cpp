@@ -0,0 +1,1190 @@
+// QuarterJIT.cpp
+#include "QuarterJIT.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#if QL_JIT_X64
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static int64_t qlJitFail(QLJitContext* ctx, std::string why) {
+    if (ctx->status != QLJitStatus::Failed) *ctx->error = std::move(why);
+    ctx->status = QLJitStatus::Failed;
+    return 0;
+}
+
+int64_t qlJitOverflow(int64_t*, QLJitContext* ctx, uint64_t function) {
+    return qlJitFail(ctx, "stack overflow entering native function " + std::to_string(function));
+}
+
+static int64_t qlJitCallInterpreted(int64_t* window, QLJitContext* ctx, uint64_t function) {
+    const QLRegFunction& fn = ctx->module->functions[function];
+    if (window + fn.frameSize > ctx->limit) return qlJitOverflow(window, ctx, function);
+    std::fill(window + fn.params, window + fn.slots, 0);
+    QLRegState& state = *ctx->state;
+    state.acc = ctx->acc;
+    state.flag = ctx->flag != 0;
+    QLRegEntry entry{ fn.entry, window, static_cast<size_t>(ctx->limit - window) };
+    runRegisterVM<QL_VM_COMPUTED_GOTO != 0>(*ctx->module, state, &entry);
+    ctx->acc = state.acc;
+    ctx->flag = state.flag;
+    ctx->externalCalls += state.externalCalls;
+    if (!state.error.empty()) return qlJitFail(ctx, state.error);
+    if (!state.returned) {
+        ctx->status = QLJitStatus::Halted;
+        return 0;
+    }
+    return window[0] = state.result;
+}
+
+static int64_t qlJitCallNative(int64_t* args, QLJitContext* ctx, uint64_t site, int64_t callee) {
+    const QLCallSite& call = ctx->module->callSites[site];
+    int64_t value;
+    if (!callNative(ctx->state->callCaches, ctx->state->natives, ctx->module->strings, static_cast<uint32_t>(site), call,
+                    call.name == QL_NO_STRING ? callee : call.name, args, value, ctx->externalCalls))
+        return qlJitFail(ctx, "native arity mismatch at call site " + std::to_string(site));
+    if (call.pushesResult) args[0] = value;
+    return value;
+}
+
+const QLStencils& qlStencils() {
+    static const QLStencils stencils = [] {
+        constexpr uint8_t LIMIT = offsetof(QLJitContext, limit), FLOOR = offsetof(QLJitContext, stackFloor),
+                          ACC = offsetof(QLJitContext, acc), STATUS = offsetof(QLJitContext, status),
+                          FLAG = offsetof(QLJitContext, flag);
+        static_assert(offsetof(QLJitContext, flag) < 128, "context fields must be disp8-addressable");
+        struct Builder {
+            QLStencil s;
+            Builder& raw(std::initializer_list<uint8_t> b) { s.bytes.insert(s.bytes.end(), b); return *this; }
+            Builder& hole(QLHole kind, size_t width) {
+                s.holes.emplace_back(static_cast<uint16_t>(s.bytes.size()), kind);
+                s.bytes.resize(s.bytes.size() + width, 0);
+                return *this;
+            }
+            Builder& loadRax(QLHole r) { return raw({ 0x48, 0x8B, 0x83 }).hole(r, 4); }         // mov rax, [rbx+r]
+            Builder& storeRax() { return raw({ 0x48, 0x89, 0x83 }).hole(QLHole::D, 4); }        // mov [rbx+d], rax
+            Builder& raxImm() { return raw({ 0x48, 0xB8 }).hole(QLHole::Imm64, 8); }            // mov rax, imm64
+            Builder& rcxImm() { return raw({ 0x48, 0xB9 }).hole(QLHole::Imm64, 8); }            // mov rcx, imm64
+            Builder& epilogue() { return raw({ 0x48, 0x83, 0xC4, 0x08, 0x41, 0x5C, 0x5B, 0xC3 }); }  // add rsp, 8; pop r12; pop rbx; ret
+            Builder& setStatus(QLJitStatus st) { return raw({ 0x41, 0xC6, 0x44, 0x24, STATUS, static_cast<uint8_t>(st) }); }
+            Builder& storeAcc() { return raw({ 0x49, 0x89, 0x44, 0x24, ACC }); }               // mov [r12+acc], rax
+            Builder& helperArgs() { return raw({ 0x48, 0x8D, 0xBB }).hole(QLHole::D, 4).raw({ 0x4C, 0x89, 0xE6 }); }  // lea rdi, [rbx+d]; mov rsi, r12
+            Builder& callHelper(const void* fn) {                                                // mov rax, fn; call rax
+                s.helper = fn;
+                return raw({ 0x48, 0xB8 }).hole(QLHole::Helper, 8).raw({ 0xFF, 0xD0 });
+            }
+            Builder& leaveOnStatus() {                                                           // cmp byte [r12+status], 0; jne exit
+                return raw({ 0x41, 0x80, 0x7C, 0x24, STATUS, 0x00, 0x0F, 0x85 }).hole(QLHole::Exit, 4);
+            }
+            Builder& entry() {
+                raw({ 0x53, 0x41, 0x54, 0x48, 0x83, 0xEC, 0x08 });                               // push rbx; push r12; sub rsp, 8
+                raw({ 0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4 });                                     // mov rbx, rdi; mov r12, rsi
+                raw({ 0x48, 0x8D, 0x83 }).hole(QLHole::Frame, 4);                                // lea rax, [rbx+frame]
+                raw({ 0x49, 0x3B, 0x44, 0x24, LIMIT, 0x0F, 0x87 }).hole(QLHole::Overflow, 4);    // cmp rax, [r12+limit]; ja overflow
+                return raw({ 0x49, 0x3B, 0x64, 0x24, FLOOR, 0x0F, 0x82 }).hole(QLHole::Overflow, 4);  // cmp rsp, [r12+floor]; jb overflow
+            }
+        };
+        auto binary = [](uint8_t memOp, std::initializer_list<uint8_t> regTail, bool imm, std::initializer_list<uint8_t> tail) {
+            Builder b;
+            b.loadRax(QLHole::A);
+            if (imm) b.rcxImm().raw(regTail);                                   // op rax, rcx
+            else if (memOp == 0xAF) b.raw({ 0x48, 0x0F, 0xAF, 0x83 }).hole(QLHole::B, 4);  // imul rax, [rbx+b]
+            else b.raw({ 0x48, memOp, 0x83 }).hole(QLHole::B, 4);                  // op rax, [rbx+b]
+            return b.raw(tail).storeRax().s;
+        };
+        auto compare = [&](uint8_t setcc, bool imm) {  // setcc al; movzx eax, al
+            return binary(0x3B, { 0x48, 0x39, 0xC8 }, imm, { 0x0F, setcc, 0xC0, 0x0F, 0xB6, 0xC0 });
+        };
+
+        QLStencils t;
+        auto op = [&](QLRegOp o) -> QLStencil& { return t.ops[static_cast<size_t>(o)]; };
+        op(QLRegOp::MOV) = Builder().loadRax(QLHole::A).storeRax().s;
+        op(QLRegOp::MOVI) = Builder().raxImm().storeRax().s;
+        op(QLRegOp::ADD) = binary(0x03, {}, false, {});
+        op(QLRegOp::ADDI) = binary(0, { 0x48, 0x01, 0xC8 }, true, {});
+        op(QLRegOp::SUB) = binary(0x2B, {}, false, {});
+        op(QLRegOp::SUBI) = binary(0, { 0x48, 0x29, 0xC8 }, true, {});
+        op(QLRegOp::MUL) = binary(0xAF, {}, false, {});
+        op(QLRegOp::MULI) = binary(0, { 0x48, 0x0F, 0xAF, 0xC1 }, true, {});
+        op(QLRegOp::LT) = compare(0x9C, false);
+        op(QLRegOp::LTI) = compare(0x9C, true);
+        op(QLRegOp::LE) = compare(0x9E, false);
+        op(QLRegOp::LEI) = compare(0x9E, true);
+        op(QLRegOp::EQ) = compare(0x94, false);
+        op(QLRegOp::EQI) = compare(0x94, true);
+        op(QLRegOp::JMP) = Builder().raw({ 0xE9 }).hole(QLHole::Target, 4).s;
+        op(QLRegOp::JZ) = Builder().raw({ 0x48, 0x83, 0xBB }).hole(QLHole::A, 4).raw({ 0x00, 0x0F, 0x84 }).hole(QLHole::Target, 4).s;
+        op(QLRegOp::CALL_EXT) = Builder().helperArgs().raw({ 0xBA }).hole(QLHole::Imm32, 4)
+                                    .callHelper(reinterpret_cast<const void*>(&qlJitCallNative)).leaveOnStatus().s;
+        op(QLRegOp::CALL_DYN) = Builder().helperArgs().raw({ 0xBA }).hole(QLHole::Imm32, 4).raw({ 0x48, 0x8B, 0x8B }).hole(QLHole::A, 4)
+                                    .callHelper(reinterpret_cast<const void*>(&qlJitCallNative)).leaveOnStatus().s;
+        op(QLRegOp::RET) = Builder().loadRax(QLHole::A).epilogue().s;
+        op(QLRegOp::RETI) = Builder().raxImm().epilogue().s;
+        op(QLRegOp::HALT) = Builder().loadRax(QLHole::A).storeAcc().setStatus(QLJitStatus::Halted).epilogue().s;
+        op(QLRegOp::HALTI) = Builder().raxImm().storeAcc().setStatus(QLJitStatus::Halted).epilogue().s;
+        op(QLRegOp::HALT_ACC) = Builder().setStatus(QLJitStatus::Halted).epilogue().s;
+        op(QLRegOp::SET_ACC) = Builder().raxImm().storeAcc().s;
+        op(QLRegOp::SET_FLAG) = Builder().raw({ 0x41, 0xC6, 0x44, 0x24, FLAG }).hole(QLHole::Imm8, 1).s;
+        t.callNativeToRax = Builder().helperArgs().raw({ 0xE8 }).hole(QLHole::Callee, 4).leaveOnStatus().s;
+        t.callNative = Builder{ t.callNativeToRax }.storeRax().s;
+        t.callInterpreted = Builder().helperArgs().raw({ 0xBA }).hole(QLHole::Imm32, 4)
+                                .callHelper(reinterpret_cast<const void*>(&qlJitCallInterpreted)).leaveOnStatus().s;
+        t.prologue = Builder().entry().s;
+        t.resume = Builder().entry().raw({ 0xE9 }).hole(QLHole::Target, 4).s;
+        t.zeroSlot = Builder().raw({ 0x48, 0xC7, 0x83 }).hole(QLHole::D, 4).raw({ 0, 0, 0, 0 }).s;  // mov qword [rbx+d], 0
+        t.exit = Builder().epilogue().s;
+        t.overflow = Builder().raw({ 0x48, 0x89, 0xDF, 0x4C, 0x89, 0xE6, 0xBA }).hole(QLHole::Imm32, 4)  // mov rdi, rbx; mov rsi, r12; mov edx, f
+                         .callHelper(reinterpret_cast<const void*>(&qlJitOverflow)).epilogue().s;
+        return t;
+    }();
+    return stencils;
+}
+
+bool allocateRegisters(const QLRegModule& module, uint32_t function, QLRegAllocation& out) {
+    const QLRegFunction& fn = module.functions[function];
+    const uint32_t begin = fn.entry;
+    const uint32_t end = function + 1 < module.functions.size() ? module.functions[function + 1].entry
+                                                                 : static_cast<uint32_t>(module.code.size());
+    const uint32_t width = fn.frameSize, words = (width + 63) / 64;
+    auto access = [&](const QLRegInstr& in) {
+        return qlRegAccess(module.callSites, in, [&](int64_t f) { return module.functions[f].params; });
+    };
+    auto endsFlow = [](QLRegOp op) {
+        return op == QLRegOp::JMP || op == QLRegOp::RET || op == QLRegOp::RETI || op == QLRegOp::HALT ||
+               op == QLRegOp::HALTI || op == QLRegOp::HALT_ACC;
+    };
+
+    out = {};
+    out.words = words;
+    std::vector<bool> leader(end - begin + 1, false);
+    leader[0] = true;
+    for (uint32_t pc = begin; pc < end; ++pc) {
+        const QLRegInstr& in = module.code[pc];
+        if (in.op == QLRegOp::JMP || in.op == QLRegOp::JZ) leader[in.imm - begin] = true;
+        if (in.op == QLRegOp::JZ || endsFlow(in.op)) leader[pc + 1 - begin] = true;
+    }
+    for (uint32_t pc = begin; pc < end; ++pc)
+        if (leader[pc - begin]) out.leaders.push_back(pc);
+    const size_t blocks = out.leaders.size();
+    if (blocks * words > (size_t(1) << 22)) return false;
+    auto blockOf = [&](int64_t pc) {
+        return static_cast<uint32_t>(std::lower_bound(out.leaders.begin(), out.leaders.end(), static_cast<uint32_t>(pc)) - out.leaders.begin());
+    };
+    auto last = [&](size_t b) { return (b + 1 < blocks ? out.leaders[b + 1] : end) - 1; };
+
+    // Backward liveness over blocks; a call clobbers the registers above d.
+    std::vector<uint64_t> gen(blocks * words, 0), kill(blocks * words, 0), liveOut(blocks * words, 0);
+    out.liveIn.assign(blocks * words, 0);
+    auto set = [](uint64_t* bits, uint32_t r) { bits[r / 64] |= uint64_t(1) << (r % 64); };
+    auto clear = [](uint64_t* bits, uint32_t r) { bits[r / 64] &= ~(uint64_t(1) << (r % 64)); };
+    auto test = [](const uint64_t* bits, uint32_t r) { return (bits[r / 64] >> (r % 64)) & 1; };
+    for (size_t b = 0; b < blocks; ++b)
+        for (uint32_t pc = last(b) + 1; pc-- > out.leaders[b];) {
+            const QLRegInstr& in = module.code[pc];
+            QLIRAccess x = access(in);
+            uint64_t* g = &gen[b * words];
+            uint64_t* k = &kill[b * words];
+            auto def = [&](uint32_t r) { set(k, r); clear(g, r); };
+            if (x.clobbers)
+                for (uint32_t r = in.d + 1u; r < width; ++r) def(r);
+            if (x.writes) def(in.d);
+            if (x.readsA) set(g, in.a);
+            if (x.readsB) set(g, in.b);
+            for (uint32_t a = 0; a < x.argc; ++a) set(g, in.d + a);
+        }
+    auto forEachSuccessor = [&](size_t b, auto&& visit) {
+        const QLRegInstr& in = module.code[last(b)];
+        if (in.op == QLRegOp::JMP || in.op == QLRegOp::JZ) visit(blockOf(in.imm));
+        if (!endsFlow(in.op) && b + 1 < blocks) visit(static_cast<uint32_t>(b + 1));
+    };
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t b = blocks; b-- > 0;) {
+            uint64_t* o = &liveOut[b * words];
+            forEachSuccessor(b, [&](uint32_t s) {
+                for (uint32_t w = 0; w < words; ++w) o[w] |= out.liveIn[s * words + w];
+            });
+            for (uint32_t w = 0; w < words; ++w) {
+                uint64_t in = gen[b * words + w] | (o[w] & ~kill[b * words + w]);
+                if (in != out.liveIn[b * words + w]) {
+                    out.liveIn[b * words + w] = in;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // Interval hulls, whether each is live across a call, and copy hints.
+    std::vector<uint32_t> start(width, UINT32_MAX), stop(width, 0);
+    std::vector<bool> crossesCall(width, false);
+    std::vector<uint32_t> hint(width, UINT32_MAX);
+    auto extend = [&](uint32_t r, uint32_t pos) {
+        start[r] = std::min(start[r], pos);
+        stop[r] = std::max(stop[r], pos);
+    };
+    std::vector<uint64_t> live(words);
+    for (size_t b = 0; b < blocks; ++b) {
+        uint32_t first = out.leaders[b] - begin, lastPc = last(b) - begin;
+        for (uint32_t r = 0; r < width; ++r) {
+            if (test(&out.liveIn[b * words], r)) extend(r, 2 * first);
+            if (test(&liveOut[b * words], r)) extend(r, 2 * lastPc + 1);
+        }
+        std::copy(liveOut.begin() + b * words, liveOut.begin() + (b + 1) * words, live.begin());
+        for (uint32_t pc = last(b) + 1; pc-- > out.leaders[b];) {
+            const QLRegInstr& in = module.code[pc];
+            QLIRAccess x = access(in);
+            uint32_t rel = pc - begin;
+            if (in.op == QLRegOp::CALL || in.op == QLRegOp::CALL_EXT || in.op == QLRegOp::CALL_DYN)
+                for (uint32_t w = 0; w < words; ++w)
+                    for (uint64_t bits = live[w]; bits; bits &= bits - 1) {
+                        uint32_t r = w * 64 + static_cast<uint32_t>(__builtin_ctzll(bits));
+                        if (!(x.writes && r == in.d)) crossesCall[r] = true;
+                    }
+            if (x.clobbers)
+                for (uint32_t r = in.d + 1u; r < width; ++r) clear(live.data(), r);
+            if (x.writes) {
+                clear(live.data(), in.d);
+                extend(in.d, 2 * rel + 1);
+            }
+            auto read = [&](uint32_t r) {
+                set(live.data(), r);
+                extend(r, 2 * rel);
+            };
+            if (x.readsA) read(in.a);
+            if (x.readsB) read(in.b);
+            for (uint32_t a = 0; a < x.argc; ++a) read(in.d + a);
+        }
+    }
+    for (uint32_t pc = begin; pc < end; ++pc) {
+        const QLRegInstr& in = module.code[pc];
+        if (in.op == QLRegOp::MOV && start[in.d] == 2 * (pc - begin) + 1) hint[in.d] = in.a;
+    }
+    // Use weights: reads and writes, times 8 per enclosing loop (the span
+    // of a backward jump).
+    std::vector<int32_t> depthDelta(end - begin + 1, 0);
+    for (uint32_t pc = begin; pc < end; ++pc) {
+        const QLRegInstr& in = module.code[pc];
+        if ((in.op == QLRegOp::JMP || in.op == QLRegOp::JZ) && in.imm <= pc) {
+            ++depthDelta[in.imm - begin];
+            --depthDelta[pc + 1 - begin];
+        }
+    }
+    std::vector<uint64_t> weight(width, 0);
+    int32_t depth = 0;
+    for (uint32_t pc = begin; pc < end; ++pc) {
+        depth += depthDelta[pc - begin];
+        const QLRegInstr& in = module.code[pc];
+        QLIRAccess x = access(in);
+        uint64_t w = uint64_t(1) << (3 * std::min(depth, 6));
+        if (x.readsA) weight[in.a] += w;
+        if (x.readsB) weight[in.b] += w;
+        for (uint32_t a = 0; a < x.argc; ++a) weight[in.d + a] += w;
+        if (x.writes) weight[in.d] += w;
+    }
+
+    // The scan. `active` holds allocated intervals by ascending end.
+    out.machine.assign(width, QL_NO_MACHINE_REG);
+    std::vector<uint32_t> order;
+    for (uint32_t r = 0; r < width; ++r)
+        if (start[r] != UINT32_MAX) order.push_back(r);
+    std::sort(order.begin(), order.end(), [&](uint32_t x, uint32_t y) { return start[x] != start[y] ? start[x] < start[y] : x < y; });
+    std::vector<uint32_t> active;
+    uint32_t busy = 0;  // bit per machine register
+    uint32_t calleeUsed = 0;
+    auto isCallee = [](uint8_t m) { return m == QL_R13 || m == QL_R14 || m == QL_R15 || m == QL_RBP; };
+    for (uint32_t r : order) {
+        while (!active.empty() && stop[active.front()] < start[r]) {
+            busy &= ~(1u << out.machine[active.front()]);
+            active.erase(active.begin());
+        }
+        auto allowed = [&](uint8_t m) { return !crossesCall[r] || isCallee(m); };
+        if (crossesCall[r] && weight[r] < QL_CALLEE_SAVED_MIN_WEIGHT) {
+            // Cheaper in its frame slot than saved and restored around every call.
+            ++out.stats.intervals;
+            ++out.stats.spilled;
+            continue;
+        }
+        uint8_t pick = QL_NO_MACHINE_REG;
+        if (hint[r] != UINT32_MAX) {
+            uint8_t m = out.machine[hint[r]];
+            if (m != QL_NO_MACHINE_REG && !(busy >> m & 1) && allowed(m)) pick = m;
+        }
+        if (pick == QL_NO_MACHINE_REG && !crossesCall[r])
+            for (uint8_t m : QL_CALLER_SAVED)
+                if (!(busy >> m & 1)) { pick = m; break; }
+        if (pick == QL_NO_MACHINE_REG)
+            for (uint8_t m : QL_CALLEE_SAVED)
+                if (!(busy >> m & 1)) { pick = m; break; }
+        ++out.stats.intervals;
+        if (pick == QL_NO_MACHINE_REG) {
+            // Spill whichever of r and the active intervals it could take
+            // a register from ends last.
+            auto victim = active.end();
+            for (auto it = active.begin(); it != active.end(); ++it)
+                if (allowed(out.machine[*it]) && (victim == active.end() || stop[*it] > stop[*victim])) victim = it;
+            ++out.stats.spilled;
+            if (victim == active.end() || stop[*victim] <= stop[r]) continue;
+            pick = out.machine[*victim];
+            out.machine[*victim] = QL_NO_MACHINE_REG;
+            active.erase(victim);
+            busy &= ~(1u << pick);
+        }
+        out.machine[r] = pick;
+        busy |= 1u << pick;
+        if (isCallee(pick)) calleeUsed |= 1u << pick;
+        active.insert(std::upper_bound(active.begin(), active.end(), r, [&](uint32_t x, uint32_t y) { return stop[x] < stop[y]; }), r);
+    }
+    for (uint8_t m : QL_CALLEE_SAVED)
+        if (calleeUsed >> m & 1) out.calleeSaved.push_back(m);
+    for (uint32_t r = 0; r < width; ++r) out.stats.allocated += out.machine[r] != QL_NO_MACHINE_REG;
+    for (uint32_t pc = begin; pc < end; ++pc) {
+        const QLRegInstr& in = module.code[pc];
+        if (in.op == QLRegOp::MOV && out.machine[in.d] != QL_NO_MACHINE_REG && out.machine[in.d] == out.machine[in.a]) ++out.stats.coalesced;
+    }
+    out.stats.calleeSaved = out.calleeSaved.size();
+    return true;
+}
+
+QLSimdLevel qlHostSimd() {
+#if QL_JIT_X64
+    static const QLSimdLevel level = __builtin_cpu_supports("avx2") ? QLSimdLevel::AVX2 : QLSimdLevel::SSE2;
+    return level;
+#else
+    return QLSimdLevel::None;
+#endif
+}
+
+static uint32_t qlSimdLanes(QLSimdLevel level) { return level == QLSimdLevel::AVX2 ? 4 : level == QLSimdLevel::SSE2 ? 2 : 1; }
+
+const char* qlSimdName(QLSimdLevel level) {
+    return level == QLSimdLevel::AVX2 ? "AVX2" : level == QLSimdLevel::SSE2 ? "SSE2" : "scalar";
+}
+
+bool qlVectorLoopPays(const QLVectorLoop& loop, QLSimdLevel level) {
+    const bool avx = level == QLSimdLevel::AVX2;
+    size_t cost = 3;  // add, cmp and jl on the counter
+    for (const QLVectorLoop::Step& s : loop.body) {
+        if (s.op == QLVectorLoop::Op::Mul) cost += avx ? (s.highB ? 8 : 5) : (s.highB ? 12 : 8);
+        else cost += avx || s.op == QLVectorLoop::Op::Move || s.d == s.a ? 1 : 2;
+    }
+    return cost < (loop.latch - loop.header + 4) * size_t(qlSimdLanes(level));
+}
+
+bool planVectorLoop(const QLRegModule& module, uint32_t function, const QLRegAllocation& alloc, uint32_t header,
+                    uint32_t latch, QLSimdLevel level, QLVectorLoop& out) {
+    using Op = QLRegOp;
+    const uint32_t lanes = qlSimdLanes(level);
+    const QLRegFunction& fn = module.functions[function];
+    const uint32_t end = function + 1 < module.functions.size() ? module.functions[function + 1].entry
+                                                                 : static_cast<uint32_t>(module.code.size());
+    if (latch < header + 2 || latch - header > QL_VECTOR_MAX_BODY || module.code[latch].op != Op::JMP ||
+        module.code[latch].imm != header)
+        return false;
+    const QLRegInstr& cmp = module.code[header];
+    const QLRegInstr& test = module.code[header + 1];
+    const bool immediate = cmp.op == Op::LTI || cmp.op == Op::LEI;
+    if ((cmp.op != Op::LT && cmp.op != Op::LE && !immediate) || test.op != Op::JZ || test.a != cmp.d || cmp.d == cmp.a ||
+        (!immediate && cmp.d == cmp.b) || (test.imm >= header && test.imm <= latch))
+        return false;
+    for (uint32_t pc = fn.entry; pc < end; ++pc) {
+        const QLRegInstr& in = module.code[pc];
+        if ((in.op == Op::JMP || in.op == Op::JZ) && in.imm > header && in.imm <= latch) return false;
+    }
+    const uint32_t first = header + 2, width = fn.frameSize;
+    std::vector<bool> written(width, false);
+    for (uint32_t pc = first; pc < latch; ++pc) {
+        if (module.code[pc].op > Op::MULI) return false;
+        written[module.code[pc].d] = true;
+    }
+
+    // r = r + k, r - k, r + x or r - x for an invariant x, and the step it adds.
+    auto stepOf = [&](const QLRegInstr& in, QLLinear& delta) {
+        delta = {};
+        if ((in.op == Op::ADDI || in.op == Op::SUBI) && in.a == in.d) {
+            delta.constant = in.op == Op::ADDI ? in.imm : static_cast<int64_t>(0 - uint64_t(in.imm));
+            return true;
+        }
+        uint32_t x = in.a == in.d ? in.b : in.a;
+        if ((in.op == Op::ADD && (in.a == in.d) != (in.b == in.d)) || (in.op == Op::SUB && in.a == in.d && in.b != in.d)) {
+            if (written[x]) return false;
+            delta.terms.emplace_back(x, in.op == Op::ADD ? 1 : -1);
+            return true;
+        }
+        return false;
+    };
+    auto accumulates = [](const QLRegInstr& in) {
+        return (in.op == Op::ADD && (in.a == in.d) != (in.b == in.d)) || (in.op == Op::SUB && in.a == in.d && in.b != in.d);
+    };
+
+    // Registers written in the loop and live at its header carry values
+    // between iterations: induction variables, failing that reductions.
+    enum Kind : uint8_t { Unused, Invariant, Induction, Reduction, Temporary };
+    std::vector<uint8_t> kind(width, Unused);
+    for (uint32_t r = 0; r < width; ++r)
+        if (written[r]) kind[r] = alloc.liveAt(header, r) ? Induction : Temporary;
+    std::vector<QLLinear> stride(width);
+    QLLinear delta;
+    for (uint32_t pc = first; pc < latch; ++pc)
+        if (kind[module.code[pc].d] == Induction && !stepOf(module.code[pc], delta)) kind[module.code[pc].d] = Reduction;
+    std::vector<uint32_t> lastUpdate(width, 0), lastRead(width, 0), lastAccess(width, 0);
+    std::vector<bool> readInBody(width, false), defined(width, false);
+    for (uint32_t pc = first; pc < latch; ++pc) {
+        const QLRegInstr& in = module.code[pc];
+        const bool update = kind[in.d] == Induction || kind[in.d] == Reduction;
+        if (kind[in.d] == Reduction && !accumulates(in)) return false;
+        if (kind[in.d] == Induction) {
+            stepOf(in, delta);
+            stride[in.d].add(delta);
+            lastUpdate[in.d] = pc;
+        }
+        auto read = [&](uint32_t r) {
+            lastAccess[r] = pc;
+            if (update && r == in.d) return true;
+            if (kind[r] == Reduction || (kind[r] == Temporary && !defined[r])) return false;
+            if (!written[r]) {
+                if (!alloc.liveAt(header, r)) return false;  // e.g. the header's compare result
+                kind[r] = Invariant;
+            }
+            readInBody[r] = true;
+            lastRead[r] = pc;
+            return true;
+        };
+        if (in.op != Op::MOVI && !read(in.a)) return false;
+        if ((in.op == Op::ADD || in.op == Op::SUB || in.op == Op::MUL) && !read(in.b)) return false;
+        defined[in.d] = true;
+        lastAccess[in.d] = pc;
+    }
+
+    const uint32_t counter = cmp.a;
+    if (kind[counter] != Induction || !stride[counter].terms.empty() || stride[counter].constant <= 0 ||
+        stride[counter].constant > QL_VECTOR_MAX_STEP)
+        return false;
+    out = {};
+    out.header = header;
+    out.latch = latch;
+    out.counter = counter;
+    out.counterStep = stride[counter].constant;
+    out.inclusive = cmp.op == Op::LE || cmp.op == Op::LEI;
+    const int64_t span = int64_t(lanes - 1) * out.counterStep;
+    if (immediate) {
+        if (cmp.imm < INT64_MIN + span) return false;
+        out.immediateBound = true;
+        out.bound = cmp.imm - span;
+    } else {
+        if (written[cmp.b]) return false;
+        out.boundRegister = cmp.b;
+    }
+
+    // Vector registers: values live through the whole loop first, then
+    // temporaries, each free again after its last access.
+    std::vector<uint8_t> vec(width, QL_NO_SIMD_REG), endAdd(width, QL_NO_SIMD_REG), foldAdd(width, QL_NO_SIMD_REG);
+    uint32_t busy = 0;
+    auto take = [&] {
+        for (uint8_t v = 0; v < QL_SIMD_REGS; ++v)
+            if (!(busy >> v & 1)) {
+                busy |= 1u << v;
+                return v;
+            }
+        return QL_NO_SIMD_REG;
+    };
+    std::map<int64_t, uint8_t> constants;
+    auto broadcast = [&](const QLLinear& value) {
+        if (value.terms.empty()) {
+            auto it = constants.find(value.constant);
+            if (it != constants.end()) return it->second;
+        }
+        uint8_t v = take();
+        if (v == QL_NO_SIMD_REG) return v;
+        if (value.terms.empty()) constants[value.constant] = v;
+        out.setup.push_back({ QLVectorLoop::Setup::Broadcast, v, 0, value });
+        return v;
+    };
+    // An induction variable nothing else reads advances once per vector
+    // iteration; the counter then needs no vector at all. Otherwise its
+    // updates run lane by lane, and the last one also adds the (lanes - 1)
+    // iterations the other lanes ran, unless something reads it after.
+    auto hasVector = [&](uint32_t r) { return kind[r] != Induction || r != counter || readInBody[r]; };
+    auto skipped = [&](uint32_t r) { return !readInBody[r]; };
+    auto folded = [&](uint32_t r, uint32_t pc) { return readInBody[r] && pc == lastUpdate[r] && lastRead[r] < pc; };
+    for (uint32_t r = 0; r < width; ++r) {
+        if (!((kind[r] == Invariant && readInBody[r]) || kind[r] == Induction || kind[r] == Reduction) || !hasVector(r)) continue;
+        if ((vec[r] = take()) == QL_NO_SIMD_REG) return false;
+        if (kind[r] == Invariant) out.setup.push_back({ QLVectorLoop::Setup::Broadcast, vec[r], 0, QLLinear{ 0, { { r, 1 } } } });
+        else if (kind[r] == Induction) out.setup.push_back({ QLVectorLoop::Setup::Lanes, vec[r], r, stride[r] });
+        else out.setup.push_back({ QLVectorLoop::Setup::FirstLane, vec[r], r, {} });
+    }
+    for (uint32_t r = 0; r < width; ++r) {
+        if (kind[r] != Induction || !hasVector(r)) continue;
+        QLLinear value;
+        if (skipped(r)) value.add(stride[r], lanes);
+        else if (lastRead[r] < lastUpdate[r]) {
+            stepOf(module.code[lastUpdate[r]], value);
+            value.add(stride[r], lanes - 1);
+        } else value.add(stride[r], lanes - 1);
+        uint8_t v = broadcast(value);
+        if (v == QL_NO_SIMD_REG) return false;
+        (folded(r, lastUpdate[r]) ? foldAdd : endAdd)[r] = v;
+    }
+    for (uint32_t pc = first; pc < latch; ++pc) {
+        const QLRegInstr& in = module.code[pc];
+        bool immediateOperand = in.op == Op::MOVI || in.op == Op::ADDI || in.op == Op::SUBI || in.op == Op::MULI;
+        if (kind[in.d] == Induction && (!hasVector(in.d) || skipped(in.d) || folded(in.d, pc))) continue;
+        if (immediateOperand && broadcast(QLLinear{ in.imm, {} }) == QL_NO_SIMD_REG) return false;
+    }
+
+    for (uint32_t pc = first; pc < latch; ++pc) {
+        const QLRegInstr& in = module.code[pc];
+        const uint32_t d = in.d;
+        if (kind[d] == Induction && (!hasVector(d) || skipped(d))) continue;
+        if (kind[d] == Induction && folded(d, pc)) {
+            out.body.push_back({ QLVectorLoop::Op::Add, vec[d], vec[d], foldAdd[d], false });
+            continue;
+        }
+        uint8_t a = in.op == Op::MOVI ? constants[in.imm] : vec[in.a];
+        uint8_t b = in.op == Op::ADD || in.op == Op::SUB || in.op == Op::MUL ? vec[in.b]
+                  : in.op == Op::ADDI || in.op == Op::SUBI || in.op == Op::MULI ? constants[in.imm] : QL_NO_SIMD_REG;
+        auto release = [&](uint32_t r) {
+            if (r != d && kind[r] == Temporary && lastAccess[r] == pc) busy &= ~(1u << vec[r]);
+        };
+        if (in.op != Op::MOVI) release(in.a);
+        if (in.op == Op::ADD || in.op == Op::SUB || in.op == Op::MUL) release(in.b);
+        if (kind[d] == Temporary && vec[d] == QL_NO_SIMD_REG && (vec[d] = take()) == QL_NO_SIMD_REG) return false;
+        QLVectorLoop::Op op = in.op == Op::MOV || in.op == Op::MOVI ? QLVectorLoop::Op::Move
+                            : in.op == Op::ADD || in.op == Op::ADDI ? QLVectorLoop::Op::Add
+                            : in.op == Op::SUB || in.op == Op::SUBI ? QLVectorLoop::Op::Sub : QLVectorLoop::Op::Mul;
+        bool highB = in.op == Op::MUL || (in.op == Op::MULI && uint64_t(in.imm) >> 32 != 0);
+        if (op != QLVectorLoop::Op::Move || vec[d] != a) out.body.push_back({ op, vec[d], a, b, highB });
+        if (kind[d] == Temporary && lastAccess[d] == pc) busy &= ~(1u << vec[d]);
+    }
+    for (uint32_t r = 0; r < width; ++r) {
+        if (endAdd[r] != QL_NO_SIMD_REG) out.body.push_back({ QLVectorLoop::Op::Add, vec[r], vec[r], endAdd[r], false });
+        if (kind[r] == Induction && r != counter) out.inductions.emplace_back(r, vec[r]);
+        if (kind[r] == Reduction) out.reductions.emplace_back(r, vec[r]);
+    }
+    return true;
+}
+
+// SSE2 and AVX2 encodings for vector loops, on xmm/ymm register numbers.
+// AVX2 code is VEX-encoded throughout, 256 bits wide unless `wide` is
+// false, so it never mixes with legacy SSE encodings.
+struct QLSimdWriter {
+    QLX64Writer& x;
+    bool avx;
+
+    void vex(uint8_t map, bool w, uint8_t v, bool wide, uint8_t opcode, uint8_t reg, uint8_t rm) {
+        x.bytes({ 0xC4, static_cast<uint8_t>((reg < 8 ? 0x80 : 0) | 0x40 | (rm < 8 ? 0x20 : 0) | map),
+                  static_cast<uint8_t>((w ? 0x80 : 0) | (~v & 15) << 3 | (wide ? 4 : 0) | 1), opcode,
+                  static_cast<uint8_t>(0xC0 | (reg & 7) << 3 | (rm & 7)) });
+    }
+    void sse(uint8_t opcode, uint8_t reg, uint8_t rm, bool w = false) {
+        x.out.push_back(0x66);
+        if (w || reg >= 8 || rm >= 8) x.out.push_back(static_cast<uint8_t>(0x40 | (w ? 8 : 0) | (reg >= 8 ? 4 : 0) | (rm >= 8 ? 1 : 0)));
+        x.bytes({ 0x0F, opcode, static_cast<uint8_t>(0xC0 | (reg & 7) << 3 | (rm & 7)) });
+    }
+    void move(uint8_t d, uint8_t a) {  // movdqa
+        if (d == a) return;
+        if (avx) vex(1, false, 0, true, 0x6F, d, a);
+        else sse(0x6F, d, a);
+    }
+    // d = a op b: paddq D4, psubq FB, pmuludq F4, punpcklqdq 6C.
+    void binary(uint8_t opcode, uint8_t d, uint8_t a, uint8_t b, bool wide = true) {
+        if (avx) return vex(1, false, a, wide, opcode, d, b);
+        if (d == b && d != a) {
+            if (opcode == 0xD4 || opcode == 0xF4) return sse(opcode, d, a);
+            move(QL_SIMD_T2, b);
+            b = QL_SIMD_T2;
+        }
+        move(d, a);
+        sse(opcode, d, b);
+    }
+    void shift(uint8_t ext, uint8_t d, uint8_t a, uint8_t bits) {  // psrlq /2, psllq /6
+        if (avx) vex(1, false, d, true, 0x73, ext, a);
+        else {
+            move(d, a);
+            sse(0x73, ext, d);
+        }
+        x.out.push_back(bits);
+    }
+    void fromGpr(uint8_t d, uint8_t r) {  // movq d, r (zeroing the other lanes)
+        if (avx) vex(1, true, 0, false, 0x6E, d, r);
+        else sse(0x6E, d, r, true);
+    }
+    void toGpr(uint8_t r, uint8_t s) {  // movq r, s (lane 0)
+        if (avx) vex(1, true, 0, false, 0x7E, s, r);
+        else sse(0x7E, s, r, true);
+    }
+    void broadcast(uint8_t d) {  // lane 0 to every lane: vpbroadcastq or punpcklqdq
+        if (avx) vex(2, false, 0, true, 0x59, d, d);
+        else sse(0x6C, d, d);
+    }
+    // d = a * b per 64-bit lane: lo(a)lo(b) + (hi(a)lo(b) + lo(a)hi(b)) << 32.
+    void mul(uint8_t d, uint8_t a, uint8_t b, bool highB) {
+        shift(2, QL_SIMD_T1, a, 32);
+        binary(0xF4, QL_SIMD_T1, QL_SIMD_T1, b);
+        if (highB) {
+            shift(2, QL_SIMD_T2, b, 32);
+            binary(0xF4, QL_SIMD_T2, QL_SIMD_T2, a);
+            binary(0xD4, QL_SIMD_T1, QL_SIMD_T1, QL_SIMD_T2);
+        }
+        shift(6, QL_SIMD_T1, QL_SIMD_T1, 32);
+        binary(0xF4, QL_SIMD_T2, a, b);
+        binary(0xD4, d, QL_SIMD_T2, QL_SIMD_T1);
+    }
+    void sum(uint8_t r, uint8_t s) {  // r = the sum of s's lanes
+        if (avx) {
+            vex(3, false, 0, true, 0x39, s, QL_SIMD_T1);              // vextracti128 t1, s, 1
+            x.out.push_back(1);
+            binary(0xD4, QL_SIMD_T1, QL_SIMD_T1, s, false);
+        } else move(QL_SIMD_T1, s);
+        if (avx) vex(1, false, 0, false, 0x70, QL_SIMD_T2, QL_SIMD_T1);  // pshufd t2, t1, 0x4E (swap halves)
+        else sse(0x70, QL_SIMD_T2, QL_SIMD_T1);
+        x.out.push_back(0x4E);
+        binary(0xD4, QL_SIMD_T1, QL_SIMD_T1, QL_SIMD_T2, false);
+        toGpr(r, QL_SIMD_T1);
+    }
+};
+
+void emitVectorLoop(QLX64Writer& x, const QLVectorLoop& loop, QLSimdLevel level, const std::vector<uint8_t>& machine) {
+    QLSimdWriter v{ x, level == QLSimdLevel::AVX2 };
+    const int64_t lanes = qlSimdLanes(level), span = (lanes - 1) * loop.counterStep;
+    auto load = [&](uint8_t dst, uint32_t r) {
+        if (machine[r] == QL_NO_MACHINE_REG) x.rm({ 0x8B }, dst, int64_t(r) * 8);
+        else if (machine[r] != dst) x.rr({ 0x8B }, dst, machine[r]);
+    };
+    auto store = [&](uint32_t r, uint8_t src) {
+        if (machine[r] == QL_NO_MACHINE_REG) x.rm({ 0x89 }, src, int64_t(r) * 8);
+        else x.rr({ 0x8B }, machine[r], src);
+    };
+    auto evaluate = [&](const QLLinear& value) {  // rax = value
+        if (value.constant == 0 && value.terms.size() == 1 && value.terms[0].second == 1) return load(QL_RAX, value.terms[0].first);
+        x.movImm(QL_RAX, value.constant);
+        for (auto [r, scale] : value.terms) {
+            load(QL_R11, r);
+            if (scale != 1) {
+                x.rr({ 0x69 }, QL_R11, QL_R11);                                  // imul r11, r11, simm32
+                x.imm32(scale);
+            }
+            x.rr({ 0x03 }, QL_RAX, QL_R11);                                      // add rax, r11
+        }
+    };
+    auto bound = [&] {  // rax = the last counter value a vector iteration may start at
+        if (loop.immediateBound) return x.movImm(QL_RAX, loop.bound);
+        load(QL_RAX, loop.boundRegister);
+        x.aluImm(5, QL_RAX, span);                                               // sub rax, span
+    };
+    auto jcc = [&](uint8_t cc) {
+        x.bytes({ 0x0F, cc });
+        size_t at = x.out.size();
+        x.imm32(0);
+        return at;
+    };
+    std::vector<size_t> toScalar;
+    bound();
+    if (!loop.immediateBound) toScalar.push_back(jcc(0x80));                     // jo: no lane fits below INT64_MIN
+    load(QL_R11, loop.counter);
+    x.rr({ 0x3B }, QL_R11, QL_RAX);                                              // cmp r11, rax
+    toScalar.push_back(jcc(loop.inclusive ? 0x8F : 0x8D));                       // jg / jge
+    for (const QLVectorLoop::Init& init : loop.setup) {
+        if (init.how == QLVectorLoop::Setup::Broadcast) {
+            evaluate(init.value);
+            v.fromGpr(init.v, QL_RAX);
+            v.broadcast(init.v);
+            continue;
+        }
+        if (init.how == QLVectorLoop::Setup::FirstLane) {
+            load(QL_RAX, init.start);
+            v.fromGpr(init.v, QL_RAX);
+            continue;
+        }
+        evaluate(init.value);
+        x.rr({ 0x8B }, QL_R11, QL_RAX);                                          // r11 = the step between lanes
+        load(QL_RAX, init.start);
+        v.fromGpr(init.v, QL_RAX);
+        for (uint32_t lane = 1; lane < lanes; lane += 2) {
+            uint8_t pair = lane == 1 ? init.v : QL_SIMD_T1;
+            x.rr({ 0x03 }, QL_RAX, QL_R11);
+            if (lane == 1) v.fromGpr(QL_SIMD_T1, QL_RAX);
+            else {
+                v.fromGpr(QL_SIMD_T1, QL_RAX);
+                x.rr({ 0x03 }, QL_RAX, QL_R11);
+                v.fromGpr(QL_SIMD_T2, QL_RAX);
+            }
+            v.binary(0x6C, pair, pair, lane == 1 ? QL_SIMD_T1 : QL_SIMD_T2, false);
+            if (lane != 1) {
+                v.vex(3, false, init.v, true, 0x38, init.v, QL_SIMD_T1);         // vinserti128 v, v, t1, 1
+                x.out.push_back(1);
+            }
+        }
+    }
+    load(QL_R11, loop.counter);
+    bound();
+    const size_t top = x.out.size();
+    for (const QLVectorLoop::Step& s : loop.body) {
+        switch (s.op) {
+        case QLVectorLoop::Op::Move: v.move(s.d, s.a); break;
+        case QLVectorLoop::Op::Add: v.binary(0xD4, s.d, s.a, s.b); break;
+        case QLVectorLoop::Op::Sub: v.binary(0xFB, s.d, s.a, s.b); break;
+        case QLVectorLoop::Op::Mul: v.mul(s.d, s.a, s.b, s.highB); break;
+        }
+    }
+    x.aluImm(0, QL_R11, lanes * loop.counterStep);                               // add r11, lanes * step
+    x.rr({ 0x3B }, QL_R11, QL_RAX);
+    size_t back = jcc(loop.inclusive ? 0x8E : 0x8C);                             // jle / jl top
+    int32_t rel = static_cast<int32_t>(int64_t(top) - int64_t(back + 4));
+    std::memcpy(x.out.data() + back, &rel, 4);
+    store(loop.counter, QL_R11);
+    for (auto [r, vr] : loop.inductions) {
+        v.toGpr(QL_RAX, vr);
+        store(r, QL_RAX);
+    }
+    for (auto [r, vr] : loop.reductions) {
+        v.sum(QL_RAX, vr);
+        store(r, QL_RAX);
+    }
+    if (v.avx) x.bytes({ 0xC5, 0xF8, 0x77 });                                   // vzeroupper
+    for (size_t at : toScalar) {
+        rel = static_cast<int32_t>(int64_t(x.out.size()) - int64_t(at + 4));
+        std::memcpy(x.out.data() + at, &rel, 4);
+    }
+}
+
+int64_t runTiered(const QLVMModule& module, QLVMState& state, QLTieredRuntime& tiers) {
+    if (!module.verified || state.forceChecked) return runVM(module, state);
+    return runVM<QL_VM_COMPUTED_GOTO != 0, false, false, QLTieredRuntime>(module, state, nullptr, &tiers);
+}
+
+bool QLBaselineJIT::compile(const QLRegModule& module, std::string& error, size_t maxFunctionInstrs,
+                            const std::vector<bool>* skip, bool allocate, QLSimdLevel simd) {
+    auto t0 = std::chrono::steady_clock::now();
+    release();
+    source = &module;
+    const size_t fnCount = module.functions.size();
+    functionOffset.assign(fnCount, UINT32_MAX);
+    resumeOffset.assign(module.code.size(), UINT32_MAX);
+    if (!QL_JIT_X64) return true;
+
+    const QLStencils& st = qlStencils();
+    auto regionEnd = [&](size_t f) { return f + 1 < fnCount ? module.functions[f + 1].entry : module.code.size(); };
+    std::vector<bool> native(fnCount, false);
+    for (size_t f = 0; f < fnCount; ++f)
+        native[f] = regionEnd(f) - module.functions[f].entry <= maxFunctionInstrs && !(skip && f < skip->size() && (*skip)[f]);
+
+    Emission e;
+    e.label.assign(module.code.size(), UINT32_MAX);
+    e.exitAt.assign(fnCount, 0);
+    e.overflowAt.assign(fnCount, 0);
+    for (uint32_t f = 0; f < fnCount; ++f) {
+        if (!native[f]) continue;
+        const QLRegFunction& fn = module.functions[f];
+        functionOffset[f] = static_cast<uint32_t>(e.out.size());
+        QLRegAllocation allocation;
+        if (allocate && allocateRegisters(module, f, allocation)) {
+            emitAllocated(module, f, regionEnd(f), native, allocation, simd, e);
+            allocStats.add(allocation.stats);
+            continue;
+        }
+        emitStencil(e, st.prologue, {}, f, fn.frameSize);
+        for (uint32_t slot = fn.params; slot < fn.slots; ++slot) emitStencil(e, st.zeroSlot, { 0, static_cast<uint16_t>(slot) }, f, 0);
+        for (size_t pc = fn.entry; pc < regionEnd(f); ++pc) {
+            const QLRegInstr& in = module.code[pc];
+            e.label[pc] = static_cast<uint32_t>(e.out.size());
+            if (in.op == QLRegOp::CALL) emitStencil(e, native[in.imm] ? st.callNative : st.callInterpreted, in, f, 0);
+            else emitStencil(e, st.ops[static_cast<size_t>(in.op)], in, f, 0);
+        }
+        e.exitAt[f] = static_cast<uint32_t>(e.out.size());
+        emitStencil(e, st.exit, {}, f, 0);
+        e.overflowAt[f] = static_cast<uint32_t>(e.out.size());
+        emitStencil(e, st.overflow, { static_cast<int64_t>(f) }, f, 0);
+        // Loop headers (targets of backward jumps) get OSR entries.
+        for (size_t pc = fn.entry; pc < regionEnd(f); ++pc) {
+            const QLRegInstr& in = module.code[pc];
+            bool backward = (in.op == QLRegOp::JMP || in.op == QLRegOp::JZ) && static_cast<size_t>(in.imm) <= pc;
+            if (!backward || resumeOffset[in.imm] != UINT32_MAX) continue;
+            resumeOffset[in.imm] = static_cast<uint32_t>(e.out.size());
+            emitStencil(e, st.resume, { in.imm }, f, fn.frameSize);
+        }
+    }
+    for (const Fixup& fix : e.fixups) {
+        uint32_t target = 0;
+        switch (fix.kind) {
+        case QLHole::Target: target = e.label[fix.value]; break;
+        case QLHole::Callee: target = functionOffset[fix.value]; break;
+        case QLHole::Exit: target = e.exitAt[fix.value]; break;
+        default: target = e.overflowAt[fix.value]; break;
+        }
+        int32_t rel = static_cast<int32_t>(int64_t(target) - int64_t(fix.at + 4));
+        std::memcpy(e.out.data() + fix.at, &rel, 4);
+    }
+    if (e.out.empty()) return true;
+
+#if QL_JIT_X64
+    size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t size = (e.out.size() + page - 1) / page * page;
+    void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        error = "mmap failed";
+        functionOffset.assign(fnCount, UINT32_MAX);
+        resumeOffset.assign(module.code.size(), UINT32_MAX);
+        return false;
+    }
+    std::memcpy(map, e.out.data(), e.out.size());
+    if (::mprotect(map, size, PROT_READ | PROT_EXEC) != 0) {
+        ::munmap(map, size);
+        error = "mprotect failed";
+        functionOffset.assign(fnCount, UINT32_MAX);
+        resumeOffset.assign(module.code.size(), UINT32_MAX);
+        return false;
+    }
+    code = static_cast<uint8_t*>(map);
+    mapped = size;
+#endif
+    codeBytes = e.out.size();
+    compiledFunctions = static_cast<size_t>(std::count(native.begin(), native.end(), true));
+    compileMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    return true;
+}
+
+void QLBaselineJIT::emitStencil(Emission& e, const QLStencil& s, const QLRegInstr& in, uint32_t function, int64_t frame) {
+    size_t base = e.out.size();
+    e.out.insert(e.out.end(), s.bytes.begin(), s.bytes.end());
+    for (auto [offset, kind] : s.holes) {
+        uint8_t* at = e.out.data() + base + offset;
+        auto put32 = [&](int64_t v) { int32_t x = static_cast<int32_t>(v); std::memcpy(at, &x, 4); };
+        switch (kind) {
+        case QLHole::A: put32(int64_t(in.a) * 8); break;
+        case QLHole::B: put32(int64_t(in.b) * 8); break;
+        case QLHole::D: put32(int64_t(in.d) * 8); break;
+        case QLHole::Frame: put32(frame * 8); break;
+        case QLHole::Imm64: std::memcpy(at, &in.imm, 8); break;
+        case QLHole::Imm32: put32(in.imm); break;
+        case QLHole::Imm8: *at = in.imm != 0; break;
+        case QLHole::Helper: std::memcpy(at, &s.helper, 8); break;
+        case QLHole::Target:
+        case QLHole::Callee: e.fixups.push_back({ static_cast<uint32_t>(base + offset), kind, static_cast<uint32_t>(in.imm) }); break;
+        case QLHole::Exit:
+        case QLHole::Overflow: e.fixups.push_back({ static_cast<uint32_t>(base + offset), kind, function }); break;
+        }
+    }
+}
+
+void QLBaselineJIT::emitAllocated(const QLRegModule& module, uint32_t f, size_t end, const std::vector<bool>& native,
+                                  const QLRegAllocation& alloc, QLSimdLevel simd, Emission& e) {
+    constexpr uint8_t LIMIT = offsetof(QLJitContext, limit), FLOOR = offsetof(QLJitContext, stackFloor),
+                      ACC = offsetof(QLJitContext, acc), STATUS = offsetof(QLJitContext, status);
+    const QLStencils& st = qlStencils();
+    const QLRegFunction& fn = module.functions[f];
+    QLX64Writer x{ e.out };
+    auto fixup = [&](QLHole kind, uint32_t value) {
+        e.fixups.push_back({ static_cast<uint32_t>(e.out.size()), kind, value });
+        x.imm32(0);
+    };
+    const bool pad = alloc.calleeSaved.size() % 2 == 0;  // keeps rsp 16-byte aligned at calls
+    auto prologue = [&] {
+        x.push(QL_RBX);
+        x.push(QL_R12);
+        for (uint8_t r : alloc.calleeSaved) x.push(r);
+        if (pad) x.bytes({ 0x48, 0x83, 0xEC, 0x08 });                       // sub rsp, 8
+        x.bytes({ 0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4 });                    // mov rbx, rdi; mov r12, rsi
+        x.bytes({ 0x48, 0x8D, 0x83 });                                      // lea rax, [rbx+frame]
+        x.imm32(int64_t(fn.frameSize) * 8);
+        x.bytes({ 0x49, 0x3B, 0x44, 0x24, LIMIT, 0x0F, 0x87 });             // cmp rax, [r12+limit]; ja overflow
+        fixup(QLHole::Overflow, f);
+        x.bytes({ 0x49, 0x3B, 0x64, 0x24, FLOOR, 0x0F, 0x82 });             // cmp rsp, [r12+floor]; jb overflow
+        fixup(QLHole::Overflow, f);
+    };
+    auto epilogue = [&] {
+        if (pad) x.bytes({ 0x48, 0x83, 0xC4, 0x08 });                       // add rsp, 8
+        for (size_t i = alloc.calleeSaved.size(); i-- > 0;) x.pop(alloc.calleeSaved[i]);
+        x.pop(QL_R12);
+        x.pop(QL_RBX);
+        x.bytes({ 0xC3 });
+    };
+    auto halt = [&](bool storeAcc) {
+        if (storeAcc) x.bytes({ 0x49, 0x89, 0x44, 0x24, ACC });             // mov [r12+acc], rax
+        x.bytes({ 0x41, 0xC6, 0x44, 0x24, STATUS, static_cast<uint8_t>(QLJitStatus::Halted) });
+        epilogue();
+    };
+
+    struct Loc {
+        uint8_t reg;  // QL_NO_MACHINE_REG for the frame slot
+        int64_t disp;
+        bool inReg() const { return reg != QL_NO_MACHINE_REG; }
+    };
+    auto loc = [&](uint32_t r) { return Loc{ r < alloc.machine.size() ? alloc.machine[r] : uint8_t(QL_NO_MACHINE_REG), int64_t(r) * 8 }; };
+    auto load = [&](uint8_t dst, Loc src) {
+        if (!src.inReg()) x.rm({ 0x8B }, dst, src.disp);
+        else if (src.reg != dst) x.rr({ 0x8B }, dst, src.reg);
+    };
+    auto store = [&](Loc dst, uint8_t src) {
+        if (!dst.inReg()) x.rm({ 0x89 }, src, dst.disp);
+        else if (dst.reg != src) x.rr({ 0x8B }, dst.reg, src);
+    };
+    auto alu = [&](std::initializer_list<uint8_t> opcode, uint8_t dst, Loc src) {
+        if (src.inReg()) x.rr(opcode, dst, src.reg);
+        else x.rm(opcode, dst, src.disp);
+    };
+    auto arith = [&](QLRegOp op, uint8_t dst, Loc src) {  // add, sub or imul dst, src
+        if (op == QLRegOp::ADD || op == QLRegOp::ADDI) alu({ 0x03 }, dst, src);
+        else if (op == QLRegOp::SUB || op == QLRegOp::SUBI) alu({ 0x2B }, dst, src);
+        else alu({ 0x0F, 0xAF }, dst, src);
+    };
+    auto fits32 = [](int64_t v) { return v >= INT32_MIN && v <= INT32_MAX; };
+    auto writeBack = [&](uint32_t r) {
+        if (loc(r).inReg()) x.rm({ 0x89 }, alloc.machine[r], int64_t(r) * 8);
+    };
+    auto loadLiveIn = [&](uint32_t pc) {
+        for (uint32_t r = 0; r < fn.frameSize; ++r)
+            if (loc(r).inReg() && alloc.liveAt(pc, r)) x.rm({ 0x8B }, alloc.machine[r], int64_t(r) * 8);
+    };
+    // A compare whose result only feeds the JZ after it becomes a
+    // conditional jump, unless something else jumps to that JZ.
+    auto fusesWithJump = [&](size_t pc) {
+        if (pc + 1 >= end) return false;
+        const QLRegInstr& cmp = module.code[pc];
+        const QLRegInstr& jz = module.code[pc + 1];
+        if (jz.op != QLRegOp::JZ || jz.a != cmp.d ||
+            std::binary_search(alloc.leaders.begin(), alloc.leaders.end(), static_cast<uint32_t>(pc + 1)))
+            return false;
+        return (static_cast<size_t>(jz.imm) >= end || !alloc.liveAt(static_cast<uint32_t>(jz.imm), cmp.d)) && (pc + 2 >= end || !alloc.liveAt(static_cast<uint32_t>(pc + 2), cmp.d));
+    };
+
+    std::vector<QLVectorLoop> vectorLoops;
+    std::vector<uint32_t> scalarAt;  // per vector loop, where its scalar header starts
+    for (size_t pc = fn.entry; simd != QLSimdLevel::None && pc < end; ++pc) {
+        const QLRegInstr& in = module.code[pc];
+        QLVectorLoop loop;
+        if (in.op == QLRegOp::JMP && static_cast<size_t>(in.imm) < pc &&
+            planVectorLoop(module, f, alloc, static_cast<uint32_t>(in.imm), static_cast<uint32_t>(pc), simd, loop) &&
+            (!vectorCostModel || qlVectorLoopPays(loop, simd)))
+            vectorLoops.push_back(std::move(loop));
+    }
+    scalarAt.assign(vectorLoops.size(), 0);
+    vectorizedLoops += vectorLoops.size();
+    auto vectorLoopAt = [&](int64_t header) {
+        for (size_t k = 0; k < vectorLoops.size(); ++k)
+            if (vectorLoops[k].header == header) return k;
+        return vectorLoops.size();
+    };
+
+    prologue();
+    for (uint32_t r = 0; r < fn.frameSize; ++r) {
+        bool zeroed = r >= fn.params && r < fn.slots;
+        if (!loc(r).inReg()) {
+            if (zeroed) emitStencil(e, st.zeroSlot, { 0, static_cast<uint16_t>(r) }, f, 0);
+        } else if (alloc.liveAt(fn.entry, r)) {
+            if (zeroed) x.movImm(alloc.machine[r], 0);
+            else x.rm({ 0x8B }, alloc.machine[r], int64_t(r) * 8);
+        }
+    }
+    for (size_t pc = fn.entry; pc < end; ++pc) {
+        const QLRegInstr& in = module.code[pc];
+        e.label[pc] = static_cast<uint32_t>(e.out.size());
+        if (size_t k = vectorLoopAt(static_cast<int64_t>(pc)); k < vectorLoops.size()) {
+            emitVectorLoop(x, vectorLoops[k], simd, alloc.machine);
+            scalarAt[k] = static_cast<uint32_t>(e.out.size());
+        }
+        Loc D = loc(in.d), A = loc(in.a), B = loc(in.b);
+        switch (in.op) {
+        case QLRegOp::MOV:
+            if (D.inReg()) load(D.reg, A);
+            else if (A.inReg()) store(D, A.reg);
+            else {
+                load(QL_RAX, A);
+                store(D, QL_RAX);
+            }
+            break;
+        case QLRegOp::MOVI:
+            if (D.inReg()) x.movImm(D.reg, in.imm);
+            else if (fits32(in.imm)) {
+                x.rm({ 0xC7 }, 0, D.disp);                                   // mov qword [rbx+d], simm32
+                x.imm32(in.imm);
+            } else {
+                x.movImm(QL_RAX, in.imm);
+                store(D, QL_RAX);
+            }
+            break;
+        case QLRegOp::ADD: case QLRegOp::SUB: case QLRegOp::MUL: {
+            if (in.op != QLRegOp::SUB && D.inReg() && B.inReg() && B.reg == D.reg) std::swap(A, B);
+            uint8_t t = D.inReg() && !(B.inReg() && B.reg == D.reg) ? D.reg : uint8_t(QL_RAX);
+            load(t, A);
+            arith(in.op, t, B);
+            store(D, t);
+            break;
+        }
+        case QLRegOp::ADDI: case QLRegOp::SUBI: case QLRegOp::MULI: {
+            uint8_t t = D.inReg() ? D.reg : uint8_t(QL_RAX);
+            load(t, A);
+            if (!fits32(in.imm)) {
+                x.movImm(QL_R11, in.imm);
+                arith(in.op, t, Loc{ QL_R11, 0 });
+            } else if (in.op == QLRegOp::MULI) {
+                x.rr({ 0x69 }, t, t);                                        // imul t, t, simm32
+                x.imm32(in.imm);
+            } else x.aluImm(in.op == QLRegOp::ADDI ? 0 : 5, t, in.imm);      // add/sub t, simm32
+            store(D, t);
+            break;
+        }
+        case QLRegOp::LT: case QLRegOp::LTI: case QLRegOp::LE: case QLRegOp::LEI: case QLRegOp::EQ: case QLRegOp::EQI: {
+            uint8_t lhs = A.inReg() ? A.reg : uint8_t(QL_RAX);
+            load(lhs, A);
+            if (in.op == QLRegOp::LT || in.op == QLRegOp::LE || in.op == QLRegOp::EQ) alu({ 0x3B }, lhs, B);  // cmp lhs, b
+            else if (fits32(in.imm)) x.aluImm(7, lhs, in.imm);               // cmp lhs, simm32
+            else {
+                x.movImm(QL_R11, in.imm);
+                x.rr({ 0x3B }, lhs, QL_R11);
+            }
+            uint8_t cc = in.op == QLRegOp::LT || in.op == QLRegOp::LTI ? 0x9C : in.op == QLRegOp::LE || in.op == QLRegOp::LEI ? 0x9E : 0x94;
+            if (fusesWithJump(pc)) {
+                // jge/jg/jne straight to the JZ's target; the flag is never stored.
+                x.bytes({ 0x0F, static_cast<uint8_t>((cc ^ 0x01) - 0x10) });
+                fixup(QLHole::Target, static_cast<uint32_t>(module.code[++pc].imm));
+                e.label[pc] = static_cast<uint32_t>(e.out.size());
+                break;
+            }
+            uint8_t t = D.inReg() ? D.reg : uint8_t(QL_RAX);
+            x.bytes({ 0x0F, cc, 0xC0 });                                     // setcc al
+            if (t >= 8) x.out.push_back(0x44);
+            x.bytes({ 0x0F, 0xB6, static_cast<uint8_t>(0xC0 | (t & 7) << 3) });  // movzx t32, al
+            store(D, t);
+            break;
+        }
+        case QLRegOp::JMP:
+            x.bytes({ 0xE9 });
+            if (size_t k = vectorLoopAt(in.imm); k < vectorLoops.size() && vectorLoops[k].latch == pc)
+                x.imm32(int64_t(scalarAt[k]) - int64_t(e.out.size() + 4));
+            else fixup(QLHole::Target, static_cast<uint32_t>(in.imm));
+            break;
+        case QLRegOp::JZ:
+            if (A.inReg()) x.rr({ 0x85 }, A.reg, A.reg);                      // test a, a
+            else {
+                x.rm({ 0x83 }, 7, A.disp);                                   // cmp qword [rbx+a], 0
+                x.bytes({ 0x00 });
+            }
+            x.bytes({ 0x0F, 0x84 });
+            fixup(QLHole::Target, static_cast<uint32_t>(in.imm));
+            break;
+        case QLRegOp::CALL:
+            for (uint32_t k = 0; k < module.functions[in.imm].params; ++k) writeBack(in.d + k);
+            emitStencil(e, !native[in.imm] ? st.callInterpreted : D.inReg() ? st.callNativeToRax : st.callNative, in, f, 0);
+            if (D.inReg()) x.rr({ 0x8B }, D.reg, QL_RAX);
+            break;
+        case QLRegOp::CALL_EXT: case QLRegOp::CALL_DYN: {
+            const QLCallSite& site = module.callSites[in.imm];
+            for (uint32_t k = 0; k < site.argc; ++k) writeBack(in.d + k);
+            if (in.op == QLRegOp::CALL_DYN) writeBack(in.a);
+            emitStencil(e, st.ops[static_cast<size_t>(in.op)], in, f, 0);
+            if (D.inReg() && (in.op == QLRegOp::CALL_DYN || site.pushesResult)) load(D.reg, Loc{ QL_NO_MACHINE_REG, D.disp });
+            break;
+        }
+        case QLRegOp::RET:
+            load(QL_RAX, A);
+            epilogue();
+            break;
+        case QLRegOp::RETI:
+            x.movImm(QL_RAX, in.imm);
+            epilogue();
+            break;
+        case QLRegOp::HALT:
+            load(QL_RAX, A);
+            halt(true);
+            break;
+        case QLRegOp::HALTI:
+            x.movImm(QL_RAX, in.imm);
+            halt(true);
+            break;
+        case QLRegOp::HALT_ACC: halt(false); break;
+        default: emitStencil(e, st.ops[static_cast<size_t>(in.op)], in, f, 0); break;  // SET_ACC, SET_FLAG
+        }
+    }
+    e.exitAt[f] = static_cast<uint32_t>(e.out.size());
+    epilogue();
+    e.overflowAt[f] = static_cast<uint32_t>(e.out.size());
+    x.bytes({ 0x48, 0x89, 0xDF, 0x4C, 0x89, 0xE6, 0xBA });                 // mov rdi, rbx; mov rsi, r12; mov edx, f
+    x.imm32(f);
+    const void* helper = reinterpret_cast<const void*>(&qlJitOverflow);
+    x.bytes({ 0x48, 0xB8 });                                                // mov rax, helper; call rax
+    e.out.insert(e.out.end(), reinterpret_cast<const uint8_t*>(&helper), reinterpret_cast<const uint8_t*>(&helper) + 8);
+    x.bytes({ 0xFF, 0xD0 });
+    epilogue();
+    for (size_t pc = fn.entry; pc < end; ++pc) {
+        const QLRegInstr& in = module.code[pc];
+        bool backward = (in.op == QLRegOp::JMP || in.op == QLRegOp::JZ) && static_cast<size_t>(in.imm) <= pc;
+        if (!backward || resumeOffset[in.imm] != UINT32_MAX) continue;
+        resumeOffset[in.imm] = static_cast<uint32_t>(e.out.size());
+        prologue();
+        loadLiveIn(static_cast<uint32_t>(in.imm));
+        x.bytes({ 0xE9 });
+        fixup(QLHole::Target, static_cast<uint32_t>(in.imm));
+    }
+}
+
+QLTierExit QLBaselineJIT::run(uint32_t offset, int64_t* window, size_t windowSize, QLRegState& state, int64_t& acc, bool& flag,
+                              uint64_t& externalCalls, int64_t& result, std::string& error) const {
+    // Room for a frame per QLRegState frame; each native frame takes 32
+    // bytes, up to 64 with callee-saved registers pushed.
+    constexpr uintptr_t STACK_BUDGET = 2u << 20;
+    char marker;
+    uintptr_t here = reinterpret_cast<uintptr_t>(&marker);
+    QLJitContext ctx{ window + windowSize, here > STACK_BUDGET ? here - STACK_BUDGET : 0, acc, QLJitStatus::Running,
+                      static_cast<uint8_t>(flag), source, &state, 0, &error };
+    state.callCaches.prepare(source, source->callSites.size());
+    using Entry = int64_t (*)(int64_t*, QLJitContext*);
+    result = reinterpret_cast<Entry>(code + offset)(window, &ctx);
+    acc = ctx.acc;
+    flag = ctx.flag != 0;
+    externalCalls += ctx.externalCalls;
+    if (ctx.status == QLJitStatus::Failed) return QLTierExit::Error;
+    return ctx.status == QLJitStatus::Halted ? QLTierExit::Halt : QLTierExit::Return;
+}
+
+void QLBaselineJIT::release() {
+#if QL_JIT_X64
+    if (code) ::munmap(code, mapped);
+#endif
+    code = nullptr;
+    mapped = codeBytes = compiledFunctions = 0;
+    compileMicros = 0;
+    allocStats = {};
+    vectorizedLoops = 0;
+}
+
+void QLTieredRuntime::compile() {
+    auto t0 = std::chrono::steady_clock::now();
+    regState = QLRegState(0);  // tier 1's frame stack, only paid for by runs that tier up
+    auto fused = [](const QLVMInstr& in) { return static_cast<uint8_t>(in.op) >= static_cast<uint8_t>(QLVMOp::LOAD_LOAD); };
+    if (std::any_of(source.code.begin(), source.code.end(), fused)) {
+        QLVMModule unfused = source;
+        for (QLVMInstr& in : unfused.code)
+            for (const auto& super : QL_SUPERINSTRUCTIONS)
+                if (in.op == super.fused) in.op = super.sequence[0];
+        compileRegisterModule(unfused, code, compileError, &entries);
+    }
+    else compileRegisterModule(source, code, compileError, &entries);
+    // A JIT failure only means everything stays in register mode.
+    std::string jitError;
+    if (compileError.empty() && policy.baselineJIT)
+        jit.compile(code, jitError, policy.jitMaxFunctionInstrs, nullptr, policy.allocateRegisters, policy.simd);
+    compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    ready.store(true, std::memory_order_release);
+}
+
+QLTierExit QLTieredRuntime::enter(uint32_t pc, int64_t* window, size_t windowSize, int64_t& acc, bool& flag, uint64_t& externalCalls,
+                                  int64_t& result, QLVMState& caller) {
+    QLRegEntry entry{ pc, window, windowSize };
+    regState.natives = caller.natives;
+    regState.acc = acc;
+    regState.flag = flag;
+    runRegisterVM<QL_VM_COMPUTED_GOTO != 0>(code, regState, &entry);
+    acc = regState.acc;
+    flag = regState.flag;
+    externalCalls += regState.externalCalls;
+    if (!regState.error.empty()) {
+        caller.error = regState.error;
+        return QLTierExit::Error;
+    }
+    if (!regState.returned) return QLTierExit::Halt;
+    result = regState.result;
+    return QLTierExit::Return;
+}
@@ -0,0 +1,548 @@
+// QuarterJIT.hpp
+// Baseline x86-64 JIT over register-VM code, its linear-scan register
+// allocator and loop vectorizer, and the tiered runtime that drives it.
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "QuarterIR.hpp"
+
+// ======== Baseline JIT (x86-64) ========
+// A copy-and-patch compiler from register code to machine code. Every
+// QLRegOp has a stencil: machine code built once, with holes for operand
+// offsets, immediates, branch targets and helper addresses. Compiling a
+// function copies one stencil per instruction and patches its holes, which
+// costs microseconds per function.
+//
+// Native code keeps the register VM's frame layout. rbx points at the
+// frame's register window and r12 at a QLJitContext, and every register
+// stays in its memory slot between instructions. That makes fallback cheap.
+// A native caller reaches a function the JIT skipped through a helper that
+// runs it in register mode on the same window. Tiered execution can hand a
+// stack-VM frame to either tier.
+//
+// Code is written to a read-write mapping that is then made read-execute
+// (W^X), so no page is ever writable and executable at once. Only System V
+// x86-64 hosts compile; elsewhere every function falls back.
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(_WIN32)
+#define QL_JIT_X64 1
+#else
+#define QL_JIT_X64 0
+#endif
+
+enum class QLJitStatus : uint8_t { Running, Halted, Failed };
+
+// Native code reads the first five fields at fixed offsets.
+struct QLJitContext {
+    int64_t* limit;        // end of the register window
+    uintptr_t stackFloor;  // native frames fail rather than push the machine stack below this
+    int64_t acc;
+    QLJitStatus status;
+    uint8_t flag;
+    const QLRegModule* module;
+    QLRegState* state;     // natives, call caches, and the register VM for skipped functions
+    uint64_t externalCalls;
+    std::string* error;
+};
+static_assert(std::is_standard_layout_v<QLJitContext>, "native code addresses QLJitContext by offset");
+
+// Helpers called from native code (System V ABI). Each writes its result to
+// window[0], where the call's destination register is, and signals a halt
+// or an error through ctx->status.
+int64_t qlJitOverflow(int64_t*, QLJitContext* ctx, uint64_t function);
+
+enum class QLHole : uint8_t {
+    A, B, D,     // disp32: register index * 8
+    Frame,       // disp32: frame size * 8
+    Imm64, Imm32, Imm8,
+    Target,      // rel32 to the register pc in imm
+    Callee,      // rel32 to the native entry of function imm
+    Exit,        // rel32 to the function's exit stub
+    Overflow,    // rel32 to the function's overflow stub
+    Helper,      // abs64 address of the stencil's helper
+};
+
+struct QLStencil {
+    std::vector<uint8_t> bytes;
+    std::vector<std::pair<uint16_t, QLHole>> holes;
+    const void* helper = nullptr;
+};
+
+// The stencil set, assembled once per process from the fragments below.
+struct QLStencils {
+    QLStencil ops[static_cast<size_t>(QLRegOp::COUNT)];
+    QLStencil callNative;       // CALL of a compiled function
+    QLStencil callNativeToRax;  // the same, leaving the result in rax only
+    QLStencil callInterpreted;  // CALL of a function the JIT skipped
+    QLStencil prologue;         // saves rbx/r12, checks frame and machine stack room
+    QLStencil resume;           // prologue + jump, the OSR entry to a loop header
+    QLStencil zeroSlot;
+    QLStencil exit;
+    QLStencil overflow;
+};
+
+const QLStencils& qlStencils();
+
+// ---- Linear-scan register allocation ----
+// Chooses which frame registers of a function the JIT keeps in machine
+// registers, by linear scan (Poletto and Sarkar) over one live interval
+// per frame register. Positions are 2*pc for reads and 2*pc+1 for writes,
+// so a register whose last read is the instruction defining another can
+// hand its machine register over; a MOV hinted that way disappears.
+//
+// System V: rax and r11 are scratch and rbx and r12 hold the window and
+// context. Registers live across a call get callee-saved r13-r15 or rbp,
+// which the prologue pushes. Others take caller-saved rcx, rdx, rsi, rdi
+// and r8-r10 first. When none is free, the interval ending last is spilled.
+// A spilled register lives in its frame slot, the same slot the register
+// VM uses, so spill slots cost no frame space and fallback, OSR and calls
+// see the frame they expect once live registers are written back.
+enum QLX64Reg : uint8_t {
+    QL_RAX, QL_RCX, QL_RDX, QL_RBX, QL_RSP, QL_RBP, QL_RSI, QL_RDI,
+    QL_R8, QL_R9, QL_R10, QL_R11, QL_R12, QL_R13, QL_R14, QL_R15,
+    QL_NO_MACHINE_REG = 0xFF
+};
+constexpr uint8_t QL_CALLER_SAVED[] = { QL_RCX, QL_RDX, QL_RSI, QL_RDI, QL_R8, QL_R9, QL_R10 };
+constexpr uint8_t QL_CALLEE_SAVED[] = { QL_R13, QL_R14, QL_R15, QL_RBP };
+// Weighted uses a register live across a call needs before a callee-saved
+// register (a push and a pop per call of the function) pays for itself.
+constexpr uint64_t QL_CALLEE_SAVED_MIN_WEIGHT = 8;
+
+struct QLRegAllocStats {
+    size_t intervals = 0;
+    size_t allocated = 0;    // intervals given a machine register
+    size_t spilled = 0;      // intervals left in their frame slot
+    size_t coalesced = 0;    // MOVs whose source and destination share a machine register
+    size_t calleeSaved = 0;  // callee-saved registers pushed by prologues
+
+    void add(const QLRegAllocStats& o) {
+        intervals += o.intervals;
+        allocated += o.allocated;
+        spilled += o.spilled;
+        coalesced += o.coalesced;
+        calleeSaved += o.calleeSaved;
+    }
+};
+
+struct QLRegAllocation {
+    std::vector<uint8_t> machine;   // per frame register, QL_NO_MACHINE_REG when it stays in memory
+    std::vector<uint32_t> leaders;  // first pc of each block, ascending
+    std::vector<uint64_t> liveIn;   // per block, frame registers live on entry
+    uint32_t words = 0;
+    std::vector<uint8_t> calleeSaved;  // in push order
+    QLRegAllocStats stats;
+
+    // `pc` must start a block: the entry or a jump target.
+    bool liveAt(uint32_t pc, uint32_t r) const {
+        size_t b = std::lower_bound(leaders.begin(), leaders.end(), pc) - leaders.begin();
+        return (liveIn[b * words + r / 64] >> (r % 64)) & 1;
+    }
+};
+
+// Allocates function `function` of `module`. Fails, leaving the function to
+// the stack-slot JIT, when its liveness sets would be too large.
+bool allocateRegisters(const QLRegModule& module, uint32_t function, QLRegAllocation& out);
+
+// A few x86-64 encodings for code that keeps registers in machine
+// registers. Memory operands are frame slots, [rbx + disp32].
+struct QLX64Writer {
+    std::vector<uint8_t>& out;
+
+    void bytes(std::initializer_list<uint8_t> b) { out.insert(out.end(), b); }
+    void imm32(int64_t v) {
+        int32_t x = static_cast<int32_t>(v);
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&x);
+        out.insert(out.end(), p, p + 4);
+    }
+    void rex(uint8_t reg, uint8_t rm) { out.push_back(0x48 | (reg >= 8 ? 4 : 0) | (rm >= 8 ? 1 : 0)); }
+    // op reg, rm with both registers
+    void rr(std::initializer_list<uint8_t> opcode, uint8_t reg, uint8_t rm) {
+        rex(reg, rm);
+        bytes(opcode);
+        out.push_back(static_cast<uint8_t>(0xC0 | (reg & 7) << 3 | (rm & 7)));
+    }
+    // op reg, [rbx + disp]
+    void rm(std::initializer_list<uint8_t> opcode, uint8_t reg, int64_t disp) {
+        rex(reg, QL_RBX);
+        bytes(opcode);
+        out.push_back(static_cast<uint8_t>(0x80 | (reg & 7) << 3 | QL_RBX));
+        imm32(disp);
+    }
+    void push(uint8_t r) {
+        if (r >= 8) out.push_back(0x41);
+        out.push_back(static_cast<uint8_t>(0x50 | (r & 7)));
+    }
+    void pop(uint8_t r) {
+        if (r >= 8) out.push_back(0x41);
+        out.push_back(static_cast<uint8_t>(0x58 | (r & 7)));
+    }
+    void movImm(uint8_t r, int64_t v) {
+        if (v == 0) {  // xor r32, r32
+            if (r >= 8) out.push_back(0x45);
+            bytes({ 0x31, static_cast<uint8_t>(0xC0 | (r & 7) << 3 | (r & 7)) });
+        } else if (v > 0 && v <= INT64_C(0xFFFFFFFF)) {  // mov r32, imm32
+            if (r >= 8) out.push_back(0x41);
+            out.push_back(static_cast<uint8_t>(0xB8 | (r & 7)));
+            imm32(v);
+        } else if (v >= INT32_MIN && v < 0) {  // mov r64, simm32
+            rex(0, r);
+            bytes({ 0xC7, static_cast<uint8_t>(0xC0 | (r & 7)) });
+            imm32(v);
+        } else {  // mov r64, imm64
+            rex(0, r);
+            out.push_back(static_cast<uint8_t>(0xB8 | (r & 7)));
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
+            out.insert(out.end(), p, p + 8);
+        }
+    }
+    // add/sub/cmp r64, simm32 (`ext` is the ModRM opcode extension)
+    void aluImm(uint8_t ext, uint8_t r, int64_t v) {
+        rex(0, r);
+        bytes({ 0x81, static_cast<uint8_t>(0xC0 | ext << 3 | (r & 7)) });
+        imm32(v);
+    }
+};
+
+// ---- Loop vectorization ----
+// Counted loops whose bodies are straight-line integer arithmetic run
+// several iterations at once in SIMD registers: two 64-bit lanes with SSE2,
+// four with AVX2 where the host has it. The register VM has no arrays, so
+// the loops that qualify are the ones numeric capsules lower to: sums over
+// values computed from induction variables, such as dot_product and
+// matrix_cell. Lane j runs iteration k + j of each group of lanes, so
+//
+//   - an induction variable, updated only by adding constants or invariant
+//     registers, starts as r, r + s, r + 2s, ... for its step s per
+//     iteration and advances by lanes * s,
+//   - a reduction, read only by its own acc = acc + x or acc - x updates,
+//     starts as acc, 0, 0, ... and its lanes are summed on exit,
+//   - invariants and immediates are broadcast, and temporaries (registers
+//     not live at the header) are computed lane by lane.
+//
+// Integer arithmetic wraps, so regrouping a reduction's sum cannot change
+// it. The vector loop runs while the header's test would pass for every
+// lane, i < n - (lanes - 1) * step, then falls into the original loop,
+// which finishes the remaining iterations as scalar code. Neither SSE2 nor
+// AVX2 multiplies 64-bit lanes, so products are built from 32-bit pmuludq
+// halves.
+enum class QLSimdLevel : uint8_t { None, SSE2, AVX2 };
+
+// The widest level this host runs; None where the JIT does not compile.
+QLSimdLevel qlHostSimd();
+
+const char* qlSimdName(QLSimdLevel level);
+
+constexpr uint8_t QL_SIMD_REGS = 14;  // xmm0-13 hold values; xmm14 and xmm15 are scratch
+constexpr uint8_t QL_SIMD_T1 = 14, QL_SIMD_T2 = 15;
+constexpr uint8_t QL_NO_SIMD_REG = 0xFF;
+constexpr uint32_t QL_VECTOR_MAX_BODY = 256;
+constexpr int64_t QL_VECTOR_MAX_STEP = 1 << 20;  // the counter's step, so lanes * step stays an imm32
+
+// constant + sum of scale * register, evaluated once before a vector loop.
+struct QLLinear {
+    int64_t constant = 0;
+    std::vector<std::pair<uint32_t, int64_t>> terms;
+
+    QLLinear& add(const QLLinear& o, int64_t scale = 1) {
+        constant = static_cast<int64_t>(uint64_t(constant) + uint64_t(o.constant) * uint64_t(scale));
+        for (auto [r, s] : o.terms) {
+            auto it = std::find_if(terms.begin(), terms.end(), [&](const auto& t) { return t.first == r; });
+            if (it != terms.end()) it->second += s * scale;
+            else terms.emplace_back(r, s * scale);
+        }
+        return *this;
+    }
+};
+
+struct QLVectorLoop {
+    enum class Setup : uint8_t {
+        Broadcast,  // every lane = value
+        Lanes,      // lane j = start + j * value
+        FirstLane,  // lane 0 = start, the others 0
+    };
+    struct Init {
+        Setup how;
+        uint8_t v;
+        uint32_t start;
+        QLLinear value;
+    };
+    enum class Op : uint8_t { Move, Add, Sub, Mul };
+    struct Step {
+        Op op;
+        uint8_t d, a, b;
+        bool highB;  // Mul: b may have its high 32 bits set
+    };
+
+    uint32_t header = 0, latch = 0;  // the compare (a JZ follows it) and the back edge
+    uint32_t counter = 0;            // the induction variable the header compares
+    int64_t counterStep = 0;         // per scalar iteration, positive
+    bool inclusive = false;          // LE or LEI
+    bool immediateBound = false;
+    int64_t bound = 0;               // immediateBound: the bound less (lanes - 1) * counterStep
+    uint32_t boundRegister = 0;
+    std::vector<Init> setup;
+    std::vector<Step> body;
+    std::vector<std::pair<uint32_t, uint8_t>> inductions, reductions;  // frame register, vector register
+};
+
+// Instructions a vector loop spends per scalar iteration, against the
+// scalar loop's body plus about six for its compare, branch and jump.
+// Emulated multiplies dominate: with two SSE2 lanes a loop of products is
+// usually slower vectorized, with four AVX2 lanes about twice as fast.
+bool qlVectorLoopPays(const QLVectorLoop& loop, QLSimdLevel level);
+
+// Plans the loop with its header (a compare, then a JZ out of the loop) at
+// `header` and its back edge at `latch`. Fails unless everything between
+// is arithmetic that fits the scheme above in QL_SIMD_REGS registers.
+bool planVectorLoop(const QLRegModule& module, uint32_t function, const QLRegAllocation& alloc, uint32_t header,
+                    uint32_t latch, QLSimdLevel level, QLVectorLoop& out);
+
+// Emits the vector loop in front of its scalar loop, which must follow
+// directly: every path out of this code falls or jumps to the end of it.
+// Reads the loop's registers where `machine` keeps them, writes back the
+// induction variables and reductions, and clobbers rax and r11.
+void emitVectorLoop(QLX64Writer& x, const QLVectorLoop& loop, QLSimdLevel level, const std::vector<uint8_t>& machine);
+
+class QLBaselineJIT {
+public:
+    QLBaselineJIT() = default;
+    QLBaselineJIT(const QLBaselineJIT&) = delete;
+    QLBaselineJIT& operator=(const QLBaselineJIT&) = delete;
+    ~QLBaselineJIT() { release(); }
+
+    // Compiles the functions of `module` (which must outlive this object)
+    // that have at most maxFunctionInstrs instructions and are not listed in
+    // `skip`, keeping frame registers in machine registers when `allocate`
+    // is set. Allocated code also vectorizes counted loops at `simd`.
+    // Returns false only when executable memory cannot be set up.
+    bool compile(const QLRegModule& module, std::string& error, size_t maxFunctionInstrs = 1 << 16,
+                 const std::vector<bool>* skip = nullptr, bool allocate = false, QLSimdLevel simd = QLSimdLevel::None);
+
+    bool has(uint32_t function) const { return code && functionOffset[function] != UINT32_MAX; }
+    bool canResume(uint32_t registerPc) const { return code && resumeOffset[registerPc] != UINT32_MAX; }
+
+    // Runs a compiled function with its arguments in place at window[0, params).
+    QLTierExit call(uint32_t function, int64_t* window, size_t windowSize, QLRegState& state, int64_t& acc, bool& flag,
+                    uint64_t& externalCalls, int64_t& result, std::string& error) const {
+        return run(functionOffset[function], window, windowSize, state, acc, flag, externalCalls, result, error);
+    }
+    // Continues a frame whose registers match register pc `registerPc`, a loop header.
+    QLTierExit resume(uint32_t registerPc, int64_t* window, size_t windowSize, QLRegState& state, int64_t& acc, bool& flag,
+                      uint64_t& externalCalls, int64_t& result, std::string& error) const {
+        return run(resumeOffset[registerPc], window, windowSize, state, acc, flag, externalCalls, result, error);
+    }
+
+    size_t codeBytes = 0;
+    size_t compiledFunctions = 0;
+    double compileMicros = 0;
+    QLRegAllocStats allocStats;  // summed over allocated functions
+    size_t vectorizedLoops = 0;
+    bool vectorCostModel = true;  // false vectorizes every loop that qualifies (testing)
+
+private:
+    struct Fixup {
+        uint32_t at;
+        QLHole kind;
+        uint32_t value;  // register pc, function index, or the function owning an exit/overflow stub
+    };
+    struct Emission {
+        std::vector<uint8_t> out;
+        std::vector<Fixup> fixups;
+        std::vector<uint32_t> label, exitAt, overflowAt;
+    };
+
+    void emitStencil(Emission& e, const QLStencil& s, const QLRegInstr& in, uint32_t function, int64_t frame);
+
+    // Function f with its allocated registers kept in machine registers.
+    // Arithmetic, copies and branches are encoded per instruction rather
+    // than copied from stencils. Calls reuse the call stencils once their
+    // arguments are written back to the frame; a result kept in a machine
+    // register is not also stored to its slot. Entry, loop-header (OSR)
+    // entries and the exits push and pop the callee-saved registers in use.
+    // A loop planVectorLoop accepts gets its vector loop at the header's
+    // label, so entries and OSR run it, and its back edge skips it.
+    void emitAllocated(const QLRegModule& module, uint32_t f, size_t end, const std::vector<bool>& native,
+                       const QLRegAllocation& alloc, QLSimdLevel simd, Emission& e);
+
+    QLTierExit run(uint32_t offset, int64_t* window, size_t windowSize, QLRegState& state, int64_t& acc, bool& flag,
+                   uint64_t& externalCalls, int64_t& result, std::string& error) const;
+
+    void release();
+
+    const QLRegModule* source = nullptr;
+    uint8_t* code = nullptr;
+    size_t mapped = 0;
+    std::vector<uint32_t> functionOffset;  // native entry per function, UINT32_MAX when it falls back
+    std::vector<uint32_t> resumeOffset;    // OSR entry per register pc, UINT32_MAX where there is none
+};
+
+// ======== Tiered Execution ========
+// Tier 0 is the stack VM, with a counter per function (calls) and per loop
+// header (back edges). When the first counter crosses its threshold, the
+// module is compiled to tier 1, register code, on a background thread. The
+// interpreter never waits for it. Once the code is published, a hot
+// function runs in tier 1 from its next call. A hot loop moves over at its
+// next back edge (on-stack replacement) and finishes its frame there.
+//
+// Neither transfer copies anything. A stack-VM frame is already a register
+// window: slots first, then operand k at slots + k. At every jump target,
+// register code holds its values in exactly those places. Code in tier 1
+// stays there, calls included, until its entry frame returns. The same
+// compile also runs the baseline JIT over the register code. Transfers use
+// native code where it exists and register code for whatever the JIT
+// skipped.
+struct QLTierPolicy {
+    uint32_t callThreshold = 1000;
+    uint32_t backEdgeThreshold = 10000;
+    // false compiles on the interpreter's thread (deterministic). With a single
+    // core a worker only takes turns with the interpreter, so compile inline.
+    bool background = std::thread::hardware_concurrency() > 1;
+    bool baselineJIT = true;
+    size_t jitMaxFunctionInstrs = 1 << 16;  // longer functions stay in register mode
+    bool allocateRegisters = true;          // native code keeps hot frame registers in machine registers
+    QLSimdLevel simd = qlHostSimd();        // ... and runs counted loops this many lanes wide
+};
+
+struct QLTierStats {
+    uint64_t calls = 0;              // calls dispatched by tier 0
+    uint64_t tier1Calls = 0;         // ... that entered tier 1
+    uint64_t osrEntries = 0;         // loop back edges that entered tier 1
+    uint64_t promotedFunctions = 0;  // distinct functions entered in tier 1
+    uint64_t promotedLoops = 0;      // distinct loop headers entered in tier 1
+    uint64_t nativeEntries = 0;      // tier-1 calls and OSR entries that ran machine code
+    uint64_t compiles = 0;
+    double compileMs = 0;            // valid once compiled() or after wait(), JIT included
+    size_t nativeFunctions = 0;      // likewise
+    size_t nativeBytes = 0;
+    double jitMicros = 0;
+    size_t vectorizedLoops = 0;
+};
+
+// `module` must outlive the runtime and stay unchanged while it exists.
+class QLTieredRuntime {
+public:
+    explicit QLTieredRuntime(const QLVMModule& module, QLTierPolicy policy = {})
+        : source(module), policy(policy), callCounts(module.functions.size(), 0),
+          promotedFunctions(module.functions.size(), false), regState(0, 0) {}
+    ~QLTieredRuntime() { wait(); }
+    QLTieredRuntime(const QLTieredRuntime&) = delete;
+    QLTieredRuntime& operator=(const QLTieredRuntime&) = delete;
+
+    // Tier-0 hooks: count, queue the compile when a counter first crosses
+    // its threshold, and say whether tier 1 can take over now.
+    bool hotCall(uint32_t function) {
+        ++tierStats.calls;
+        uint32_t& count = callCounts[function];
+        if (count < policy.callThreshold && ++count < policy.callThreshold) return false;
+        return tierReady();
+    }
+    // Register pc to resume the loop at, or UINT32_MAX to keep interpreting.
+    uint32_t hotBackEdge(size_t header) {
+        if (backEdgeCounts.empty()) {
+            backEdgeCounts.assign(source.code.size(), 0);
+            promotedLoops.assign(source.code.size(), false);
+        }
+        uint32_t& count = backEdgeCounts[header];
+        if (count < policy.backEdgeThreshold && ++count < policy.backEdgeThreshold) return UINT32_MAX;
+        return tierReady() ? entries[header] : UINT32_MAX;
+    }
+
+    // Runs a call tier 0 has checked the frame capacity for. The arguments
+    // are in place at window[0, params).
+    QLTierExit enterFunction(uint32_t function, int64_t* window, size_t windowSize, int64_t& acc, bool& flag,
+                             uint64_t& externalCalls, int64_t& result, QLVMState& caller) {
+        const QLRegFunction& fn = code.functions[function];
+        std::fill(window + fn.params, window + fn.slots, 0);
+        ++tierStats.tier1Calls;
+        if (!promotedFunctions[function]) {
+            promotedFunctions[function] = true;
+            ++tierStats.promotedFunctions;
+        }
+        if (jit.has(function)) {
+            ++tierStats.nativeEntries;
+            regState.natives = caller.natives;
+            return jit.call(function, window, windowSize, regState, acc, flag, externalCalls, result, caller.error);
+        }
+        return enter(fn.entry, window, windowSize, acc, flag, externalCalls, result, caller);
+    }
+    // Continues the frame at `base` from loop header `header`.
+    QLTierExit enterLoop(size_t header, uint32_t entry, int64_t* base, size_t windowSize, int64_t& acc, bool& flag,
+                         uint64_t& externalCalls, int64_t& result, QLVMState& caller) {
+        ++tierStats.osrEntries;
+        if (!promotedLoops[header]) {
+            promotedLoops[header] = true;
+            ++tierStats.promotedLoops;
+        }
+        if (jit.canResume(entry)) {
+            ++tierStats.nativeEntries;
+            regState.natives = caller.natives;
+            return jit.resume(entry, base, windowSize, regState, acc, flag, externalCalls, result, caller.error);
+        }
+        return enter(entry, base, windowSize, acc, flag, externalCalls, result, caller);
+    }
+
+    bool compiled() const { return ready.load(std::memory_order_acquire) && compileError.empty(); }
+    const std::string& error() const { return compileError; }  // valid once compiled() or after wait()
+    void wait() {
+        if (worker.joinable()) worker.join();
+    }
+    QLTierStats stats() const {
+        QLTierStats out = tierStats;
+        if (ready.load(std::memory_order_acquire)) {
+            out.compileMs = compileMs;
+            out.nativeFunctions = jit.compiledFunctions;
+            out.nativeBytes = jit.codeBytes;
+            out.jitMicros = jit.compileMicros;
+            out.vectorizedLoops = jit.vectorizedLoops;
+        }
+        return out;
+    }
+
+private:
+    bool tierReady() {
+        if (ready.load(std::memory_order_acquire)) return compileError.empty();
+        if (!requested) {
+            requested = true;
+            ++tierStats.compiles;
+            if (policy.background) worker = std::thread([this] { compile(); });
+            else compile();
+        }
+        return ready.load(std::memory_order_acquire) && compileError.empty();
+    }
+
+    // Runs on the worker: everything it writes is published by `ready`.
+    // Register mode compiles the unfused program; fused handlers only exist
+    // in the stack VM, which keeps running the module as given.
+    void compile();
+
+    QLTierExit enter(uint32_t pc, int64_t* window, size_t windowSize, int64_t& acc, bool& flag, uint64_t& externalCalls,
+                     int64_t& result, QLVMState& caller);
+
+    const QLVMModule& source;
+    QLTierPolicy policy;
+    std::vector<uint32_t> callCounts;
+    std::vector<uint32_t> backEdgeCounts;  // by loop header pc, sized at the first back edge
+    std::vector<bool> promotedFunctions;
+    std::vector<bool> promotedLoops;
+    QLTierStats tierStats;
+
+    bool requested = false;
+    std::thread worker;
+    std::atomic<bool> ready{ false };
+    QLRegModule code;               // written by the worker before `ready`
+    std::vector<uint32_t> entries;  // stack-VM pc -> register pc at jump targets
+    std::string compileError;
+    double compileMs = 0;
+    QLBaselineJIT jit;              // likewise
+    QLRegState regState;
+};
+
+// Runs `module` in tier 0 with `tiers` (built from the same module) free to
+// promote its hot functions and loops. Counters and compiled code persist in
+// `tiers` across runs. Modules that must run checked are never promoted.
+int64_t runTiered(const QLVMModule& module, QLVMState& state, QLTieredRuntime& tiers);
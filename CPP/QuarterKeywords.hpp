@@ -0,0 +1,240 @@
+// QuarterKeywords.hpp
+// Keyword set of QuarterLang_Statements___Keywords_Chart.csv plus the core
+// block words (func, end, call, star, ...), with a perfect hash generated at
+// compile time. Shared by the transpiler lexer, the indent lexers, the syntax
+// highlighters and the completion engine; lookups hash four bytes and the
+// length, probe one slot and never allocate.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace QuarterKeywords {
+
+    struct Entry {
+        std::string_view word;
+        std::string_view purpose;
+        std::string_view example;
+    };
+
+    inline constexpr Entry ENTRIES[] = {
+        { "val", "Declare immutable variable", "val x as int: 5" },
+        { "var", "Declare mutable variable", "var score as float: 0.0" },
+        { "bool", "Declare a boolean value", "val is_valid as bool: true" },
+        { "truths", "Declare foundational truths for logic/proof", "truths: identity, motion" },
+        { "proofs", "Declare verifiable logical constructs", "proofs validate gravity against mass" },
+        { "types", "Define or annotate data types", "val t as types: numeric" },
+        { "primatives", "Declare raw values or low-level types", "val id as primative: 42" },
+        { "dodecagrams", "Declare DG values (base-12 SIMD symbols)", "val id as dodecagram: 9A3" },
+        { "dg", "Shorthand for DG declaration", "val x as dg: A9B" },
+        { "dgvec", "SIMD vector of DodecaGrams", "val v as dgvec: [9A1, 9A2, 9A3, 9A4]" },
+        { "loop", "Create bounded loop", "loop from 1 to 10:" },
+        { "while", "Loop while condition is true", "while x < 10:" },
+        { "when", "Conditional branch", "when score > 90:" },
+        { "else", "Else branch", "else:" },
+        { "elif", "Else-if condition", "elif score == 80:" },
+        { "stop", "Immediate halt of program", "stop" },
+        { "match", "Pattern match multiple values", "match status:" },
+        { "case", "Case inside match", "case 200:" },
+        { "conditionals", "Enable advanced logical structures", "conditionals: x > y and y > z" },
+        { "say", "Output to console or stdout", "say \"Running\"" },
+        { "define", "Named function definition", "define compute(x y):" },
+        { "fn", "Anonymous inline function", "fn a b -> a + b" },
+        { "procedure", "Side-effect driven named block", "procedure setup()" },
+        { "yield", "Yield from coroutine or generator", "yield data" },
+        { "return", "Return value from function", "return result: ok x" },
+        { "thread", "Launch parallel thread", "thread update_UI()" },
+        { "spawn", "Spawn new thread or unit", "spawn indexer()" },
+        { "async", "Define asynchronous task", "async define fetch_data():" },
+        { "await", "Await async result", "val output: await fetch_data()" },
+        { "lock", "Lock shared resource", "lock file_handler:" },
+        { "sync", "Synchronize threads or scopes", "sync:" },
+        { "inline", "Inline function or logic", "inline multiply()" },
+        { "nest", "Create encapsulated block", "nest config:" },
+        { "pipe", "Direct data stream", "val log as pipe: \"debug.log\"" },
+        { "map", "Transform collections", "map items with fn x -> x * 2" },
+        { "filter", "Filter collection by predicate", "filter nums with fn x -> x > 0" },
+        { "reduce", "Reduce collection to single result", "reduce nums with fn acc x -> acc + x" },
+        { "bind", "Bind value or result", "bind total to sum(x, y)" },
+        { "derive", "Create transformation of value", "derive z from x by 2" },
+        { "from", "Specify source in derivation/import", "derive b from a:" },
+        { "by", "Modifier in transformation", "derive size from area by 2" },
+        { "entry", "Insert key-value into table/map", "entry users: 101 => \"admin\"" },
+        { "table", "Declare associative map (DG-backed)", "table lookup as map[int, string]:" },
+        { "scope", "Create a local isolated block", "scope buffer:" },
+        { "decorate", "Attach metadata to functions or types", "@trace define render()" },
+        { "decorators", "Define reusable annotations", "decorators: @trace, @inline" },
+        { "class", "Define a reusable object blueprint", "class Window:" },
+        { "object", "Instantiate or reference a class", "val main as Window: new()" },
+        { "structs", "Define structured record types", "struct Point: x as int, y as int" },
+        { "module", "Declare self-contained namespace", "module geometry:" },
+        { "import", "Import external module", "import crypto.qtr" },
+        { "include", "Include file into current source", "include \"mathlib.qtr\"" },
+        { "textures", "Reference graphical assets (GPU, media)", "val tex as texture: \"skin1.png\"" },
+        { "update", "Declare update logic loop", "procedure update_state():" },
+        { "frame", "Single tick unit in rendering or sim loop", "frame render():" },
+        { "tick", "Frame timing & scheduling", "tickrate: 60hz" },
+        { "tickrate", "Frame timing & scheduling", "tickrate: 60hz" },
+        { "unit", "Declare atomic isolated operation", "unit ClearMemory:" },
+        { "cycle", "Timed loop or system trigger", "cycle heartbeat every 100ms:" },
+        { "ref", "Reference alias to variable", "ref current to settings.main:" },
+        { "mutate", "Explicit variable mutation", "mutate balance with fn x -> x - 5" },
+        { "mirror", "Reflect or observe structure", "mirror payload:" },
+        { "lens", "View/edit subset of structure", "lens position from obj:" },
+        { "nodes", "Declare DAG or graph-like node units", "node filter_gate:" },
+        { "controls", "Master flow-control structures", "controls: loop, match, case, thread" },
+        { "keywords", "Inspect or print language keywords", "say keywords" },
+        { "nasm", "Inline NASM injection", "nasm { mov rdi, rax }" },
+        { "hex", "Inline hexadecimal encoding (DG optimized)", "hex: 0x48 0x89 0xC7" },
+        { "asm", "Inline assembly block", "asm { mov rax, 5 }" },
+        { "profile", "Mark block for benchmarking", "profile \"parser_speed\":" },
+        { "assert", "Runtime assertion check", "assert x == 5" },
+        { "test", "Declare unit test", "test \"math add\":" },
+        { "option", "Optional value container", "val name as option[string]: none" },
+        { "result", "Success/error union result", "return result: ok 42" },
+        { "error", "Return error in union", "return result: error \"bad op\"" },
+        { "try", "Handle exceptions", "try: ... catch e:" },
+        { "catch", "Handle exceptions", "try: ... catch e:" },
+        { "finally", "Cleanup block", "finally:" },
+        { "guard", "Protected block", "guard:" },
+        { "track", "Monitor value at runtime", "track packet_id" },
+        { "override", "Override method in class/trait", "override define toString():" },
+        { "implements", "Satisfy contract/trait", "define draw(obj) implements Drawable:" },
+        { "concept", "Define behavior constraint", "concept Equatable:" },
+        { "func", "Open a function block", "func greet()" },
+        { "end", "Close the current block", "end" },
+        { "call", "Invoke a function or capsule", "call greet" },
+        { "let", "Declare mutable variable", "let count = 0" },
+        { "star", "Program entry block", "star" },
+        { "enum", "Declare an enumeration", "enum Color:" },
+        { "struct", "Declare a record type", "struct Point:" },
+        { "extern", "Declare an external symbol", "extern puts" },
+        { "plugin", "Load a runtime plugin", "plugin \"net\"" },
+        { "load", "Load a module or resource", "load \"stdlib\"" },
+        { "as", "Type annotation", "val x as int: 5" },
+        { "if", "Conditional branch", "if x > 0:" },
+        { "for", "Iterate over a range or collection", "for item in list:" },
+        { "true", "Boolean true literal", "val ok as bool: true" },
+        { "false", "Boolean false literal", "val ok as bool: false" },
+        { "null", "Absent value literal", "val p: null" },
+        { "none", "Empty option value", "val name as option[string]: none" },
+    };
+
+    inline constexpr size_t COUNT = sizeof(ENTRIES) / sizeof(ENTRIES[0]);
+    inline constexpr uint8_t NONE = 0xFF;
+    inline constexpr size_t MIN_LENGTH = 2;
+    inline constexpr size_t MAX_LENGTH = 12;
+    static_assert(COUNT < NONE, "keyword index must fit in a byte");
+
+    // Two-level hash-and-displace: the top bits pick one of BUCKETS buckets,
+    // whose displacement moves every key in it to a free slot.
+    inline constexpr size_t SLOTS = 256;
+    inline constexpr size_t BUCKETS = 64;
+
+    // Mixes the length with the first two and last two bytes, which is enough
+    // to tell every keyword apart (derive/define differ only at n-2).
+    constexpr uint32_t hash(std::string_view w) {
+        size_t n = w.size();
+        uint32_t x = 0x811C9DC5u ^ static_cast<uint32_t>(n);
+        x = (x ^ static_cast<uint8_t>(w[0])) * 0x01000193u;
+        x = (x ^ static_cast<uint8_t>(w[1])) * 0x01000193u;
+        x = (x ^ static_cast<uint8_t>(w[n - 2])) * 0x01000193u;
+        x = (x ^ static_cast<uint8_t>(w[n - 1])) * 0x01000193u;
+        x ^= x >> 15;
+        x *= 0x2C1B3C6Du;
+        x ^= x >> 12;
+        x *= 0x297A2D39u;
+        x ^= x >> 15;
+        return x;
+    }
+
+    constexpr size_t bucketOf(uint32_t h) { return h >> 26; }
+    constexpr size_t slotOf(uint32_t h, uint16_t displacement) {
+        return ((h & 0xFFFFu) + (displacement % SLOTS) + (displacement / SLOTS) * (((h >> 16) & 0x7Fu) | 1u)) % SLOTS;
+    }
+
+    struct Table {
+        uint16_t displacement[BUCKETS];
+        uint8_t slot[SLOTS];
+    };
+
+    // Places the largest buckets first and searches each bucket's displacement
+    // until all of its keys land on free slots.
+    constexpr Table buildTable() {
+        Table table{};
+        for (auto& s : table.slot) s = NONE;
+        size_t bucketSize[BUCKETS] = {};
+        for (size_t i = 0; i < COUNT; ++i) ++bucketSize[bucketOf(hash(ENTRIES[i].word))];
+
+        bool placed[BUCKETS] = {};
+        for (size_t round = 0; round < BUCKETS; ++round) {
+            size_t b = 0;
+            for (size_t c = 0; c < BUCKETS; ++c)
+                if (!placed[c] && (placed[b] || bucketSize[c] > bucketSize[b])) b = c;
+            placed[b] = true;
+            if (bucketSize[b] == 0) continue;
+
+            for (uint32_t d = 0; d < SLOTS * SLOTS; ++d) {
+                bool fits = true;
+                for (size_t i = 0; i < COUNT && fits; ++i) {
+                    uint32_t h = hash(ENTRIES[i].word);
+                    if (bucketOf(h) != b) continue;
+                    size_t s = slotOf(h, static_cast<uint16_t>(d));
+                    if (table.slot[s] != NONE) fits = false;
+                    else table.slot[s] = static_cast<uint8_t>(i);
+                }
+                if (fits) {
+                    table.displacement[b] = static_cast<uint16_t>(d);
+                    break;
+                }
+                for (size_t i = 0; i < COUNT; ++i) { // undo the partial placement
+                    uint32_t h = hash(ENTRIES[i].word);
+                    if (bucketOf(h) == b && table.slot[slotOf(h, static_cast<uint16_t>(d))] == i)
+                        table.slot[slotOf(h, static_cast<uint16_t>(d))] = NONE;
+                }
+            }
+        }
+        return table;
+    }
+
+    inline constexpr Table TABLE = buildTable();
+
+    // Index into ENTRIES, or NONE for non-keywords.
+    constexpr uint8_t lookup(std::string_view w) {
+        if (w.size() < MIN_LENGTH || w.size() > MAX_LENGTH) return NONE;
+        uint32_t h = hash(w);
+        uint8_t i = TABLE.slot[slotOf(h, TABLE.displacement[bucketOf(h)])];
+        return i != NONE && ENTRIES[i].word == w ? i : NONE;
+    }
+
+    constexpr bool isKeyword(std::string_view w) { return lookup(w) != NONE; }
+
+    // Compile-time keyword index for switch labels: case id("func"): ...
+    // A word that is not in ENTRIES throws, which is not a constant
+    // expression, so a misspelled label fails to compile instead of
+    // quietly matching NONE.
+#if defined(__cpp_consteval)
+    consteval
+#else
+    constexpr
+#endif
+    uint8_t id(std::string_view w) {
+        uint8_t i = lookup(w);
+        if (i == NONE) throw "QuarterKeywords::id: not a keyword";
+        return i;
+    }
+
+    constexpr bool allKeywordsResolve() {
+        for (size_t i = 0; i < COUNT; ++i)
+            if (lookup(ENTRIES[i].word) != i) return false;
+        return true;
+    }
+    static_assert(allKeywordsResolve(), "keyword perfect hash has a collision");
+
+    // Completion: calls emit(entry) for every keyword starting with prefix.
+    template <typename Emit>
+    void complete(std::string_view prefix, Emit&& emit) {
+        for (const Entry& e : ENTRIES)
+            if (e.word.substr(0, prefix.size()) == prefix) emit(e);
+    }
+}
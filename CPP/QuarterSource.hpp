@@ -0,0 +1,41 @@
+// QuarterSource.hpp
+// Whole-file reads shared by the transpiler's QLSourceBuffer fallback and the
+// IO modules. Seekable files are read with one call sized from their length;
+// pipes, /dev/stdin and /proc files report no usable length and are drained
+// through istreambuf_iterator instead of reading as empty.
+#pragma once
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <string>
+
+namespace QuarterSource {
+
+    // Reads the rest of `in` into out. Returns false on a stream error.
+    inline bool readAll(std::istream& in, std::string& out) {
+        out.clear();
+        std::streampos start = in.tellg();
+        if (start != std::streampos(-1) && in.seekg(0, std::ios::end)) {
+            std::streamoff length = in.tellg() - start;
+            in.seekg(start);
+            if (length > 0 && in) {
+                out.resize(static_cast<size_t>(length));
+                in.read(&out[0], length);
+                out.resize(static_cast<size_t>(in.gcount()));
+                return !in.bad();
+            }
+        }
+        in.clear();
+        out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return !in.bad();
+    }
+
+    // Returns false (out left empty) if the file cannot be opened or read.
+    inline bool readFile(const std::string& path, std::string& out) {
+        out.clear();
+        std::ifstream in(path, std::ios::in | std::ios::binary);
+        if (in && readAll(in, out)) return true;
+        out.clear();
+        return false;
+    }
+}
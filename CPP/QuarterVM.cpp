@@ -0,0 +1,682 @@
+// QuarterVM.cpp
+#include "QuarterVM.hpp"
+#include <cstdlib>
+#include <deque>
+
+QL_NOINLINE const QLNativeBinding* resolveNativeSlow(QLCallCaches& caches, QLInlineCache& cache, uint32_t name,
+                                                     const QLPluginRegistry& registry, const std::vector<std::string>& strings) {
+    ++caches.misses;
+    const QLNativeBinding* target = registry.find(strings[name]);
+    if (!caches.enabled) return target;
+    if (cache.epoch != registry.epoch()) {
+        cache.epoch = registry.epoch();
+        cache.size = 0;
+        cache.megamorphic = false;
+    }
+    if (cache.size < QL_IC_ENTRIES) {
+        cache.keys[cache.size] = name;
+        cache.targets[cache.size] = target;
+        ++cache.size;
+    }
+    else {
+        cache.megamorphic = true;
+    }
+    return target;
+}
+
+// Operand stack values an unfused instruction pops and pushes. Indices must
+// already be in range.
+static void vmStackEffect(const QLVMModule& module, QLVMOp op, const QLVMInstr& in, int32_t& pops, int32_t& pushes) {
+    pops = pushes = 0;
+    switch (op) {
+    case QLVMOp::PUSH: case QLVMOp::LOAD: pushes = 1; break;
+    case QLVMOp::STORE: case QLVMOp::POP: case QLVMOp::JZ: pops = 1; break;
+    case QLVMOp::ADD: case QLVMOp::SUB: case QLVMOp::MUL:
+    case QLVMOp::LT: case QLVMOp::LE: case QLVMOp::EQ: pops = 2; pushes = 1; break;
+    case QLVMOp::CALL: pops = static_cast<int32_t>(module.functions[in.a].params); pushes = 1; break;
+    case QLVMOp::CALL_EXT:
+        pops = static_cast<int32_t>(module.callSites[in.a].argc);
+        pushes = module.callSites[in.a].pushesResult;
+        break;
+    case QLVMOp::CALL_DYN: pops = static_cast<int32_t>(module.callSites[in.a].argc) + 1; pushes = 1; break;
+    default: break;
+    }
+}
+
+// Instruction range of the top level (function index UINT32_MAX) and of each
+// function: a body runs up to the FUNC marker of the next one.
+struct QLVMRegion {
+    size_t begin, end;
+    uint32_t function;
+};
+
+static std::vector<QLVMRegion> vmRegions(const QLVMModule& module) {
+    std::vector<QLVMRegion> regions;
+    size_t topEnd = module.functions.empty() ? module.code.size() : module.functions[0].entry;
+    regions.push_back({ 0, topEnd, UINT32_MAX });
+    for (uint32_t f = 0; f < module.functions.size(); ++f) {
+        size_t end = f + 1 < module.functions.size() ? module.functions[f + 1].entry : module.code.size();
+        regions.push_back({ module.functions[f].entry, end, f });
+    }
+    return regions;
+}
+
+// Operand stack depth before every instruction of a region (-1 where
+// unreachable) and its maximum. Fails on underflow, on jumps that leave the
+// region and on paths that reach one instruction with different depths.
+static bool analyzeStackDepths(const QLVMModule& module, const QLVMRegion& region, std::vector<int32_t>& depth,
+                        uint32_t& maxDepth, std::string& error) {
+    maxDepth = 0;
+    std::vector<size_t> work{ region.begin };
+    depth[region.begin] = 0;
+    auto reach = [&](size_t from, size_t to, int32_t d) {
+        if (to < region.begin || to >= region.end) {
+            error = "instruction " + std::to_string(from) + ": jump leaves its function";
+            return false;
+        }
+        if (depth[to] < 0) {
+            depth[to] = d;
+            work.push_back(to);
+        }
+        else if (depth[to] != d) {
+            error = "instruction " + std::to_string(to) + ": stack depth " + std::to_string(depth[to]) + " vs " + std::to_string(d);
+            return false;
+        }
+        return true;
+    };
+    while (!work.empty()) {
+        size_t pc = work.back();
+        work.pop_back();
+        const QLVMInstr& in = module.code[pc];
+        int32_t d = depth[pc], pops, pushes;
+        if (static_cast<uint8_t>(in.op) >= static_cast<uint8_t>(QLVMOp::LOAD_LOAD)) {
+            error = "instruction " + std::to_string(pc) + ": superinstructions are applied after verification";
+            return false;
+        }
+        vmStackEffect(module, in.op, in, pops, pushes);
+        if (d < pops) {
+            error = "instruction " + std::to_string(pc) + ": stack underflow";
+            return false;
+        }
+        d += pushes - pops;
+        maxDepth = std::max<uint32_t>(maxDepth, static_cast<uint32_t>(d));
+        if (in.op == QLVMOp::JMP || in.op == QLVMOp::JZ)
+            if (!reach(pc, static_cast<size_t>(in.a), d)) return false;
+        if (in.op != QLVMOp::JMP && in.op != QLVMOp::RET && in.op != QLVMOp::HALT)
+            if (!reach(pc, pc + 1, d)) return false;
+    }
+    return true;
+}
+
+bool verifyVMModule(QLVMModule& module, std::string& error) {
+    module.verified = false;
+    const size_t n = module.code.size();
+    if (n == 0 || module.code.back().op != QLVMOp::HALT) {
+        error = "module must end in HALT";
+        return false;
+    }
+    auto inRange = [](int64_t index, size_t size) { return index >= 0 && static_cast<uint64_t>(index) < size; };
+    for (const QLVMFunction& fn : module.functions) {
+        if (fn.entry == 0 || fn.entry >= n || fn.params > fn.slots) {
+            error = "function " + fn.name + ": bad entry or slot count";
+            return false;
+        }
+    }
+    for (size_t pc = 0; pc < n; ++pc) {
+        const QLVMInstr& in = module.code[pc];
+        std::string why;
+        switch (in.op) {
+        case QLVMOp::JMP:
+        case QLVMOp::JZ:
+            if (!inRange(in.a, n)) why = "jump target " + std::to_string(in.a) + " out of range";
+            break;
+        case QLVMOp::CALL:
+            if (!inRange(in.a, module.functions.size())) why = "function index out of range";
+            break;
+        case QLVMOp::CALL_EXT:
+        case QLVMOp::CALL_DYN:
+            if (!inRange(in.a, module.callSites.size())) why = "call site out of range";
+            else if (in.op == QLVMOp::CALL_EXT ? module.callSites[in.a].name >= module.strings.size()
+                                               : module.callSites[in.a].name != QL_NO_STRING)
+                why = "call site name out of range";
+            break;
+        case QLVMOp::COMPARE:
+            if (!inRange(in.a, module.strings.size()) || !inRange(in.b, module.strings.size())) why = "string index out of range";
+            break;
+        default:
+            if (static_cast<uint8_t>(in.op) >= static_cast<uint8_t>(QLVMOp::LOAD_LOAD)) why = "superinstructions are applied after verification";
+            break;
+        }
+        if (!why.empty()) {
+            error = "instruction " + std::to_string(pc) + ": " + why;
+            return false;
+        }
+    }
+
+    std::vector<int32_t> depth(n, -1);
+    for (const QLVMRegion& region : vmRegions(module)) {
+        uint32_t maxDepth;
+        if (!analyzeStackDepths(module, region, depth, maxDepth, error)) return false;
+        uint32_t slots = region.function == UINT32_MAX ? module.topSlots : module.functions[region.function].slots;
+        uint64_t frameSize = uint64_t(slots) + maxDepth;
+        if (frameSize > QL_VM_STACK_SLOTS) {
+            error = (region.function == UINT32_MAX ? std::string("top level") : "function " + module.functions[region.function].name) +
+                    ": frame of " + std::to_string(frameSize) + " slots exceeds the VM stack";
+            return false;
+        }
+        for (size_t pc = region.begin; pc < region.end; ++pc) {
+            const QLVMInstr& in = module.code[pc];
+            if ((in.op == QLVMOp::LOAD || in.op == QLVMOp::STORE) && !inRange(in.a, slots)) {
+                error = "instruction " + std::to_string(pc) + ": slot " + std::to_string(in.a) + " out of range";
+                return false;
+            }
+        }
+        if (region.function == UINT32_MAX) module.topFrameSize = static_cast<uint32_t>(frameSize);
+        else module.functions[region.function].frameSize = static_cast<uint32_t>(frameSize);
+    }
+    module.verified = true;
+    return true;
+}
+
+bool loadVMModule(const Bytecode& bc, QLVMModule& module, std::string& error) {
+    module = {};
+    std::unordered_map<std::string_view, uint32_t> stringIndex;
+    std::deque<std::string> stringStore;
+    auto intern = [&](std::string_view s) {
+        auto it = stringIndex.find(s);
+        if (it != stringIndex.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(stringStore.size());
+        stringStore.emplace_back(s);
+        stringIndex.emplace(stringStore.back(), id);
+        return id;
+    };
+
+    struct PendingCall {
+        size_t at;
+        std::string name;
+        int64_t argc;  // -1 for a capsule call without an argument count
+    };
+    std::vector<PendingCall> calls;                        // CALL sites resolved after every FUNC is known
+    std::unordered_map<std::string, uint32_t> variables;   // names in the current function (or top level)
+    bool ok = true;
+    auto fail = [&](size_t at, const std::string& why) {
+        if (ok) error = "instruction " + std::to_string(at) + ": " + why;
+        ok = false;
+    };
+
+    bool decoded = decodeBytecode(bc, [&](QLOpcode op, std::string_view name, const std::vector<QLOperand>& operands) {
+        size_t at = module.code.size();
+        QLVMInstr in;
+        const QLOpcodeInfo& info = QL_OPCODE_TABLE[static_cast<uint8_t>(op)];
+        if (operands.size() < info.minOperands || operands.size() > info.maxOperands) {
+            fail(at, std::string(name) + " takes " + std::to_string(info.minOperands) +
+                         (info.maxOperands == info.minOperands ? "" : "+") + " operands, got " + std::to_string(operands.size()));
+            module.code.push_back(in);
+            return;
+        }
+        auto immediate = [&](size_t i) -> int64_t {
+            if (i >= operands.size() || operands[i].isConstant) {
+                fail(at, std::string(name) + " expects an integer operand");
+                return 0;
+            }
+            return operands[i].value;
+        };
+        auto text = [&](size_t i) -> std::string {
+            if (i >= operands.size()) return "";
+            return operands[i].isConstant ? std::string(operands[i].text) : std::to_string(operands[i].value);
+        };
+        // Capsule arithmetic folds at load, so a non-numeric operand is rejected
+        // here rather than read as 0 (or thrown from stoi) mid-run. DG
+        // spellings (digits with X/Y) fold as base 12, like number literals.
+        auto asInt = [&](size_t i) -> int64_t {
+            if (!operands[i].isConstant) return operands[i].value;
+            std::string digits(operands[i].text);
+            if (digits.size() <= 8 && classifyConstant(digits) == QLConstTag::DG && digits.find_first_of("XY") != std::string::npos)
+                return convertDG12(digits);
+            char* end = nullptr;
+            int64_t value = std::strtoll(digits.c_str(), &end, 10);
+            if (digits.empty() || *end) fail(at, std::string(name) + " operand '" + digits + "' is not an integer");
+            return value;
+        };
+        // Variables get the next free slot of the enclosing frame on first use.
+        auto slot = [&]() -> int64_t {
+            if (operands.empty() || !operands[0].isConstant) return immediate(0);
+            auto it = variables.find(std::string(operands[0].text));
+            if (it != variables.end()) return it->second;
+            uint32_t& slots = module.functions.empty() ? module.topSlots : module.functions.back().slots;
+            variables.emplace(std::string(operands[0].text), slots);
+            return slots++;
+        };
+        switch (op) {
+        case QLOpcode::PUSH:  in.op = QLVMOp::PUSH;  in.a = immediate(0); break;
+        case QLOpcode::LOAD:  in.op = QLVMOp::LOAD;  in.a = slot(); break;
+        case QLOpcode::STORE: in.op = QLVMOp::STORE; in.a = slot(); break;
+        case QLOpcode::JMP:   in.op = QLVMOp::JMP;   in.a = immediate(0); break;
+        case QLOpcode::JZ:    in.op = QLVMOp::JZ;    in.a = immediate(0); break;
+        case QLOpcode::POP:   in.op = QLVMOp::POP; break;
+        case QLOpcode::ADD:   in.op = QLVMOp::ADD; break;
+        case QLOpcode::SUB:   in.op = QLVMOp::SUB; break;
+        case QLOpcode::MUL:   in.op = QLVMOp::MUL; break;
+        case QLOpcode::LT:    in.op = QLVMOp::LT; break;
+        case QLOpcode::LE:    in.op = QLVMOp::LE; break;
+        case QLOpcode::EQ:    in.op = QLVMOp::EQ; break;
+        case QLOpcode::RET:   in.op = QLVMOp::RET; break;
+        case QLOpcode::HALT:  in.op = QLVMOp::HALT; break;
+        case QLOpcode::FUNC: {
+            // Falling into a function body from the code above it ends the run.
+            in.op = QLVMOp::HALT;
+            int64_t params = immediate(1), slots = immediate(2);
+            if (params < 0 || slots < 0 || slots > QL_VM_STACK_SLOTS) {
+                fail(at, "FUNC " + text(0) + " slot counts must be within 0.." + std::to_string(QL_VM_STACK_SLOTS));
+                params = slots = 0;
+            }
+            QLVMFunction fn{ text(0), static_cast<uint32_t>(at + 1), static_cast<uint32_t>(params), static_cast<uint32_t>(slots) };
+            if (fn.slots < fn.params) fail(at, "FUNC " + fn.name + " has fewer slots than parameters");
+            variables.clear();
+            for (size_t i = 3; i < operands.size() && i - 3 < fn.params; ++i) variables.emplace(text(i), static_cast<uint32_t>(i - 3));
+            module.functions.push_back(std::move(fn));
+            break;
+        }
+        case QLOpcode::CALL:
+            calls.push_back({ at, text(0), operands.size() >= 2 ? immediate(1) : -1 });
+            break;
+        case QLOpcode::FNREF:
+            in.op = QLVMOp::PUSH;
+            in.a = intern(text(0));
+            break;
+        case QLOpcode::CALLI:
+            in.op = QLVMOp::CALL_DYN;
+            in.a = static_cast<int64_t>(module.callSites.size());
+            module.callSites.push_back({ QL_NO_STRING, static_cast<uint32_t>(immediate(0)), true });
+            break;
+        case QLOpcode::FOLD_ADD: in.op = QLVMOp::FOLD_ADD; in.a = asInt(0); in.b = asInt(1); break;
+        case QLOpcode::REC_FOLD: in.op = QLVMOp::REC_FOLD; in.a = foldFactorial(asInt(0)); break;
+        case QLOpcode::COMPARE:  in.op = QLVMOp::COMPARE;  in.a = intern(text(0)); in.b = intern(text(1)); break;
+        default:
+            break; // NOP, structural markers and EXT glyphs have no runtime effect
+        }
+        module.code.push_back(in);
+    }, error);
+    if (!decoded) return false;
+    module.code.push_back({ 0, 0, QLVMOp::HALT });
+
+    std::unordered_map<std::string_view, uint32_t> functionIndex;
+    for (uint32_t i = 0; i < module.functions.size(); ++i) functionIndex.emplace(module.functions[i].name, i);
+    for (const PendingCall& call : calls) {
+        auto it = functionIndex.find(call.name);
+        if (it != functionIndex.end()) {
+            if (call.argc >= 0 && call.argc != module.functions[it->second].params)
+                fail(call.at, "CALL " + call.name + " passes " + std::to_string(call.argc) + " arguments");
+            module.code[call.at] = { it->second, 0, QLVMOp::CALL };
+        }
+        else {
+            module.code[call.at] = { static_cast<int64_t>(module.callSites.size()), 0, QLVMOp::CALL_EXT };
+            module.callSites.push_back({ intern(call.name), static_cast<uint32_t>(std::max<int64_t>(call.argc, 0)), call.argc >= 0 });
+        }
+    }
+
+    module.strings.assign(std::make_move_iterator(stringStore.begin()), std::make_move_iterator(stringStore.end()));
+    return ok && verifyVMModule(module, error);
+}
+
+QL_NOINLINE bool checkVMStep(const QLVMModule& module, size_t at, size_t depth, uint32_t slots, size_t room,
+                             std::string& error) {
+    const size_t n = module.code.size();
+    auto inRange = [](int64_t index, size_t size) { return index >= 0 && static_cast<uint64_t>(index) < size; };
+    auto fail = [&](size_t pc, const std::string& why) {
+        error = "checked mode: instruction " + std::to_string(pc) + ": " + why;
+        return false;
+    };
+    if (at >= n) return fail(at, "pc out of range");
+    QLVMOp first = module.code[at].op;
+    if (static_cast<uint8_t>(first) >= static_cast<uint8_t>(QLVMOp::COUNT)) return fail(at, "invalid opcode");
+    const QLVMOp* sequence = &first;
+    size_t length = 1;
+    for (const auto& super : QL_SUPERINSTRUCTIONS) {
+        if (super.fused == first) {
+            sequence = super.sequence;
+            length = super.length;
+        }
+    }
+    for (size_t k = 0; k < length; ++k) {
+        size_t pc = at + k;
+        if (pc >= n) return fail(pc, "fused sequence runs past the end");
+        const QLVMInstr& in = module.code[pc];
+        QLVMOp op = sequence[k];
+        switch (op) {
+        case QLVMOp::LOAD:
+        case QLVMOp::STORE:
+            if (!inRange(in.a, slots)) return fail(pc, "slot out of range");
+            break;
+        case QLVMOp::JMP:
+        case QLVMOp::JZ:
+            if (!inRange(in.a, n)) return fail(pc, "jump target out of range");
+            break;
+        case QLVMOp::CALL: {
+            if (!inRange(in.a, module.functions.size())) return fail(pc, "function index out of range");
+            const QLVMFunction& fn = module.functions[in.a];
+            if (fn.entry >= n || fn.params > fn.slots) return fail(pc, "bad function record");
+            if (room < fn.slots - fn.params) return fail(pc, "stack overflow");
+            break;
+        }
+        case QLVMOp::CALL_EXT:
+        case QLVMOp::CALL_DYN:
+            if (!inRange(in.a, module.callSites.size())) return fail(pc, "call site out of range");
+            if (op == QLVMOp::CALL_EXT && module.callSites[in.a].name >= module.strings.size()) return fail(pc, "call site name out of range");
+            break;
+        default:
+            break;
+        }
+        int32_t pops, pushes;
+        vmStackEffect(module, op, in, pops, pushes);
+        if (depth < slots + static_cast<size_t>(pops)) return fail(pc, "operand stack underflow");
+        depth -= pops;
+        room += pops;
+        if (room < static_cast<size_t>(pushes)) return fail(pc, "stack overflow");
+        depth += pushes;
+        room -= pushes;
+    }
+    return true;
+}
+
+int64_t runVM(const QLVMModule& module, QLVMState& state) {
+    if (!module.verified || state.forceChecked) return runVM<false, false, true>(module, state);
+    return runVM<QL_VM_COMPUTED_GOTO != 0>(module, state);
+}
+
+static bool isVMControlTransfer(QLVMOp op) {
+    return op == QLVMOp::JMP || op == QLVMOp::JZ || op == QLVMOp::CALL || op == QLVMOp::RET || op == QLVMOp::HALT;
+}
+
+// True when code[pc...] spells the sequence and only its last instruction
+// may transfer control.
+static bool matchesSequence(const std::vector<QLVMInstr>& code, size_t pc, const QLVMOp* sequence, size_t length) {
+    if (pc + length > code.size()) return false;
+    for (size_t k = 0; k < length; ++k) {
+        if (code[pc + k].op != sequence[k]) return false;
+        if (k + 1 < length && isVMControlTransfer(sequence[k])) return false;
+    }
+    return true;
+}
+
+std::vector<QLVMNGram> hotNGrams(const QLVMModule& module, const std::vector<uint64_t>& hits, size_t maxLength, size_t top) {
+    std::unordered_map<uint64_t, uint64_t> counts;  // length << 56 | op0 | op1 << 8 | ...
+    for (size_t pc = 0; pc < module.code.size(); ++pc) {
+        if (!hits[pc]) continue;
+        uint64_t key = 0;
+        for (size_t n = 1; n <= maxLength && pc + n <= module.code.size(); ++n) {
+            QLVMOp op = module.code[pc + n - 1].op;
+            key |= static_cast<uint64_t>(op) << (8 * (n - 1));
+            if (n >= 2) counts[(static_cast<uint64_t>(n) << 56) | key] += hits[pc];
+            if (isVMControlTransfer(op)) break;
+        }
+    }
+    std::vector<QLVMNGram> grams;
+    for (auto [key, count] : counts) {
+        QLVMNGram gram{ {}, count };
+        for (size_t k = 0; k < (key >> 56); ++k) gram.ops.push_back(static_cast<QLVMOp>((key >> (8 * k)) & 0xFF));
+        grams.push_back(std::move(gram));
+    }
+    std::sort(grams.begin(), grams.end(), [](const QLVMNGram& x, const QLVMNGram& y) {
+        return x.count != y.count ? x.count > y.count : x.ops.size() > y.ops.size();
+    });
+    if (grams.size() > top) grams.resize(top);
+    return grams;
+}
+
+std::vector<QLVMOp> selectSuperinstructions(const QLVMModule& module, const std::vector<uint64_t>& hits, size_t limit) {
+    std::vector<std::pair<uint64_t, QLVMOp>> ranked;
+    for (const auto& super : QL_SUPERINSTRUCTIONS) {
+        uint64_t saved = 0;
+        for (size_t pc = 0; pc < module.code.size(); ++pc)
+            if (hits[pc] && matchesSequence(module.code, pc, super.sequence, super.length)) saved += hits[pc] * (super.length - 1);
+        if (saved) ranked.emplace_back(saved, super.fused);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const auto& x, const auto& y) { return x.first > y.first; });
+    std::vector<QLVMOp> chosen;
+    for (size_t i = 0; i < ranked.size() && i < limit; ++i) chosen.push_back(ranked[i].second);
+    return chosen;
+}
+
+size_t applySuperinstructions(QLVMModule& module, const std::vector<QLVMOp>& enabled) {
+    size_t sites = 0;
+    for (size_t pc = 0; pc < module.code.size();) {
+        size_t advance = 1;
+        for (const auto& super : QL_SUPERINSTRUCTIONS) {
+            if (std::find(enabled.begin(), enabled.end(), super.fused) == enabled.end()) continue;
+            if (!matchesSequence(module.code, pc, super.sequence, super.length)) continue;
+            module.code[pc].op = super.fused;
+            advance = super.length;
+            ++sites;
+            break;
+        }
+        pc += advance;
+    }
+    return sites;
+}
+
+const char* vmOpName(QLVMOp op) {
+    if (static_cast<size_t>(op) < sizeof(QL_VM_OP_NAMES) / sizeof(QL_VM_OP_NAMES[0])) return QL_VM_OP_NAMES[static_cast<size_t>(op)];
+    for (const auto& super : QL_SUPERINSTRUCTIONS)
+        if (super.fused == op) return super.name;
+    return "?";
+}
+
+bool compileRegisterModule(const QLVMModule& module, QLRegModule& out, std::string& error,
+                           std::vector<uint32_t>* entries) {
+    out = {};
+    if (!module.verified) {
+        error = "register mode needs a verified module";
+        return false;
+    }
+    const size_t n = module.code.size();
+    std::vector<int32_t> depth(n, -1);
+    std::vector<bool> leader(n, false);
+    std::vector<uint32_t> target(n, 0);  // register pc of each leader
+    std::vector<std::pair<size_t, size_t>> fixups;
+    for (const QLVMInstr& in : module.code)
+        if (in.op == QLVMOp::JMP || in.op == QLVMOp::JZ) leader[static_cast<size_t>(in.a)] = true;
+
+    for (const QLVMRegion& region : vmRegions(module)) {
+        uint32_t maxDepth;
+        if (!analyzeStackDepths(module, region, depth, maxDepth, error)) return false;
+        uint32_t slots = region.function == UINT32_MAX ? module.topSlots : module.functions[region.function].slots;
+        if (slots + maxDepth > 0xFFFF) {
+            error = "frame needs more than 65535 registers";
+            return false;
+        }
+        if (region.function == UINT32_MAX) {
+            out.topSlots = slots;
+            out.topFrameSize = slots + maxDepth;
+        }
+        else {
+            const QLVMFunction& fn = module.functions[region.function];
+            out.functions.push_back({ static_cast<uint32_t>(out.code.size()), fn.params, fn.slots, slots + maxDepth });
+        }
+
+        struct Value {
+            bool isImm;
+            int64_t imm;
+            uint16_t reg;
+        };
+        std::vector<Value> stack;
+        size_t producer = SIZE_MAX;  // instruction that wrote the top temporary, if nothing followed it
+        auto temp = [&](size_t k) { return static_cast<uint16_t>(slots + k); };
+        auto emit = [&](QLRegOp op, uint16_t d, uint16_t a, uint16_t b, int64_t imm) {
+            out.code.push_back({ imm, d, a, b, op });
+            producer = SIZE_MAX;
+        };
+        auto materialize = [&](size_t k) {
+            Value& v = stack[k];
+            if (v.isImm) emit(QLRegOp::MOVI, temp(k), 0, 0, v.imm);
+            else if (v.reg != temp(k)) emit(QLRegOp::MOV, temp(k), v.reg, 0, 0);
+            v = { false, 0, temp(k) };
+        };
+        auto flush = [&] { for (size_t k = 0; k < stack.size(); ++k) materialize(k); };
+        auto binary = [&](QLRegOp reg, QLRegOp imm, bool commutative, int64_t (*fold)(int64_t, int64_t)) {
+            Value b = stack.back(); stack.pop_back();
+            Value a = stack.back(); stack.pop_back();
+            uint16_t t = temp(stack.size());
+            if (a.isImm && b.isImm) {
+                stack.push_back({ true, fold(a.imm, b.imm), 0 });
+                return;
+            }
+            if (b.isImm) emit(imm, t, a.reg, 0, b.imm);
+            else if (a.isImm && commutative) emit(imm, t, b.reg, 0, a.imm);
+            else if (a.isImm) {
+                emit(QLRegOp::MOVI, t, 0, 0, a.imm);
+                emit(reg, t, t, b.reg, 0);
+            }
+            else emit(reg, t, a.reg, b.reg, 0);
+            producer = out.code.size() - 1;
+            stack.push_back({ false, 0, t });
+        };
+
+        bool fallsThrough = false;
+        for (size_t pc = region.begin; pc < region.end; ++pc) {
+            if (depth[pc] < 0) {
+                fallsThrough = false;
+                continue;
+            }
+            if (leader[pc]) {
+                if (fallsThrough) flush();
+                stack.clear();
+                for (int32_t k = 0; k < depth[pc]; ++k) stack.push_back({ false, 0, temp(k) });
+                producer = SIZE_MAX;
+                target[pc] = static_cast<uint32_t>(out.code.size());
+            }
+            fallsThrough = true;
+            const QLVMInstr& in = module.code[pc];
+            switch (in.op) {
+            case QLVMOp::NOP:
+                break;
+            case QLVMOp::PUSH:
+                stack.push_back({ true, in.a, 0 });
+                break;
+            case QLVMOp::LOAD:
+                stack.push_back({ false, 0, static_cast<uint16_t>(in.a) });
+                break;
+            case QLVMOp::STORE: {
+                uint16_t slot = static_cast<uint16_t>(in.a);
+                Value v = stack.back();
+                stack.pop_back();
+                for (size_t k = 0; k < stack.size(); ++k)
+                    if (!stack[k].isImm && stack[k].reg == slot) materialize(k);
+                if (!v.isImm && v.reg == temp(stack.size()) && producer == out.code.size() - 1) out.code.back().d = slot;
+                else if (v.isImm) emit(QLRegOp::MOVI, slot, 0, 0, v.imm);
+                else if (v.reg != slot) emit(QLRegOp::MOV, slot, v.reg, 0, 0);
+                producer = SIZE_MAX;
+                break;
+            }
+            case QLVMOp::POP:
+                stack.pop_back();
+                break;
+            case QLVMOp::ADD:
+                binary(QLRegOp::ADD, QLRegOp::ADDI, true, [](int64_t x, int64_t y) {
+                    return static_cast<int64_t>(static_cast<uint64_t>(x) + static_cast<uint64_t>(y)); });
+                break;
+            case QLVMOp::SUB:
+                binary(QLRegOp::SUB, QLRegOp::SUBI, false, [](int64_t x, int64_t y) {
+                    return static_cast<int64_t>(static_cast<uint64_t>(x) - static_cast<uint64_t>(y)); });
+                break;
+            case QLVMOp::MUL:
+                binary(QLRegOp::MUL, QLRegOp::MULI, true, [](int64_t x, int64_t y) {
+                    return static_cast<int64_t>(static_cast<uint64_t>(x) * static_cast<uint64_t>(y)); });
+                break;
+            case QLVMOp::LT:
+                binary(QLRegOp::LT, QLRegOp::LTI, false, [](int64_t x, int64_t y) -> int64_t { return x < y; });
+                break;
+            case QLVMOp::LE:
+                binary(QLRegOp::LE, QLRegOp::LEI, false, [](int64_t x, int64_t y) -> int64_t { return x <= y; });
+                break;
+            case QLVMOp::EQ:
+                binary(QLRegOp::EQ, QLRegOp::EQI, true, [](int64_t x, int64_t y) -> int64_t { return x == y; });
+                break;
+            case QLVMOp::JMP:
+                flush();
+                fixups.emplace_back(out.code.size(), static_cast<size_t>(in.a));
+                emit(QLRegOp::JMP, 0, 0, 0, 0);
+                fallsThrough = false;
+                break;
+            case QLVMOp::JZ: {
+                Value c = stack.back();
+                stack.pop_back();
+                flush();
+                if (!c.isImm) {
+                    fixups.emplace_back(out.code.size(), static_cast<size_t>(in.a));
+                    emit(QLRegOp::JZ, 0, c.reg, 0, 0);
+                }
+                else if (c.imm == 0) {
+                    fixups.emplace_back(out.code.size(), static_cast<size_t>(in.a));
+                    emit(QLRegOp::JMP, 0, 0, 0, 0);
+                }
+                break;
+            }
+            case QLVMOp::CALL: {
+                flush();
+                uint32_t params = module.functions[in.a].params;
+                uint16_t first = temp(stack.size() - params);
+                emit(QLRegOp::CALL, first, 0, 0, in.a);
+                stack.resize(stack.size() - params);
+                stack.push_back({ false, 0, first });
+                break;
+            }
+            case QLVMOp::CALL_EXT: {
+                flush();
+                const QLCallSite& site = module.callSites[in.a];
+                uint16_t first = temp(stack.size() - site.argc);
+                emit(QLRegOp::CALL_EXT, first, 0, 0, in.a);
+                stack.resize(stack.size() - site.argc);
+                if (site.pushesResult) stack.push_back({ false, 0, first });
+                break;
+            }
+            case QLVMOp::CALL_DYN: {
+                flush();
+                const QLCallSite& site = module.callSites[in.a];
+                uint16_t callee = temp(stack.size() - 1);
+                uint16_t first = temp(stack.size() - 1 - site.argc);
+                emit(QLRegOp::CALL_DYN, first, callee, 0, in.a);
+                stack.resize(stack.size() - 1 - site.argc);
+                stack.push_back({ false, 0, first });
+                break;
+            }
+            case QLVMOp::RET:
+            case QLVMOp::HALT: {
+                bool ret = in.op == QLVMOp::RET;
+                if (stack.empty()) {
+                    if (ret) emit(QLRegOp::RETI, 0, 0, 0, 0);
+                    else emit(QLRegOp::HALT_ACC, 0, 0, 0, 0);
+                }
+                else if (stack.back().isImm) emit(ret ? QLRegOp::RETI : QLRegOp::HALTI, 0, 0, 0, stack.back().imm);
+                else emit(ret ? QLRegOp::RET : QLRegOp::HALT, 0, stack.back().reg, 0, 0);
+                fallsThrough = false;
+                break;
+            }
+            case QLVMOp::FOLD_ADD:
+                emit(QLRegOp::SET_ACC, 0, 0, 0, static_cast<int64_t>(static_cast<uint64_t>(in.a) + static_cast<uint64_t>(in.b)));
+                break;
+            case QLVMOp::REC_FOLD:
+                emit(QLRegOp::SET_ACC, 0, 0, 0, in.a);
+                break;
+            case QLVMOp::COMPARE:
+                emit(QLRegOp::SET_FLAG, 0, 0, 0, in.a == in.b);
+                break;
+            default:
+                break; // superinstructions are rejected by analyzeStackDepths
+            }
+        }
+    }
+    for (auto [at, pc] : fixups) out.code[at].imm = target[pc];
+    if (entries) {
+        entries->assign(n, UINT32_MAX);
+        for (size_t pc = 0; pc < n; ++pc)
+            if (leader[pc] && depth[pc] >= 0) (*entries)[pc] = target[pc];
+    }
+    out.callSites = module.callSites;
+    out.strings = module.strings;
+    return true;
+}
+
+int64_t runRegisterVM(const QLRegModule& module, QLRegState& state) {
+    return runRegisterVM<QL_VM_COMPUTED_GOTO != 0>(module, state);
+}
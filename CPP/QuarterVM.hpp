@@ -0,0 +1,889 @@
+// QuarterVM.hpp
+// QLVM: the verifying loader, the stack VM with its superinstructions
+// and native-call inline caches, and the register VM compiled from it.
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "QuarterBytecode.hpp"
+
+#if defined(__GNUC__)
+#define QL_NOINLINE __attribute__((noinline))
+#else
+#define QL_NOINLINE
+#endif
+
+// ======== Bytecode VM ========
+// QLVM executes modules from compileUICLToBytecode directly. Loading decodes
+// the module once into 16-byte QLVMInstr records, resolves CALL targets to
+// function indices (other names become native call sites, see QLCallSite),
+// turns named LOAD/STORE operands into frame slots and checks slots and jump
+// targets. Values live on one contiguous int64 stack;
+// a frame is just a return address and the base of its slots on that stack.
+//
+// Dispatch is computed goto where the compiler supports labels-as-values and a
+// switch otherwise. Both share the handler bodies below; runVM<false> forces
+// the switch so the two can be compared in one binary.
+#ifndef QL_VM_COMPUTED_GOTO
+#if defined(__GNUC__) || defined(__clang__)
+#define QL_VM_COMPUTED_GOTO 1
+#else
+#define QL_VM_COMPUTED_GOTO 0
+#endif
+#endif
+
+// Host functions that plugins expose to bytecode. A call site that names one
+// resolves it through an inline cache instead of hashing the name on every
+// call: one entry (monomorphic) for a CALL to a fixed name, up to
+// QL_IC_ENTRIES for a CALLI whose callee varies, and a registry lookup once a
+// site has seen more targets than that. Every change to the registry bumps
+// its epoch, which invalidates all caches filled before it.
+using QLNativeFn = int64_t (*)(const int64_t* args, uint32_t argc, void* context);
+
+struct QLNativeBinding {
+    std::string name;
+    uint32_t arity = 0;
+    QLNativeFn fn = nullptr;
+    void* context = nullptr;
+};
+
+class QLPluginRegistry {
+public:
+    // Loading a plugin that is already loaded replaces its functions.
+    void loadPlugin(const std::string& plugin, std::vector<QLNativeBinding> functions) {
+        if (!plugins.count(plugin)) loadOrder.push_back(plugin);
+        plugins[plugin] = std::move(functions);
+        reindex();
+    }
+
+    void unloadPlugin(const std::string& plugin) {
+        if (!plugins.erase(plugin)) return;
+        loadOrder.erase(std::find(loadOrder.begin(), loadOrder.end(), plugin));
+        reindex();
+    }
+
+    // Later plugins shadow earlier ones that export the same name.
+    const QLNativeBinding* find(std::string_view name) const {
+        auto it = index.find(name);
+        return it == index.end() ? nullptr : it->second;
+    }
+
+    uint64_t epoch() const { return currentEpoch; }
+
+private:
+    void reindex() {
+        index.clear();
+        for (const std::string& plugin : loadOrder)
+            for (const QLNativeBinding& binding : plugins[plugin]) index[binding.name] = &binding;
+        ++currentEpoch;
+    }
+
+    std::map<std::string, std::vector<QLNativeBinding>> plugins;
+    std::vector<std::string> loadOrder;
+    std::unordered_map<std::string_view, const QLNativeBinding*> index;
+    uint64_t currentEpoch = 0;
+};
+
+struct QLCallSite {
+    uint32_t name = QL_NO_STRING;  // string index of the callee; QL_NO_STRING for CALLI
+    uint32_t argc = 0;
+    bool pushesResult = false;     // capsule calls (CALL with no argument count) leave the stack alone
+};
+
+constexpr uint8_t QL_IC_ENTRIES = 4;
+
+struct QLInlineCache {
+    uint64_t epoch = UINT64_MAX;
+    uint8_t size = 0;
+    bool megamorphic = false;
+    uint32_t keys[QL_IC_ENTRIES] = {};
+    const QLNativeBinding* targets[QL_IC_ENTRIES] = {};
+};
+
+// Per-run cache storage, kept across runs of the same module.
+struct QLCallCaches {
+    const void* owner = nullptr;
+    std::vector<QLInlineCache> sites;
+    uint64_t misses = 0;
+    bool enabled = true;
+
+    void prepare(const void* module, size_t siteCount) {
+        if (owner == module && sites.size() == siteCount) return;
+        owner = module;
+        sites.assign(siteCount, {});
+    }
+};
+
+QL_NOINLINE const QLNativeBinding* resolveNativeSlow(QLCallCaches& caches, QLInlineCache& cache, uint32_t name,
+                                                     const QLPluginRegistry& registry, const std::vector<std::string>& strings);
+
+// Calls the native a site names (or the callee name for CALLI) with args.
+// Names no plugin provides are unresolved capsule calls: they count in
+// `unresolved` and yield 0. Returns false on an arity mismatch.
+inline bool callNative(QLCallCaches& caches, const QLPluginRegistry* registry, const std::vector<std::string>& strings,
+                       uint32_t siteIndex, const QLCallSite& site, int64_t name, const int64_t* args,
+                       int64_t& result, uint64_t& unresolved) {
+    const QLNativeBinding* target = nullptr;
+    if (registry && name >= 0 && static_cast<uint64_t>(name) < strings.size()) {
+        QLInlineCache& cache = caches.sites[siteIndex];
+        uint32_t key = static_cast<uint32_t>(name);
+        bool hit = false;
+        if (cache.epoch == registry->epoch()) {
+            for (uint8_t i = 0; i < cache.size; ++i) {
+                if (cache.keys[i] == key) {
+                    target = cache.targets[i];
+                    hit = true;
+                    break;
+                }
+            }
+        }
+        if (!hit) target = resolveNativeSlow(caches, cache, key, *registry, strings);
+    }
+    if (!target) {
+        ++unresolved;
+        result = 0;
+        return true;
+    }
+    if (target->arity != site.argc) return false;
+    result = target->fn(args, site.argc, target->context);
+    return true;
+}
+
+enum class QLVMOp : uint8_t {
+    NOP,
+    PUSH,
+    LOAD,
+    STORE,
+    POP,
+    ADD,
+    SUB,
+    MUL,
+    LT,
+    LE,
+    EQ,
+    JMP,
+    JZ,
+    CALL,      // a = function index
+    CALL_EXT,  // a = call site; a native, or an unresolved capsule
+    RET,
+    HALT,
+    FOLD_ADD,  // ACC = a + b
+    REC_FOLD,  // ACC = a (factorial folded at load)
+    COMPARE,   // FLAG = (a == b), string indices; ACC is untouched as in runProgram
+    CALL_DYN,  // a = call site; the callee name index is on top of the stack
+    // Superinstructions (see applySuperinstructions). Each replaces the first
+    // instruction of its sequence and reads the rest of its operands from the
+    // instructions that follow, which stay in place for jumps into the middle.
+    LOAD_LOAD,
+    LOAD_PUSH,
+    LOAD_ADD,
+    PUSH_ADD,
+    PUSH_SUB,
+    PUSH_MUL,
+    LT_JZ,
+    LE_JZ,
+    LOAD_PUSH_SUB,
+    LOAD_LOAD_LT_JZ,
+    LOAD_PUSH_LE_JZ,
+    LOAD_PUSH_ADD_STORE,
+    COUNT
+};
+
+struct QLVMInstr {
+    int64_t a = 0;
+    int64_t b = 0;
+    QLVMOp op = QLVMOp::NOP;
+};
+
+// Default operand stack of a QLVMState, in slots. No verified frame may be
+// larger, so frame sizes and slot counts always fit in 32 bits.
+constexpr uint32_t QL_VM_STACK_SLOTS = 1 << 20;
+
+struct QLVMFunction {
+    std::string name;
+    uint32_t entry = 0;
+    uint32_t params = 0;
+    uint32_t slots = 0;
+    uint32_t frameSize = 0;  // slots + deepest operand stack, set by verifyVMModule
+};
+
+struct QLVMModule {
+    std::vector<QLVMInstr> code;
+    std::vector<QLVMFunction> functions;
+    std::vector<QLCallSite> callSites;
+    std::vector<std::string> strings;
+    uint32_t topSlots = 0;  // variables named by top-level code
+    uint32_t topFrameSize = 0;
+    bool verified = false;  // set by verifyVMModule; runVM runs unverified modules checked
+};
+
+// Load-time verification. Once a module passes, runVM and
+// compileRegisterModule rely on every jump target, slot, function, call site
+// and string index being in range. They also rely on every instruction seeing
+// one operand stack depth on all paths, deep enough for what it pops. Each
+// frame's size (slots + deepest stack) is recorded, so a call needs one
+// capacity check and nothing else is checked at runtime.
+bool verifyVMModule(QLVMModule& module, std::string& error);
+
+bool loadVMModule(const Bytecode& bc, QLVMModule& module, std::string& error);
+
+// Fused opcodes and the sequences they stand for. applySuperinstructions
+// rewrites only the first instruction of a sequence, so the operands of the
+// rest stay in place for the fused handler (and the checker) to read.
+struct QLSuperinstruction {
+    QLVMOp fused;
+    uint8_t length;
+    QLVMOp sequence[4];
+    const char* name;
+};
+
+constexpr QLSuperinstruction QL_SUPERINSTRUCTIONS[] = {
+    { QLVMOp::LOAD_LOAD_LT_JZ, 4, { QLVMOp::LOAD, QLVMOp::LOAD, QLVMOp::LT, QLVMOp::JZ }, "LOAD+LOAD+LT+JZ" },
+    { QLVMOp::LOAD_PUSH_LE_JZ, 4, { QLVMOp::LOAD, QLVMOp::PUSH, QLVMOp::LE, QLVMOp::JZ }, "LOAD+PUSH+LE+JZ" },
+    { QLVMOp::LOAD_PUSH_ADD_STORE, 4, { QLVMOp::LOAD, QLVMOp::PUSH, QLVMOp::ADD, QLVMOp::STORE }, "LOAD+PUSH+ADD+STORE" },
+    { QLVMOp::LOAD_PUSH_SUB, 3, { QLVMOp::LOAD, QLVMOp::PUSH, QLVMOp::SUB }, "LOAD+PUSH+SUB" },
+    { QLVMOp::LOAD_LOAD, 2, { QLVMOp::LOAD, QLVMOp::LOAD }, "LOAD+LOAD" },
+    { QLVMOp::LOAD_PUSH, 2, { QLVMOp::LOAD, QLVMOp::PUSH }, "LOAD+PUSH" },
+    { QLVMOp::LOAD_ADD, 2, { QLVMOp::LOAD, QLVMOp::ADD }, "LOAD+ADD" },
+    { QLVMOp::PUSH_ADD, 2, { QLVMOp::PUSH, QLVMOp::ADD }, "PUSH+ADD" },
+    { QLVMOp::PUSH_SUB, 2, { QLVMOp::PUSH, QLVMOp::SUB }, "PUSH+SUB" },
+    { QLVMOp::PUSH_MUL, 2, { QLVMOp::PUSH, QLVMOp::MUL }, "PUSH+MUL" },
+    { QLVMOp::LT_JZ, 2, { QLVMOp::LT, QLVMOp::JZ }, "LT+JZ" },
+    { QLVMOp::LE_JZ, 2, { QLVMOp::LE, QLVMOp::JZ }, "LE+JZ" },
+};
+
+struct QLVMState {
+    std::vector<int64_t> stack;
+    struct Frame {
+        const QLVMInstr* returnPc;
+        int64_t* base;
+        uint32_t slots;  // caller's slot count, tracked in checked mode only
+    };
+    std::vector<Frame> frames;
+    int64_t acc = 0;
+    bool flag = false;
+    uint64_t externalCalls = 0;
+    std::string error;
+    const QLPluginRegistry* natives = nullptr;
+    QLCallCaches callCaches;
+    bool forceChecked = false;  // run verified modules through the checked loop too
+
+    explicit QLVMState(size_t stackSlots = QL_VM_STACK_SLOTS, size_t maxFrames = 1 << 16) : stack(stackSlots), frames(maxFrames) {}
+};
+
+// How a frame handed to a higher execution tier came back (see Tiered
+// Execution below).
+enum class QLTierExit : uint8_t {
+    Return,  // the entered frame returned; the result is for tier 0 to push
+    Halt,    // the program halted in tier 1
+    Error,   // reported in the caller's state
+};
+
+// What verifyVMModule proves for the whole module, checked for one
+// instruction against the live frame: `depth` values above the frame base
+// (slots included) and `room` free stack values. A fused instruction is
+// checked as the sequence it replaced.
+QL_NOINLINE bool checkVMStep(const QLVMModule& module, size_t at, size_t depth, uint32_t slots, size_t room,
+                             std::string& error);
+
+// Returns the value on top of the stack when the program halts, or ACC when
+// the stack is empty. A verified module runs with no checks except one per
+// call: the verifier bounds every frame's stack use, so only the frame itself
+// has to fit. Checked runs validate each instruction with checkVMStep before
+// dispatching it (through the switch), for unverified modules and debugging.
+// Profiled runs count dispatches per instruction into hits[pc]. Tiered runs
+// report calls and back edges to `tiers` (a QLTieredRuntime), which may take
+// a frame over in register mode.
+template <bool Threaded, bool Profiled = false, bool Checked = false, class Tiers = void>
+int64_t runVM(const QLVMModule& module, QLVMState& state, uint64_t* hits = nullptr, Tiers* tiers = nullptr) {
+    constexpr bool Tiered = !std::is_void_v<Tiers>;
+    static_assert(!(Tiered && Checked), "tiered runs need a verified module");
+    const QLVMInstr* code = module.code.data();
+    const QLVMInstr* pc = code;
+    const QLVMFunction* functions = module.functions.data();
+    int64_t* const stackBase = state.stack.data();
+    int64_t* sp = stackBase + module.topSlots;
+    int64_t* base = stackBase;
+    int64_t* const stackEnd = stackBase + state.stack.size();
+    uint32_t slots = module.topSlots;
+    QLVMState::Frame* frame = state.frames.data();
+    QLVMState::Frame* const frameLimit = frame + state.frames.size();
+    int64_t acc = 0;
+    bool flag = false;
+    uint64_t externalCalls = 0;
+    const QLCallSite* sites = module.callSites.data();
+    state.error.clear();
+    state.callCaches.prepare(&module, module.callSites.size());
+    if (module.topSlots > state.stack.size() || (!Checked && module.topFrameSize > state.stack.size())) {
+        state.error = "stack too small";
+        return 0;
+    }
+    std::fill(stackBase, sp, 0);
+
+
+    auto wrapAdd = [](int64_t x, int64_t y) { return static_cast<int64_t>(static_cast<uint64_t>(x) + static_cast<uint64_t>(y)); };
+    auto wrapSub = [](int64_t x, int64_t y) { return static_cast<int64_t>(static_cast<uint64_t>(x) - static_cast<uint64_t>(y)); };
+    auto wrapMul = [](int64_t x, int64_t y) { return static_cast<int64_t>(static_cast<uint64_t>(x) * static_cast<uint64_t>(y)); };
+
+#if QL_VM_COMPUTED_GOTO
+    // Order must match QLVMOp.
+    static void* const handlers[] = {
+        &&vm_NOP, &&vm_PUSH, &&vm_LOAD, &&vm_STORE, &&vm_POP, &&vm_ADD, &&vm_SUB, &&vm_MUL, &&vm_LT, &&vm_LE,
+        &&vm_EQ, &&vm_JMP, &&vm_JZ, &&vm_CALL, &&vm_CALL_EXT, &&vm_RET, &&vm_HALT, &&vm_FOLD_ADD, &&vm_REC_FOLD,
+        &&vm_COMPARE, &&vm_CALL_DYN, &&vm_LOAD_LOAD, &&vm_LOAD_PUSH, &&vm_LOAD_ADD, &&vm_PUSH_ADD, &&vm_PUSH_SUB, &&vm_PUSH_MUL,
+        &&vm_LT_JZ, &&vm_LE_JZ, &&vm_LOAD_PUSH_SUB, &&vm_LOAD_LOAD_LT_JZ, &&vm_LOAD_PUSH_LE_JZ, &&vm_LOAD_PUSH_ADD_STORE,
+    };
+    static_assert(sizeof(handlers) / sizeof(handlers[0]) == static_cast<size_t>(QLVMOp::COUNT), "handler table out of sync");
+#define QL_VM_NEXT() do { \
+        if constexpr (Threaded && !Checked) { \
+            if constexpr (Profiled) ++hits[pc - code]; \
+            goto *handlers[static_cast<uint8_t>(pc->op)]; \
+        } \
+        else goto dispatch; \
+    } while (0)
+#else
+#define QL_VM_NEXT() goto dispatch
+#endif
+#define QL_VM_OP(name) case QLVMOp::name: vm_##name
+#define QL_VM_JUMP(index) do { \
+        const QLVMInstr* target = code + (index); \
+        if constexpr (Tiered) { \
+            if (target <= pc) { \
+                pc = target; \
+                goto backEdge; \
+            } \
+        } \
+        pc = target; \
+    } while (0)
+
+    goto dispatch;
+dispatch:
+    if constexpr (Checked) {
+        if (!checkVMStep(module, pc - code, sp - base, slots, stackEnd - sp, state.error)) goto finish;
+    }
+    if constexpr (Profiled) ++hits[pc - code];
+    switch (pc->op) {
+    QL_VM_OP(NOP):
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(PUSH):
+        *sp++ = pc->a;
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(LOAD):
+        *sp++ = base[pc->a];
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(STORE):
+        base[pc->a] = *--sp;
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(POP):
+        --sp;
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(ADD):
+        --sp;
+        sp[-1] = wrapAdd(sp[-1], sp[0]);
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(SUB):
+        --sp;
+        sp[-1] = wrapSub(sp[-1], sp[0]);
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(MUL):
+        --sp;
+        sp[-1] = wrapMul(sp[-1], sp[0]);
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(LT):
+        --sp;
+        sp[-1] = sp[-1] < sp[0];
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(LE):
+        --sp;
+        sp[-1] = sp[-1] <= sp[0];
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(EQ):
+        --sp;
+        sp[-1] = sp[-1] == sp[0];
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(JMP):
+        QL_VM_JUMP(pc->a);
+        QL_VM_NEXT();
+    QL_VM_OP(JZ):
+        if (*--sp == 0) QL_VM_JUMP(pc->a);
+        else ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(CALL): {
+        const QLVMFunction& fn = functions[pc->a];
+        if (frame == frameLimit) goto overflow;
+        if constexpr (Checked) {
+            *frame++ = { pc + 1, base, slots };
+            slots = fn.slots;
+        }
+        else {
+            if (static_cast<size_t>(stackEnd - sp) + fn.params < fn.frameSize) goto overflow;
+            if constexpr (Tiered) {
+                if (tiers->hotCall(static_cast<uint32_t>(pc->a))) {
+                    int64_t* window = sp - fn.params;
+                    int64_t result;
+                    if (tiers->enterFunction(static_cast<uint32_t>(pc->a), window, stackEnd - window, acc, flag, externalCalls,
+                                             result, state) != QLTierExit::Return)
+                        goto finish;
+                    sp = window;
+                    *sp++ = result;
+                    ++pc;
+                    QL_VM_NEXT();
+                }
+            }
+            *frame++ = { pc + 1, base, 0 };
+        }
+        base = sp - fn.params;
+        for (uint32_t i = fn.params; i < fn.slots; ++i) *sp++ = 0;
+        pc = code + fn.entry;
+        QL_VM_NEXT();
+    }
+    QL_VM_OP(CALL_EXT): {
+        const QLCallSite& site = sites[pc->a];
+        int64_t value;
+        sp -= site.argc;
+        if (!callNative(state.callCaches, state.natives, module.strings, static_cast<uint32_t>(pc->a), site, site.name, sp, value, externalCalls))
+            goto arity;
+        if (site.pushesResult) *sp++ = value;
+        ++pc;
+        QL_VM_NEXT();
+    }
+    QL_VM_OP(CALL_DYN): {
+        const QLCallSite& site = sites[pc->a];
+        int64_t callee = *--sp;
+        int64_t value;
+        sp -= site.argc;
+        if (!callNative(state.callCaches, state.natives, module.strings, static_cast<uint32_t>(pc->a), site, callee, sp, value, externalCalls))
+            goto arity;
+        *sp++ = value;
+        ++pc;
+        QL_VM_NEXT();
+    }
+    QL_VM_OP(RET): {
+        int64_t result = sp > base + (frame == state.frames.data() ? module.topSlots : 0) ? sp[-1] : 0;
+        if (frame == state.frames.data()) {
+            acc = result;
+            goto finish;
+        }
+        sp = base;
+        *sp++ = result;
+        --frame;
+        pc = frame->returnPc;
+        base = frame->base;
+        if constexpr (Checked) slots = frame->slots;
+        QL_VM_NEXT();
+    }
+    QL_VM_OP(FOLD_ADD):
+        acc = wrapAdd(pc->a, pc->b);
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(REC_FOLD):
+        acc = pc->a;
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(COMPARE):
+        flag = pc->a == pc->b;
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(HALT):
+        goto done;
+    QL_VM_OP(LOAD_LOAD):
+        sp[0] = base[pc[0].a];
+        sp[1] = base[pc[1].a];
+        sp += 2;
+        pc += 2;
+        QL_VM_NEXT();
+    QL_VM_OP(LOAD_PUSH):
+        sp[0] = base[pc[0].a];
+        sp[1] = pc[1].a;
+        sp += 2;
+        pc += 2;
+        QL_VM_NEXT();
+    QL_VM_OP(LOAD_ADD):
+        sp[-1] = wrapAdd(sp[-1], base[pc[0].a]);
+        pc += 2;
+        QL_VM_NEXT();
+    QL_VM_OP(PUSH_ADD):
+        sp[-1] = wrapAdd(sp[-1], pc[0].a);
+        pc += 2;
+        QL_VM_NEXT();
+    QL_VM_OP(PUSH_SUB):
+        sp[-1] = wrapSub(sp[-1], pc[0].a);
+        pc += 2;
+        QL_VM_NEXT();
+    QL_VM_OP(PUSH_MUL):
+        sp[-1] = wrapMul(sp[-1], pc[0].a);
+        pc += 2;
+        QL_VM_NEXT();
+    QL_VM_OP(LT_JZ):
+        sp -= 2;
+        if (!(sp[0] < sp[1])) QL_VM_JUMP(pc[1].a);
+        else pc += 2;
+        QL_VM_NEXT();
+    QL_VM_OP(LE_JZ):
+        sp -= 2;
+        if (!(sp[0] <= sp[1])) QL_VM_JUMP(pc[1].a);
+        else pc += 2;
+        QL_VM_NEXT();
+    QL_VM_OP(LOAD_PUSH_SUB):
+        *sp++ = wrapSub(base[pc[0].a], pc[1].a);
+        pc += 3;
+        QL_VM_NEXT();
+    QL_VM_OP(LOAD_LOAD_LT_JZ):
+        if (!(base[pc[0].a] < base[pc[1].a])) QL_VM_JUMP(pc[3].a);
+        else pc += 4;
+        QL_VM_NEXT();
+    QL_VM_OP(LOAD_PUSH_LE_JZ):
+        if (!(base[pc[0].a] <= pc[1].a)) QL_VM_JUMP(pc[3].a);
+        else pc += 4;
+        QL_VM_NEXT();
+    QL_VM_OP(LOAD_PUSH_ADD_STORE):
+        base[pc[3].a] = wrapAdd(base[pc[0].a], pc[1].a);
+        pc += 4;
+        QL_VM_NEXT();
+    case QLVMOp::COUNT:
+        break;
+    }
+    state.error = "invalid opcode at instruction " + std::to_string(pc - code);
+    goto finish;
+[[maybe_unused]] backEdge:
+    // pc is a loop header that was just jumped back to.
+    if constexpr (Tiered) {
+        uint32_t entry = tiers->hotBackEdge(static_cast<size_t>(pc - code));
+        if (entry != UINT32_MAX) {
+            int64_t result;
+            if (tiers->enterLoop(static_cast<size_t>(pc - code), entry, base, stackEnd - base, acc, flag, externalCalls, result,
+                                 state) != QLTierExit::Return)
+                goto finish;
+            if (frame == state.frames.data()) {
+                acc = result;
+                goto finish;
+            }
+            sp = base;
+            *sp++ = result;
+            --frame;
+            pc = frame->returnPc;
+            base = frame->base;
+        }
+    }
+    QL_VM_NEXT();
+overflow:
+    state.error = "stack overflow at instruction " + std::to_string(pc - code);
+    goto finish;
+arity:
+    state.error = "native arity mismatch at instruction " + std::to_string(pc - code);
+    goto finish;
+done:
+    acc = sp > stackBase + module.topSlots ? sp[-1] : acc;
+finish:
+#undef QL_VM_JUMP
+#undef QL_VM_OP
+#undef QL_VM_NEXT
+    state.acc = acc;
+    state.flag = flag;
+    state.externalCalls = externalCalls;
+    return acc;
+}
+
+int64_t runVM(const QLVMModule& module, QLVMState& state);
+
+// ======== Superinstructions ========
+// A profiled run counts dispatches per instruction. Since a straight-line
+// sequence runs once each time its first instruction does, those counts give
+// the exact dynamic frequency of every opcode n-gram. The catalog below lists
+// QL_SUPERINSTRUCTIONS lists the sequences that have fused handlers in runVM. selectSuperinstructions
+// ranks them by the dispatches they would save on a profile, and
+// applySuperinstructions rewrites a loaded module to use the chosen ones.
+constexpr const char* QL_VM_OP_NAMES[] = {
+    "NOP", "PUSH", "LOAD", "STORE", "POP", "ADD", "SUB", "MUL", "LT", "LE", "EQ", "JMP", "JZ", "CALL", "CALL_EXT",
+    "RET", "HALT", "FOLD_ADD", "REC_FOLD", "COMPARE", "CALL_DYN",
+};
+static_assert(sizeof(QL_VM_OP_NAMES) / sizeof(QL_VM_OP_NAMES[0]) == static_cast<size_t>(QLVMOp::LOAD_LOAD),
+              "every base opcode needs a name");
+
+struct QLVMNGram {
+    std::vector<QLVMOp> ops;
+    uint64_t count;
+};
+
+// The most frequently executed opcode sequences of 2..maxLength instructions.
+std::vector<QLVMNGram> hotNGrams(const QLVMModule& module, const std::vector<uint64_t>& hits, size_t maxLength, size_t top);
+
+// Catalog entries ordered by the dispatches they would save on this profile
+// (overlapping matches are each counted), keeping at most `limit`.
+std::vector<QLVMOp> selectSuperinstructions(const QLVMModule& module, const std::vector<uint64_t>& hits, size_t limit);
+
+// Rewrites the first instruction of every enabled sequence, longest catalog
+// entry first, scanning left to right without overlap. Returns the number
+// of sites rewritten. Fused handlers move the stack exactly as the sequence
+// would, so a verified module stays verified.
+size_t applySuperinstructions(QLVMModule& module, const std::vector<QLVMOp>& enabled);
+
+const char* vmOpName(QLVMOp op);
+
+// ======== Register VM ========
+// Register mode compiles a loaded QLVMModule into three-address code over a
+// contiguous register file. Each frame is a window of it: registers
+// [0, slots) are the function's parameters and variables (already slots, so
+// no names survive loading), and the operand stack position k maps to
+// register slots + k. Stack depths are fixed per instruction, which
+// verifyVMModule checks before a module can be compiled.
+//
+// Translation runs a symbolic operand stack: LOAD and PUSH emit nothing, and
+// arithmetic reads its operands straight from variable registers or
+// immediates. A STORE of a fresh result retargets the instruction that made
+// it. The symbolic stack is written back to its canonical registers only at
+// jumps, jump targets and calls. A call passes its arguments in place: the
+// callee's window starts at the caller's first argument register, and the
+// result lands in that same register.
+enum class QLRegOp : uint8_t {
+    MOV,       // d = a
+    MOVI,      // d = imm
+    ADD, ADDI, SUB, SUBI, MUL, MULI,
+    LT, LTI, LE, LEI, EQ, EQI,
+    JMP,       // imm = target
+    JZ,        // if a == 0 goto imm
+    CALL,      // imm = function, d = first argument register (receives the result)
+    CALL_EXT,  // imm = call site, d = first argument register (receives the result)
+    RET,       // return a
+    RETI,      // return imm
+    HALT,      // stop with a
+    HALTI,     // stop with imm
+    HALT_ACC,  // stop with ACC
+    SET_ACC,   // ACC = imm (Δ and Ψ fold at compile time)
+    SET_FLAG,  // FLAG = imm (Ξ compares interned strings at compile time)
+    CALL_DYN,  // imm = call site, d = first argument register, a = callee name register
+    COUNT
+};
+
+struct QLRegInstr {
+    int64_t imm = 0;
+    uint16_t d = 0, a = 0, b = 0;
+    QLRegOp op = QLRegOp::MOV;
+};
+
+struct QLRegFunction {
+    uint32_t entry = 0;
+    uint32_t params = 0;
+    uint32_t slots = 0;      // zeroed on entry beyond the parameters
+    uint32_t frameSize = 0;  // slots + deepest operand stack
+};
+
+struct QLRegModule {
+    std::vector<QLRegInstr> code;
+    std::vector<QLRegFunction> functions;
+    std::vector<QLCallSite> callSites;
+    std::vector<std::string> strings;
+    uint32_t topSlots = 0;
+    uint32_t topFrameSize = 0;
+};
+
+// When `entries` is given it receives, for every jump target of the module,
+// the register pc whose frame state matches the stack VM's there (operand k
+// in register slots + k), and UINT32_MAX elsewhere.
+bool compileRegisterModule(const QLVMModule& module, QLRegModule& out, std::string& error,
+                           std::vector<uint32_t>* entries = nullptr);
+
+struct QLRegState {
+    std::vector<int64_t> registers;
+    struct Frame {
+        const QLRegInstr* returnPc;
+        int64_t* base;
+        uint32_t result;
+    };
+    std::vector<Frame> frames;
+    int64_t acc = 0;
+    bool flag = false;
+    uint64_t externalCalls = 0;
+    std::string error;
+    const QLPluginRegistry* natives = nullptr;
+    QLCallCaches callCaches;
+    bool returned = false;  // an entered run left its entry frame (result in `result`) rather than halting
+    int64_t result = 0;
+
+    explicit QLRegState(size_t registerCount = 1 << 20, size_t maxFrames = 1 << 16) : registers(registerCount), frames(maxFrames) {}
+};
+
+// Starts a run part-way through a module on a caller-owned register window,
+// continuing a frame another tier set up. ACC and FLAG carry over from the
+// state, and returning from the entry frame ends the run with
+// state.returned set instead of ending the program.
+struct QLRegEntry {
+    uint32_t pc;
+    int64_t* window;
+    size_t windowSize;
+};
+
+// Same result convention as runVM. Frame sizes are static, so the only
+// bounds check left at runtime is on CALL.
+template <bool Threaded>
+int64_t runRegisterVM(const QLRegModule& module, QLRegState& state, const QLRegEntry* entry = nullptr) {
+    const QLRegInstr* code = module.code.data();
+    const QLRegInstr* pc = entry ? code + entry->pc : code;
+    const QLRegFunction* functions = module.functions.data();
+    int64_t* r = entry ? entry->window : state.registers.data();
+    int64_t* const registerLimit = r + (entry ? entry->windowSize : state.registers.size());
+    QLRegState::Frame* frame = state.frames.data();
+    QLRegState::Frame* const frameLimit = frame + state.frames.size();
+    int64_t acc = entry ? state.acc : 0;
+    int64_t result = 0;
+    bool flag = entry ? state.flag : false;
+    uint64_t externalCalls = 0;
+    const QLCallSite* sites = module.callSites.data();
+    state.error.clear();
+    state.returned = false;
+    state.callCaches.prepare(&module, module.callSites.size());
+    if (!entry) {
+        if (module.topFrameSize > state.registers.size()) {
+            state.error = "register file too small";
+            return 0;
+        }
+        std::fill(r, r + module.topSlots, 0);
+    }
+
+    auto wrapAdd = [](int64_t x, int64_t y) { return static_cast<int64_t>(static_cast<uint64_t>(x) + static_cast<uint64_t>(y)); };
+    auto wrapSub = [](int64_t x, int64_t y) { return static_cast<int64_t>(static_cast<uint64_t>(x) - static_cast<uint64_t>(y)); };
+    auto wrapMul = [](int64_t x, int64_t y) { return static_cast<int64_t>(static_cast<uint64_t>(x) * static_cast<uint64_t>(y)); };
+
+#if QL_VM_COMPUTED_GOTO
+    // Order must match QLRegOp.
+    static void* const handlers[] = {
+        &&reg_MOV, &&reg_MOVI, &&reg_ADD, &&reg_ADDI, &&reg_SUB, &&reg_SUBI, &&reg_MUL, &&reg_MULI,
+        &&reg_LT, &&reg_LTI, &&reg_LE, &&reg_LEI, &&reg_EQ, &&reg_EQI, &&reg_JMP, &&reg_JZ, &&reg_CALL,
+        &&reg_CALL_EXT, &&reg_RET, &&reg_RETI, &&reg_HALT, &&reg_HALTI, &&reg_HALT_ACC, &&reg_SET_ACC, &&reg_SET_FLAG,
+        &&reg_CALL_DYN,
+    };
+    static_assert(sizeof(handlers) / sizeof(handlers[0]) == static_cast<size_t>(QLRegOp::COUNT), "handler table out of sync");
+#define QL_VM_NEXT() do { if constexpr (Threaded) goto *handlers[static_cast<uint8_t>(pc->op)]; else goto dispatch; } while (0)
+#else
+#define QL_VM_NEXT() goto dispatch
+#endif
+#define QL_VM_OP(name) case QLRegOp::name: reg_##name
+#define QL_VM_BINARY(name, expr) \
+    QL_VM_OP(name): { int64_t x = r[pc->a], y = r[pc->b]; r[pc->d] = (expr); ++pc; QL_VM_NEXT(); } \
+    QL_VM_OP(name##I): { int64_t x = r[pc->a], y = pc->imm; r[pc->d] = (expr); ++pc; QL_VM_NEXT(); }
+
+    goto dispatch;
+dispatch:
+    switch (pc->op) {
+    QL_VM_OP(MOV):
+        r[pc->d] = r[pc->a];
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(MOVI):
+        r[pc->d] = pc->imm;
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_BINARY(ADD, wrapAdd(x, y))
+    QL_VM_BINARY(SUB, wrapSub(x, y))
+    QL_VM_BINARY(MUL, wrapMul(x, y))
+    QL_VM_BINARY(LT, x < y)
+    QL_VM_BINARY(LE, x <= y)
+    QL_VM_BINARY(EQ, x == y)
+    QL_VM_OP(JMP):
+        pc = code + pc->imm;
+        QL_VM_NEXT();
+    QL_VM_OP(JZ):
+        pc = r[pc->a] == 0 ? code + pc->imm : pc + 1;
+        QL_VM_NEXT();
+    QL_VM_OP(CALL): {
+        const QLRegFunction& fn = functions[pc->imm];
+        int64_t* callee = r + pc->d;
+        if (frame == frameLimit || callee + fn.frameSize > registerLimit) goto overflow;
+        *frame++ = { pc + 1, r, pc->d };
+        std::fill(callee + fn.params, callee + fn.slots, 0);
+        r = callee;
+        pc = code + fn.entry;
+        QL_VM_NEXT();
+    }
+    QL_VM_OP(CALL_EXT): {
+        const QLCallSite& site = sites[pc->imm];
+        int64_t value;
+        if (!callNative(state.callCaches, state.natives, module.strings, static_cast<uint32_t>(pc->imm), site, site.name, r + pc->d, value, externalCalls))
+            goto arity;
+        if (site.pushesResult) r[pc->d] = value;
+        ++pc;
+        QL_VM_NEXT();
+    }
+    QL_VM_OP(CALL_DYN): {
+        const QLCallSite& site = sites[pc->imm];
+        int64_t value;
+        if (!callNative(state.callCaches, state.natives, module.strings, static_cast<uint32_t>(pc->imm), site, r[pc->a], r + pc->d, value, externalCalls))
+            goto arity;
+        r[pc->d] = value;
+        ++pc;
+        QL_VM_NEXT();
+    }
+    QL_VM_OP(RET):
+        result = r[pc->a];
+        goto leave;
+    QL_VM_OP(RETI):
+        result = pc->imm;
+        goto leave;
+    QL_VM_OP(HALT):
+        acc = r[pc->a];
+        goto finish;
+    QL_VM_OP(HALTI):
+        acc = pc->imm;
+        goto finish;
+    QL_VM_OP(HALT_ACC):
+        goto finish;
+    QL_VM_OP(SET_ACC):
+        acc = pc->imm;
+        ++pc;
+        QL_VM_NEXT();
+    QL_VM_OP(SET_FLAG):
+        flag = pc->imm != 0;
+        ++pc;
+        QL_VM_NEXT();
+    case QLRegOp::COUNT:
+        break;
+    }
+    state.error = "invalid opcode at instruction " + std::to_string(pc - code);
+    goto finish;
+leave:
+    if (frame == state.frames.data()) {
+        if (entry) {
+            state.returned = true;
+            state.result = result;
+        }
+        else acc = result;
+        goto finish;
+    }
+    --frame;
+    pc = frame->returnPc;
+    r = frame->base;
+    r[frame->result] = result;
+    QL_VM_NEXT();
+overflow:
+    state.error = "stack overflow at instruction " + std::to_string(pc - code);
+    goto finish;
+arity:
+    state.error = "native arity mismatch at instruction " + std::to_string(pc - code);
+finish:
+#undef QL_VM_BINARY
+#undef QL_VM_OP
+#undef QL_VM_NEXT
+    state.acc = acc;
+    state.flag = flag;
+    state.externalCalls = externalCalls;
+    return acc;
+}
+
+int64_t runRegisterVM(const QLRegModule& module, QLRegState& state);
@@ -0,0 +1,1766 @@
+// QuarterVMBench.cpp
+#include "QuarterVMBench.hpp"
+#include "QuarterSource.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Builds VM programs as UICL so they travel through compileUICLToBytecode
+// like any other module.
+class QLVMAssembler {
+public:
+    size_t here() const { return ops.size(); }
+
+    size_t emit(QLOpcode opcode, std::vector<std::string> operands = {}) {
+        ops.push_back({ opcode, std::move(operands) });
+        return ops.size() - 1;
+    }
+    size_t emit(QLOpcode opcode, int64_t operand) { return emit(opcode, { std::to_string(operand) }); }
+
+    void patch(size_t at, size_t target) { ops[at].operands[0] = std::to_string(target); }
+
+    const std::vector<UICLOp>& uicl() const { return ops; }
+
+private:
+    std::vector<UICLOp> ops;
+};
+
+// Entry code: push args, CALL entry, HALT. Functions follow.
+static void emitVMEntry(QLVMAssembler& as, const std::string& entry, int64_t arg) {
+    as.emit(QLOpcode::PUSH, arg);
+    as.emit(QLOpcode::CALL, { entry });
+    as.emit(QLOpcode::HALT);
+}
+
+// fib_naive(n): when n <= 1 return n, else fib_naive(n - 1) + fib_naive(n - 2)
+static void emitFibNaive(QLVMAssembler& as) {
+    as.emit(QLOpcode::FUNC, { "fib_naive", "1", "1", "n" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::LE);
+    size_t toRecurse = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::RET);
+    as.patch(toRecurse, as.here());
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::SUB);
+    as.emit(QLOpcode::CALL, { "fib_naive" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::PUSH, 2);
+    as.emit(QLOpcode::SUB);
+    as.emit(QLOpcode::CALL, { "fib_naive" });
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::RET);
+}
+
+// arith(n): for i < n, acc = acc + i * 3 - 1
+static void emitArithLoop(QLVMAssembler& as) {
+    as.emit(QLOpcode::FUNC, { "arith", "1", "1", "n" });
+    size_t head = as.here();
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::LT);
+    size_t toEnd = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::LOAD, { "acc" });
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::PUSH, 3);
+    as.emit(QLOpcode::MUL);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::SUB);
+    as.emit(QLOpcode::STORE, { "acc" });
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "i" });
+    as.emit(QLOpcode::JMP, static_cast<int64_t>(head));
+    as.patch(toEnd, as.here());
+    as.emit(QLOpcode::LOAD, { "acc" });
+    as.emit(QLOpcode::RET);
+}
+
+// constants(n): scale = 3 * 4, bias = scale - 12, one = 1 and a dead
+// n * 7 are set up front; the loop adds i * scale * one + bias to acc, with
+// a branch on bias == 0 that never goes the other way.
+static void emitConstantLoop(QLVMAssembler& as) {
+    as.emit(QLOpcode::FUNC, { "constants", "1", "1", "n" });
+    as.emit(QLOpcode::PUSH, 3);
+    as.emit(QLOpcode::STORE, { "base" });
+    as.emit(QLOpcode::LOAD, { "base" });
+    as.emit(QLOpcode::PUSH, 4);
+    as.emit(QLOpcode::MUL);
+    as.emit(QLOpcode::STORE, { "scale" });
+    as.emit(QLOpcode::LOAD, { "scale" });
+    as.emit(QLOpcode::PUSH, 12);
+    as.emit(QLOpcode::SUB);
+    as.emit(QLOpcode::STORE, { "bias" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::STORE, { "one" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::PUSH, 7);
+    as.emit(QLOpcode::MUL);
+    as.emit(QLOpcode::STORE, { "dead" });
+    size_t head = as.here();
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::LT);
+    size_t toEnd = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::LOAD, { "bias" });
+    as.emit(QLOpcode::PUSH, 0);
+    as.emit(QLOpcode::EQ);
+    size_t toNever = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::LOAD, { "acc" });
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::LOAD, { "scale" });
+    as.emit(QLOpcode::MUL);
+    as.emit(QLOpcode::LOAD, { "one" });
+    as.emit(QLOpcode::MUL);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::LOAD, { "bias" });
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "acc" });
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "i" });
+    as.emit(QLOpcode::JMP, static_cast<int64_t>(head));
+    as.patch(toNever, as.here());
+    as.emit(QLOpcode::LOAD, { "acc" });
+    as.emit(QLOpcode::PUSH, 1000);
+    as.emit(QLOpcode::SUB);
+    as.emit(QLOpcode::STORE, { "acc" });
+    as.emit(QLOpcode::JMP, static_cast<int64_t>(head));
+    as.patch(toEnd, as.here());
+    as.emit(QLOpcode::LOAD, { "acc" });
+    as.emit(QLOpcode::RET);
+}
+
+// redundant(n): for i < n, acc = acc + i * i + i * i, then a and b trade
+// places with b picking up i, and c and d swap outright; returns
+// acc + a * 7 + b * 3 + c. The repeated products and the copies through t
+// are what value numbering removes, and the swaps need parallel copies.
+static void emitRedundantLoop(QLVMAssembler& as) {
+    as.emit(QLOpcode::FUNC, { "redundant", "1", "1", "n" });
+    for (auto [slot, value] : { std::pair<const char*, int64_t>{ "a", 1 }, { "b", 2 }, { "c", 5 }, { "d", 9 } }) {
+        as.emit(QLOpcode::PUSH, value);
+        as.emit(QLOpcode::STORE, { slot });
+    }
+    size_t head = as.here();
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::LT);
+    size_t toEnd = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::LOAD, { "acc" });
+    for (int k = 0; k < 2; ++k) {
+        as.emit(QLOpcode::LOAD, { "i" });
+        as.emit(QLOpcode::LOAD, { "i" });
+        as.emit(QLOpcode::MUL);
+        as.emit(QLOpcode::ADD);
+    }
+    as.emit(QLOpcode::STORE, { "acc" });
+    as.emit(QLOpcode::LOAD, { "a" });
+    as.emit(QLOpcode::STORE, { "t" });
+    as.emit(QLOpcode::LOAD, { "b" });
+    as.emit(QLOpcode::STORE, { "a" });
+    as.emit(QLOpcode::LOAD, { "t" });
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "b" });
+    as.emit(QLOpcode::LOAD, { "c" });
+    as.emit(QLOpcode::STORE, { "t" });
+    as.emit(QLOpcode::LOAD, { "d" });
+    as.emit(QLOpcode::STORE, { "c" });
+    as.emit(QLOpcode::LOAD, { "t" });
+    as.emit(QLOpcode::STORE, { "d" });
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "i" });
+    as.emit(QLOpcode::JMP, static_cast<int64_t>(head));
+    as.patch(toEnd, as.here());
+    as.emit(QLOpcode::LOAD, { "acc" });
+    as.emit(QLOpcode::LOAD, { "a" });
+    as.emit(QLOpcode::PUSH, 7);
+    as.emit(QLOpcode::MUL);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::LOAD, { "b" });
+    as.emit(QLOpcode::PUSH, 3);
+    as.emit(QLOpcode::MUL);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::LOAD, { "c" });
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::RET);
+}
+
+static int64_t redundantLoopResult(int64_t n) {
+    uint64_t acc = 0, a = 1, b = 2, c = 5, d = 9;
+    for (uint64_t i = 0; static_cast<int64_t>(i) < n; ++i) {
+        acc += 2 * i * i;
+        uint64_t t = a;
+        a = b;
+        b = t + i;
+        std::swap(c, d);
+    }
+    return static_cast<int64_t>(acc + a * 7 + b * 3 + c);
+}
+
+// nested(n): for i < n, for j < i, acc = acc + j when j * j < i, else
+// acc = acc - 1. Two loop headers, one of them the function's first block.
+static void emitNestedLoop(QLVMAssembler& as) {
+    as.emit(QLOpcode::FUNC, { "nested", "1", "1", "n" });
+    size_t outer = as.here();
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::LT);
+    size_t toEnd = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::PUSH, 0);
+    as.emit(QLOpcode::STORE, { "j" });
+    size_t inner = as.here();
+    as.emit(QLOpcode::LOAD, { "j" });
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::LT);
+    size_t toNext = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::LOAD, { "j" });
+    as.emit(QLOpcode::LOAD, { "j" });
+    as.emit(QLOpcode::MUL);
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::LT);
+    size_t toElse = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::LOAD, { "acc" });
+    as.emit(QLOpcode::LOAD, { "j" });
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "acc" });
+    size_t toJoin = as.emit(QLOpcode::JMP, 0);
+    as.patch(toElse, as.here());
+    as.emit(QLOpcode::LOAD, { "acc" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::SUB);
+    as.emit(QLOpcode::STORE, { "acc" });
+    as.patch(toJoin, as.here());
+    as.emit(QLOpcode::LOAD, { "j" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "j" });
+    as.emit(QLOpcode::JMP, static_cast<int64_t>(inner));
+    as.patch(toNext, as.here());
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "i" });
+    as.emit(QLOpcode::JMP, static_cast<int64_t>(outer));
+    as.patch(toEnd, as.here());
+    as.emit(QLOpcode::LOAD, { "acc" });
+    as.emit(QLOpcode::RET);
+}
+
+static int64_t nestedLoopResult(int64_t n) {
+    int64_t acc = 0;
+    for (int64_t i = 0; i < n; ++i)
+        for (int64_t j = 0; j < i; ++j) acc += j * j < i ? j : -1;
+    return acc;
+}
+
+// dot_product(n): recursion.qtr's dot_product as a loop, over vectors
+// v1[idx] = idx * 3 + 1 and v2[idx] = idx * 5 + 2 generated in place (the
+// register VM has no lists). The index products are strength-reduction
+// candidates.
+static void emitDotProduct(QLVMAssembler& as) {
+    as.emit(QLOpcode::FUNC, { "dot_product", "1", "1", "n" });
+    size_t head = as.here();
+    as.emit(QLOpcode::LOAD, { "idx" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::LT);
+    size_t toEnd = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::LOAD, { "acc" });
+    for (int64_t scale : { 3, 5 }) {
+        as.emit(QLOpcode::LOAD, { "idx" });
+        as.emit(QLOpcode::PUSH, scale);
+        as.emit(QLOpcode::MUL);
+        as.emit(QLOpcode::PUSH, scale == 3 ? 1 : 2);
+        as.emit(QLOpcode::ADD);
+    }
+    as.emit(QLOpcode::MUL);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "acc" });
+    as.emit(QLOpcode::LOAD, { "idx" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "idx" });
+    as.emit(QLOpcode::JMP, static_cast<int64_t>(head));
+    as.patch(toEnd, as.here());
+    as.emit(QLOpcode::LOAD, { "acc" });
+    as.emit(QLOpcode::RET);
+}
+
+static int64_t dotProductResult(int64_t n) {
+    uint64_t acc = 0;
+    for (uint64_t idx = 0; static_cast<int64_t>(idx) < n; ++idx) acc += (idx * 3 + 1) * (idx * 5 + 2);
+    return static_cast<int64_t>(acc);
+}
+
+// matrix_multiply(n): recursion.qtr's matrix_multiply over n x n matrices
+// A[row][k] = row * n + k and B[k][col] = k * n + col. Each cell is a
+// matrix_cell call, the dot product of a row of A with a column of B, and
+// the result folds the cells in order, acc = acc * 3 + cell. row * n is
+// invariant in the dot product's loop and k * n an induction variable.
+static void emitMatrixMultiply(QLVMAssembler& as) {
+    as.emit(QLOpcode::FUNC, { "matrix_multiply", "1", "1", "n" });
+    size_t rows = as.here();
+    as.emit(QLOpcode::LOAD, { "row" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::LT);
+    size_t toEnd = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::PUSH, 0);
+    as.emit(QLOpcode::STORE, { "col" });
+    size_t cols = as.here();
+    as.emit(QLOpcode::LOAD, { "col" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::LT);
+    size_t toNextRow = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::LOAD, { "acc" });
+    as.emit(QLOpcode::PUSH, 3);
+    as.emit(QLOpcode::MUL);
+    as.emit(QLOpcode::LOAD, { "row" });
+    as.emit(QLOpcode::LOAD, { "col" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::CALL, { "matrix_cell" });
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "acc" });
+    as.emit(QLOpcode::LOAD, { "col" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "col" });
+    as.emit(QLOpcode::JMP, static_cast<int64_t>(cols));
+    as.patch(toNextRow, as.here());
+    as.emit(QLOpcode::LOAD, { "row" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "row" });
+    as.emit(QLOpcode::JMP, static_cast<int64_t>(rows));
+    as.patch(toEnd, as.here());
+    as.emit(QLOpcode::LOAD, { "acc" });
+    as.emit(QLOpcode::RET);
+
+    as.emit(QLOpcode::FUNC, { "matrix_cell", "3", "3", "row", "col", "n" });
+    size_t head = as.here();
+    as.emit(QLOpcode::LOAD, { "k" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::LT);
+    size_t toDone = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::LOAD, { "cell" });
+    as.emit(QLOpcode::LOAD, { "row" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::MUL);
+    as.emit(QLOpcode::LOAD, { "k" });
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::LOAD, { "k" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::MUL);
+    as.emit(QLOpcode::LOAD, { "col" });
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::MUL);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "cell" });
+    as.emit(QLOpcode::LOAD, { "k" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "k" });
+    as.emit(QLOpcode::JMP, static_cast<int64_t>(head));
+    as.patch(toDone, as.here());
+    as.emit(QLOpcode::LOAD, { "cell" });
+    as.emit(QLOpcode::RET);
+}
+
+static int64_t matrixMultiplyResult(int64_t n) {
+    uint64_t acc = 0, size = static_cast<uint64_t>(n);
+    for (uint64_t row = 0; static_cast<int64_t>(row) < n; ++row)
+        for (uint64_t col = 0; static_cast<int64_t>(col) < n; ++col) {
+            uint64_t cell = 0;
+            for (uint64_t k = 0; static_cast<int64_t>(k) < n; ++k) cell += (row * size + k) * (k * size + col);
+            acc = acc * 3 + cell;
+        }
+    return static_cast<int64_t>(acc);
+}
+
+// tak(x, y, z): when y < x, tak(tak(x - 1, y, z), tak(y - 1, z, x),
+// tak(z - 1, x, y)), else z. Three parameters live across three calls.
+static void emitTak(QLVMAssembler& as) {
+    as.emit(QLOpcode::FUNC, { "tak", "3", "3", "x", "y", "z" });
+    as.emit(QLOpcode::LOAD, { "y" });
+    as.emit(QLOpcode::LOAD, { "x" });
+    as.emit(QLOpcode::LT);
+    size_t toBase = as.emit(QLOpcode::JZ, 0);
+    const char* const rotations[3][3] = { { "x", "y", "z" }, { "y", "z", "x" }, { "z", "x", "y" } };
+    for (const auto& args : rotations) {
+        as.emit(QLOpcode::LOAD, { args[0] });
+        as.emit(QLOpcode::PUSH, 1);
+        as.emit(QLOpcode::SUB);
+        as.emit(QLOpcode::LOAD, { args[1] });
+        as.emit(QLOpcode::LOAD, { args[2] });
+        as.emit(QLOpcode::CALL, { "tak" });
+    }
+    as.emit(QLOpcode::CALL, { "tak" });
+    as.emit(QLOpcode::RET);
+    as.patch(toBase, as.here());
+    as.emit(QLOpcode::LOAD, { "z" });
+    as.emit(QLOpcode::RET);
+}
+
+static int64_t takResult(int64_t x, int64_t y, int64_t z) { return y < x ? takResult(takResult(x - 1, y, z), takResult(y - 1, z, x), takResult(z - 1, x, y)) : z; }
+
+static void emitPressureLoop(QLVMAssembler& as) {
+    as.emit(QLOpcode::FUNC, { "pressure", "1", "1", "n" });
+    size_t head = as.here();
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::LT);
+    size_t toEnd = as.emit(QLOpcode::JZ, 0);
+    for (int k = 0; k < QL_PRESSURE_VALUES; ++k) {
+        std::string v = "v" + std::to_string(k);
+        as.emit(QLOpcode::LOAD, { v });
+        as.emit(QLOpcode::LOAD, { "i" });
+        as.emit(QLOpcode::PUSH, k + 1 < QL_PRESSURE_VALUES ? k + 1 : QL_PRESSURE_WIDE_FACTOR);
+        as.emit(QLOpcode::MUL);
+        as.emit(QLOpcode::ADD);
+        as.emit(QLOpcode::STORE, { v });
+    }
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "i" });
+    as.emit(QLOpcode::JMP, static_cast<int64_t>(head));
+    as.patch(toEnd, as.here());
+    as.emit(QLOpcode::LOAD, { "v0" });
+    for (int k = 1; k < QL_PRESSURE_VALUES; ++k) {
+        as.emit(QLOpcode::LOAD, { "v" + std::to_string(k) });
+        as.emit(QLOpcode::ADD);
+    }
+    as.emit(QLOpcode::RET);
+}
+
+static int64_t pressureLoopResult(int64_t n) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; static_cast<int64_t>(i) < n; ++i)
+        for (int k = 0; k < QL_PRESSURE_VALUES; ++k)
+            sum += i * static_cast<uint64_t>(k + 1 < QL_PRESSURE_VALUES ? k + 1 : QL_PRESSURE_WIDE_FACTOR);
+    return static_cast<int64_t>(sum);
+}
+
+// calls(n): for i < n, x = add1(x)
+static void emitCallLoop(QLVMAssembler& as) {
+    as.emit(QLOpcode::FUNC, { "add1", "1", "1", "v" });
+    as.emit(QLOpcode::LOAD, { "v" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::RET);
+    as.emit(QLOpcode::FUNC, { "calls", "1", "1", "n" });
+    size_t head = as.here();
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::LT);
+    size_t toEnd = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::LOAD, { "x" });
+    as.emit(QLOpcode::CALL, { "add1" });
+    as.emit(QLOpcode::STORE, { "x" });
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "i" });
+    as.emit(QLOpcode::JMP, static_cast<int64_t>(head));
+    as.patch(toEnd, as.here());
+    as.emit(QLOpcode::LOAD, { "x" });
+    as.emit(QLOpcode::RET);
+}
+
+// native_calls(n): for i < n, x = add1(x), with add1 provided by a plugin
+static void emitNativeCallLoop(QLVMAssembler& as) {
+    as.emit(QLOpcode::FUNC, { "native_calls", "1", "1", "n" });
+    size_t head = as.here();
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::LT);
+    size_t toEnd = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::LOAD, { "x" });
+    as.emit(QLOpcode::CALL, { "add1", "1" });
+    as.emit(QLOpcode::STORE, { "x" });
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "i" });
+    as.emit(QLOpcode::JMP, static_cast<int64_t>(head));
+    as.patch(toEnd, as.here());
+    as.emit(QLOpcode::LOAD, { "x" });
+    as.emit(QLOpcode::RET);
+}
+
+// dynamic_calls(n): for i < n, x = f0(x), then rotate f0..fk-1 so one CALLI
+// site sees every callee in turn
+static void emitDynamicCallLoop(QLVMAssembler& as, const std::vector<std::string>& callees) {
+    auto fn = [](size_t k) { return "f" + std::to_string(k); };
+    as.emit(QLOpcode::FUNC, { "dynamic_calls", "1", "1", "n" });
+    for (size_t k = 0; k < callees.size(); ++k) {
+        as.emit(QLOpcode::FNREF, { callees[k] });
+        as.emit(QLOpcode::STORE, { fn(k) });
+    }
+    size_t head = as.here();
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::LT);
+    size_t toEnd = as.emit(QLOpcode::JZ, 0);
+    as.emit(QLOpcode::LOAD, { "x" });
+    as.emit(QLOpcode::LOAD, { fn(0) });
+    as.emit(QLOpcode::CALLI, 1);
+    as.emit(QLOpcode::STORE, { "x" });
+    as.emit(QLOpcode::LOAD, { fn(0) });
+    as.emit(QLOpcode::STORE, { "t" });
+    for (size_t k = 1; k < callees.size(); ++k) {
+        as.emit(QLOpcode::LOAD, { fn(k) });
+        as.emit(QLOpcode::STORE, { fn(k - 1) });
+    }
+    as.emit(QLOpcode::LOAD, { "t" });
+    as.emit(QLOpcode::STORE, { fn(callees.size() - 1) });
+    as.emit(QLOpcode::LOAD, { "i" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::STORE, { "i" });
+    as.emit(QLOpcode::JMP, static_cast<int64_t>(head));
+    as.patch(toEnd, as.here());
+    as.emit(QLOpcode::LOAD, { "x" });
+    as.emit(QLOpcode::RET);
+}
+
+static int64_t qlNativeAddConstant(const int64_t* args, uint32_t, void* context) {
+    return args[0] + static_cast<int64_t>(reinterpret_cast<intptr_t>(context));
+}
+
+// Plugin "math" exporting addK(x) = x + K * scale for K in 1..count.
+static std::vector<QLNativeBinding> mathPluginFunctions(int count, int scale) {
+    std::vector<QLNativeBinding> functions;
+    for (int k = 1; k <= count; ++k)
+        functions.push_back({ "add" + std::to_string(k), 1, qlNativeAddConstant, reinterpret_cast<void*>(static_cast<intptr_t>(k * scale)) });
+    return functions;
+}
+
+bool runCallCacheBenchmark(int64_t calls, int runs) {
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    QLPluginRegistry registry;
+    registry.loadPlugin("math", mathPluginFunctions(6, 1));
+    bool allMatch = true;
+
+    struct Case {
+        const char* name;
+        std::vector<UICLOp> uicl;
+        int64_t expected;
+    };
+    std::vector<Case> cases;
+    QLVMAssembler mono;
+    emitVMEntry(mono, "native_calls", calls);
+    emitNativeCallLoop(mono);
+    cases.push_back({ "monomorphic", mono.uicl(), calls });
+    for (int width : { 3, 6 }) {
+        std::vector<std::string> callees;
+        for (int k = 1; k <= width; ++k) callees.push_back("add" + std::to_string(k));
+        QLVMAssembler dyn;
+        emitVMEntry(dyn, "dynamic_calls", calls);
+        emitDynamicCallLoop(dyn, callees);
+        int64_t expected = 0;
+        for (int64_t i = 0; i < calls; ++i) expected += i % width + 1;
+        cases.push_back({ width <= QL_IC_ENTRIES ? "polymorphic" : "megamorphic", dyn.uicl(), expected });
+    }
+
+    for (const Case& c : cases) {
+        QLVMModule module;
+        QLRegModule registers;
+        std::string error;
+        if (!loadVMModule(compileUICLToBytecode(c.uicl), module, error) || !compileRegisterModule(module, registers, error)) {
+            std::cerr << "[BENCH] " << c.name << ": " << error << std::endl;
+            return false;
+        }
+        QLVMState state;
+        state.natives = &registry;
+        QLRegState regState;
+        regState.natives = &registry;
+        auto best = [&](auto run, const std::string& err) {
+            double bestMs = 1e300;
+            for (int r = 0; r < runs; ++r) {
+                auto t0 = Clock::now();
+                int64_t result = run();
+                bestMs = std::min(bestMs, Ms(Clock::now() - t0).count());
+                allMatch = allMatch && err.empty() && result == c.expected;
+            }
+            return bestMs;
+        };
+        state.callCaches.enabled = false;
+        state.callCaches.misses = 0;
+        double uncachedMs = best([&] { return runVM(module, state); }, state.error);
+        uint64_t uncachedMisses = state.callCaches.misses / runs;
+        state.callCaches.enabled = true;
+        state.callCaches.misses = 0;
+        double cachedMs = best([&] { return runVM(module, state); }, state.error);
+        uint64_t cachedMisses = state.callCaches.misses;
+        double registerMs = best([&] { return runRegisterVM(registers, regState); }, regState.error);
+        std::cout << "[BENCH] " << c.name << ": " << calls << " calls, stack VM lookup-per-call " << uncachedMs
+                  << " ms (" << uncachedMisses << " lookups), inline cache " << cachedMs << " ms (" << cachedMisses
+                  << " lookups over " << runs << " runs), " << uncachedMs / std::max(cachedMs, 1e-9)
+                  << "x; register VM cached " << registerMs << " ms\n";
+
+        // A reload must be seen by caches that are already warm.
+        registry.loadPlugin("math", mathPluginFunctions(6, 2));
+        int64_t reloaded = runVM(module, state);
+        int64_t reloadedRegisters = runRegisterVM(registers, regState);
+        allMatch = allMatch && reloaded == 2 * c.expected && reloadedRegisters == 2 * c.expected;
+        registry.loadPlugin("math", mathPluginFunctions(6, 1));
+    }
+
+    // Baseline: name lookup plus std::function call on every invocation.
+    std::unordered_map<std::string, std::function<int64_t(int64_t)>> functions;
+    functions["add1"] = [](int64_t x) { return x + 1; };
+    std::string name = "add1";
+    double mapMs = 1e300;
+    for (int r = 0; r < runs; ++r) {
+        auto t0 = Clock::now();
+        int64_t x = 0;
+        for (int64_t i = 0; i < calls; ++i) x = functions[name](x);
+        mapMs = std::min(mapMs, Ms(Clock::now() - t0).count());
+        allMatch = allMatch && x == calls;
+    }
+    std::cout << "[BENCH] std::function map dispatch (no interpreter): " << mapMs << " ms\n";
+    std::cout << "[BENCH] results match, reload invalidates caches: " << (allMatch ? "yes" : "NO") << "\n";
+    return allMatch;
+}
+
+static int64_t fibNaiveNative(int64_t n) { return n <= 1 ? n : fibNaiveNative(n - 1) + fibNaiveNative(n - 2); }
+
+struct QLVMBenchCase {
+    const char* name;
+    std::vector<UICLOp> uicl;
+    int64_t expected;
+};
+
+// Arithmetic loop, call loop, fib_naive and a capsule pipeline, each with the
+// result the same computation gives natively.
+static std::vector<QLVMBenchCase> vmBenchmarkCases(int64_t loopCount, int64_t fibN) {
+    std::vector<QLVMBenchCase> cases;
+
+    QLVMAssembler arith;
+    emitVMEntry(arith, "arith", loopCount);
+    emitArithLoop(arith);
+    int64_t arithExpected = 0;
+    for (int64_t i = 0; i < loopCount; ++i) arithExpected += i * 3 - 1;
+    cases.push_back({ "arith_loop", arith.uicl(), arithExpected });
+
+    QLVMAssembler calls;
+    emitVMEntry(calls, "calls", loopCount);
+    emitCallLoop(calls);
+    cases.push_back({ "calls", calls.uicl(), loopCount });
+
+    QLVMAssembler fib;
+    emitVMEntry(fib, "fib_naive", fibN);
+    emitFibNaive(fib);
+    cases.push_back({ "fib_naive", fib.uicl(), fibNaiveNative(fibN) });
+
+    std::vector<UICLOp> pipeline = synthesizeCapsulePipeline(static_cast<size_t>(loopCount));
+    cases.push_back({ "capsule_pipeline", pipeline, runProgram(predecodeUICL(pipeline), nullptr) });
+    return cases;
+}
+
+bool runVMBenchmark(int64_t loopCount, int64_t fibN, int runs) {
+    std::vector<QLVMBenchCase> cases = vmBenchmarkCases(loopCount, fibN);
+
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    bool allMatch = true;
+    QLVMState state;
+    QLRegState regState;
+    std::cout << "[BENCH] VM dispatch: computed goto " << (QL_VM_COMPUTED_GOTO ? "available" : "unavailable") << "\n";
+    for (const QLVMBenchCase& c : cases) {
+        QLVMModule module;
+        std::string error;
+        if (!loadVMModule(compileUICLToBytecode(c.uicl), module, error)) {
+            std::cerr << "[BENCH] " << c.name << ": load failed: " << error << std::endl;
+            return false;
+        }
+        QLRegModule registers;
+        if (!compileRegisterModule(module, registers, error)) {
+            std::cerr << "[BENCH] " << c.name << ": register compile failed: " << error << std::endl;
+            return false;
+        }
+        auto best = [&](auto run) {
+            double bestMs = 1e300;
+            int64_t result = 0;
+            for (int r = 0; r < runs; ++r) {
+                auto t0 = Clock::now();
+                result = run();
+                bestMs = std::min(bestMs, Ms(Clock::now() - t0).count());
+            }
+            allMatch = allMatch && state.error.empty() && regState.error.empty() && result == c.expected;
+            return bestMs;
+        };
+        double switchMs = best([&] { return runVM<false>(module, state); });
+        double gotoMs = best([&] { return runVM<true>(module, state); });
+        double checkedMs = best([&] { return runVM<false, false, true>(module, state); });
+        double registerMs = best([&] { return runRegisterVM(registers, regState); });
+        std::cout << "[BENCH] " << c.name << ": switch " << switchMs << " ms, goto " << gotoMs << " ms, speedup "
+                  << switchMs / std::max(gotoMs, 1e-9) << "x (" << module.code.size() << " instrs)\n";
+        std::cout << "[BENCH] " << c.name << ": checked " << checkedMs << " ms, verified goto "
+                  << checkedMs / std::max(gotoMs, 1e-9) << "x faster\n";
+        std::cout << "[BENCH] " << c.name << ": register " << registerMs << " ms, "
+                  << gotoMs / std::max(registerMs, 1e-9) << "x over stack goto (" << registers.code.size() << " instrs)\n";
+    }
+    std::cout << "[BENCH] results match native: " << (allMatch ? "yes" : "NO") << "\n";
+    return allMatch;
+}
+
+bool runVerifierTest() {
+    struct Case {
+        const char* name;
+        std::vector<UICLOp> uicl;
+        bool valid;
+    };
+    auto program = [](std::function<void(QLVMAssembler&)> body) {
+        QLVMAssembler as;
+        body(as);
+        return as.uicl();
+    };
+    std::vector<Case> cases = {
+        { "jump past end", program([](QLVMAssembler& as) { as.emit(QLOpcode::JMP, 99); }), false },
+        { "negative jump", program([](QLVMAssembler& as) { as.emit(QLOpcode::JMP, -1); }), false },
+        { "stack underflow", program([](QLVMAssembler& as) { as.emit(QLOpcode::PUSH, 1); as.emit(QLOpcode::ADD); }), false },
+        { "underflow into slots", program([](QLVMAssembler& as) {
+              as.emit(QLOpcode::PUSH, 1);
+              as.emit(QLOpcode::CALL, { "f" });
+              as.emit(QLOpcode::HALT);
+              as.emit(QLOpcode::FUNC, { "f", "1", "1", "x" });
+              as.emit(QLOpcode::POP);
+              as.emit(QLOpcode::RET);
+          }), false },
+        { "depth differs at join", program([](QLVMAssembler& as) {
+              as.emit(QLOpcode::PUSH, 0);
+              size_t skip = as.emit(QLOpcode::JZ, 0);
+              as.emit(QLOpcode::PUSH, 7);
+              as.patch(skip, as.here());
+              as.emit(QLOpcode::HALT);
+          }), false },
+        { "slot out of range", program([](QLVMAssembler& as) { as.emit(QLOpcode::LOAD, 5); }), false },
+        { "missing operand", program([](QLVMAssembler& as) { as.emit(QLOpcode::PUSH); }), false },
+        { "extra operand", program([](QLVMAssembler& as) { as.emit(QLOpcode::ADD, 1); }), false },
+        { "junk fold operand", program([](QLVMAssembler& as) { as.emit(QLOpcode::FOLD_ADD, { "12", "x3" }); }), false },
+        { "short FUNC", program([](QLVMAssembler& as) { as.emit(QLOpcode::FUNC, { "f", "1" }); }), false },
+        { "params over slots", program([](QLVMAssembler& as) { as.emit(QLOpcode::FUNC, { "f", "2", "1" }); as.emit(QLOpcode::RET); }), false },
+        { "frame wraps 32 bits", program([](QLVMAssembler& as) {
+              as.emit(QLOpcode::CALL, { "f", "0" });
+              as.emit(QLOpcode::HALT);
+              as.emit(QLOpcode::FUNC, { "f", "0", "4294967295" });
+              as.emit(QLOpcode::PUSH, 7);
+              as.emit(QLOpcode::STORE, 100);
+              as.emit(QLOpcode::PUSH, 0);
+              as.emit(QLOpcode::RET);
+          }), false },
+        { "CALL argc mismatch", program([](QLVMAssembler& as) {
+              as.emit(QLOpcode::CALL, { "f", "2" });
+              as.emit(QLOpcode::HALT);
+              as.emit(QLOpcode::FUNC, { "f", "1", "1", "x" });
+              as.emit(QLOpcode::RET);
+          }), false },
+        { "loop", program([](QLVMAssembler& as) {
+              size_t head = as.here();
+              as.emit(QLOpcode::LOAD, { "i" });
+              as.emit(QLOpcode::PUSH, 5);
+              as.emit(QLOpcode::LT);
+              size_t exit = as.emit(QLOpcode::JZ, 0);
+              as.emit(QLOpcode::LOAD, { "i" });
+              as.emit(QLOpcode::PUSH, 1);
+              as.emit(QLOpcode::ADD);
+              as.emit(QLOpcode::STORE, { "i" });
+              as.emit(QLOpcode::JMP, static_cast<int64_t>(head));
+              as.patch(exit, as.here());
+              as.emit(QLOpcode::LOAD, { "i" });
+              as.emit(QLOpcode::HALT);
+          }), true },
+        { "fib", program([](QLVMAssembler& as) { emitVMEntry(as, "fib_naive", 10); emitFibNaive(as); }), true },
+        { "capsules", program([](QLVMAssembler& as) {
+              as.emit(QLOpcode::FOLD_ADD, { "12", "30" });
+              as.emit(QLOpcode::REC_FOLD, { "5" });
+              as.emit(QLOpcode::COMPARE, { "a", "a" });
+              as.emit(QLOpcode::CALL, { "unbound" });
+          }), true },
+    };
+
+    bool pass = true;
+    for (const Case& c : cases) {
+        QLVMModule module;
+        std::string error;
+        bool loaded = loadVMModule(compileUICLToBytecode(c.uicl), module, error);
+        bool agree = true;
+        if (loaded) {
+            QLVMState fast, checked;
+            checked.forceChecked = true;
+            agree = runVM(module, fast) == runVM(module, checked) && fast.error.empty() && checked.error.empty();
+        }
+        bool ok = loaded == c.valid && agree;
+        if (!ok) std::cerr << "[TEST] verifier: " << c.name << (loaded ? " loaded" : " rejected: " + error) << std::endl;
+        pass = pass && ok;
+    }
+
+    // A checked run must stop, not crash, on a module the verifier never saw.
+    QLVMModule raw;
+    raw.code = { { 3, 0, QLVMOp::LOAD }, { 0, 0, QLVMOp::HALT } };
+    QLVMState state;
+    runVM(raw, state);
+    pass = pass && !state.error.empty();
+
+    std::cout << "[TEST] bytecode verifier: " << (pass ? "PASS" : "FAIL") << " (" << cases.size() << " modules)\n";
+    return pass;
+}
+
+bool runSuperinstructionBenchmark(int64_t loopCount, int64_t fibN, size_t limit, int runs) {
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    bool allMatch = true;
+    QLVMState state;
+    for (const QLVMBenchCase& c : vmBenchmarkCases(loopCount, fibN)) {
+        QLVMModule module;
+        std::string error;
+        if (!loadVMModule(compileUICLToBytecode(c.uicl), module, error)) {
+            std::cerr << "[BENCH] " << c.name << ": load failed: " << error << std::endl;
+            return false;
+        }
+        auto profile = [&](const QLVMModule& m, std::vector<uint64_t>& hits) {
+            hits.assign(m.code.size(), 0);
+            int64_t result = runVM<QL_VM_COMPUTED_GOTO != 0, true>(m, state, hits.data());
+            allMatch = allMatch && state.error.empty() && result == c.expected;
+            uint64_t dispatches = 0;
+            for (uint64_t h : hits) dispatches += h;
+            return dispatches;
+        };
+        auto best = [&](const QLVMModule& m) {
+            double bestMs = 1e300;
+            for (int r = 0; r < runs; ++r) {
+                auto t0 = Clock::now();
+                int64_t result = runVM(m, state);
+                bestMs = std::min(bestMs, Ms(Clock::now() - t0).count());
+                allMatch = allMatch && state.error.empty() && result == c.expected;
+            }
+            return bestMs;
+        };
+
+        std::vector<uint64_t> hits;
+        uint64_t before = profile(module, hits);
+        std::cout << "[BENCH] " << c.name << ": hot n-grams:";
+        for (const QLVMNGram& gram : hotNGrams(module, hits, 4, 4)) {
+            std::cout << " ";
+            for (size_t k = 0; k < gram.ops.size(); ++k) std::cout << (k ? "+" : "") << vmOpName(gram.ops[k]);
+            std::cout << "=" << gram.count;
+        }
+        std::cout << "\n";
+
+        QLVMModule fused = module;
+        std::vector<QLVMOp> chosen = selectSuperinstructions(module, hits, limit);
+        size_t sites = applySuperinstructions(fused, chosen);
+        uint64_t after = profile(fused, hits);
+        double baseMs = best(module);
+        double fusedMs = best(fused);
+
+        std::cout << "[BENCH] " << c.name << ": " << sites << " sites using";
+        for (QLVMOp op : chosen) std::cout << " " << vmOpName(op);
+        std::cout << "\n[BENCH] " << c.name << ": dispatches " << before << " -> " << after << " (saved "
+                  << before - after << ", " << 100.0 * (before - after) / std::max<uint64_t>(before, 1) << "%), time "
+                  << baseMs << " -> " << fusedMs << " ms, " << baseMs / std::max(fusedMs, 1e-9) << "x\n";
+    }
+    std::cout << "[BENCH] results unchanged: " << (allMatch ? "yes" : "NO") << "\n";
+    return allMatch;
+}
+
+bool runTierBenchmark(int64_t loopCount, int64_t fibN, QLTierPolicy policy, int runs) {
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    bool allMatch = true;
+    QLVMState state;
+    QLRegState regState;
+    for (const QLVMBenchCase& c : vmBenchmarkCases(loopCount, fibN)) {
+        QLVMModule module;
+        QLRegModule registers;
+        std::string error;
+        if (!loadVMModule(compileUICLToBytecode(c.uicl), module, error) || !compileRegisterModule(module, registers, error)) {
+            std::cerr << "[BENCH] " << c.name << ": load failed: " << error << std::endl;
+            return false;
+        }
+        auto best = [&](auto run) {
+            double bestMs = 1e300;
+            for (int r = 0; r < runs; ++r) {
+                auto t0 = Clock::now();
+                int64_t result = run();
+                bestMs = std::min(bestMs, Ms(Clock::now() - t0).count());
+                allMatch = allMatch && state.error.empty() && regState.error.empty() && result == c.expected;
+            }
+            return bestMs;
+        };
+        QLTierStats stats;
+        double tier0Ms = best([&] { return runVM(module, state); });
+        double registerMs = best([&] { return runRegisterVM(registers, regState); });
+        double tieredMs = best([&] {
+            QLTieredRuntime tiers(module, policy);
+            int64_t result = runTiered(module, state, tiers);
+            tiers.wait();
+            stats = tiers.stats();
+            return result;
+        });
+        std::cout << "[BENCH] " << c.name << ": tier 0 " << tier0Ms << " ms, register " << registerMs << " ms, tiered "
+                  << tieredMs << " ms (" << tier0Ms / std::max(tieredMs, 1e-9) << "x over tier 0)\n";
+        std::cout << "[BENCH] " << c.name << ": compile " << stats.compileMs * 1000 << " us, calls " << stats.calls
+                  << " (" << stats.tier1Calls << " entered tier 1, " << stats.promotedFunctions << " functions), OSR "
+                  << stats.osrEntries << " (" << stats.promotedLoops << " loops)\n";
+
+        // Once as loaded, once with every superinstruction applied.
+        QLVMModule fused = module;
+        std::vector<QLVMOp> everyFusion;
+        for (const auto& super : QL_SUPERINSTRUCTIONS) everyFusion.push_back(super.fused);
+        applySuperinstructions(fused, everyFusion);
+        for (const QLVMModule* m : { &module, &fused }) {
+            QLTieredRuntime eager(*m, { 1, 1, false });
+            allMatch = allMatch && runTiered(*m, state, eager) == c.expected && state.error.empty();
+            allMatch = allMatch && (eager.stats().compiles == 0 || eager.compiled());
+        }
+    }
+    std::cout << "[BENCH] results match native, eager transfers included: " << (allMatch ? "yes" : "NO") << "\n";
+    return allMatch;
+}
+
+bool runOptimizerBenchmark(int64_t loopCount, int64_t fibN, const std::string& repoRoot, const QLSourceLowering& lower, int runs) {
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    bool allMatch = true;
+    auto describe = [](const QLOptReport& report) {
+        std::ostringstream line;
+        size_t before = report.input;
+        double micros = 0;
+        line << report.input << " instrs";
+        for (const QLOptPass& pass : report.passes) {
+            line << ", " << pass.name << (pass.instructions > before ? " +" : " -")
+                 << (pass.instructions > before ? pass.instructions - before : before - pass.instructions);
+            before = pass.instructions;
+            micros += pass.micros;
+        }
+        line << ", layout " << (report.output > before ? "+" : "-")
+             << (report.output > before ? report.output - before : before - report.output) << " -> " << report.output << " ("
+             << 100.0 * (report.output > report.input ? static_cast<double>(report.output - report.input) : static_cast<double>(report.input - report.output)) /
+                    std::max<size_t>(report.input, 1)
+             << (report.output > report.input ? "% more, " : "% fewer, ") << micros << " us)";
+        return line.str();
+    };
+
+    std::vector<QLVMBenchCase> cases = vmBenchmarkCases(loopCount, fibN);
+    QLVMAssembler constants;
+    emitVMEntry(constants, "constants", loopCount);
+    emitConstantLoop(constants);
+    cases.push_back({ "constants", constants.uicl(), static_cast<int64_t>(12 * (static_cast<uint64_t>(loopCount) * (loopCount - 1) / 2)) });
+    QLVMAssembler redundant;
+    emitVMEntry(redundant, "redundant", loopCount);
+    emitRedundantLoop(redundant);
+    cases.push_back({ "redundant", redundant.uicl(), redundantLoopResult(loopCount) });
+    int64_t nestedN = 2;  // about loopCount inner iterations
+    while (nestedN * (nestedN - 1) / 2 < loopCount) ++nestedN;
+    QLVMAssembler nested;
+    emitVMEntry(nested, "nested", nestedN);
+    emitNestedLoop(nested);
+    cases.push_back({ "nested", nested.uicl(), nestedLoopResult(nestedN) });
+    // The same kind of loop written in QuarterLang, so the passes see what the
+    // front end emits: a constant product, a store that is never read and an
+    // identity add in the body. Literals are dozenal.
+    std::string count;
+    for (int64_t n = loopCount; n > 0; n /= 12) count.insert(count.begin(), "0123456789XY"[n % 12]);
+    std::string source = "func scaled_sum(n) {\n"
+                         "    var total = 0\n"
+                         "    var i = 0\n"
+                         "    while i < n:\n"
+                         "        val scale = 2 * 6\n"
+                         "        val unused = i * 3\n"
+                         "        total = total + i * scale + 0\n"
+                         "        i = i + 1\n"
+                         "    return total\n"
+                         "}\n"
+                         "return scaled_sum(0" + count + ")\n";
+    cases.push_back({ "source", lower(std::move(source)),
+                      static_cast<int64_t>(12 * (static_cast<uint64_t>(loopCount) * (loopCount - 1) / 2)) });
+    QLRegState state;
+    for (const QLVMBenchCase& c : cases) {
+        QLVMModule module;
+        QLRegModule plain;
+        std::string error;
+        if (!loadVMModule(compileUICLToBytecode(c.uicl), module, error) || !compileRegisterModule(module, plain, error)) {
+            std::cerr << "[BENCH] " << c.name << ": load failed: " << error << std::endl;
+            return false;
+        }
+        QLRegModule optimized = plain;
+        QLOptReport report;
+        if (!optimizeRegisterModule(optimized, error, &report)) {
+            std::cerr << "[BENCH] " << c.name << ": optimize failed: " << error << std::endl;
+            return false;
+        }
+        auto best = [&](const QLRegModule& code) {
+            double bestMs = 1e300;
+            for (int r = 0; r < runs; ++r) {
+                auto t0 = Clock::now();
+                int64_t result = runRegisterVM(code, state);
+                bestMs = std::min(bestMs, Ms(Clock::now() - t0).count());
+                allMatch = allMatch && state.error.empty() && result == c.expected;
+            }
+            return bestMs;
+        };
+        double plainMs = best(plain);
+        double optimizedMs = best(optimized);
+        std::cout << "[BENCH] " << c.name << ": " << describe(report) << "\n";
+        std::cout << "[BENCH] " << c.name << ": register " << plainMs << " ms, optimized " << optimizedMs << " ms ("
+                  << plainMs / std::max(optimizedMs, 1e-9) << "x)\n";
+    }
+
+    if (!repoRoot.empty()) {
+        size_t input = 0, output = 0;
+        for (const char* file : { "recursion.qtr", "utils.qtr", "QuarterLang_Indexter.qtr", "QuarterLang_Lexer.qtr",
+                                  "QuarterLang_Parser.qtr", "QuarterLang_SyntaxHighlighter.qtr", "InterpreterEngine.qtr", "stdlib.qtr" }) {
+            std::string source;
+            if (!QuarterSource::readFile(repoRoot + "/" + file, source)) {
+                std::cerr << "[BENCH] missing corpus file: " << file << std::endl;
+                return false;
+            }
+            QLVMModule module;
+            QLRegModule plain;
+            std::string error;
+            if (!loadVMModule(compileUICLToBytecode(lower(std::move(source))), module, error) ||
+                !compileRegisterModule(module, plain, error)) {
+                std::cerr << "[BENCH] " << file << ": load failed: " << error << std::endl;
+                return false;
+            }
+            QLRegModule optimized = plain;
+            QLOptReport report;
+            if (!optimizeRegisterModule(optimized, error, &report)) {
+                std::cerr << "[BENCH] " << file << ": optimize failed: " << error << std::endl;
+                return false;
+            }
+            QLRegState before, after;
+            int64_t expected = runRegisterVM(plain, before);
+            bool match = runRegisterVM(optimized, after) == expected && after.error == before.error &&
+                         after.externalCalls == before.externalCalls;
+            allMatch = allMatch && match;
+            input += report.input;
+            output += report.output;
+            std::cout << "[BENCH] " << file << ": " << describe(report) << (match ? "" : ", RESULT DIFFERS") << "\n";
+        }
+        std::cout << "[BENCH] corpus: " << input << " -> " << output << " instrs ("
+                  << 100.0 * (1.0 - static_cast<double>(output) / std::max<size_t>(input, 1)) << "% fewer)\n";
+    }
+    std::cout << "[BENCH] optimized results unchanged: " << (allMatch ? "yes" : "NO") << "\n";
+    return allMatch;
+}
+
+bool runSSATest(const std::string& repoRoot, const QLSourceLowering& lower) {
+    struct Program {
+        std::string name;
+        std::vector<UICLOp> uicl;
+    };
+    std::vector<Program> programs;
+    for (const QLVMBenchCase& c : vmBenchmarkCases(2000, 15)) programs.push_back({ c.name, c.uicl });
+    auto add = [&](const char* name, const char* entry, void (*emit)(QLVMAssembler&), int64_t arg = 40) {
+        QLVMAssembler as;
+        emitVMEntry(as, entry, arg);
+        emit(as);
+        programs.push_back({ name, as.uicl() });
+    };
+    add("constants", "constants", emitConstantLoop);
+    add("redundant", "redundant", emitRedundantLoop);
+    add("nested", "nested", emitNestedLoop);
+    add("dot_product", "dot_product", emitDotProduct, 43);
+    add("matrix_multiply", "matrix_multiply", emitMatrixMultiply, 7);
+    QLVMAssembler low;  // dot_product(INT64_MIN + 1), built up from immediates that fit
+    low.emit(QLOpcode::PUSH, int64_t(1) << 59);
+    low.emit(QLOpcode::PUSH, -16);
+    low.emit(QLOpcode::MUL);
+    low.emit(QLOpcode::PUSH, 1);
+    low.emit(QLOpcode::ADD);
+    low.emit(QLOpcode::CALL, { "dot_product" });
+    low.emit(QLOpcode::HALT);
+    emitDotProduct(low);
+    programs.push_back({ "dot_product (bound near INT64_MIN)", low.uicl() });
+    if (!repoRoot.empty())
+        for (const char* file : { "recursion.qtr", "utils.qtr", "QuarterLang_Indexter.qtr", "QuarterLang_SyntaxHighlighter.qtr", "stdlib.qtr" }) {
+            std::string source;
+            if (!QuarterSource::readFile(repoRoot + "/" + file, source)) {
+                std::cerr << "[TEST] missing corpus file: " << file << std::endl;
+                return false;
+            }
+            programs.push_back({ file, lower(std::move(source)) });
+        }
+
+    bool ok = true;
+    size_t regions = 0;
+    QLLoopStats loops;
+    auto fail = [&](const std::string& where, const std::string& what) {
+        std::cerr << "[TEST] ssa: " << where << ": " << what << std::endl;
+        ok = false;
+    };
+    for (const Program& p : programs) {
+        QLVMModule vm;
+        QLRegModule plain;
+        QLIRModule ir;
+        std::string error;
+        if (!loadVMModule(compileUICLToBytecode(p.uicl), vm, error) || !compileRegisterModule(vm, plain, error) ||
+            !buildIRModule(plain, ir, error)) {
+            fail(p.name, "load failed: " + error);
+            continue;
+        }
+        size_t phis = 0;
+        for (size_t f = 0; f < ir.regions.size(); ++f) {
+            QLIRFunction& fn = ir.regions[f];
+            std::string where = p.name + " region " + std::to_string(f);
+            QLIRGraph g;
+            std::vector<std::vector<uint32_t>> succs = irSuccessors(fn);
+            buildIRGraph(succs, 0, g);
+            const size_t n = fn.blocks.size();
+            if (n <= 2048) {
+                // dom[b][a]: a dominates b, as the greatest fixed point.
+                std::vector<std::vector<bool>> dom(n, std::vector<bool>(n, true));
+                dom[0].assign(n, false);
+                dom[0][0] = true;
+                for (bool changed = true; changed;) {
+                    changed = false;
+                    for (size_t i = 1; i < g.rpo.size(); ++i) {
+                        uint32_t b = g.rpo[i];
+                        std::vector<bool> meet(n, true);
+                        for (uint32_t q : g.preds[b])
+                            for (size_t a = 0; a < n; ++a) meet[a] = meet[a] && dom[q][a];
+                        meet[b] = true;
+                        if (meet != dom[b]) {
+                            dom[b] = std::move(meet);
+                            changed = true;
+                        }
+                    }
+                }
+                for (uint32_t b : g.rpo) {
+                    for (uint32_t a : g.rpo)
+                        if (g.dominates(a, b) != dom[b][a]) fail(where, "dominance of " + std::to_string(b) + " by " + std::to_string(a));
+                    std::vector<uint32_t> frontier;
+                    for (uint32_t y : g.rpo) {
+                        bool strict = b != y && dom[y][b], edge = false;
+                        for (uint32_t q : g.preds[y]) edge = edge || dom[q][b];
+                        if (edge && !strict) frontier.push_back(y);
+                    }
+                    std::vector<uint32_t> got = g.frontier[b];
+                    std::sort(got.begin(), got.end());
+                    if (got != frontier) fail(where, "frontier of block " + std::to_string(b));
+                }
+            }
+            QLSSAFunction ssa;
+            irInsertPreheaders(fn);
+            if (!buildSSA(ir, fn, ssa)) continue;
+            ++regions;
+            for (const QLSSABlock& block : ssa.blocks) phis += block.phis.size();
+            if (!verifySSA(ssa, error)) fail(where, "after construction: " + error);
+            ssaValueNumber(ssa);
+            if (!verifySSA(ssa, error)) fail(where, "after value numbering: " + error);
+            ssaOptimizeLoops(ssa, loops);
+            if (!verifySSA(ssa, error)) fail(where, "after loop optimization: " + error);
+            QLIRFunction lowered;
+            if (!lowerSSA(ir, ssa, lowered)) fail(where, "out of SSA failed");
+            else fn = std::move(lowered);
+        }
+        QLRegModule roundTrip = plain, optimized = plain;
+        lowerIRModule(ir, roundTrip);
+        if (!optimizeRegisterModule(optimized, error)) fail(p.name, "optimize failed: " + error);
+        QLRegState before, after, full;
+        int64_t expected = runRegisterVM(plain, before);
+        int64_t got = runRegisterVM(roundTrip, after), gotFull = runRegisterVM(optimized, full);
+        if (got != expected || after.error != before.error || after.externalCalls != before.externalCalls)
+            fail(p.name, "SSA round trip returned " + std::to_string(got) + ", expected " + std::to_string(expected));
+        if (gotFull != expected || full.error != before.error || full.externalCalls != before.externalCalls)
+            fail(p.name, "optimized code returned " + std::to_string(gotFull) + ", expected " + std::to_string(expected));
+        std::cout << "[TEST] ssa: " << p.name << ": " << ir.regions.size() << " regions, " << phis << " phis, "
+                  << plain.code.size() << " -> " << roundTrip.code.size() << " instrs round trip, " << optimized.code.size()
+                  << " optimized\n";
+    }
+    std::cout << "[TEST] ssa: " << loops.loops << " loops, " << loops.hoisted << " instructions hoisted, " << loops.reduced
+              << " multiplications reduced\n";
+    std::cout << "[TEST] ssa: " << (ok ? "PASS" : "FAIL") << " (" << programs.size() << " programs, " << regions << " regions)\n";
+    return ok;
+}
+
+bool runJitBenchmark(int64_t loopCount, int64_t fibN, int runs) {
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    bool allMatch = true;
+    QLVMState state;
+    std::cout << "[BENCH] baseline JIT: " << (QL_JIT_X64 ? "x86-64" : "unavailable, every function falls back") << "\n";
+    for (const QLVMBenchCase& c : vmBenchmarkCases(loopCount, fibN)) {
+        QLVMModule module;
+        QLRegModule registers;
+        std::string error;
+        if (!loadVMModule(compileUICLToBytecode(c.uicl), module, error) || !compileRegisterModule(module, registers, error)) {
+            std::cerr << "[BENCH] " << c.name << ": load failed: " << error << std::endl;
+            return false;
+        }
+        QLBaselineJIT jit;
+        double jitMicros = 1e300;
+        for (int r = 0; r < runs; ++r) {
+            if (!jit.compile(registers, error)) {
+                std::cerr << "[BENCH] " << c.name << ": JIT failed: " << error << std::endl;
+                return false;
+            }
+            jitMicros = std::min(jitMicros, jit.compileMicros);
+        }
+        auto best = [&](auto run) {
+            double bestMs = 1e300;
+            for (int r = 0; r < runs; ++r) {
+                auto t0 = Clock::now();
+                int64_t result = run();
+                bestMs = std::min(bestMs, Ms(Clock::now() - t0).count());
+                allMatch = allMatch && state.error.empty() && result == c.expected;
+            }
+            return bestMs;
+        };
+        auto tiered = [&](bool native) {
+            QLTieredRuntime tiers(module, { 1, 1, false, native });
+            return runTiered(module, state, tiers);
+        };
+        double tier0Ms = best([&] { return runVM(module, state); });
+        double registerMs = best([&] { return tiered(false); });
+        double nativeMs = best([&] { return tiered(true); });
+        std::cout << "[BENCH] " << c.name << ": JIT " << jit.compiledFunctions << " functions, " << jit.codeBytes << " bytes in "
+                  << jitMicros << " us (" << jitMicros / std::max<size_t>(jit.compiledFunctions, 1) << " us per function)\n";
+        std::cout << "[BENCH] " << c.name << ": tier 0 " << tier0Ms << " ms, register " << registerMs << " ms, native "
+                  << nativeMs << " ms (" << registerMs / std::max(nativeMs, 1e-9) << "x over register, "
+                  << tier0Ms / std::max(nativeMs, 1e-9) << "x over tier 0)\n";
+    }
+
+    QLVMAssembler as;
+    emitVMEntry(as, "outer", loopCount / 10);
+    as.emit(QLOpcode::FUNC, { "outer", "1", "1", "n" });
+    as.emit(QLOpcode::LOAD, { "n" });
+    as.emit(QLOpcode::CALL, { "arith" });
+    as.emit(QLOpcode::PUSH, 1);
+    as.emit(QLOpcode::ADD);
+    as.emit(QLOpcode::RET);
+    emitArithLoop(as);
+    QLVMModule module;
+    QLRegModule registers;
+    std::string error;
+    bool fallback = loadVMModule(compileUICLToBytecode(as.uicl()), module, error) && compileRegisterModule(module, registers, error);
+    if (fallback) {
+        int64_t expected = runVM(module, state);
+        QLTierPolicy policy{ 1, 1, false, true, registers.functions[1].entry - registers.functions[0].entry };
+        QLTieredRuntime tiers(module, policy);
+        fallback = runTiered(module, state, tiers) == expected && state.error.empty() &&
+                   tiers.stats().nativeFunctions == (QL_JIT_X64 ? 1u : 0u);
+    }
+    std::cout << "[BENCH] native caller, register-mode callee: " << (fallback ? "ok" : "FAILED") << "\n";
+
+    QLVMAssembler deep;
+    emitVMEntry(deep, "fib_naive", 30);
+    emitFibNaive(deep);
+    QLVMState small(24);
+    bool overflow = loadVMModule(compileUICLToBytecode(deep.uicl()), module, error);
+    if (overflow) {
+        QLTieredRuntime tiers(module, { 1, 1, false });
+        runTiered(module, small, tiers);
+        overflow = small.error.find("stack overflow") != std::string::npos;
+    }
+    std::cout << "[BENCH] native stack overflow reported: " << (overflow ? "ok" : "FAILED") << "\n";
+    allMatch = allMatch && fallback && overflow;
+    std::cout << "[BENCH] results match native: " << (allMatch ? "yes" : "NO") << "\n";
+    return allMatch;
+}
+
+bool runRegAllocBenchmark(int64_t loopCount, int64_t fibN, int runs) {
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    bool allMatch = true;
+    std::vector<QLVMBenchCase> cases = vmBenchmarkCases(loopCount, fibN);
+    int64_t takN = std::max<int64_t>(2, fibN / 3);
+    QLVMAssembler tak;
+    tak.emit(QLOpcode::PUSH, 3 * takN);
+    tak.emit(QLOpcode::PUSH, 2 * takN);
+    tak.emit(QLOpcode::PUSH, takN);
+    tak.emit(QLOpcode::CALL, { "tak" });
+    tak.emit(QLOpcode::HALT);
+    emitTak(tak);
+    cases.push_back({ "tak", tak.uicl(), takResult(3 * takN, 2 * takN, takN) });
+    QLVMAssembler pressure;
+    emitVMEntry(pressure, "pressure", loopCount / 10);
+    emitPressureLoop(pressure);
+    cases.push_back({ "pressure", pressure.uicl(), pressureLoopResult(loopCount / 10) });
+    QLVMAssembler redundant;
+    emitVMEntry(redundant, "redundant", loopCount);
+    emitRedundantLoop(redundant);
+    cases.push_back({ "redundant", redundant.uicl(), redundantLoopResult(loopCount) });
+
+    QLVMState state;
+    QLRegAllocStats total;
+    std::cout << "[BENCH] register allocation: " << (QL_JIT_X64 ? "x86-64" : "unavailable, every function falls back") << "\n";
+    for (const QLVMBenchCase& c : cases) {
+        QLVMModule module;
+        QLRegModule registers;
+        std::string error;
+        if (!loadVMModule(compileUICLToBytecode(c.uicl), module, error) || !compileRegisterModule(module, registers, error)) {
+            std::cerr << "[BENCH] " << c.name << ": load failed: " << error << std::endl;
+            return false;
+        }
+        QLBaselineJIT slots, allocated;
+        if (!slots.compile(registers, error) || !allocated.compile(registers, error, 1 << 16, nullptr, true)) {
+            std::cerr << "[BENCH] " << c.name << ": JIT failed: " << error << std::endl;
+            return false;
+        }
+        const QLRegAllocStats& s = allocated.allocStats;
+        total.add(s);
+        auto best = [&](bool allocate) {
+            double bestMs = 1e300;
+            for (int r = 0; r < runs; ++r) {
+                QLTierPolicy policy{ 1, 1, false, true };
+                policy.allocateRegisters = allocate;
+                QLTieredRuntime tiers(module, policy);
+                auto t0 = Clock::now();
+                int64_t result = runTiered(module, state, tiers);
+                bestMs = std::min(bestMs, Ms(Clock::now() - t0).count());
+                allMatch = allMatch && state.error.empty() && result == c.expected;
+            }
+            return bestMs;
+        };
+        double slotMs = best(false);
+        double allocatedMs = best(true);
+        std::cout << "[BENCH] " << c.name << ": " << s.intervals << " intervals, " << s.allocated << " in registers, " << s.spilled
+                  << " spilled, " << s.coalesced << " moves coalesced, " << s.calleeSaved << " callee-saved; code " << slots.codeBytes
+                  << " -> " << allocated.codeBytes << " bytes\n";
+        std::cout << "[BENCH] " << c.name << ": stack slots " << slotMs << " ms, allocated " << allocatedMs << " ms ("
+                  << slotMs / std::max(allocatedMs, 1e-9) << "x)\n";
+    }
+    std::cout << "[BENCH] total: " << total.intervals << " intervals, " << total.spilled << " spilled, " << total.coalesced
+              << " moves coalesced\n";
+    std::cout << "[BENCH] allocated results match: " << (allMatch ? "yes" : "NO") << "\n";
+    return allMatch;
+}
+
+bool runLoopBenchmark(int64_t loopCount, int64_t matrixN, int runs) {
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    bool allMatch = true;
+    std::vector<QLVMBenchCase> cases;
+    QLVMAssembler dot;
+    emitVMEntry(dot, "dot_product", loopCount);
+    emitDotProduct(dot);
+    cases.push_back({ "dot_product", dot.uicl(), dotProductResult(loopCount) });
+    QLVMAssembler matrix;
+    emitVMEntry(matrix, "matrix_multiply", matrixN);
+    emitMatrixMultiply(matrix);
+    cases.push_back({ "matrix_multiply", matrix.uicl(), matrixMultiplyResult(matrixN) });
+    int64_t nestedN = 2;
+    while (nestedN * (nestedN - 1) / 2 < loopCount) ++nestedN;
+    QLVMAssembler nested;
+    emitVMEntry(nested, "nested", nestedN);
+    emitNestedLoop(nested);
+    cases.push_back({ "nested", nested.uicl(), nestedLoopResult(nestedN) });
+    QLVMAssembler redundant;
+    emitVMEntry(redundant, "redundant", loopCount);
+    emitRedundantLoop(redundant);
+    cases.push_back({ "redundant", redundant.uicl(), redundantLoopResult(loopCount) });
+    QLVMAssembler pressure;
+    emitVMEntry(pressure, "pressure", loopCount / 10);
+    emitPressureLoop(pressure);
+    cases.push_back({ "pressure", pressure.uicl(), pressureLoopResult(loopCount / 10) });
+
+    QLRegState state;
+    QLLoopStats total;
+    for (const QLVMBenchCase& c : cases) {
+        QLVMModule module;
+        QLRegModule plain;
+        std::string error;
+        if (!loadVMModule(compileUICLToBytecode(c.uicl), module, error) || !compileRegisterModule(module, plain, error)) {
+            std::cerr << "[BENCH] " << c.name << ": load failed: " << error << std::endl;
+            return false;
+        }
+        QLRegModule baseline = plain, optimized = plain;
+        QLOptReport report;
+        if (!optimizeRegisterModule(baseline, error, nullptr, false) || !optimizeRegisterModule(optimized, error, &report)) {
+            std::cerr << "[BENCH] " << c.name << ": optimize failed: " << error << std::endl;
+            return false;
+        }
+        const QLLoopStats& s = report.loops;
+        total.add(s);
+        auto best = [&](const QLRegModule& code) {
+            double bestMs = 1e300;
+            for (int r = 0; r < runs; ++r) {
+                auto t0 = Clock::now();
+                int64_t result = runRegisterVM(code, state);
+                bestMs = std::min(bestMs, Ms(Clock::now() - t0).count());
+                allMatch = allMatch && state.error.empty() && result == c.expected;
+            }
+            return bestMs;
+        };
+        double plainMs = best(plain);
+        double baselineMs = best(baseline);
+        double loopMs = best(optimized);
+        std::cout << "[BENCH] " << c.name << ": " << s.loops << " loops, " << s.hoisted << " hoisted, " << s.reduced << " reduced, "
+                  << s.unrolled << " unrolled; " << baseline.code.size() << " -> " << optimized.code.size() << " instrs\n";
+        std::cout << "[BENCH] " << c.name << ": register " << plainMs << " ms, optimized " << baselineMs << " ms, with loop passes "
+                  << loopMs << " ms (" << baselineMs / std::max(loopMs, 1e-9) << "x)\n";
+    }
+    std::cout << "[BENCH] total: " << total.loops << " loops, " << total.hoisted << " hoisted, " << total.reduced << " reduced, "
+              << total.unrolled << " unrolled\n";
+    std::cout << "[BENCH] loop-optimized results match: " << (allMatch ? "yes" : "NO") << "\n";
+    return allMatch;
+}
+
+bool runVectorFuzzer(size_t cases, uint64_t seed) {
+    using Op = QLRegOp;
+    uint64_t rng = seed;
+    auto next = [&] {  // splitmix64
+        uint64_t z = (rng += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    };
+    auto below = [&](uint64_t n) { return static_cast<uint32_t>(next() % n); };
+    auto value = [&]() -> int64_t {
+        switch (below(4)) {
+        case 0: return int64_t(below(21)) - 10;
+        case 1: return int64_t(below(2001)) - 1000;
+        case 2: return int64_t(uint64_t(below(1u << 16)) << 32 | below(1u << 16));
+        default: return static_cast<int64_t>(next());
+        }
+    };
+    std::vector<QLSimdLevel> levels{ QLSimdLevel::None };
+    if (QL_JIT_X64) levels.push_back(QLSimdLevel::SSE2);
+    if (qlHostSimd() == QLSimdLevel::AVX2) levels.push_back(QLSimdLevel::AVX2);
+    std::vector<size_t> vectorized(levels.size(), 0);
+    size_t optimizedVectorized = 0, mismatches = 0;
+    QLRegState state;
+
+    for (size_t c = 0; c < cases; ++c) {
+        // Frame: n, invariants (the parameters), counter, induction
+        // variables, reductions, temporaries, the header's compare result.
+        const uint32_t invariants = below(4), inductions = below(4), reductions = 1 + below(3), temps = 1 + below(5);
+        const uint32_t params = 1 + invariants, counter = params, firstIV = counter + 1, firstAcc = firstIV + inductions,
+                       firstTemp = firstAcc + reductions, flag = firstTemp + temps, frame = flag + 1;
+        const int64_t step = below(8) == 0 ? 1 + below(5000) : 1 + below(3);
+        const uint32_t trips = below(8) == 0 ? below(300) : below(40);
+        const Op compares[] = { Op::LT, Op::LE, Op::LTI, Op::LEI };
+        const Op compare = compares[below(4)];
+        const bool inclusive = compare == Op::LE || compare == Op::LEI;
+        uint64_t start;
+        switch (below(3)) {
+        case 0: start = uint64_t(int64_t(below(101)) - 50); break;
+        case 1: start = uint64_t(INT64_MIN) + uint64_t(step) + 1 + below(50); break;
+        default: start = uint64_t(INT64_MAX) - (uint64_t(trips) + 3) * uint64_t(step) - below(50); break;
+        }
+        uint64_t bound = trips == 0 ? start - (inclusive ? 1 : 0) - below(uint32_t(step))
+                       : start + (uint64_t(trips) - (inclusive ? 1 : 0)) * uint64_t(step) - (inclusive ? 0 : below(uint32_t(step)));
+        if (inclusive && trips != 0) bound += below(uint32_t(step));
+        std::vector<int64_t> args{ static_cast<int64_t>(bound) };
+        for (uint32_t k = 0; k < invariants; ++k) args.push_back(value());
+
+        QLRegModule m;
+        auto emit = [&](Op op, uint32_t d, uint32_t a = 0, uint32_t b = 0, int64_t imm = 0) {
+            QLRegInstr in;
+            in.op = op;
+            in.d = static_cast<uint16_t>(d);
+            in.a = static_cast<uint16_t>(a);
+            in.b = static_cast<uint16_t>(b);
+            in.imm = imm;
+            m.code.push_back(in);
+        };
+        for (uint32_t p = 0; p < params; ++p) emit(Op::MOVI, p, 0, 0, args[p]);
+        emit(Op::CALL, 0, 0, 0, 0);
+        emit(Op::HALT, 0, 0);
+        m.topFrameSize = params;
+        m.functions.push_back({ static_cast<uint32_t>(m.code.size()), params, frame, frame });
+        emit(Op::MOVI, counter, 0, 0, static_cast<int64_t>(start));
+        for (uint32_t r = firstIV; r < firstTemp; ++r) emit(Op::MOVI, r, 0, 0, value());
+        const uint32_t header = static_cast<uint32_t>(m.code.size());
+        emit(compare, flag, counter, 0, static_cast<int64_t>(bound));
+        emit(Op::JZ, 0, flag);
+        const size_t exitJump = m.code.size() - 1;
+
+        std::vector<uint32_t> readable{ counter };
+        for (uint32_t r = 1; r < params; ++r) readable.push_back(r);
+        for (uint32_t r = firstIV; r < firstAcc; ++r) readable.push_back(r);
+        auto operand = [&] { return readable[below(static_cast<uint32_t>(readable.size()))]; };
+        const uint32_t length = 1 + below(16), split = below(length + 1);
+        int64_t firstStep = below(2) ? int64_t(below(uint32_t(step) + 1)) : step;
+        for (uint32_t k = 0; k <= length; ++k) {
+            if (k == split) emit(Op::ADDI, counter, counter, 0, firstStep);
+            if (k == length) break;
+            uint32_t roll = below(100);
+            if (roll < 45) {
+                uint32_t d = firstTemp + below(temps);
+                Op op = static_cast<Op>(below(static_cast<uint32_t>(Op::MULI) + 1));
+                emit(op, d, operand(), operand(), value());
+                if (std::find(readable.begin(), readable.end(), d) == readable.end()) readable.push_back(d);
+            } else if (roll < 75) {
+                uint32_t acc = firstAcc + below(reductions), x = operand();
+                switch (below(3)) {
+                case 0: emit(Op::ADD, acc, acc, x); break;
+                case 1: emit(Op::ADD, acc, x, acc); break;
+                default: emit(Op::SUB, acc, acc, x); break;
+                }
+            } else if (roll < 95 && inductions) {
+                uint32_t r = firstIV + below(inductions);
+                uint32_t how = below(invariants ? 4 : 2);
+                if (how < 2) emit(how ? Op::SUBI : Op::ADDI, r, r, 0, value());
+                else emit(how == 2 ? Op::ADD : Op::SUB, r, r, 1 + below(invariants));
+            } else if (roll < 97) {
+                emit(Op::LT, firstTemp + below(temps), operand(), operand());  // not arithmetic: stays scalar
+            } else {
+                emit(Op::MOV, firstTemp + below(temps), firstAcc);  // reads a reduction: stays scalar
+            }
+        }
+        emit(Op::ADDI, counter, counter, 0, step - firstStep);
+        emit(Op::JMP, 0, 0, 0, header);
+        m.code[exitJump].imm = static_cast<int64_t>(m.code.size());
+        emit(Op::MOV, flag, counter);
+        for (uint32_t r = firstIV; r < firstTemp; ++r) {
+            emit(Op::MULI, flag, flag, 0, 1000003);
+            emit(Op::ADD, flag, flag, r);
+        }
+        emit(Op::RET, 0, flag);
+
+        int64_t expected = runRegisterVM(m, state);
+        if (!state.error.empty()) {
+            std::cerr << "[FUZZ] case " << c << ": register VM failed: " << state.error << std::endl;
+            return false;
+        }
+        auto native = [&](const QLRegModule& code, QLSimdLevel level, size_t& loops) {
+            QLBaselineJIT jit;
+            jit.vectorCostModel = false;
+            std::string error;
+            if (!jit.compile(code, error, 1 << 16, nullptr, true, level) || !jit.has(0)) return expected + 1;
+            loops = jit.vectorizedLoops;
+            std::copy(args.begin(), args.end(), state.registers.begin());
+            int64_t acc = 0, result = 0;
+            bool flagOut = false;
+            uint64_t external = 0;
+            if (jit.call(0, state.registers.data(), state.registers.size(), state, acc, flagOut, external, result, error) != QLTierExit::Return)
+                return expected + 1;
+            return result;
+        };
+        auto check = [&](const char* what, QLSimdLevel level, int64_t got) {
+            if (got == expected || !QL_JIT_X64) return;
+            if (++mismatches <= 5)
+                std::cerr << "[FUZZ] case " << c << " (seed " << seed << "): " << what << " " << qlSimdName(level) << " returned " << got
+                          << ", scalar " << expected << std::endl;
+        };
+        for (size_t l = 0; l < levels.size(); ++l) {
+            size_t loops = 0;
+            check("native", levels[l], native(m, levels[l], loops));
+            vectorized[l] += loops;
+        }
+        QLRegModule optimized = m;
+        std::string error;
+        if (!optimizeRegisterModule(optimized, error)) {
+            std::cerr << "[FUZZ] case " << c << ": optimize failed: " << error << std::endl;
+            return false;
+        }
+        size_t loops = 0;
+        check("optimized", levels.back(), runRegisterVM(optimized, state));
+        check("optimized native", levels.back(), native(optimized, levels.back(), loops));
+        optimizedVectorized += loops;
+    }
+    std::cout << "[FUZZ] vectorization: " << cases << " loops, seed " << seed << "\n";
+    for (size_t l = 1; l < levels.size(); ++l)
+        std::cout << "[FUZZ] " << qlSimdName(levels[l]) << ": " << vectorized[l] << " loops vectorized\n";
+    std::cout << "[FUZZ] optimized, " << qlSimdName(levels.back()) << ": " << optimizedVectorized << " loops vectorized\n";
+    bool ok = mismatches == 0 && (!QL_JIT_X64 || vectorized.back() > 0);
+    std::cout << "[FUZZ] native results match scalar: " << (ok ? "yes" : "NO") << "\n";
+    return ok;
+}
+
+bool runVectorBenchmark(int64_t loopCount, int64_t matrixN, int runs) {
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    struct Case {
+        const char* name;
+        QLVMAssembler as;
+        int64_t arg, expected;
+    };
+    std::vector<Case> cases(4);
+    cases[0] = { "dot_product", {}, loopCount, dotProductResult(loopCount) };
+    emitVMEntry(cases[0].as, "dot_product", loopCount);
+    emitDotProduct(cases[0].as);
+    cases[1] = { "matrix_multiply", {}, matrixN, matrixMultiplyResult(matrixN) };
+    emitVMEntry(cases[1].as, "matrix_multiply", matrixN);
+    emitMatrixMultiply(cases[1].as);
+    cases[2] = { "redundant", {}, loopCount, redundantLoopResult(loopCount) };
+    emitVMEntry(cases[2].as, "redundant", loopCount);
+    emitRedundantLoop(cases[2].as);
+    cases[3] = { "pressure", {}, loopCount / 10, pressureLoopResult(loopCount / 10) };
+    emitVMEntry(cases[3].as, "pressure", loopCount / 10);
+    emitPressureLoop(cases[3].as);
+
+    std::vector<QLSimdLevel> levels{ QLSimdLevel::None };
+    if (QL_JIT_X64) levels.push_back(QLSimdLevel::SSE2);
+    if (qlHostSimd() == QLSimdLevel::AVX2) levels.push_back(QLSimdLevel::AVX2);
+    std::cout << "[BENCH] vectorization: host " << qlSimdName(qlHostSimd()) << "\n";
+    bool allMatch = true;
+    QLRegState state;
+    for (Case& c : cases) {
+        QLVMModule module;
+        QLRegModule plain;
+        std::string error;
+        if (!loadVMModule(compileUICLToBytecode(c.as.uicl()), module, error) || !compileRegisterModule(module, plain, error)) {
+            std::cerr << "[BENCH] " << c.name << ": load failed: " << error << std::endl;
+            return false;
+        }
+        QLRegModule optimized = plain;
+        if (!optimizeRegisterModule(optimized, error)) {
+            std::cerr << "[BENCH] " << c.name << ": optimize failed: " << error << std::endl;
+            return false;
+        }
+        for (const QLRegModule* code : { &plain, &optimized }) {
+            std::cout << "[BENCH] " << c.name << (code == &plain ? ", register code:" : ", optimized:");
+            double scalarMs = 0;
+            for (QLSimdLevel level : levels) {
+                QLBaselineJIT jit;
+                if (!jit.compile(*code, error, 1 << 16, nullptr, true, level)) {
+                    std::cerr << "\n[BENCH] " << c.name << ": JIT failed: " << error << std::endl;
+                    return false;
+                }
+                double bestMs = 1e300;
+                for (int r = 0; r < runs; ++r) {
+                    state.registers[0] = c.arg;
+                    int64_t acc = 0, result = 0;
+                    bool flag = false;
+                    uint64_t external = 0;
+                    auto t0 = Clock::now();
+                    QLTierExit exit = QLTierExit::Error;
+                    if (jit.has(0))
+                        exit = jit.call(0, state.registers.data(), state.registers.size(), state, acc, flag, external, result, error);
+                    bestMs = std::min(bestMs, Ms(Clock::now() - t0).count());
+                    allMatch = allMatch && exit == QLTierExit::Return && result == c.expected;
+                }
+                if (level == QLSimdLevel::None) {
+                    scalarMs = bestMs;
+                    std::cout << " scalar " << bestMs << " ms";
+                } else {
+                    std::cout << ", " << qlSimdName(level) << " " << bestMs << " ms (" << jit.vectorizedLoops << " loops, "
+                              << scalarMs / std::max(bestMs, 1e-9) << "x)";
+                }
+            }
+            std::cout << "\n";
+        }
+    }
+    std::cout << "[BENCH] vectorized results match: " << (allMatch ? "yes" : "NO") << "\n";
+    return allMatch;
+}
+
+// ======== Engine Commands ========
+struct QLVMCommandArgs {
+    int argc;
+    char** argv;
+    const QLSourceLowering& lower;
+    int64_t integer(int i, int64_t fallback) const { return argc > i ? std::stoll(argv[i]) : fallback; }
+    std::string text(int i) const { return argc > i ? argv[i] : ""; }
+};
+
+struct QLVMCommand {
+    const char* name;
+    const char* usage;
+    bool (*run)(const QLVMCommandArgs& args);
+};
+
+// Positional arguments start at argv[2]; each has the default shown.
+const QLVMCommand QL_VM_COMMANDS[] = {
+    { "--test-verifier", "", [](const QLVMCommandArgs&) { return runVerifierTest(); } },
+    { "--test-ssa", "[repo-root]", [](const QLVMCommandArgs& a) { return runSSATest(a.text(2), a.lower); } },
+    { "--bench-vm", "[loop-count] [fib-n]",
+      [](const QLVMCommandArgs& a) { return runVMBenchmark(a.integer(2, 10000000), a.integer(3, 27)); } },
+    { "--bench-super", "[loop-count] [fib-n]",
+      [](const QLVMCommandArgs& a) { return runSuperinstructionBenchmark(a.integer(2, 10000000), a.integer(3, 27)); } },
+    { "--bench-tiers", "[loop-count] [fib-n]",
+      [](const QLVMCommandArgs& a) { return runTierBenchmark(a.integer(2, 10000000), a.integer(3, 27)); } },
+    { "--bench-jit", "[loop-count] [fib-n]",
+      [](const QLVMCommandArgs& a) { return runJitBenchmark(a.integer(2, 10000000), a.integer(3, 27)); } },
+    { "--bench-opt", "[loop-count] [fib-n] [repo-root]",
+      [](const QLVMCommandArgs& a) { return runOptimizerBenchmark(a.integer(2, 10000000), a.integer(3, 27), a.text(4), a.lower); } },
+    { "--bench-regalloc", "[loop-count] [fib-n]",
+      [](const QLVMCommandArgs& a) { return runRegAllocBenchmark(a.integer(2, 10000000), a.integer(3, 27)); } },
+    { "--bench-loops", "[loop-count] [matrix-n]",
+      [](const QLVMCommandArgs& a) { return runLoopBenchmark(a.integer(2, 10000000), a.integer(3, 160)); } },
+    { "--bench-simd", "[loop-count] [matrix-n]",
+      [](const QLVMCommandArgs& a) { return runVectorBenchmark(a.integer(2, 10000000), a.integer(3, 160)); } },
+    { "--fuzz-simd", "[cases] [seed]",
+      [](const QLVMCommandArgs& a) { return runVectorFuzzer(a.integer(2, 2000), a.integer(3, 1)); } },
+    { "--bench-calls", "[calls]", [](const QLVMCommandArgs& a) { return runCallCacheBenchmark(a.integer(2, 10000000)); } },
+};
+
+bool runVMCommand(int argc, char** argv, const QLSourceLowering& lower, int& status) {
+    if (argc < 2) return false;
+    for (const QLVMCommand& command : QL_VM_COMMANDS) {
+        if (std::string_view(argv[1]) != command.name) continue;
+        status = command.run({ argc, argv, lower }) ? 0 : 1;
+        return true;
+    }
+    return false;
+}
+
+void printVMUsage(std::ostream& out, const char* program) {
+    for (const QLVMCommand& command : QL_VM_COMMANDS) {
+        out << "       " << program << " " << command.name;
+        if (*command.usage) out << " " << command.usage;
+        out << "\n";
+    }
+}
+
+bool runBytecodeOnVM(const Bytecode& bytecode, const QLVMRunOptions& options) {
+    QLVMModule module;
+    std::string error;
+    if (!loadVMModule(bytecode, module, error)) {
+        std::cerr << "Bytecode load failed: " << error << std::endl;
+        return false;
+    }
+    QLVMState state;
+    state.forceChecked = options.checked;
+    QLTieredRuntime tiers(module);
+    int64_t result = options.tiered ? runTiered(module, state, tiers) : runVM(module, state);
+    if (!state.error.empty()) {
+        std::cerr << "VM error: " << state.error << std::endl;
+        return false;
+    }
+    std::cout << "[VM] result = " << result << ", external calls = " << state.externalCalls << "\n";
+    if (options.tiered) {
+        tiers.wait();
+        QLTierStats stats = tiers.stats();
+        std::cout << "[VM] tiers: " << stats.compiles << " compiles (" << stats.compileMs << " ms), " << stats.tier1Calls
+                  << " of " << stats.calls << " calls and " << stats.osrEntries << " loop entries in register mode\n";
+        std::cout << "[VM] native: " << stats.nativeFunctions << " functions (" << stats.nativeBytes << " bytes in "
+                  << stats.jitMicros << " us), " << stats.nativeEntries << " entries, " << stats.vectorizedLoops << " loops vectorized ("
+                  << qlSimdName(qlHostSimd()) << ")\n";
+    }
+    QLRegModule registers;
+    if (!compileRegisterModule(module, registers, error)) {
+        std::cerr << "Register compile failed: " << error << std::endl;
+        return false;
+    }
+    QLRegState regState;
+    result = runRegisterVM(registers, regState);
+    if (!regState.error.empty()) {
+        std::cerr << "VM error: " << regState.error << std::endl;
+        return false;
+    }
+    std::cout << "[VM] register mode result = " << result << "\n";
+    if (options.optimize) {
+        QLOptReport report;
+        if (!optimizeRegisterModule(registers, error, &report)) {
+            std::cerr << "Optimize failed: " << error << std::endl;
+            return false;
+        }
+        result = runRegisterVM(registers, regState);
+        if (!regState.error.empty()) {
+            std::cerr << "VM error: " << regState.error << std::endl;
+            return false;
+        }
+        std::cout << "[VM] optimized register mode result = " << result << " (" << report.input << " -> " << report.output
+                  << " instrs)\n";
+    }
+    return true;
+}
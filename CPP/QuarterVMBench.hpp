@@ -0,0 +1,118 @@
+// QuarterVMBench.hpp
+// Benchmarks and self-tests for the execution engine, and the
+// --bench-*/--test-* commands that run them.
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include "QuarterJIT.hpp"
+
+// Lowers QuarterLang source to UICL. The engine does not link the front
+// end, so the transpiler passes its lowering to the commands that need one.
+using QLSourceLowering = std::function<std::vector<UICLOp>(std::string source)>;
+
+// pressure(n): fourteen accumulators, v0..v13, all live around the loop;
+// for i < n, vk = vk + i * (k + 1), with v13's factor 3000000000 to
+// take the 64-bit immediate path. Returns the sum of the vk.
+constexpr int QL_PRESSURE_VALUES = 14;
+constexpr int64_t QL_PRESSURE_WIDE_FACTOR = 3000000000;
+
+// Native call throughput with inline caches on and off, against the
+// std::function-per-name lookup the tree-walking interpreters use. Also
+// checks that reloading the plugin invalidates warm caches.
+bool runCallCacheBenchmark(int64_t calls, int runs = 3);
+
+// Dispatch microbenchmarks: each program is assembled, encoded to a module,
+// loaded, and run under both stack-VM dispatch strategies and in register
+// mode; results are checked against the same computation done natively.
+bool runVMBenchmark(int64_t loopCount, int64_t fibN, int runs = 3);
+
+// Feeds the loader modules that break one verifier rule each and checks that
+// every one is rejected, while well-formed modules (including ones whose
+// stack depth varies by path only inside a function) load and give the same
+// result checked and unchecked.
+bool runVerifierTest();
+
+// Profiles each benchmark program, rewrites it with the superinstructions
+// its profile ranks highest and reports dispatches and wall time before and
+// after, checking that results are unchanged.
+bool runSuperinstructionBenchmark(int64_t loopCount, int64_t fibN, size_t limit = 8, int runs = 3);
+
+// Times each benchmark program in tier 0 alone, in register mode alone and
+// tiered with a fresh QLTieredRuntime per run (so every run pays for warm-up
+// and the background compile), then reruns it with thresholds of 1 and an
+// inline compile so transfers happen at the first call and back edge, on the
+// module as loaded and with superinstructions.
+bool runTierBenchmark(int64_t loopCount, int64_t fibN, QLTierPolicy policy = {}, int runs = 3);
+
+// IR optimizer: instruction counts after each pass and register-mode time
+// before and after, on the VM benchmark programs plus one built around
+// foldable constants, then on the repository's .qtr corpus when a root is
+// given. Optimized code must give the same results.
+bool runOptimizerBenchmark(int64_t loopCount, int64_t fibN, const std::string& repoRoot, const QLSourceLowering& lower,
+                           int runs = 3);
+
+// SSA checks on every region of the VM benchmark programs, the optimizer's
+// loops and, given a repo root, the corpus. CHK dominators and frontiers
+// are compared against the set-based definitions. SSA is checked after
+// construction, after value numbering and after the loop passes, then
+// lowered back. The round trip, and the whole pipeline, must leave every
+// result unchanged; the loop programs run with trip counts that leave
+// unrolled loops a remainder, and with a bound whose adjustment underflows.
+bool runSSATest(const std::string& repoRoot, const QLSourceLowering& lower);
+
+// Baseline JIT: compile latency and code size per program, then each
+// program run tiered with thresholds of 1 and an inline compile, with and
+// without native code, against tier 0 alone. Also checks two fallbacks.
+// A native function calls one over the JIT's size budget, which runs in
+// register mode. A frame that does not fit fails cleanly in native code.
+bool runJitBenchmark(int64_t loopCount, int64_t fibN, int runs = 3);
+
+// Register allocation in the baseline JIT: per program, the intervals the
+// linear scan saw, how many got machine registers or were spilled, copies
+// coalesced, callee-saved registers pushed and code size. Each program is
+// then timed in native code with stack slots and with allocation. The
+// recursive workloads (fib, tak, calls) keep values live across calls, and
+// `pressure` has more live values than there are machine registers.
+bool runRegAllocBenchmark(int64_t loopCount, int64_t fibN, int runs = 3);
+
+// Loop optimization, headlined by recursion.qtr's matrix routines as loops:
+// per program, the loops found, instructions hoisted, multiplications
+// strength-reduced and loops unrolled, then register-mode time for the
+// unoptimized code, the IR pipeline without the loop passes, and with them.
+bool runLoopBenchmark(int64_t loopCount, int64_t matrixN, int runs = 3);
+
+// Vectorization fuzzer: random counted loops in register code, each run by
+// the register VM (the scalar reference) and by allocated native code at
+// every SIMD level the host has, with the cost model off so that every
+// loop that qualifies is vectorized. Bodies mix temporaries, induction
+// variables stepped by immediates and invariants, reductions, immediates
+// with high bits set, and now and then an instruction that rules the loop
+// out. Bounds are registers or immediates, with starts near INT64_MIN and
+// INT64_MAX. Each case is also run through optimizeRegisterModule, whose
+// unrolled loops must vectorize to the same results.
+bool runVectorFuzzer(size_t cases, uint64_t seed);
+
+// Vectorized native code on recursion.qtr's dot_product and
+// matrix_multiply loops, plus two loops that do not qualify: per program,
+// register code as the tiers compile it and after optimizeRegisterModule,
+// each timed as allocated native code at every SIMD level the host has.
+bool runVectorBenchmark(int64_t loopCount, int64_t matrixN, int runs = 3);
+
+// Runs the engine test or benchmark that argv[1] names, setting `status` to
+// its exit code. Returns false when argv[1] is not an engine command.
+bool runVMCommand(int argc, char** argv, const QLSourceLowering& lower, int& status);
+
+// One usage line per engine command.
+void printVMUsage(std::ostream& out, const char* program);
+
+struct QLVMRunOptions {
+    bool checked = false;   // verify every step, as untrusted modules are
+    bool tiered = false;    // run through QLTieredRuntime instead of tier 0 alone
+    bool optimize = false;  // also run the register code after optimizeRegisterModule
+};
+
+// Runs a compiled program on the stack VM, then in register mode, printing
+// each result. Returns false, after printing why, if any stage fails.
+bool runBytecodeOnVM(const Bytecode& bytecode, const QLVMRunOptions& options);
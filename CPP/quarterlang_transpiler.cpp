@@ -273,7 +273,7 @@ void generateExecutable(const Bytecode& bc, const std::string& output_path) {
 #ifdef _WIN32
     out.write("MZ", 2);
 #else
-    out.write("\x7FELF", 4);
+    out.write("\x7F" "ELF", 4);
 #endif
     for (auto byte : bc.code) out.put(static_cast<char>(byte));
     out.close();
@@ -315,16 +315,71 @@ int main(int argc, char** argv) {
 #include <memory>
 #include <regex>
 #include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <type_traits>
+#include <sstream>
+#include <functional>
+#include <thread>
+#include "QuarterKeywords.hpp"
+#include "QuarterSource.hpp"
+#include "QuarterIndentLexer.hpp"
+#include "QuarterArena.hpp"
+// The execution engine behind --run-vm and the --bench-*/--test-* engine
+// commands is built from its own translation units: QuarterBytecode.cpp,
+// QuarterVM.cpp, QuarterIR.cpp, QuarterJIT.cpp and QuarterVMBench.cpp. It is
+// the buildable counterpart of the VM, RuntimeVM, MachineEngine, Optimizer,
+// RegAllocator and QuarterLangJIT sketches in the other segments of this
+// file, which do not compile, and it runs what this pipeline lowers.
+#include "QuarterVMBench.hpp"
 #ifdef _WIN32
 #include <windows.h>
 #else
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
 #endif
 
 bool DEBUG_MODE = false;
 
+// ======== Heap Allocation Counter ========
+// Benchmark builds (-DQL_COUNT_ALLOCATIONS) replace the global operator new so
+// --bench-ast and --bench-frontend can report allocations; every other build
+// keeps the standard allocator and the reports show the counts as n/a. The
+// replacements are out of line so GCC does not pair the inlined malloc/free
+// with new/delete call sites and report a false -Wmismatched-new-delete.
+std::atomic<size_t> g_heapAllocations{ 0 };
+std::atomic<size_t> g_heapBytes{ 0 };
+
+#ifdef QL_COUNT_ALLOCATIONS
+constexpr bool QL_ALLOCATIONS_COUNTED = true;
+
+QL_NOINLINE void* operator new(size_t size) {
+    g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    g_heapBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+QL_NOINLINE void operator delete(void* p) noexcept { std::free(p); }
+QL_NOINLINE void operator delete(void* p, size_t) noexcept { std::free(p); }
+#else
+constexpr bool QL_ALLOCATIONS_COUNTED = false;
+#endif
+
+std::string allocationsText(size_t count) { return QL_ALLOCATIONS_COUNTED ? std::to_string(count) : "n/a"; }
+
 // ======== Symbol Table for Scope Awareness ========
-std::map<std::string, std::string> symbolTable;
+// Keyed by the interned identifier ID from qlSymbols.
+std::unordered_map<uint32_t, std::string> symbolTable;
 
 // ======== Step 1: QuarterLang Lexer ========
 struct QLToken {
@@ -332,7 +387,394 @@ struct QLToken {
     std::string value;
 };
 
+// Character classes for the table-driven scanner. Every byte is classified
+// once through QL_CHAR_CLASS and then drives the DFA in QL_LEXER_DFA, so the
+// whole buffer is lexed in a single linear pass.
+enum QLCharClass : uint8_t {
+    QC_OTHER,
+    QC_SPACE,
+    QC_ALPHA,   // [a-zA-Z_] minus the DG digits
+    QC_DG,      // X / Y: letters in identifiers, digits 10 / 11 in DG numbers
+    QC_DIGIT,
+    QC_SYMBOL,  // + - * / : ; ( ) { } [ ] , .
+    QC_EQ,      // =
+    QC_BANG,    // !
+    QC_ANGLE,   // < >
+    QC_COUNT
+};
+
+struct QLCharClassTable {
+    uint8_t cls[256];
+    constexpr QLCharClassTable() : cls{} {
+        for (int c = 'a'; c <= 'z'; ++c) cls[c] = QC_ALPHA;
+        for (int c = 'A'; c <= 'Z'; ++c) cls[c] = QC_ALPHA;
+        for (int c = '0'; c <= '9'; ++c) cls[c] = QC_DIGIT;
+        cls[static_cast<unsigned char>('_')] = QC_ALPHA;
+        cls[static_cast<unsigned char>('X')] = QC_DG;
+        cls[static_cast<unsigned char>('Y')] = QC_DG;
+        for (char c : { ' ', '\t', '\n', '\v', '\f', '\r' }) cls[static_cast<unsigned char>(c)] = QC_SPACE;
+        for (char c : { '+', '-', '*', '/', ':', ';', '(', ')', '{', '}', '[', ']', ',', '.' }) cls[static_cast<unsigned char>(c)] = QC_SYMBOL;
+        cls[static_cast<unsigned char>('=')] = QC_EQ;
+        cls[static_cast<unsigned char>('!')] = QC_BANG;
+        cls[static_cast<unsigned char>('<')] = QC_ANGLE;
+        cls[static_cast<unsigned char>('>')] = QC_ANGLE;
+    }
+};
+constexpr QLCharClassTable QL_CHAR_CLASS{};
+
+enum QLLexState : uint8_t {
+    QS_START,
+    QS_IDENT,
+    QS_NUMBER,
+    QS_SYMBOL,  // complete single-char symbol
+    QS_EQ,      // '=', '<' or '>' (may extend with '=')
+    QS_BANG,    // '!' (only valid as '!=')
+    QS_SYMBOL2, // '==', '!=', '<=' or '>='
+    QS_DEAD,
+    QS_COUNT
+};
+
+//                                      OTHER    SPACE    ALPHA     DG         DIGIT      SYMBOL     EQ          BANG     ANGLE
+constexpr uint8_t QL_LEXER_DFA[QS_COUNT][QC_COUNT] = {
+    /* START   */ { QS_DEAD, QS_DEAD, QS_IDENT, QS_IDENT,  QS_NUMBER, QS_SYMBOL, QS_EQ,      QS_BANG, QS_EQ },
+    /* IDENT   */ { QS_DEAD, QS_DEAD, QS_IDENT, QS_IDENT,  QS_IDENT,  QS_DEAD,   QS_DEAD,    QS_DEAD, QS_DEAD },
+    /* NUMBER  */ { QS_DEAD, QS_DEAD, QS_DEAD,  QS_NUMBER, QS_NUMBER, QS_DEAD,   QS_DEAD,    QS_DEAD, QS_DEAD },
+    /* SYMBOL  */ { QS_DEAD, QS_DEAD, QS_DEAD,  QS_DEAD,   QS_DEAD,   QS_DEAD,   QS_DEAD,    QS_DEAD, QS_DEAD },
+    /* EQ      */ { QS_DEAD, QS_DEAD, QS_DEAD,  QS_DEAD,   QS_DEAD,   QS_DEAD,   QS_SYMBOL2, QS_DEAD, QS_DEAD },
+    /* BANG    */ { QS_DEAD, QS_DEAD, QS_DEAD,  QS_DEAD,   QS_DEAD,   QS_DEAD,   QS_SYMBOL2, QS_DEAD, QS_DEAD },
+    /* SYMBOL2 */ { QS_DEAD, QS_DEAD, QS_DEAD,  QS_DEAD,   QS_DEAD,   QS_DEAD,   QS_DEAD,    QS_DEAD, QS_DEAD },
+    /* DEAD    */ { QS_DEAD, QS_DEAD, QS_DEAD,  QS_DEAD,   QS_DEAD,   QS_DEAD,   QS_DEAD,    QS_DEAD, QS_DEAD },
+};
+
+// COMMENT is only produced by the incremental (highlighter) lexer; the batch
+// scanner drops comments.
+enum class QLTokenKind : uint8_t { FUNC, END, CALL, VAL, RETURN, IDENT, NUMBER, SYMBOL, STRING, COMMENT, NONE };
+
+const char* qlTokenKindName(QLTokenKind kind) {
+    static const char* const names[] = { "FUNC", "END", "CALL", "VAL", "RETURN", "IDENT", "NUMBER", "SYMBOL", "STRING", "COMMENT", "NONE" };
+    return names[static_cast<uint8_t>(kind)];
+}
+
+// Token kind produced when the DFA stops in a given state (NONE = reject).
+constexpr QLTokenKind QL_ACCEPT[QS_COUNT] = {
+    QLTokenKind::NONE, QLTokenKind::IDENT, QLTokenKind::NUMBER, QLTokenKind::SYMBOL,
+    QLTokenKind::SYMBOL, QLTokenKind::NONE, QLTokenKind::SYMBOL, QLTokenKind::NONE
+};
+
+// Punctuators and operators, classified once by the scanner so the parser and
+// the lowering switch on them instead of comparing lexemes.
+enum class QLPunct : uint8_t {
+    NONE, PLUS, MINUS, STAR, SLASH, COLON, SEMICOLON, COMMA, DOT,
+    LPAREN, RPAREN, LBRACE, RBRACE, LBRACKET, RBRACKET,
+    ASSIGN, EQ, NE, LT, LE, GT, GE
+};
+
+constexpr QLPunct classifyPunct(const char* s, size_t len) {
+    if (len == 2) {
+        switch (s[0]) {
+        case '=': return QLPunct::EQ;
+        case '!': return QLPunct::NE;
+        case '<': return QLPunct::LE;
+        case '>': return QLPunct::GE;
+        default: return QLPunct::NONE;
+        }
+    }
+    switch (s[0]) {
+    case '+': return QLPunct::PLUS;
+    case '-': return QLPunct::MINUS;
+    case '*': return QLPunct::STAR;
+    case '/': return QLPunct::SLASH;
+    case ':': return QLPunct::COLON;
+    case ';': return QLPunct::SEMICOLON;
+    case ',': return QLPunct::COMMA;
+    case '.': return QLPunct::DOT;
+    case '(': return QLPunct::LPAREN;
+    case ')': return QLPunct::RPAREN;
+    case '{': return QLPunct::LBRACE;
+    case '}': return QLPunct::RBRACE;
+    case '[': return QLPunct::LBRACKET;
+    case ']': return QLPunct::RBRACKET;
+    case '=': return QLPunct::ASSIGN;
+    case '<': return QLPunct::LT;
+    case '>': return QLPunct::GT;
+    default: return QLPunct::NONE;
+    }
+}
+
+// Keywords the front end compares against outside switch labels. Resolving
+// them here keeps QuarterKeywords::id in a constant expression, so a
+// misspelling fails to build in C++17 too.
+constexpr uint8_t QL_KW_AS = QuarterKeywords::id("as");
+constexpr uint8_t QL_KW_DEFINE = QuarterKeywords::id("define");
+constexpr uint8_t QL_KW_ELIF = QuarterKeywords::id("elif");
+constexpr uint8_t QL_KW_ELSE = QuarterKeywords::id("else");
+constexpr uint8_t QL_KW_FALSE = QuarterKeywords::id("false");
+constexpr uint8_t QL_KW_IF = QuarterKeywords::id("if");
+constexpr uint8_t QL_KW_LET = QuarterKeywords::id("let");
+constexpr uint8_t QL_KW_LOOP = QuarterKeywords::id("loop");
+constexpr uint8_t QL_KW_MODULE = QuarterKeywords::id("module");
+constexpr uint8_t QL_KW_STAR = QuarterKeywords::id("star");
+constexpr uint8_t QL_KW_TRUE = QuarterKeywords::id("true");
+constexpr uint8_t QL_KW_VAR = QuarterKeywords::id("var");
+constexpr uint8_t QL_KW_WHEN = QuarterKeywords::id("when");
+constexpr uint8_t QL_KW_WHILE = QuarterKeywords::id("while");
+
+QLTokenKind classifyKeyword(uint8_t keyword) {
+    using QuarterKeywords::id;
+    switch (keyword) {
+    case id("func"): return QLTokenKind::FUNC;
+    case id("end"): return QLTokenKind::END;
+    case id("call"): return QLTokenKind::CALL;
+    case id("val"): return QLTokenKind::VAL;
+    case id("return"): return QLTokenKind::RETURN;
+    default: return QLTokenKind::IDENT;
+    }
+}
+
+// Single linear pass over [src, src + n). Calls emit(kind, offset, length,
+// punct, keyword) for every token, with the QLPunct of a SYMBOL and the
+// QuarterKeywords id of a word (NONE otherwise); the callback decides how (or
+// whether) to materialise it. '#'
+// comments run to the end of the line and are skipped. A """ string is one
+// STRING token up to its closing """, any other string up to the next '"' on
+// its line, the same split the incremental lexer makes.
+template <typename Emit>
+void scanQuarterLang(const char* src, size_t n, Emit&& emit) {
+    size_t pos = 0;
+    while (pos < n) {
+        uint8_t cls = QL_CHAR_CLASS.cls[static_cast<unsigned char>(src[pos])];
+        if (cls == QC_SPACE) {
+            ++pos;
+            continue;
+        }
+        // Maximal munch: run the DFA until it dies, remembering the last accept.
+        uint8_t state = QS_START;
+        size_t end = pos;
+        size_t acceptEnd = pos;
+        uint8_t acceptState = QS_DEAD;
+        while (end < n) {
+            state = QL_LEXER_DFA[state][QL_CHAR_CLASS.cls[static_cast<unsigned char>(src[end])]];
+            if (state == QS_DEAD) break;
+            ++end;
+            if (QL_ACCEPT[state] != QLTokenKind::NONE) {
+                acceptState = state;
+                acceptEnd = end;
+            }
+        }
+        if (acceptEnd == pos) {
+            if (src[pos] == '#') {
+                const void* nl = std::memchr(src + pos, '\n', n - pos);
+                pos = nl ? static_cast<size_t>(static_cast<const char*>(nl) - src) : n;
+                continue;
+            }
+            if (src[pos] == '"') {
+                std::string_view rest(src + pos, n - pos);
+                size_t length;
+                if (rest.compare(0, 3, "\"\"\"") == 0) {
+                    size_t close = rest.find("\"\"\"", 3);
+                    length = close == std::string_view::npos ? rest.size() : close + 3;
+                }
+                else {
+                    size_t close = rest.find_first_of("\"\n", 1);
+                    length = close == std::string_view::npos ? rest.size() : close + (rest[close] == '"');
+                }
+                emit(QLTokenKind::STRING, pos, length, QLPunct::NONE, QuarterKeywords::NONE);
+                pos += length;
+                continue;
+            }
+            pos++; // unrecognised byte (including UTF-8 capsule glyphs): skip it
+            continue;
+        }
+        QLTokenKind kind = QL_ACCEPT[acceptState];
+        QLPunct punct = QLPunct::NONE;
+        uint8_t keyword = QuarterKeywords::NONE;
+        if (acceptState == QS_IDENT) {
+            keyword = QuarterKeywords::lookup(std::string_view(src + pos, acceptEnd - pos));
+            kind = classifyKeyword(keyword);
+        }
+        else if (kind == QLTokenKind::SYMBOL) {
+            punct = classifyPunct(src + pos, acceptEnd - pos);
+        }
+        emit(kind, pos, acceptEnd - pos, punct, keyword);
+        pos = acceptEnd;
+    }
+}
+
 std::vector<QLToken> tokenizeQuarterLang(const std::string& code) {
+    std::vector<QLToken> tokens;
+    tokens.reserve(code.size() / 4);
+    scanQuarterLang(code.data(), code.size(), [&](QLTokenKind kind, size_t offset, size_t length, QLPunct, uint8_t) {
+        tokens.push_back(QLToken{ qlTokenKindName(kind), code.substr(offset, length) });
+    });
+    if (DEBUG_MODE) {
+        std::cout << "Tokens:\n";
+        for (const auto& tok : tokens) std::cout << tok.type << ": " << tok.value << "\n";
+    }
+    return tokens;
+}
+
+// ======== Source Buffer (mmap-backed) ========
+// Read-only view of a source file. On POSIX the file is mapped with mmap so the
+// lexer reads the page cache directly; otherwise (or if mapping fails, or the
+// input is a pipe) it is read through QuarterSource::readFile. REPL lines and
+// benchmark corpora can be wrapped through fromString.
+class QLSourceBuffer {
+public:
+    QLSourceBuffer() = default;
+    QLSourceBuffer(const QLSourceBuffer&) = delete;
+    QLSourceBuffer& operator=(const QLSourceBuffer&) = delete;
+    QLSourceBuffer(QLSourceBuffer&& other) noexcept { *this = std::move(other); }
+    QLSourceBuffer& operator=(QLSourceBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            owned = std::move(other.owned);
+            mappedBase = other.mappedBase;
+            length = other.length;
+            ptr = mappedBase ? static_cast<const char*>(mappedBase) : owned.data();
+            other.mappedBase = nullptr;
+            other.ptr = nullptr;
+            other.length = 0;
+        }
+        return *this;
+    }
+    ~QLSourceBuffer() { release(); }
+
+    static QLSourceBuffer fromString(std::string text) {
+        QLSourceBuffer buf;
+        buf.owned = std::move(text);
+        buf.ptr = buf.owned.data();
+        buf.length = buf.owned.size();
+        return buf;
+    }
+
+    // Returns false (and leaves the buffer empty) if the file cannot be read.
+    bool load(const std::string& path) {
+        release();
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size_t fileSize = static_cast<size_t>(st.st_size);
+        if (fileSize > 0) {
+            void* base = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (base != MAP_FAILED) {
+                ::madvise(base, fileSize, MADV_SEQUENTIAL);
+                mappedBase = base;
+                ptr = static_cast<const char*>(base);
+                length = fileSize;
+                ::close(fd);
+                return true;
+            }
+        }
+        ::close(fd);
+#endif
+        if (!QuarterSource::readFile(path, owned)) return false;
+        ptr = owned.data();
+        length = owned.size();
+        return true;
+    }
+
+    const char* data() const { return ptr; }
+    size_t size() const { return length; }
+    bool mapped() const { return mappedBase != nullptr; }
+    std::string_view view() const { return std::string_view(ptr, length); }
+
+private:
+    void release() {
+#ifndef _WIN32
+        if (mappedBase) ::munmap(mappedBase, length);
+#endif
+        mappedBase = nullptr;
+        owned.clear();
+        ptr = nullptr;
+        length = 0;
+    }
+
+    std::string owned;
+    void* mappedBase = nullptr;
+    const char* ptr = nullptr;
+    size_t length = 0;
+};
+
+// ======== Zero-Copy Token Stream ========
+constexpr uint32_t QL_NO_SYMBOL = 0xFFFFFFFFu;
+
+// Interns identifier spellings and hands out dense 32-bit IDs. Names live in a
+// deque so the string_view keys stay valid as the table grows.
+class QLSymbolTable {
+public:
+    uint32_t intern(std::string_view name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(names.size());
+        names.emplace_back(name);
+        ids.emplace(std::string_view(names.back()), id);
+        return id;
+    }
+
+    uint32_t lookup(std::string_view name) const {
+        auto it = ids.find(name);
+        return it == ids.end() ? QL_NO_SYMBOL : it->second;
+    }
+
+    std::string_view name(uint32_t id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+
+private:
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, uint32_t> ids;
+};
+
+QLSymbolTable qlSymbols;
+
+// 16 bytes per token, no heap allocation: the lexeme is a span into the
+// stream's source buffer and identifiers carry their interned ID.
+struct QLSpanToken {
+    QLTokenKind kind;
+    QLPunct punct;   // NONE unless kind == SYMBOL
+    uint8_t keyword; // QuarterKeywords id of a word, NONE otherwise
+    uint32_t offset;
+    uint32_t length;
+    uint32_t symbol; // QL_NO_SYMBOL unless kind == IDENT
+};
+
+struct QLTokenStream {
+    QLSourceBuffer source; // owning (or mapped) buffer every span points into
+    std::vector<QLSpanToken> tokens;
+
+    std::string_view lexeme(const QLSpanToken& tok) const {
+        return std::string_view(source.data() + tok.offset, tok.length);
+    }
+};
+
+QLTokenStream lexQuarterLang(QLSourceBuffer source, QLSymbolTable& symbols = qlSymbols) {
+    QLTokenStream stream;
+    stream.source = std::move(source);
+    stream.tokens.reserve(stream.source.size() / 4);
+    const char* src = stream.source.data();
+    scanQuarterLang(src, stream.source.size(), [&](QLTokenKind kind, size_t offset, size_t length, QLPunct punct, uint8_t keyword) {
+        uint32_t symbol = kind == QLTokenKind::IDENT
+            ? symbols.intern(std::string_view(src + offset, length))
+            : QL_NO_SYMBOL;
+        stream.tokens.push_back(QLSpanToken{ kind, punct, keyword, static_cast<uint32_t>(offset), static_cast<uint32_t>(length), symbol });
+    });
+    if (DEBUG_MODE) {
+        std::cout << "Tokens:\n";
+        for (const auto& tok : stream.tokens) std::cout << qlTokenKindName(tok.kind) << ": " << stream.lexeme(tok) << "\n";
+    }
+    return stream;
+}
+
+QLTokenStream lexQuarterLang(std::string code, QLSymbolTable& symbols = qlSymbols) {
+    return lexQuarterLang(QLSourceBuffer::fromString(std::move(code)), symbols);
+}
+
+// Previous regex-driven tokenizer, kept as the reference for runLexerBenchmark.
+std::vector<QLToken> tokenizeQuarterLangRegex(const std::string& code) {
     std::vector<QLToken> tokens;
     std::vector<std::pair<std::string, std::string>> patterns = {
         {"FUNC", R"((\bfunc\b))"},
@@ -366,167 +808,2327 @@ std::vector<QLToken> tokenizeQuarterLang(const std::string& code) {
         }
         if (!matched) pos++;
     }
-    if (DEBUG_MODE) {
-        std::cout << "Tokens:\n";
-        for (const auto& tok : tokens) std::cout << tok.type << ": " << tok.value << "\n";
-    }
     return tokens;
 }
 
+// ======== Lexer Throughput Benchmark ========
+double lexerThroughputMBs(std::vector<QLToken> (*lex)(const std::string&), const std::string& code, size_t& tokenCount) {
+    auto start = std::chrono::steady_clock::now();
+    auto tokens = lex(code);
+    std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+    tokenCount = tokens.size();
+    return (code.size() / (1024.0 * 1024.0)) / std::max(secs.count(), 1e-9);
+}
+
+void runLexerBenchmark(const std::string& corpus) {
+    // The regex lexer is quadratic, so it only gets a bounded prefix of the corpus.
+    const size_t regexBudget = 8 * 1024;
+    std::string prefix = corpus.substr(0, std::min(corpus.size(), regexBudget));
+    size_t prefixCut = prefix.find_last_of(" \t\r\n");
+    if (prefixCut != std::string::npos && prefix.size() < corpus.size()) prefix.resize(prefixCut);
+
+    size_t tableTokens = 0, regexTokens = 0, prefixTokens = 0;
+    double tableMBs = lexerThroughputMBs(tokenizeQuarterLang, corpus, tableTokens);
+
+    auto spanStart = std::chrono::steady_clock::now();
+    QLTokenStream stream = lexQuarterLang(corpus);
+    std::chrono::duration<double> spanSecs = std::chrono::steady_clock::now() - spanStart;
+    double spanMBs = (corpus.size() / (1024.0 * 1024.0)) / std::max(spanSecs.count(), 1e-9);
+    double tablePrefixMBs = lexerThroughputMBs(tokenizeQuarterLang, prefix, prefixTokens);
+    double regexMBs = lexerThroughputMBs(tokenizeQuarterLangRegex, prefix, regexTokens);
+
+    std::cout << "[BENCH] lexer corpus: " << corpus.size() << " bytes\n";
+    std::cout << "[BENCH] table-driven: " << tableMBs << " MB/s (" << tableTokens << " tokens)\n";
+    std::cout << "[BENCH] span stream:  " << spanMBs << " MB/s (" << stream.tokens.size() << " tokens, "
+              << qlSymbols.size() << " interned symbols)\n";
+    std::cout << "[BENCH] table-driven (" << prefix.size() << "-byte prefix): " << tablePrefixMBs << " MB/s (" << prefixTokens << " tokens)\n";
+    std::cout << "[BENCH] regex        (" << prefix.size() << "-byte prefix): " << regexMBs << " MB/s (" << regexTokens << " tokens)\n";
+    std::cout << "[BENCH] speedup on prefix: " << (tablePrefixMBs / std::max(regexMBs, 1e-9)) << "x\n";
+}
+
 // ======== Step 2: DCIL Capsule-Aware Instructions ========
+// Byte range in the source buffer, from the opcode keyword through its argument.
+struct QLSpan {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+// DCIL opcodes and AST node kinds share one enum; names are only for output.
+// Children, in order: FUNC name: PARAM*, BLOCK. PARAM name: [NUMBER default].
+// VAL / ASSIGN name: [value]. RETURN: [value]. WHEN: condition, then, [else]
+// (BLOCKs as a statement, an elif is a nested WHEN; values as an expression).
+// WHILE: condition, BLOCK. APPLY callee: arguments. BINARY operator: lhs, rhs.
+// CALL is a capsule call of its value and has no children.
+enum class QLNodeKind : uint8_t { PROGRAM, BLOCK, FUNC, CALL, VAL, RETURN, PARAM, ASSIGN, WHEN, WHILE, APPLY, NAME, NUMBER, BINARY, UNKNOWN };
+
+const char* qlNodeKindName(QLNodeKind kind) {
+    switch (kind) {
+    case QLNodeKind::PROGRAM: return "Program";
+    case QLNodeKind::BLOCK: return "Block";
+    case QLNodeKind::FUNC: return "FUNC";
+    case QLNodeKind::CALL: return "CALL";
+    case QLNodeKind::VAL: return "VAL";
+    case QLNodeKind::RETURN: return "RETURN";
+    case QLNodeKind::PARAM: return "PARAM";
+    case QLNodeKind::ASSIGN: return "ASSIGN";
+    case QLNodeKind::WHEN: return "WHEN";
+    case QLNodeKind::WHILE: return "WHILE";
+    case QLNodeKind::APPLY: return "APPLY";
+    case QLNodeKind::NAME: return "NAME";
+    case QLNodeKind::NUMBER: return "NUMBER";
+    case QLNodeKind::BINARY: return "BINARY";
+    default: return "UNKNOWN";
+    }
+}
+
 struct DCILInstruction {
-    std::string opcode;
+    QLNodeKind opcode = QLNodeKind::UNKNOWN;
     std::vector<std::string> args;
     std::string capsuleSymbol; // e.g. ΔΞΩ⟁🜂
+    QLTokenKind argKind = QLTokenKind::NONE; // token kind of args[0]
+    uint32_t argSymbol = QL_NO_SYMBOL;       // interned ID of args[0] if it is an identifier
+    QLSpan span;
+    uint32_t arity = 0;                      // children: the last `arity` subtrees emitted before it
+    QLPunct argPunct = QLPunct::NONE;        // operator of a BINARY
 };
 
-std::vector<DCILInstruction> generateDCIL(const std::vector<QLToken>& tokens) {
-    std::vector<DCILInstruction> dcil;
-    for (size_t i = 0; i < tokens.size(); ++i) {
-        if (tokens[i].type == "CALL") {
-            DCILInstruction instr;
-            instr.opcode = "CALL";
-            if (i + 1 < tokens.size()) instr.args.push_back(tokens[i + 1].value);
-            instr.capsuleSymbol = "Ω"; // Ω = meta-call capsule
-            dcil.push_back(instr);
+// Nesting (blocks, parentheses, operator chains) a statement may reach.
+// Deeper input does not parse, which keeps the recursive lowering well inside
+// the native stack.
+constexpr uint32_t QL_PARSE_MAX_DEPTH = 256;
+
+// The batch parser and the incremental document measure indentation alike:
+// a tab is QL_TAB_WIDTH columns, a space one. Returns the width of the blanks
+// at s[pos, n) and advances pos past them.
+constexpr uint32_t QL_TAB_WIDTH = 4;
+
+uint32_t qlSkipIndent(const char* s, size_t n, size_t& pos) {
+    uint32_t width = 0;
+    for (; pos < n && (s[pos] == ' ' || s[pos] == '\t'); ++pos) width += s[pos] == '\t' ? QL_TAB_WIDTH : 1;
+    return width;
+}
+
+// Recursive-descent parser behind generateDCIL, emitting DCIL in postfix
+// order. A block is braces, or ':' and then either one statement on the same
+// line or the lines indented under the header. A statement that does not
+// parse is dropped with the lines indented under it and its span recorded in
+// `failed`; a loop that lost a statement is dropped whole, since what was
+// lost may have been its exit. A `call` that does not parse keeps the capsule
+// lowering: CALL of the token after it.
+class QLDCILParser {
+public:
+    QLDCILParser(const QLTokenStream& stream, std::vector<DCILInstruction>& out, std::vector<QLSpan>& failed)
+        : stream(stream), tokens(stream.tokens), out(out), failed(failed), lineStart(tokens.size()), lineIndent(tokens.size()) {
+        const char* src = stream.source.data();
+        size_t scanned = 0, lineBegin = 0;
+        uint32_t indent = 0;
+        bool newline = true;
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            for (; scanned < tokens[i].offset; ++scanned) {
+                if (src[scanned] == '\n') {
+                    lineBegin = scanned + 1;
+                    newline = true;
+                }
+            }
+            if (newline) {
+                size_t blank = lineBegin;
+                indent = qlSkipIndent(src, tokens[i].offset, blank);
+            }
+            lineStart[i] = newline;
+            lineIndent[i] = indent;
+            newline = false;
+            scanned = size_t(tokens[i].offset) + tokens[i].length; // block strings hold newlines of their own
         }
     }
-    if (DEBUG_MODE) {
-        std::cout << "\nDCIL:\n";
-        for (const auto& d : dcil) std::cout << d.opcode << "(" << d.capsuleSymbol << ") " << (d.args.empty() ? "" : d.args[0]) << "\n";
+
+    void program() {
+        while (pos < tokens.size()) {
+            if (isSymbol(QLPunct::RBRACE) || isSymbol(QLPunct::SEMICOLON)) ++pos;
+            else statement(topLevel);
+        }
     }
-    return dcil;
-}
 
-// ======== Step 3: AST via Context-Free Grammar ========
-struct ASTNode {
-    std::string type;
-    std::string value;
-    std::vector<std::shared_ptr<ASTNode>> children;
-};
+private:
+    static constexpr size_t NO_TOKEN = SIZE_MAX;
 
-std::shared_ptr<ASTNode> parseDCILToAST(const std::vector<DCILInstruction>& dcil) {
-    auto root = std::make_shared<ASTNode>();
-    root->type = "Program";
-    for (auto& instr : dcil) {
-        auto node = std::make_shared<ASTNode>();
-        node->type = instr.opcode;
-        node->value = instr.args.empty() ? "" : instr.args[0];
-        root->children.push_back(node);
+    struct Nest {
+        uint32_t& depth;
+        explicit Nest(uint32_t& depth) : depth(++depth) {}
+        ~Nest() { --depth; }
+        bool tooDeep() const { return depth > QL_PARSE_MAX_DEPTH; }
+    };
+
+    bool isKind(QLTokenKind kind, size_t at) const { return at < tokens.size() && tokens[at].kind == kind; }
+    bool isKind(QLTokenKind kind) const { return isKind(kind, pos); }
+    bool isSymbol(QLPunct p, size_t at) const { return at < tokens.size() && tokens[at].punct == p; }
+    bool isSymbol(QLPunct p) const { return isSymbol(p, pos); }
+    bool isWord(uint8_t keyword) const { return isKind(QLTokenKind::IDENT) && tokens[pos].keyword == keyword; }
+    bool consume(QLPunct p) {
+        if (!isSymbol(p)) return false;
+        ++pos;
+        return true;
     }
-    if (DEBUG_MODE) {
-        std::cout << "\nAST:\n";
-        for (auto& child : root->children) std::cout << child->type << " -> " << child->value << "\n";
+    // An expression continues onto the next line only inside parentheses.
+    bool sameLine() const { return pos < tokens.size() && (parens > 0 || !lineStart[pos]); }
+    bool isComparison() const {
+        switch (pos < tokens.size() ? tokens[pos].punct : QLPunct::NONE) {
+        case QLPunct::LT: case QLPunct::LE: case QLPunct::GT: case QLPunct::GE: case QLPunct::EQ: case QLPunct::NE: return true;
+        default: return false;
+        }
+    }
+    bool atElse() const { return isWord(QL_KW_ELSE) || isWord(QL_KW_ELIF); }
+    // `end` may also close an inline block: when c: x = 1 end when
+    bool atStatementEnd() const {
+        return pos >= tokens.size() || lineStart[pos] || isSymbol(QLPunct::SEMICOLON) || isSymbol(QLPunct::RBRACE) || atElse() ||
+               isKind(QLTokenKind::END);
+    }
+    // ': type' or 'as type'
+    bool annotation() {
+        if (!consume(QLPunct::COLON) && !isWord(QL_KW_AS)) return false;
+        if (isWord(QL_KW_AS)) ++pos;
+        return true;
     }
-    return root;
-}
 
-// ======== Step 4: UICL with Dodecagram Base-12 Eval and Type Check ========
-struct UICLOp {
-    std::string opcode;
-    std::vector<std::string> operands;
-};
+    void emit(QLNodeKind kind, uint32_t arity, size_t valueToken, size_t firstToken) {
+        DCILInstruction instr;
+        instr.opcode = kind;
+        instr.arity = arity;
+        if (valueToken != NO_TOKEN) {
+            const QLSpanToken& value = tokens[valueToken];
+            instr.args.emplace_back(stream.lexeme(value));
+            instr.argKind = value.kind;
+            instr.argSymbol = value.symbol;
+            instr.argPunct = value.punct;
+        }
+        const QLSpanToken& last = tokens[pos - 1];
+        instr.span = { tokens[firstToken].offset, last.offset + last.length - tokens[firstToken].offset };
+        out.push_back(std::move(instr));
+    }
 
-int convertDG12(const std::string& dg) {
-    std::string digits = "0123456789AB";
-    int result = 0;
-    for (char c : dg) {
-        size_t pos = digits.find(c);
-        if (pos == std::string::npos) return -1;
-        result = result * 12 + static_cast<int>(pos);
+    void emitLiteral(const char* digits, size_t firstToken) {
+        emit(QLNodeKind::NUMBER, 0, NO_TOKEN, firstToken);
+        out.back().args.emplace_back(digits);
+        out.back().argKind = QLTokenKind::NUMBER;
     }
-    return result;
-}
 
-std::vector<UICLOp> convertASTToUICL(const std::shared_ptr<ASTNode>& ast) {
-    std::vector<UICLOp> uicl;
-    for (auto& node : ast->children) {
-        UICLOp op;
-        op.opcode = node->type;
-        if (!node->value.empty()) {
-            if (node->value.find_first_not_of("0123456789AB") == std::string::npos) {
-                op.operands.push_back(std::to_string(convertDG12(node->value)));
+    void emitCapsuleCall(size_t call) {
+        DCILInstruction instr;
+        instr.opcode = QLNodeKind::CALL;
+        if (call + 1 < tokens.size()) {
+            const QLSpanToken& arg = tokens[call + 1];
+            instr.args.emplace_back(stream.lexeme(arg));
+            instr.argKind = arg.kind;
+            instr.argSymbol = arg.symbol;
+            instr.span = { tokens[call].offset, arg.offset + arg.length - tokens[call].offset };
+        }
+        else {
+            instr.span = { tokens[call].offset, tokens[call].length };
+        }
+        instr.capsuleSymbol = "Ω"; // Ω = meta-call capsule
+        out.push_back(std::move(instr));
+    }
+
+    // Parses one statement into `count` more subtrees of the enclosing block
+    // (a module adds several, `star` and `end` none).
+    void statement(uint32_t& count) {
+        Nest nest(depth);
+        size_t start = pos;
+        size_t mark = out.size();
+        uint32_t before = count;
+        parens = 0;
+        if (!nest.tooDeep() && parseStatement(count) && (consume(QLPunct::SEMICOLON) || atStatementEnd())) return;
+        out.resize(mark);
+        count = before;
+        bool capsule = isKind(QLTokenKind::CALL, start);
+        if (capsule) {
+            emitCapsuleCall(start);
+            ++count;
+        }
+        // Skip the rest of the statement's line, the lines indented under it
+        // and any braces it opened, stopping at a '}' that closes an
+        // enclosing block.
+        pos = std::max(pos, start + 1);
+        uint32_t braces = 0;
+        for (; pos < tokens.size(); ++pos) {
+            if (!braces && lineStart[pos] && lineIndent[pos] <= lineIndent[start]) break;
+            if (isSymbol(QLPunct::LBRACE)) ++braces;
+            else if (isSymbol(QLPunct::RBRACE) && braces-- == 0) break;
+        }
+        if (capsule) return;
+        const QLSpanToken& last = tokens[pos - 1];
+        failed.push_back({ tokens[start].offset, last.offset + last.length - tokens[start].offset });
+    }
+
+    bool parseStatement(uint32_t& count) {
+        switch (tokens[pos].kind) {
+        case QLTokenKind::FUNC: return function(count);
+        case QLTokenKind::VAL: return declaration(count);
+        case QLTokenKind::RETURN: return returnStatement(count);
+        case QLTokenKind::CALL: return callStatement(count);
+        case QLTokenKind::END: // closes a `star` section, or a block as `end while`
+            ++pos;
+            if (isKind(QLTokenKind::IDENT) && !lineStart[pos]) ++pos;
+            return true;
+        case QLTokenKind::IDENT: break;
+        default: return false;
+        }
+        if (isWord(QL_KW_STAR)) {
+            ++pos;
+            return true;
+        }
+        if (isWord(QL_KW_DEFINE)) return function(count);
+        if (isWord(QL_KW_VAR) || isWord(QL_KW_LET)) return declaration(count);
+        if (isWord(QL_KW_WHEN) || isWord(QL_KW_IF)) return conditional(count);
+        if (isWord(QL_KW_WHILE) || isWord(QL_KW_LOOP)) return loop(count);
+        if (isWord(QL_KW_MODULE)) return module(count);
+        if (isSymbol(QLPunct::ASSIGN, pos + 1) ||
+            ((isSymbol(QLPunct::PLUS, pos + 1) || isSymbol(QLPunct::MINUS, pos + 1) || isSymbol(QLPunct::STAR, pos + 1)) &&
+             isSymbol(QLPunct::ASSIGN, pos + 2) &&
+             tokens[pos + 2].offset == tokens[pos + 1].offset + 1))
+            return assignment(count);
+        // Only a call is worth evaluating for its effect; anything else in
+        // statement position (break, pass, a stray word) does not parse.
+        if (!expression() || out.back().opcode != QLNodeKind::APPLY) return false;
+        ++count;
+        return true;
+    }
+
+    // type := name ('.' name)* ['[' ... ']' | '<' ... '>']
+    bool type() {
+        if (!isKind(QLTokenKind::IDENT)) return false;
+        ++pos;
+        while (isSymbol(QLPunct::DOT) && isKind(QLTokenKind::IDENT, pos + 1)) pos += 2;
+        QLPunct open = isSymbol(QLPunct::LBRACKET) ? QLPunct::LBRACKET : isSymbol(QLPunct::LT) ? QLPunct::LT : QLPunct::NONE;
+        if (open == QLPunct::NONE) return true;
+        QLPunct close = open == QLPunct::LBRACKET ? QLPunct::RBRACKET : QLPunct::GT;
+        uint32_t nest = 0;
+        for (; pos < tokens.size(); ++pos) {
+            if (isSymbol(open)) ++nest;
+            else if (isSymbol(close) && --nest == 0) {
+                ++pos;
+                return true;
             }
-            else {
-                if (symbolTable.find(node->value) != symbolTable.end()) {
-                    op.operands.push_back(symbolTable[node->value]);
+        }
+        return false;
+    }
+
+    // func|define name(param [: type | as type] [= default], ...)
+    //     [-> type | : type | as type] block
+    bool function(uint32_t& count) {
+        size_t start = pos++;
+        if (!isKind(QLTokenKind::IDENT)) return false;
+        size_t name = pos++;
+        if (!consume(QLPunct::LPAREN)) return false;
+        uint32_t params = 0;
+        while (!consume(QLPunct::RPAREN)) {
+            if (params && !consume(QLPunct::COMMA)) return false;
+            if (!isKind(QLTokenKind::IDENT)) return false;
+            size_t param = pos++;
+            if (annotation() && !type()) return false;
+            uint32_t arity = 0;
+            if (consume(QLPunct::ASSIGN)) {
+                // Only a number literal is kept as a default; any other
+                // default is skipped and the parameter defaults to 0.
+                if (isKind(QLTokenKind::NUMBER) && (isSymbol(QLPunct::COMMA, pos + 1) || isSymbol(QLPunct::RPAREN, pos + 1))) {
+                    if (!numberFits(pos)) return false;
+                    ++pos;
+                    emit(QLNodeKind::NUMBER, 0, pos - 1, pos - 1);
+                    arity = 1;
                 }
                 else {
-                    op.operands.push_back(node->value);
+                    uint32_t nest = 0;
+                    for (; pos < tokens.size() && (nest || !(isSymbol(QLPunct::COMMA) || isSymbol(QLPunct::RPAREN))); ++pos) {
+                        if (isSymbol(QLPunct::LPAREN) || isSymbol(QLPunct::LBRACKET) || isSymbol(QLPunct::LBRACE)) ++nest;
+                        else if (isSymbol(QLPunct::RPAREN) || isSymbol(QLPunct::RBRACKET) || isSymbol(QLPunct::RBRACE)) --nest;
+                    }
                 }
             }
+            emit(QLNodeKind::PARAM, arity, param, param);
+            ++params;
         }
-        uicl.push_back(op);
-    }
-    if (DEBUG_MODE) {
-        std::cout << "\nUICL:\n";
-        for (const auto& u : uicl) std::cout << u.opcode << " " << (u.operands.empty() ? "" : u.operands[0]) << "\n";
+        if ((isSymbol(QLPunct::MINUS) && isSymbol(QLPunct::GT, pos + 1)) || isWord(QL_KW_AS)) {
+            pos += isWord(QL_KW_AS) ? 1 : 2;
+            if (!type()) return false;
+        }
+        else if (isSymbol(QLPunct::COLON) && isKind(QLTokenKind::IDENT, pos + 1) && !lineStart[pos + 1]) {
+            size_t saved = pos++;
+            if (!type() || !isSymbol(QLPunct::LBRACE)) pos = saved;
+        }
+        if (!block(lineIndent[start])) return false;
+        emit(QLNodeKind::FUNC, params + 1, name, start);
+        ++count;
+        return true;
     }
-    return uicl;
-}
-
-// ======== Step 5: Portable Bytecode Generation ========
-struct Bytecode {
-    std::vector<uint8_t> code;
-};
 
-Bytecode compileUICLToBytecode(const std::vector<UICLOp>& uicl) {
-    Bytecode bc;
-    for (const auto& op : uicl) {
-        bc.code.push_back(static_cast<uint8_t>(op.opcode[0]));
-        for (const auto& arg : op.operands) {
-            try {
-                uint8_t val = static_cast<uint8_t>(std::stoi(arg) % 256);
-                bc.code.push_back(val);
+    bool block(uint32_t header) {
+        size_t start = pos;
+        uint32_t count = 0;
+        if (consume(QLPunct::LBRACE)) {
+            while (pos < tokens.size() && !isSymbol(QLPunct::RBRACE)) {
+                if (!consume(QLPunct::SEMICOLON)) statement(count);
             }
-            catch (...) {
-                bc.code.push_back(0);
+            consume(QLPunct::RBRACE);
+        }
+        else if (consume(QLPunct::COLON)) {
+            if (pos < tokens.size() && !lineStart[pos]) {
+                while (pos < tokens.size() && !lineStart[pos] && !isSymbol(QLPunct::RBRACE) && !atElse()) statement(count);
             }
+            else {
+                while (pos < tokens.size() && lineStart[pos] && lineIndent[pos] > header && !isSymbol(QLPunct::RBRACE))
+                    statement(count);
+            }
+        }
+        else {
+            return false;
         }
+        emit(QLNodeKind::BLOCK, count, NO_TOKEN, start);
+        return true;
     }
-    return bc;
-}
 
-// ======== Step 6: Generate Windows/Linux Executable ========
-void generateExecutable(const Bytecode& bc, const std::string& output_path) {
-    std::ofstream out(output_path, std::ios::binary);
-    if (!out) {
-        std::cerr << "Failed to open output file." << std::endl;
-        return;
+    // val|var|let name [: type | as type] [= value]
+    bool declaration(uint32_t& count) {
+        size_t start = pos++;
+        if (!isKind(QLTokenKind::IDENT)) return false;
+        size_t name = pos++;
+        if (annotation() && !type()) return false;
+        uint32_t arity = 0;
+        if (consume(QLPunct::ASSIGN)) {
+            if (!expression()) return false;
+            arity = 1;
+        }
+        emit(QLNodeKind::VAL, arity, name, start);
+        ++count;
+        return true;
+    }
+
+    // name = value, or name op= value with op one of + - *
+    bool assignment(uint32_t& count) {
+        size_t name = pos++;
+        if (consume(QLPunct::ASSIGN)) {
+            if (!expression()) return false;
+        }
+        else {
+            emit(QLNodeKind::NAME, 0, name, name);
+            size_t op = pos;
+            pos += 2;
+            if (!expression()) return false;
+            emit(QLNodeKind::BINARY, 2, op, name);
+        }
+        emit(QLNodeKind::ASSIGN, 1, name, name);
+        ++count;
+        return true;
+    }
+
+    bool returnStatement(uint32_t& count) {
+        size_t start = pos++;
+        uint32_t arity = 0;
+        if (!atStatementEnd()) {
+            if (!expression()) return false;
+            arity = 1;
+        }
+        emit(QLNodeKind::RETURN, arity, NO_TOKEN, start);
+        ++count;
+        return true;
+    }
+
+    // call name(args) calls a function; call name alone stays a capsule call.
+    bool callStatement(uint32_t& count) {
+        if (isKind(QLTokenKind::IDENT, pos + 1) && isSymbol(QLPunct::LPAREN, pos + 2)) {
+            ++pos;
+            if (!expression() || out.back().opcode != QLNodeKind::APPLY) return false;
+        }
+        else {
+            emitCapsuleCall(pos);
+            pos = std::min(pos + 2, tokens.size());
+        }
+        ++count;
+        return true;
+    }
+
+    // when|if condition block [elif condition block]* [else block]
+    bool conditional(uint32_t& count) {
+        Nest nest(depth);
+        if (nest.tooDeep()) return false;
+        size_t start = pos++;
+        uint32_t header = lineIndent[start];
+        if (!expression() || !block(header)) return false;
+        uint32_t arity = 2;
+        if (atElse() && (!lineStart[pos] || lineIndent[pos] == header)) {
+            uint32_t chained = 0;
+            if (isWord(QL_KW_ELIF)) {
+                if (!conditional(chained)) return false;
+            }
+            else {
+                ++pos;
+                if (!block(header)) return false;
+            }
+            arity = 3;
+        }
+        emit(QLNodeKind::WHEN, arity, NO_TOKEN, start);
+        ++count;
+        return true;
+    }
+
+    // while|loop condition block
+    bool loop(uint32_t& count) {
+        size_t start = pos++;
+        size_t lost = failed.size();
+        if (!expression() || !block(lineIndent[start]) || failed.size() != lost) return false;
+        emit(QLNodeKind::WHILE, 2, NO_TOKEN, start);
+        ++count;
+        return true;
+    }
+
+    // module name: followed by an indented run of top-level statements
+    bool module(uint32_t& count) {
+        uint32_t header = lineIndent[pos++];
+        if (!isKind(QLTokenKind::IDENT)) return false;
+        ++pos;
+        if (!consume(QLPunct::COLON) || (pos < tokens.size() && !lineStart[pos])) return false;
+        while (pos < tokens.size() && lineStart[pos] && lineIndent[pos] > header) statement(count);
+        return true;
+    }
+
+    // expression := when condition: value else: value | sum [comparison sum]
+    bool expression() {
+        Nest nest(depth);
+        if (nest.tooDeep()) return false;
+        size_t start = pos;
+        if (isWord(QL_KW_WHEN) || isWord(QL_KW_IF)) {
+            ++pos;
+            if (!expression() || !consume(QLPunct::COLON) || !sameLine() || !expression() || !isWord(QL_KW_ELSE)) return false;
+            ++pos;
+            if (!consume(QLPunct::COLON) || !sameLine() || !expression()) return false;
+            emit(QLNodeKind::WHEN, 3, NO_TOKEN, start);
+            return true;
+        }
+        if (!sum()) return false;
+        if (sameLine() && isComparison()) {
+            size_t op = pos++;
+            if (!sum()) return false;
+            emit(QLNodeKind::BINARY, 2, op, start);
+        }
+        return true;
+    }
+
+    // Operator chains build left-deep trees, so each link counts as nesting.
+    bool sum() {
+        size_t start = pos;
+        uint32_t outer = depth;
+        bool ok = product();
+        while (ok && sameLine() && (isSymbol(QLPunct::PLUS) || isSymbol(QLPunct::MINUS))) {
+            size_t op = pos++;
+            ok = ++depth <= QL_PARSE_MAX_DEPTH && product();
+            if (ok) emit(QLNodeKind::BINARY, 2, op, start);
+        }
+        depth = outer;
+        return ok;
+    }
+
+    bool product() {
+        size_t start = pos;
+        uint32_t outer = depth;
+        bool ok = unary();
+        while (ok && sameLine() && isSymbol(QLPunct::STAR)) {
+            size_t op = pos++;
+            ok = ++depth <= QL_PARSE_MAX_DEPTH && unary();
+            if (ok) emit(QLNodeKind::BINARY, 2, op, start);
+        }
+        depth = outer;
+        return ok;
+    }
+
+    // -x is 0 - x.
+    bool unary() {
+        Nest nest(depth);
+        if (nest.tooDeep()) return false;
+        if (!isSymbol(QLPunct::MINUS)) return primary();
+        size_t op = pos++;
+        emitLiteral("0", op);
+        if (!unary()) return false;
+        emit(QLNodeKind::BINARY, 2, op, op);
+        return true;
+    }
+
+    // A literal that overflows int64 does not parse.
+    bool numberFits(size_t at) const {
+        int64_t value;
+        return parseDG12(stream.lexeme(tokens[at]), value);
+    }
+
+    bool primary() {
+        size_t start = pos;
+        if (isKind(QLTokenKind::NUMBER)) {
+            if (!numberFits(pos)) return false;
+            ++pos;
+            emit(QLNodeKind::NUMBER, 0, start, start);
+            return true;
+        }
+        if (isWord(QL_KW_TRUE) || isWord(QL_KW_FALSE)) {
+            ++pos;
+            emitLiteral(tokens[start].keyword == QL_KW_TRUE ? "1" : "0", start);
+            return true;
+        }
+        if (isKind(QLTokenKind::IDENT)) {
+            ++pos;
+            if (!(isSymbol(QLPunct::LPAREN) && sameLine())) {
+                emit(QLNodeKind::NAME, 0, start, start);
+                return true;
+            }
+            ++pos;
+            ++parens;
+            uint32_t args = 0;
+            while (!consume(QLPunct::RPAREN)) {
+                if ((args && !consume(QLPunct::COMMA)) || !expression()) return false;
+                ++args;
+            }
+            --parens;
+            emit(QLNodeKind::APPLY, args, start, start);
+            return true;
+        }
+        if (!consume(QLPunct::LPAREN)) return false;
+        ++parens;
+        if (!expression() || !consume(QLPunct::RPAREN)) return false;
+        --parens;
+        return true;
+    }
+
+    const QLTokenStream& stream;
+    const std::vector<QLSpanToken>& tokens;
+    std::vector<DCILInstruction>& out;
+    std::vector<QLSpan>& failed;
+    std::vector<bool> lineStart;       // first token on its line
+    std::vector<uint32_t> lineIndent;  // column of the first token on the token's line
+    size_t pos = 0;
+    uint32_t depth = 0;
+    uint32_t parens = 0;
+    uint32_t topLevel = 0;             // top-level subtrees become the PROGRAM's children
+};
+
+// generateDCIL's output. `failed` holds the span of every statement that did
+// not parse and is missing from `instructions`; unless it is empty, the DCIL
+// does not say what the source says.
+struct QLDCILResult {
+    std::vector<DCILInstruction> instructions;
+    std::vector<QLSpan> failed;
+};
+
+QLDCILResult generateDCIL(const QLTokenStream& stream) {
+    QLDCILResult result;
+    QLDCILParser(stream, result.instructions, result.failed).program();
+    if (DEBUG_MODE) {
+        std::cout << "\nDCIL:\n";
+        for (const auto& d : result.instructions) {
+            std::cout << qlNodeKindName(d.opcode) << "(" << d.capsuleSymbol << ") " << (d.args.empty() ? "" : d.args[0]);
+            if (d.arity) std::cout << " /" << d.arity;
+            std::cout << "\n";
+        }
+    }
+    return result;
+}
+
+// One line per failed statement: its line number and its first line of source.
+void printParseFailures(const QLTokenStream& stream, const std::vector<QLSpan>& failed, std::ostream& out) {
+    std::string_view source = stream.source.view();
+    for (const QLSpan& span : failed) {
+        size_t line = 1 + std::count(source.begin(), source.begin() + span.offset, '\n');
+        std::string_view text = source.substr(span.offset, span.length);
+        out << "line " << line << ": statement does not parse: " << text.substr(0, text.find('\n')) << "\n";
+    }
+}
+
+// ======== Step 3: AST via Context-Free Grammar ========
+// Arena-resident node: children form an intrusive singly linked list, so
+// building a node never touches the heap.
+struct ASTNode {
+    QLNodeKind kind = QLNodeKind::UNKNOWN;
+    std::string_view value;
+    ASTNode* firstChild = nullptr;
+    ASTNode* lastChild = nullptr;
+    ASTNode* nextSibling = nullptr;
+    QLTokenKind valueKind = QLTokenKind::NONE;
+    uint32_t valueSymbol = QL_NO_SYMBOL;
+    QLPunct valuePunct = QLPunct::NONE;
+
+    void appendChild(ASTNode* child) {
+        if (lastChild) lastChild->nextSibling = child;
+        else firstChild = child;
+        lastChild = child;
+    }
+
+    struct ChildIterator {
+        ASTNode* node;
+        ASTNode* operator*() const { return node; }
+        ChildIterator& operator++() { node = node->nextSibling; return *this; }
+        bool operator!=(const ChildIterator& other) const { return node != other.node; }
+    };
+    struct ChildRange {
+        ASTNode* first;
+        ChildIterator begin() const { return { first }; }
+        ChildIterator end() const { return { nullptr }; }
+    };
+    ChildRange children() const { return { firstChild }; }
+};
+
+// DCIL is postfix: each node takes the last `arity` unclaimed subtrees as its
+// children, and whatever is left unclaimed belongs to the program.
+ASTNode* parseDCILToAST(const std::vector<DCILInstruction>& dcil, ASTArena& arena) {
+    ASTNode* root = arena.make<ASTNode>();
+    root->kind = QLNodeKind::PROGRAM;
+    // Unclaimed subtrees, newest first, chained through nextSibling.
+    ASTNode* pending = nullptr;
+    auto claim = [&](ASTNode* parent, uint32_t count) {
+        for (; count && pending; --count) {
+            ASTNode* child = pending;
+            pending = child->nextSibling;
+            child->nextSibling = parent->firstChild;
+            parent->firstChild = child;
+            if (!parent->lastChild) parent->lastChild = child;
+        }
+    };
+    for (auto& instr : dcil) {
+        ASTNode* node = arena.make<ASTNode>();
+        node->kind = instr.opcode;
+        node->value = instr.args.empty() ? std::string_view() : arena.copyString(instr.args[0]);
+        node->valueKind = instr.argKind;
+        node->valueSymbol = instr.argSymbol;
+        node->valuePunct = instr.argPunct;
+        claim(node, instr.arity);
+        node->nextSibling = pending;
+        pending = node;
+    }
+    claim(root, UINT32_MAX);
+    if (DEBUG_MODE) {
+        std::cout << "\nAST:\n";
+        for (const ASTNode* child : root->children()) std::cout << qlNodeKindName(child->kind) << " -> " << child->value << "\n";
+    }
+    return root;
+}
+
+// ======== Flat AST (Structure of Arrays) ========
+// Alternative layout for passes that walk whole programs. A node is an index
+// into parallel columns, children are first-child/next-sibling index chains
+// and values are interned IDs, so a walk touches only the columns it reads
+// and never chases a heap pointer.
+constexpr uint32_t QL_NO_NODE = 0xFFFFFFFF;
+
+class FlatAST {
+public:
+    explicit FlatAST(QLSymbolTable& values = qlSymbols) : values(&values) {}
+
+    std::vector<QLNodeKind> kind;
+    std::vector<uint32_t> firstChild;
+    std::vector<uint32_t> nextSibling;
+    std::vector<QLSpan> span;
+    std::vector<uint32_t> valueId;        // QL_NO_SYMBOL when the node has no value
+    std::vector<QLTokenKind> valueKind;   // IDENT or NUMBER for valued nodes
+    std::vector<QLPunct> valuePunct;      // operator of a BINARY
+
+    uint32_t addNode(QLNodeKind k, QLSpan s = {}, uint32_t value = QL_NO_SYMBOL, QLTokenKind vk = QLTokenKind::NONE,
+                     QLPunct punct = QLPunct::NONE) {
+        uint32_t id = static_cast<uint32_t>(kind.size());
+        kind.push_back(k);
+        firstChild.push_back(QL_NO_NODE);
+        nextSibling.push_back(QL_NO_NODE);
+        lastChild.push_back(QL_NO_NODE);
+        span.push_back(s);
+        valueId.push_back(value);
+        valueKind.push_back(vk);
+        valuePunct.push_back(punct);
+        return id;
+    }
+
+    void appendChild(uint32_t parent, uint32_t child) {
+        if (lastChild[parent] != QL_NO_NODE) nextSibling[lastChild[parent]] = child;
+        else firstChild[parent] = child;
+        lastChild[parent] = child;
+    }
+
+    void reserve(size_t nodes) {
+        kind.reserve(nodes);
+        firstChild.reserve(nodes);
+        nextSibling.reserve(nodes);
+        lastChild.reserve(nodes);
+        span.reserve(nodes);
+        valueId.reserve(nodes);
+        valueKind.reserve(nodes);
+        valuePunct.reserve(nodes);
+    }
+
+    size_t size() const { return kind.size(); }
+    uint32_t root() const { return 0; }
+
+    std::string_view value(uint32_t node) const {
+        return valueId[node] == QL_NO_SYMBOL ? std::string_view() : values->name(valueId[node]);
+    }
+
+    size_t columnBytes() const {
+        return size() * (sizeof(QLNodeKind) + 3 * sizeof(uint32_t) + sizeof(QLSpan) + sizeof(uint32_t) + sizeof(QLTokenKind) +
+                         sizeof(QLPunct));
+    }
+
+    template <typename Visit>
+    void forEachChild(uint32_t node, Visit&& visit) const {
+        for (uint32_t c = firstChild[node]; c != QL_NO_NODE; c = nextSibling[c]) visit(c);
+    }
+
+    // Pre-order walk without recursion. enter(node, depth) runs before a
+    // node's children and leave(node, depth) after them, which is what
+    // scope-tracking passes and exporters need.
+    template <typename Enter, typename Leave>
+    void walk(uint32_t from, Enter&& enter, Leave&& leave) const {
+        struct Frame { uint32_t node; uint32_t next; };
+        std::vector<Frame> stack;
+        enter(from, 0u);
+        stack.push_back({ from, firstChild[from] });
+        while (!stack.empty()) {
+            Frame& top = stack.back();
+            if (top.next == QL_NO_NODE) {
+                leave(top.node, static_cast<uint32_t>(stack.size() - 1));
+                stack.pop_back();
+                continue;
+            }
+            uint32_t child = top.next;
+            top.next = nextSibling[child];
+            enter(child, static_cast<uint32_t>(stack.size()));
+            stack.push_back({ child, firstChild[child] });
+        }
+    }
+
+    template <typename Enter>
+    void walk(uint32_t from, Enter&& enter) const {
+        walk(from, std::forward<Enter>(enter), [](uint32_t, uint32_t) {});
+    }
+
+private:
+    std::vector<uint32_t> lastChild;      // build-time only
+    QLSymbolTable* values;
+};
+
+FlatAST buildFlatAST(const std::vector<DCILInstruction>& dcil, QLSymbolTable& values = qlSymbols) {
+    FlatAST ast(values);
+    ast.reserve(dcil.size() + 1);
+    uint32_t root = ast.addNode(QLNodeKind::PROGRAM);
+    std::vector<uint32_t> pending; // unclaimed subtrees, as in parseDCILToAST
+    for (auto& instr : dcil) {
+        uint32_t value = QL_NO_SYMBOL;
+        if (!instr.args.empty())
+            value = instr.argSymbol != QL_NO_SYMBOL ? instr.argSymbol : values.intern(instr.args[0]);
+        uint32_t node = ast.addNode(instr.opcode, instr.span, value, instr.argKind, instr.argPunct);
+        size_t first = pending.size() - std::min<size_t>(instr.arity, pending.size());
+        for (size_t i = first; i < pending.size(); ++i) ast.appendChild(node, pending[i]);
+        pending.resize(first);
+        pending.push_back(node);
+    }
+    for (uint32_t node : pending) ast.appendChild(root, node);
+    if (DEBUG_MODE) {
+        std::cout << "\nFlat AST:\n";
+        ast.forEachChild(root, [&](uint32_t n) { std::cout << qlNodeKindName(ast.kind[n]) << " -> " << ast.value(n) << "\n"; });
+    }
+    return ast;
+}
+
+// Graphviz export of a flat AST; edges come from the enter/leave parent stack.
+void writeASTDot(const FlatAST& ast, std::ostream& out) {
+    out << "digraph AST {\n";
+    std::vector<uint32_t> parents;
+    ast.walk(ast.root(),
+        [&](uint32_t n, uint32_t) {
+            out << "  n" << n << " [label=\"" << qlNodeKindName(ast.kind[n]);
+            if (ast.valueId[n] != QL_NO_SYMBOL) out << "\\n" << ast.value(n);
+            out << "\"];\n";
+            if (!parents.empty()) out << "  n" << parents.back() << " -> n" << n << ";\n";
+            parents.push_back(n);
+        },
+        [&](uint32_t, uint32_t) { parents.pop_back(); });
+    out << "}\n";
+}
+
+// ======== AST Allocation Benchmark ========
+// Previous shared_ptr node layout, kept as the baseline for runASTBenchmark.
+struct SharedASTNode {
+    std::string type;
+    std::string value;
+    std::vector<std::shared_ptr<SharedASTNode>> children;
+};
+
+void runASTBenchmark(size_t calls) {
+    std::vector<DCILInstruction> dcil;
+    dcil.reserve(calls);
+    for (size_t i = 0; i < calls; ++i) {
+        std::string callee = "capsule_pipeline_stage_" + std::to_string(i % 512);
+        uint32_t symbol = qlSymbols.intern(callee);
+        dcil.push_back({ QLNodeKind::CALL, { callee }, "Ω", QLTokenKind::IDENT, symbol, QLSpan{} });
+    }
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+
+    size_t sharedAllocs = g_heapAllocations.load();
+    auto t0 = Clock::now();
+    auto sharedRoot = std::make_shared<SharedASTNode>();
+    sharedRoot->type = "Program";
+    for (auto& instr : dcil) {
+        auto node = std::make_shared<SharedASTNode>();
+        node->type = qlNodeKindName(instr.opcode);
+        node->value = instr.args.empty() ? "" : instr.args[0];
+        sharedRoot->children.push_back(node);
+    }
+    auto t1 = Clock::now();
+    sharedAllocs = g_heapAllocations.load() - sharedAllocs;
+    sharedRoot.reset();
+    auto t2 = Clock::now();
+
+    size_t arenaAllocs = g_heapAllocations.load();
+    auto t3 = Clock::now();
+    auto arena = std::make_unique<ASTArena>();
+    ASTNode* root = parseDCILToAST(dcil, *arena);
+    auto t4 = Clock::now();
+    arenaAllocs = g_heapAllocations.load() - arenaAllocs;
+    size_t arenaBytes = arena->bytesUsed();
+    size_t arenaBlocks = arena->blockCount();
+    arena.reset();
+    auto t5 = Clock::now();
+    (void)root;
+
+    std::cout << "[BENCH] AST nodes: " << calls + 1 << "\n";
+    std::cout << "[BENCH] shared_ptr: " << allocationsText(sharedAllocs) << " allocations, parse " << Ms(t1 - t0).count()
+              << " ms, free " << Ms(t2 - t1).count() << " ms\n";
+    std::cout << "[BENCH] arena:      " << allocationsText(arenaAllocs) << " allocations (" << arenaBlocks << " blocks, "
+              << arenaBytes << " bytes), parse " << Ms(t4 - t3).count() << " ms, free " << Ms(t5 - t4).count() << " ms\n";
+}
+// ======== AST Traversal Benchmark ========
+// Synthetic program shaped like real QuarterLang: functions with a body block
+// of calls, some of which carry VAL arguments.
+FlatAST synthesizeFlatAST(size_t targetNodes, QLSymbolTable& values = qlSymbols) {
+    FlatAST ast(values);
+    ast.reserve(targetNodes + 64);
+    uint32_t root = ast.addNode(QLNodeKind::PROGRAM);
+    uint32_t offset = 0;
+    for (size_t f = 0; ast.size() < targetNodes; ++f) {
+        uint32_t fn = ast.addNode(QLNodeKind::FUNC, { offset, 16 }, values.intern("fn_" + std::to_string(f)), QLTokenKind::IDENT);
+        ast.appendChild(root, fn);
+        uint32_t body = ast.addNode(QLNodeKind::BLOCK, { offset, 0 });
+        ast.appendChild(fn, body);
+        offset += 16;
+        for (size_t c = 0; c < 24; ++c) {
+            uint32_t call = ast.addNode(QLNodeKind::CALL, { offset, 12 },
+                values.intern("capsule_pipeline_stage_" + std::to_string((f * 24 + c) % 512)), QLTokenKind::IDENT);
+            ast.appendChild(body, call);
+            offset += 12;
+            for (size_t a = 0; a < c % 3; ++a) {
+                ast.appendChild(call, ast.addNode(QLNodeKind::VAL, { offset, 2 }, values.intern(a ? "1X" : "Y"), QLTokenKind::NUMBER));
+                offset += 3;
+            }
+        }
+    }
+    return ast;
+}
+
+ASTNode* flatToArenaAST(const FlatAST& ast, uint32_t n, ASTArena& arena) {
+    ASTNode* node = arena.make<ASTNode>();
+    node->kind = ast.kind[n];
+    node->value = ast.value(n);
+    node->valueKind = ast.valueKind[n];
+    node->valueSymbol = ast.valueId[n];
+    node->valuePunct = ast.valuePunct[n];
+    ast.forEachChild(n, [&](uint32_t c) { node->appendChild(flatToArenaAST(ast, c, arena)); });
+    return node;
+}
+
+std::shared_ptr<SharedASTNode> flatToSharedAST(const FlatAST& ast, uint32_t n) {
+    auto node = std::make_shared<SharedASTNode>();
+    node->type = qlNodeKindName(ast.kind[n]);
+    node->value = std::string(ast.value(n));
+    ast.forEachChild(n, [&](uint32_t c) { node->children.push_back(flatToSharedAST(ast, c)); });
+    return node;
+}
+
+void runASTTraversalBenchmark(size_t nodes, int passes = 20) {
+    FlatAST flat = synthesizeFlatAST(nodes);
+    ASTArena arena;
+    ASTNode* arenaRoot = flatToArenaAST(flat, flat.root(), arena);
+    auto sharedRoot = flatToSharedAST(flat, flat.root());
+
+    using Clock = std::chrono::steady_clock;
+    using Ns = std::chrono::duration<double, std::nano>;
+    size_t visited = 0, calls = 0;
+    auto report = [&](const char* name, Clock::duration elapsed) {
+        double perNode = Ns(elapsed).count() / std::max<size_t>(visited, 1);
+        std::cout << "[BENCH] " << name << perNode << " ns/node (" << calls / passes << " calls)\n";
+        visited = calls = 0;
+    };
+
+    // Each pass counts CALL nodes, the typical shape of a lowering pass.
+    auto t0 = Clock::now();
+    for (int p = 0; p < passes; ++p) {
+        std::vector<const SharedASTNode*> stack{ sharedRoot.get() };
+        while (!stack.empty()) {
+            const SharedASTNode* n = stack.back();
+            stack.pop_back();
+            ++visited;
+            if (n->type == "CALL") ++calls;
+            for (auto it = n->children.rbegin(); it != n->children.rend(); ++it) stack.push_back(it->get());
+        }
+    }
+    report("shared_ptr tree: ", Clock::now() - t0);
+
+    t0 = Clock::now();
+    for (int p = 0; p < passes; ++p) {
+        std::vector<const ASTNode*> stack{ arenaRoot };
+        while (!stack.empty()) {
+            const ASTNode* n = stack.back();
+            stack.pop_back();
+            ++visited;
+            if (n->kind == QLNodeKind::CALL) ++calls;
+            if (n != arenaRoot && n->nextSibling) stack.push_back(n->nextSibling);
+            if (n->firstChild) stack.push_back(n->firstChild);
+        }
+    }
+    report("arena pointers:  ", Clock::now() - t0);
+
+    t0 = Clock::now();
+    for (int p = 0; p < passes; ++p) {
+        flat.walk(flat.root(), [&](uint32_t n, uint32_t) {
+            ++visited;
+            if (flat.kind[n] == QLNodeKind::CALL) ++calls;
+        });
+    }
+    report("flat SoA walk:   ", Clock::now() - t0);
+
+    std::cout << "[BENCH] traversal nodes: " << flat.size() << ", passes: " << passes << "\n";
+    std::cout << "[BENCH] flat columns: " << flat.columnBytes() << " bytes, arena: " << arena.bytesUsed() << " bytes\n";
+}
+
+// ======== Step 4: UICL with Dodecagram Base-12 Eval and Type Check ========
+// Opcode a node lowers to; kinds with no bytecode counterpart travel as EXT.
+UICLOp uiclOpForNode(QLNodeKind kind) {
+    switch (kind) {
+    case QLNodeKind::CALL: return { QLOpcode::CALL, {} };
+    case QLNodeKind::FUNC: return { QLOpcode::FUNC, {} };
+    default: return { QLOpcode::EXT, {}, qlNodeKindName(kind) };
+    }
+}
+
+// Binding rule shared by every UICL lowering: only identifier operands with an
+// interned symbol are looked up; literal IDs live in a different symbol space.
+const std::string* lookupBoundSymbol(QLTokenKind kind, uint32_t symbol) {
+    if (kind != QLTokenKind::IDENT || symbol == QL_NO_SYMBOL) return nullptr;
+    auto bound = symbolTable.find(symbol);
+    return bound == symbolTable.end() ? nullptr : &bound->second;
+}
+
+// Lowers one CALL and its argument token, shared with the incremental front end.
+UICLOp lowerCallToUICL(QLTokenKind argKind, uint32_t argSymbol, std::string_view argText) {
+    UICLOp op{ QLOpcode::CALL, {} };
+    int64_t number;
+    if (argKind == QLTokenKind::NUMBER && parseDG12(argText, number)) {
+        op.operands.push_back(std::to_string(number));
+    }
+    else if (const std::string* bound = lookupBoundSymbol(argKind, argSymbol)) {
+        op.operands.push_back(*bound);
+    }
+    else if (!argText.empty()) {
+        op.operands.emplace_back(argText);
+    }
+    return op;
+}
+
+// Read-only views so one lowering walks either AST layout.
+struct QLPointerASTView {
+    using Node = const ASTNode*;
+    static constexpr Node none = nullptr;
+    Node first(Node n) const { return n->firstChild; }
+    Node next(Node n) const { return n->nextSibling; }
+    QLNodeKind kind(Node n) const { return n->kind; }
+    bool hasValue(Node n) const { return !n->value.empty(); }
+    std::string_view value(Node n) const { return n->value; }
+    QLTokenKind valueKind(Node n) const { return n->valueKind; }
+    uint32_t valueSymbol(Node n) const { return n->valueSymbol; }
+    QLPunct valuePunct(Node n) const { return n->valuePunct; }
+};
+
+struct QLFlatASTView {
+    using Node = uint32_t;
+    static constexpr Node none = QL_NO_NODE;
+    const FlatAST& ast;
+    Node first(Node n) const { return ast.firstChild[n]; }
+    Node next(Node n) const { return ast.nextSibling[n]; }
+    QLNodeKind kind(Node n) const { return ast.kind[n]; }
+    bool hasValue(Node n) const { return ast.valueId[n] != QL_NO_SYMBOL; }
+    std::string_view value(Node n) const { return ast.value(n); }
+    QLTokenKind valueKind(Node n) const { return ast.valueKind[n]; }
+    uint32_t valueSymbol(Node n) const { return ast.valueId[n]; }
+    QLPunct valuePunct(Node n) const { return ast.valuePunct[n]; }
+};
+
+// AST to UICL for QLVM. Top-level statements run first and end in HALT, then
+// every FUNC, wherever it was declared, follows as `FUNC name params slots
+// paramNames...` with an implicit `PUSH 0; RET` at its end; other variables
+// get slots when the loader first sees them. Jump operands are instruction
+// indices into the result. Calls to a known function are padded with its
+// number defaults (0 otherwise) or have surplus arguments dropped, so every
+// call matches the first definition's arity, as the loader requires. A
+// program of capsule CALLs alone lowers to one CALL each, as it always has.
+template <typename View>
+class QLUICLLowering {
+public:
+    using Node = typename View::Node;
+
+    explicit QLUICLLowering(View ast) : ast(ast) {}
+
+    std::vector<UICLOp> run(Node root) {
+        collect(root);
+        for (Node n = ast.first(root); n != View::none; n = ast.next(n)) statement(n);
+        if (!functions.empty()) {
+            emit(QLOpcode::HALT);
+            for (Node fn : functions) function(fn);
+        }
+        return std::move(out);
+    }
+
+private:
+    // Finds every FUNC; a name's first definition fixes its parameter defaults.
+    void collect(Node n) {
+        for (Node c = ast.first(n); c != View::none; c = ast.next(c)) {
+            QLNodeKind kind = ast.kind(c);
+            if (kind == QLNodeKind::FUNC) {
+                functions.push_back(c);
+                auto inserted = signatures.emplace(ast.value(c), std::vector<int64_t>());
+                for (Node p = ast.first(c); inserted.second && p != View::none; p = ast.next(p)) {
+                    if (ast.kind(p) != QLNodeKind::PARAM) continue;
+                    Node fallback = ast.first(p);
+                    inserted.first->second.push_back(fallback == View::none ? 0 : number(fallback));
+                }
+            }
+            if (kind == QLNodeKind::FUNC || kind == QLNodeKind::BLOCK || kind == QLNodeKind::WHEN || kind == QLNodeKind::WHILE) collect(c);
+        }
+    }
+
+    size_t emit(QLOpcode op, std::vector<std::string> operands = {}) {
+        out.push_back({ op, std::move(operands) });
+        return out.size() - 1;
+    }
+    // Points the jump at `at` to the next instruction emitted.
+    void patch(size_t at) { out[at].operands = { std::to_string(out.size()) }; }
+    std::string name(Node n) const { return std::string(ast.value(n)); }
+    // The parser only emits NUMBER nodes whose literal fits.
+    int64_t number(Node n) const {
+        int64_t value = 0;
+        parseDG12(ast.value(n), value);
+        return value;
+    }
+
+    void function(Node fn) {
+        std::vector<std::string> operands{ name(fn), "", "" };
+        Node body = View::none;
+        for (Node c = ast.first(fn); c != View::none; c = ast.next(c)) {
+            if (ast.kind(c) == QLNodeKind::PARAM) operands.push_back(name(c));
+            else body = c;
+        }
+        operands[1] = operands[2] = std::to_string(operands.size() - 3);
+        emit(QLOpcode::FUNC, std::move(operands));
+        if (body != View::none) statement(body);
+        emit(QLOpcode::PUSH, { "0" });
+        emit(QLOpcode::RET);
+    }
+
+    void statement(Node n) {
+        switch (ast.kind(n)) {
+        case QLNodeKind::FUNC:
+            return; // lowered after the top level
+        case QLNodeKind::BLOCK:
+            for (Node c = ast.first(n); c != View::none; c = ast.next(c)) statement(c);
+            return;
+        case QLNodeKind::CALL: {
+            UICLOp op = lowerCallToUICL(ast.valueKind(n), ast.valueSymbol(n), ast.value(n));
+            if (op.operands.empty() || !signatures.count(op.operands[0])) {
+                out.push_back(std::move(op));
+                return;
+            }
+            call(op.operands[0], 0); // a capsule call that names a function runs it
+            emit(QLOpcode::POP);
+            return;
+        }
+        case QLNodeKind::VAL:
+        case QLNodeKind::ASSIGN:
+        case QLNodeKind::RETURN: {
+            Node value = ast.first(n);
+            if (value != View::none) expression(value);
+            else emit(QLOpcode::PUSH, { "0" });
+            if (ast.kind(n) == QLNodeKind::RETURN) emit(QLOpcode::RET);
+            else emit(QLOpcode::STORE, { name(n) });
+            return;
+        }
+        case QLNodeKind::WHEN: {
+            Node condition = ast.first(n), then = ast.next(condition), otherwise = ast.next(then);
+            expression(condition);
+            size_t skip = emit(QLOpcode::JZ, { "" });
+            statement(then);
+            if (otherwise == View::none) {
+                patch(skip);
+                return;
+            }
+            size_t done = emit(QLOpcode::JMP, { "" });
+            patch(skip);
+            statement(otherwise);
+            patch(done);
+            return;
+        }
+        case QLNodeKind::WHILE: {
+            Node condition = ast.first(n);
+            std::string top = std::to_string(out.size());
+            expression(condition);
+            size_t exit = emit(QLOpcode::JZ, { "" });
+            statement(ast.next(condition));
+            emit(QLOpcode::JMP, { top });
+            patch(exit);
+            return;
+        }
+        case QLNodeKind::APPLY:
+            expression(n);
+            emit(QLOpcode::POP);
+            return;
+        default: {
+            UICLOp op = uiclOpForNode(ast.kind(n));
+            if (ast.hasValue(n)) op.operands.emplace_back(ast.value(n));
+            out.push_back(std::move(op));
+            return;
+        }
+        }
+    }
+
+    // Arguments are already on the stack.
+    void call(const std::string& callee, size_t argc) {
+        auto known = signatures.find(callee);
+        if (known != signatures.end()) {
+            const std::vector<int64_t>& defaults = known->second;
+            for (; argc > defaults.size(); --argc) emit(QLOpcode::POP);
+            for (; argc < defaults.size(); ++argc) emit(QLOpcode::PUSH, { std::to_string(defaults[argc]) });
+        }
+        emit(QLOpcode::CALL, { callee, std::to_string(argc) });
+    }
+
+    void expression(Node n) {
+        switch (ast.kind(n)) {
+        case QLNodeKind::NUMBER:
+            emit(QLOpcode::PUSH, { std::to_string(number(n)) });
+            return;
+        case QLNodeKind::NAME:
+            emit(QLOpcode::LOAD, { name(n) });
+            return;
+        case QLNodeKind::APPLY: {
+            size_t argc = 0;
+            for (Node a = ast.first(n); a != View::none; a = ast.next(a), ++argc) expression(a);
+            call(name(n), argc);
+            return;
+        }
+        case QLNodeKind::WHEN: {
+            Node condition = ast.first(n), then = ast.next(condition);
+            expression(condition);
+            size_t skip = emit(QLOpcode::JZ, { "" });
+            expression(then);
+            size_t done = emit(QLOpcode::JMP, { "" });
+            patch(skip);
+            expression(ast.next(then));
+            patch(done);
+            return;
+        }
+        case QLNodeKind::BINARY: {
+            Node lhs = ast.first(n);
+            expression(lhs);
+            expression(ast.next(lhs));
+            // a > b is !(a <= b) and so on, keeping left-to-right evaluation.
+            QLPunct op = ast.valuePunct(n);
+            switch (op) {
+            case QLPunct::PLUS: emit(QLOpcode::ADD); break;
+            case QLPunct::MINUS: emit(QLOpcode::SUB); break;
+            case QLPunct::STAR: emit(QLOpcode::MUL); break;
+            case QLPunct::LT: case QLPunct::GE: emit(QLOpcode::LT); break;
+            case QLPunct::LE: case QLPunct::GT: emit(QLOpcode::LE); break;
+            default: emit(QLOpcode::EQ); break;
+            }
+            if (op == QLPunct::GT || op == QLPunct::GE || op == QLPunct::NE) {
+                emit(QLOpcode::PUSH, { "0" });
+                emit(QLOpcode::EQ);
+            }
+            return;
+        }
+        default:
+            emit(QLOpcode::PUSH, { "0" });
+            return;
+        }
+    }
+
+    View ast;
+    std::vector<Node> functions;
+    std::unordered_map<std::string_view, std::vector<int64_t>> signatures; // parameter defaults by name
+    std::vector<UICLOp> out;
+};
+
+void printUICL(const std::vector<UICLOp>& uicl) {
+    std::cout << "\nUICL:\n";
+    for (const auto& u : uicl) {
+        std::cout << uiclOpName(u);
+        for (const auto& operand : u.operands) std::cout << " " << operand;
+        std::cout << "\n";
+    }
+}
+
+std::vector<UICLOp> convertASTToUICL(const ASTNode* ast) {
+    std::vector<UICLOp> uicl = QLUICLLowering<QLPointerASTView>(QLPointerASTView{}).run(ast);
+    if (DEBUG_MODE) printUICL(uicl);
+    return uicl;
+}
+// Same lowering over the flat AST.
+std::vector<UICLOp> convertASTToUICL(const FlatAST& ast) {
+    std::vector<UICLOp> uicl = QLUICLLowering<QLFlatASTView>(QLFlatASTView{ ast }).run(ast.root());
+    if (DEBUG_MODE) printUICL(uicl);
+    return uicl;
+}
+
+// ======== Incremental Front End (REPL / Highlighter) ========
+// Indent stacks are hash-consed into (indent, parent) nodes, so a whole stack
+// is one 32-bit ID and two lexer states compare in O(1). ID 0 is the base [0].
+class QLIndentStackPool {
+public:
+    QLIndentStackPool() { nodes.push_back({ 0, 0 }); }
+
+    uint32_t push(uint32_t stack, uint32_t indent) {
+        uint64_t key = (static_cast<uint64_t>(stack) << 32) | indent;
+        auto it = index.find(key);
+        if (it != index.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(nodes.size());
+        nodes.push_back({ indent, stack });
+        index.emplace(key, id);
+        return id;
+    }
+    uint32_t pop(uint32_t stack) const { return nodes[stack].parent; }
+    uint32_t top(uint32_t stack) const { return nodes[stack].indent; }
+
+private:
+    struct Node {
+        uint32_t indent;
+        uint32_t parent;
+    };
+    std::vector<Node> nodes;
+    std::unordered_map<uint64_t, uint32_t> index;
+};
+
+// Lexer state carried across a line boundary. Comments are '#' to end of line,
+// so the only open construct the lexer carries is a """ block string. Open
+// braces and parentheses are counted as QLDCILParser counts them, to tell a
+// statement's continuation lines from the next statement.
+struct QLLineState {
+    uint32_t indentStack = 0;
+    uint32_t braces = 0;
+    uint32_t parens = 0;
+    bool inBlockString = false;
+
+    bool operator==(const QLLineState& o) const {
+        return indentStack == o.indentStack && braces == o.braces && parens == o.parens && inBlockString == o.inBlockString;
+    }
+    bool operator!=(const QLLineState& o) const { return !(*this == o); }
+};
+
+// Lines an edit may re-lex past its own region before the rest is left stale.
+constexpr size_t QL_RELEX_WINDOW = 256;
+
+// A document held as lines. Every line caches its entry/exit lexer state and
+// its tokens (spans relative to the line); the first line of each top-level
+// statement also caches the statement's DCIL and UICL. An edit re-lexes from
+// the first touched line and stops at the first later line whose cached entry
+// state still matches, so typing inside a function costs one line; then the
+// top-level statements those lines belong to are parsed again by QLDCILParser
+// and lowered by QLUICLLowering, as a batch compile would.
+// Opening a """ string that never closes flips every later line; rather than
+// re-lex them all, the edit stops QL_RELEX_WINDOW lines on and leaves a stale
+// frontier. Closing the string again re-lexes back to the frontier and meets
+// the cached states there; anything that reads past the frontier settles it.
+class QLIncrementalDocument {
+public:
+    struct Line {
+        std::string text;
+        QLLineState entry;
+        QLLineState exit;
+        int32_t indentDelta = 0; // +1 for INDENT, -n for n DEDENTs
+        bool stale = true;       // text or predecessor changed since this line was lexed
+        std::vector<QLSpanToken> tokens;
+        // Set on the first line of a top-level statement, for the lines up to the next one.
+        std::vector<DCILInstruction> dcil;
+        std::vector<UICLOp> uicl;        // that DCIL lowered on its own
+        std::vector<uint32_t> failed;    // lines, relative to this one, of statements that do not parse
+    };
+
+    struct EditStats {
+        size_t relexed = 0;
+        size_t relowered = 0;
+        size_t firstLowered = 0; // lines [firstLowered, firstLowered + relowered) have fresh UICL
+    };
+
+    explicit QLIncrementalDocument(QLSymbolTable& symbols = qlSymbols) : symbols(&symbols) {}
+
+    EditStats setText(std::string_view text) {
+        std::vector<std::string> split;
+        size_t start = 0;
+        while (start <= text.size()) {
+            size_t nl = text.find('\n', start);
+            if (nl == std::string_view::npos) nl = text.size();
+            split.emplace_back(text.substr(start, nl - start));
+            start = nl + 1;
+        }
+        return replaceLines(0, lines.size(), std::move(split));
+    }
+
+    EditStats appendLine(std::string text) {
+        return replaceLines(lines.size(), 0, { std::move(text) });
+    }
+
+    EditStats editLine(size_t line, std::string text) {
+        return replaceLines(line, 1, { std::move(text) });
+    }
+
+    // Replaces lines [first, first + count) with newLines (count may be 0 for an
+    // insertion, newLines may be empty for a deletion).
+    EditStats replaceLines(size_t first, size_t count, std::vector<std::string> newLines) {
+        first = std::min(first, lines.size());
+        count = std::min(count, lines.size() - first);
+        size_t inserted = newLines.size();
+        size_t reused = std::min(count, inserted);
+        for (size_t i = 0; i < reused; ++i) {
+            lines[first + i]->text = std::move(newLines[i]);
+            markStale(*lines[first + i]);
+        }
+        if (count > inserted) {
+            for (size_t i = first + reused; i < first + count; ++i) staleLines -= lines[i]->stale;
+            lines.erase(lines.begin() + first + reused, lines.begin() + first + count);
+            // Below the frontier relex() compares the next line's entry state;
+            // past it nothing will, so that line must be marked.
+            if (first > frontier && first + inserted < lines.size()) markStale(*lines[first + inserted]);
+        }
+        else if (inserted > count) {
+            std::vector<std::unique_ptr<Line>> fresh(inserted - reused);
+            for (size_t i = reused; i < inserted; ++i) {
+                fresh[i - reused] = std::make_unique<Line>();
+                fresh[i - reused]->text = std::move(newLines[i]);
+            }
+            staleLines += fresh.size();
+            lines.insert(lines.begin() + first + reused, std::make_move_iterator(fresh.begin()), std::make_move_iterator(fresh.end()));
+        }
+
+        // Past the frontier nothing is lexed yet, so the edit only marks lines.
+        if (first > frontier) return EditStats{ 0, 0, first };
+        return relex(first, first + inserted, QL_RELEX_WINDOW);
+    }
+
+    // Re-lexes from the frontier until lines [0, upTo] (default: all) are current.
+    EditStats settle(size_t upTo = SIZE_MAX) {
+        EditStats stats{ 0, 0, frontier };
+        if (lines.empty()) return stats;
+        for (bool firstStep = true; frontier < lines.size() && frontier <= upTo; firstStep = false) {
+            EditStats step = relex(frontier, frontier, lines.size());
+            if (firstStep) stats.firstLowered = step.firstLowered;
+            stats.relexed += step.relexed;
+            stats.relowered = step.firstLowered + step.relowered - stats.firstLowered;
+        }
+        return stats;
+    }
+
+    size_t lineCount() const { return lines.size(); }
+    size_t staleFrom() const { return frontier; }
+    const std::string& text(size_t i) const { return lines[i]->text; }
+    const Line& line(size_t i) {
+        settle(i);
+        // A statement starting at line i is parsed once all its lines are.
+        for (size_t next = i + 1; next < lines.size() && frontier < lines.size(); ++next) {
+            if (next >= frontier) settle(next);
+            if (startsStatement(next)) break;
+        }
+        return *lines[i];
+    }
+    std::string_view lexeme(size_t i, const QLSpanToken& tok) const {
+        return std::string_view(lines[i]->text).substr(tok.offset, tok.length);
+    }
+
+    // The whole document lowered at once, so functions and the jumps around
+    // them are laid out as in a batch compile.
+    std::vector<UICLOp> uicl() {
+        settle();
+        std::vector<DCILInstruction> all;
+        for (const auto& l : lines) all.insert(all.end(), l->dcil.begin(), l->dcil.end());
+        ASTArena arena;
+        return convertASTToUICL(parseDCILToAST(all, arena));
+    }
+
+private:
+    void markStale(Line& line) {
+        if (!line.stale) ++staleLines;
+        line.stale = true;
+    }
+
+    // Lexes lines from `first`; every line before `mustLex` is lexed, later ones
+    // only until a current line's cached entry state matches, or until `window`
+    // lines past mustLex, where the frontier is left for a later settle().
+    EditStats relex(size_t first, size_t mustLex, size_t window) {
+        EditStats stats;
+        QLLineState state = first == 0 ? QLLineState{} : lines[first - 1]->exit;
+        size_t i = first;
+        for (; i < lines.size(); ++i) {
+            Line& line = *lines[i];
+            if (i >= mustLex) {
+                if (!line.stale && line.entry == state) break;
+                if (i - mustLex >= window) {
+                    markStale(line);
+                    break;
+                }
+            }
+            lexLine(line, state);
+            state = line.exit;
+            if (line.stale) --staleLines;
+            line.stale = false;
+            ++stats.relexed;
+        }
+        frontier = i;
+        if (staleLines == 0) frontier = lines.size();
+        while (frontier < lines.size() && !lines[frontier]->stale) ++frontier;
+
+        // Parse again every statement the edit can reach. Whether a line
+        // starts a statement depends on it and the code line above it, so
+        // lines [first, i) and the first code line after them may now split
+        // or join statements: go back to the start of the statement holding
+        // line first - 1 and on to the start after that code line.
+        if (lines.empty()) return stats;
+        size_t from = std::min(first ? first - 1 : 0, lines.size() - 1);
+        while (from > 0 && !startsStatement(from)) --from;
+        size_t to = std::max(i, from + 1);
+        while (to < frontier && !hasCode(to)) ++to;
+        if (to < frontier) ++to;
+        while (to < frontier && !startsStatement(to)) ++to;
+        to = std::min(to, frontier);
+        for (size_t start = from; start < to;) {
+            size_t end = start + 1;
+            while (end < to && !startsStatement(end)) ++end;
+            parseStatement(start, end);
+            start = end;
+        }
+        stats.firstLowered = from;
+        stats.relowered = to > from ? to - from : 0;
+        return stats;
+    }
+
+    bool hasCode(size_t index) const {
+        const std::vector<QLSpanToken>& tokens = lines[index]->tokens;
+        return !tokens.empty() && tokens.front().kind != QLTokenKind::COMMENT;
+    }
+
+    // A top-level statement starts at code in column 0, outside braces,
+    // parentheses and block strings, unless the line continues the one above:
+    // a '}', an else/elif, or the argument of a `call` that ended that line.
+    bool startsStatement(size_t index) const {
+        if (index == 0) return true;
+        const Line& line = *lines[index];
+        if (!hasCode(index) || line.entry.inBlockString || line.entry.braces || line.entry.parens || line.tokens.front().offset != 0) return false;
+        const QLSpanToken& head = line.tokens.front();
+        if (head.punct == QLPunct::RBRACE || head.keyword == QL_KW_ELSE || head.keyword == QL_KW_ELIF)
+            return false;
+        for (size_t p = index; p > 0; --p) {
+            if (!hasCode(p - 1)) continue;
+            const std::vector<QLSpanToken>& above = lines[p - 1]->tokens;
+            size_t last = above.size() - (above.back().kind == QLTokenKind::COMMENT ? 2 : 1);
+            return above[last].kind != QLTokenKind::CALL;
+        }
+        return true;
+    }
+
+    // Parses lines [start, end) as one token stream, joined as the batch lexer
+    // would see them: comments dropped and a block string one token.
+    void parseStatement(size_t start, size_t end) {
+        for (size_t l = start; l < end; ++l) {
+            lines[l]->dcil.clear();
+            lines[l]->uicl.clear();
+            lines[l]->failed.clear();
+        }
+        std::string source;
+        std::vector<uint32_t> lineOffset;
+        QLTokenStream stream;
+        for (size_t l = start; l < end; ++l) {
+            const Line& line = *lines[l];
+            if (l > start) source += '\n';
+            lineOffset.push_back(static_cast<uint32_t>(source.size()));
+            for (const QLSpanToken& tok : line.tokens) {
+                if (tok.kind == QLTokenKind::COMMENT) continue;
+                QLSpanToken shifted = tok;
+                shifted.offset += lineOffset.back();
+                std::vector<QLSpanToken>& out = stream.tokens;
+                if (tok.offset == 0 && tok.kind == QLTokenKind::STRING && line.entry.inBlockString && !out.empty() &&
+                    out.back().kind == QLTokenKind::STRING)
+                    out.back().length = shifted.offset + shifted.length - out.back().offset;
+                else
+                    out.push_back(shifted);
+            }
+            source += line.text;
+        }
+        stream.source = QLSourceBuffer::fromString(std::move(source));
+
+        Line& head = *lines[start];
+        std::vector<QLSpan> failed;
+        QLDCILParser(stream, head.dcil, failed).program();
+        for (const QLSpan& span : failed) {
+            size_t at = std::upper_bound(lineOffset.begin(), lineOffset.end(), span.offset) - lineOffset.begin() - 1;
+            head.failed.push_back(static_cast<uint32_t>(at));
+        }
+        ASTArena arena;
+        head.uicl = convertASTToUICL(parseDCILToAST(head.dcil, arena));
+    }
+
+    void lexLine(Line& line, QLLineState state) {
+        line.entry = state;
+        line.tokens.clear();
+        line.indentDelta = 0;
+        const char* s = line.text.data();
+        size_t n = line.text.size();
+        size_t pos = 0;
+
+        if (state.inBlockString) {
+            size_t close = line.text.find("\"\"\"");
+            if (close == std::string::npos) {
+                line.tokens.push_back({ QLTokenKind::STRING, QLPunct::NONE, QuarterKeywords::NONE, 0, static_cast<uint32_t>(n), QL_NO_SYMBOL });
+                line.exit = state;
+                return;
+            }
+            pos = close + 3;
+            line.tokens.push_back({ QLTokenKind::STRING, QLPunct::NONE, QuarterKeywords::NONE, 0, static_cast<uint32_t>(pos), QL_NO_SYMBOL });
+            state.inBlockString = false;
+        }
+        else {
+            uint32_t indent = qlSkipIndent(s, n, pos);
+            bool blank = pos == n || s[pos] == '#' || s[pos] == '\r';
+            if (!blank) {
+                if (indent > indentStacks.top(state.indentStack)) {
+                    state.indentStack = indentStacks.push(state.indentStack, indent);
+                    line.indentDelta = 1;
+                }
+                while (indent < indentStacks.top(state.indentStack)) {
+                    state.indentStack = indentStacks.pop(state.indentStack);
+                    --line.indentDelta;
+                }
+            }
+        }
+
+        auto emit = [&](QLTokenKind kind, size_t offset, size_t length, QLPunct punct = QLPunct::NONE,
+                        uint8_t keyword = QuarterKeywords::NONE) {
+            uint32_t symbol = kind == QLTokenKind::IDENT ? symbols->intern(std::string_view(s + offset, length)) : QL_NO_SYMBOL;
+            line.tokens.push_back({ kind, punct, keyword, static_cast<uint32_t>(offset), static_cast<uint32_t>(length), symbol });
+        };
+        while (pos < n) {
+            size_t special = pos;
+            while (special < n && s[special] != '#' && s[special] != '"') ++special;
+            scanQuarterLang(s + pos, special - pos, [&](QLTokenKind kind, size_t offset, size_t length, QLPunct punct, uint8_t keyword) {
+                emit(kind, pos + offset, length, punct, keyword);
+            });
+            if (special == n) break;
+            if (s[special] == '#') {
+                emit(QLTokenKind::COMMENT, special, n - special);
+                break;
+            }
+            if (line.text.compare(special, 3, "\"\"\"") == 0) {
+                size_t close = line.text.find("\"\"\"", special + 3);
+                if (close == std::string::npos) {
+                    emit(QLTokenKind::STRING, special, n - special);
+                    state.inBlockString = true;
+                    break;
+                }
+                emit(QLTokenKind::STRING, special, close + 3 - special);
+                pos = close + 3;
+                continue;
+            }
+            size_t close = line.text.find('"', special + 1);
+            size_t end = close == std::string::npos ? n : close + 1;
+            emit(QLTokenKind::STRING, special, end - special);
+            pos = end;
+        }
+        for (const QLSpanToken& tok : line.tokens) {
+            switch (tok.punct) {
+            case QLPunct::LBRACE: ++state.braces; break;
+            case QLPunct::RBRACE: state.braces -= state.braces > 0; break;
+            case QLPunct::LPAREN: ++state.parens; break;
+            case QLPunct::RPAREN: state.parens -= state.parens > 0; break;
+            default: break;
+            }
+        }
+        line.exit = state;
+    }
+
+    std::vector<std::unique_ptr<Line>> lines; // boxed so inserts shift pointers, not lines
+    size_t frontier = 0;                      // lines [0, frontier) are lexed and parsed
+    size_t staleLines = 0;
+    QLIndentStackPool indentStacks;
+    QLSymbolTable* symbols;
+};
+
+// ======== REPL Mode (incremental) ========
+// Each entered line is appended to one document, so only that line is lexed
+// and only its statement parsed and lowered again. ":edit N <code>" rewrites
+// line N and reports what was redone.
+void runREPL() {
+    std::cout << "QuarterLang REPL (type 'exit' to quit, ':edit N <code>' to replace line N)\n";
+    QLIncrementalDocument doc;
+    std::string input;
+    while (true) {
+        std::cout << ">> ";
+        if (!std::getline(std::cin, input) || input == "exit") break;
+        QLIncrementalDocument::EditStats stats;
+        if (input.rfind(":edit ", 0) == 0) {
+            size_t lineEnd = input.find(' ', 6);
+            size_t lineNo = std::strtoul(input.c_str() + 6, nullptr, 10);
+            if (lineNo == 0 || lineNo > doc.lineCount()) {
+                std::cout << "No such line.\n";
+                continue;
+            }
+            stats = doc.editLine(lineNo - 1, lineEnd == std::string::npos ? "" : input.substr(lineEnd + 1));
+        }
+        else {
+            stats = doc.appendLine(input);
+        }
+        for (size_t l = stats.firstLowered; l < stats.firstLowered + stats.relowered; ++l) {
+            const auto& line = doc.line(l);
+            for (uint32_t failed : line.failed)
+                std::cout << "  [" << l + failed + 1 << "] statement does not parse\n";
+            for (const auto& op : line.uicl) {
+                std::cout << "  [" << l + 1 << "] " << uiclOpName(op);
+                for (const auto& operand : op.operands) std::cout << " " << operand;
+                std::cout << "\n";
+            }
+        }
+        if (DEBUG_MODE) std::cout << "  (relexed " << stats.relexed << ", relowered " << stats.relowered << " lines)\n";
+    }
+}
+
+// ======== Incremental Edit Benchmark ========
+bool sameDocument(QLIncrementalDocument& a, QLIncrementalDocument& b) {
+    if (a.lineCount() != b.lineCount()) return false;
+    for (size_t i = 0; i < a.lineCount(); ++i) {
+        const auto& x = a.line(i);
+        const auto& y = b.line(i);
+        if (x.text != y.text || x.indentDelta != y.indentDelta || x.exit.inBlockString != y.exit.inBlockString) return false;
+        if (x.tokens.size() != y.tokens.size() || x.uicl.size() != y.uicl.size() || x.failed != y.failed) return false;
+        for (size_t t = 0; t < x.tokens.size(); ++t)
+            if (x.tokens[t].kind != y.tokens[t].kind || x.tokens[t].offset != y.tokens[t].offset || x.tokens[t].length != y.tokens[t].length) return false;
+        for (size_t u = 0; u < x.uicl.size(); ++u)
+            if (!sameUICLOp(x.uicl[u], y.uicl[u])) return false;
+    }
+    return true;
+}
+
+void runIncrementalBenchmark(const std::string& corpus, size_t minLines = 50000) {
+    std::string text = corpus;
+    while (static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) < minLines) text += corpus;
+
+    using Clock = std::chrono::steady_clock;
+    using Us = std::chrono::duration<double, std::micro>;
+    QLIncrementalDocument doc;
+    auto t0 = Clock::now();
+    doc.setText(text);
+    double fullUs = Us(Clock::now() - t0).count();
+    size_t lines = doc.lineCount();
+
+    auto timeEdits = [&](const char* name, size_t edits, auto&& edit) {
+        double total = 0, worst = 0;
+        size_t relexed = 0;
+        uint32_t seed = 12345;
+        for (size_t e = 0; e < edits; ++e) {
+            seed = seed * 1664525u + 1013904223u;
+            size_t at = (seed >> 8) % doc.lineCount();
+            auto start = Clock::now();
+            relexed += edit(at).relexed;
+            double us = Us(Clock::now() - start).count();
+            total += us;
+            worst = std::max(worst, us);
+        }
+        std::cout << "[BENCH] " << name << total / edits << " us avg, " << worst << " us max, "
+                  << double(relexed) / edits << " lines relexed/edit\n";
+    };
+
+    timeEdits("edit line:    ", 2000, [&](size_t at) { return doc.editLine(at, doc.text(at) + " call extra"); });
+    timeEdits("insert line:  ", 2000, [&](size_t at) { return doc.replaceLines(at, 0, { "call inserted 1X" }); });
+    timeEdits("delete line:  ", 2000, [&](size_t at) { return doc.replaceLines(at, 1, {}); });
+    timeEdits("open+close \"\"\": ", 50, [&](size_t at) {
+        std::string original = doc.text(at);
+        auto opened = doc.editLine(at, original + " \"\"\"");
+        auto closed = doc.editLine(at, original);
+        opened.relexed += closed.relexed;
+        return opened;
+    });
+    timeEdits("add+remove \"\"\" line: ", 50, [&](size_t at) {
+        auto added = doc.replaceLines(at, 0, { "\"\"\"" });
+        auto removed = doc.replaceLines(at, 1, {});
+        added.relexed += removed.relexed;
+        return added;
+    });
+
+    std::string edited;
+    for (size_t i = 0; i < doc.lineCount(); ++i) {
+        if (i) edited += '\n';
+        edited += doc.text(i);
+    }
+    QLIncrementalDocument fresh;
+    fresh.setText(edited);
+
+    std::cout << "[BENCH] document: " << lines << " lines, full lex+lower " << fullUs / 1000.0 << " ms\n";
+    std::cout << "[BENCH] incremental state matches full re-lex: " << (sameDocument(doc, fresh) ? "yes" : "NO") << "\n";
+    ASTArena arena;
+    std::vector<UICLOp> batch = convertASTToUICL(parseDCILToAST(generateDCIL(lexQuarterLang(edited)).instructions, arena));
+    std::cout << "[BENCH] incremental UICL matches batch compile: " << (sameUICL(doc.uicl(), batch) ? "yes" : "NO") << "\n";
+}
+
+// ======== Step 5: Portable Bytecode Generation ========
+// The module format is in QuarterBytecode.hpp.
+// Previous one-byte-per-field encoding, kept for the size comparison.
+Bytecode compileUICLToBytecodeLegacy(const std::vector<UICLOp>& uicl) {
+    Bytecode bc;
+    for (const auto& op : uicl) {
+        std::string_view name = uiclOpName(op);
+        bc.code.push_back(name.empty() ? 0 : static_cast<uint8_t>(name[0]));
+        for (const auto& arg : op.operands) {
+            try {
+                uint8_t val = static_cast<uint8_t>(std::stoi(arg) % 256);
+                bc.code.push_back(val);
+            }
+            catch (...) {
+                bc.code.push_back(0);
+            }
+        }
+    }
+    return bc;
+}
+
+// ======== Bytecode Round-Trip Test and Benchmark ========
+bool runBytecodeRoundTripTest() {
+    std::vector<std::vector<UICLOp>> cases = {
+        {},
+        { { QLOpcode::FOLD_ADD, { "5", "7" } }, { QLOpcode::REC_FOLD, { "4" } }, { QLOpcode::COMPARE, { "apple", "apple" } },
+          { QLOpcode::COMPARE, { "3", "4" } } },
+        { { QLOpcode::CALL, { "function1" } }, { QLOpcode::REC_FOLD, { "3" } }, { QLOpcode::FOLD_ADD, { "2", "5" } } },
+        { { QLOpcode::CALL, {} }, { QLOpcode::CALL, { "" } }, { QLOpcode::NOP, {} } },
+        { { QLOpcode::FOLD_ADD, { "-1", "0" } }, { QLOpcode::FOLD_ADD, { "9223372036854775", "-9223372036854775" } },
+          { QLOpcode::FOLD_ADD, { "007", "+3" } } },
+        { { QLOpcode::LOOP, { "3", "Δ", "1", "2" } }, { QLOpcode::IF, { "x", "x" } }, { QLOpcode::UNLESS, { "a", "b" } } },
+        { makeUICLOp("⟁", { "1X", "hello world" }), makeUICLOp("plugin.op", { "ΔΞΩ" }), makeUICLOp("⟁", { "1X" }) },
+    };
+    cases.push_back(synthesizeCapsulePipeline(10000));
+
+    bool ok = true;
+    for (size_t i = 0; i < cases.size(); ++i) {
+        Bytecode bc = compileUICLToBytecode(cases[i]);
+        std::vector<UICLOp> decoded;
+        std::string error;
+        if (!decodeBytecodeToUICL(bc, decoded, error) || !sameUICL(cases[i], decoded)) {
+            std::cout << "[TEST] bytecode round trip case " << i << ": FAIL " << error << "\n";
+            ok = false;
+        }
+    }
+
+    // Every strict prefix of a module must be rejected, never over-read.
+    Bytecode full = compileUICLToBytecode(cases[1]);
+    for (size_t cut = 0; cut < full.code.size(); ++cut) {
+        Bytecode truncated{ std::vector<uint8_t>(full.code.begin(), full.code.begin() + cut) };
+        std::vector<UICLOp> decoded;
+        std::string error;
+        if (decodeBytecodeToUICL(truncated, decoded, error)) {
+            std::cout << "[TEST] bytecode truncated at " << cut << " bytes was accepted: FAIL\n";
+            ok = false;
+        }
+    }
+    std::cout << "[TEST] bytecode round trip: " << (ok ? "PASS" : "FAIL") << " (" << cases.size() << " cases, "
+              << full.code.size() << " truncations)\n";
+    return ok;
+}
+
+void runBytecodeBenchmark(size_t ops) {
+    std::vector<UICLOp> uicl = synthesizeCapsulePipeline(ops);
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+
+    std::string text;
+    for (const auto& op : uicl) {
+        text += uiclOpName(op);
+        for (const auto& arg : op.operands) text += " " + arg;
+        text += '\n';
+    }
+    Bytecode legacy = compileUICLToBytecodeLegacy(uicl);
+
+    auto t0 = Clock::now();
+    Bytecode bc = compileUICLToBytecode(uicl);
+    auto t1 = Clock::now();
+    size_t decodedOps = 0, decodedOperands = 0;
+    std::string error;
+    decodeBytecode(bc, [&](QLOpcode, std::string_view, const std::vector<QLOperand>& operands) {
+        ++decodedOps;
+        decodedOperands += operands.size();
+    }, error);
+    auto t2 = Clock::now();
+    std::vector<UICLOp> roundTrip;
+    decodeBytecodeToUICL(bc, roundTrip, error);
+    auto t3 = Clock::now();
+    std::vector<UICLOp> parsed;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string name, arg;
+        fields >> name;
+        UICLOp op = makeUICLOp(name);
+        while (fields >> arg) op.operands.push_back(arg);
+        parsed.push_back(std::move(op));
+    }
+    auto t4 = Clock::now();
+
+    auto opsPerSec = [&](Clock::duration d) { return decodedOps / std::max(std::chrono::duration<double>(d).count(), 1e-9); };
+    std::cout << "[BENCH] bytecode ops: " << uicl.size() << " (" << decodedOperands << " operands)\n";
+    std::cout << "[BENCH] size: binary " << bc.code.size() << " bytes, text " << text.size() << " bytes, legacy "
+              << legacy.code.size() << " bytes (lossy)\n";
+    std::cout << "[BENCH] encode: " << Ms(t1 - t0).count() << " ms\n";
+    std::cout << "[BENCH] decode (views):   " << Ms(t2 - t1).count() << " ms, " << opsPerSec(t2 - t1) << " ops/s\n";
+    std::cout << "[BENCH] decode (to UICL): " << Ms(t3 - t2).count() << " ms, " << opsPerSec(t3 - t2) << " ops/s\n";
+    std::cout << "[BENCH] parse text UICL:  " << Ms(t4 - t3).count() << " ms, " << opsPerSec(t4 - t3) << " ops/s\n";
+    std::cout << "[BENCH] round trip matches: " << (sameUICL(uicl, roundTrip) && sameUICL(uicl, parsed) ? "yes" : "NO") << "\n";
+}
+
+// ======== UICL Interpreter ========
+// Runs on the pre-decoded program of QuarterBytecode.hpp.
+void interpretUICL(const std::vector<UICLOp>& uicl) {
+    runProgram(predecodeUICL(uicl), &std::cout);
+}
+
+// Previous string-dispatch interpreter, kept as the baseline for
+// runInterpreterBenchmark: it still branches on the opcode spelling and parses
+// operands every step (int64 instead of int so long pipelines cannot overflow).
+int64_t interpretUICLStrings(const std::vector<UICLOp>& uicl, std::ostream* out) {
+    int64_t ACC = 0;
+    for (const auto& op : uicl) {
+        std::string_view opcode = uiclOpName(op);
+        if (opcode == "CALL") {
+            std::string target = op.operands.empty() ? "" : op.operands[0];
+            if (out) *out << "[CALL] Function: " << target << "\n";
+        }
+        else if (opcode == "Δ") {
+            if (op.operands.size() >= 2) {
+                int64_t a = std::stoll(op.operands[0]);
+                int64_t b = std::stoll(op.operands[1]);
+                ACC = a + b;
+                if (out) *out << "[Δ] Fold Add: " << a << " + " << b << " = " << ACC << "\n";
+            }
+        }
+        else if (opcode == "Ψ") {
+            if (op.operands.size() >= 1) {
+                int64_t depth = std::stoll(op.operands[0]);
+                ACC = foldFactorial(depth);
+                if (out) *out << "[Ψ] Rec Fold Factorial(" << depth << ") = " << ACC << "\n";
+            }
+        }
+        else if (opcode == "Ξ") {
+            if (op.operands.size() >= 2) {
+                bool result = op.operands[0] == op.operands[1];
+                if (out) *out << "[Ξ] Compare: " << op.operands[0] << " == " << op.operands[1] << " -> "
+                              << (result ? "true" : "false") << "\n";
+            }
+        }
+        else {
+            if (out) *out << "[UICL] Unknown op: " << opcode << "\n";
+        }
+    }
+    if (out) *out << "\n[REGISTER] ACC = " << ACC << "\n";
+    return ACC;
+}
+
+void runInterpreterBenchmark(size_t ops, int runs = 5) {
+    std::vector<UICLOp> uicl = synthesizeCapsulePipeline(ops);
+    using Clock = std::chrono::steady_clock;
+    using Secs = std::chrono::duration<double>;
+
+    std::ostringstream traceA, traceB;
+    std::vector<UICLOp> sample(uicl.begin(), uicl.begin() + std::min<size_t>(uicl.size(), 4096));
+    interpretUICLStrings(sample, &traceA);
+    runProgram(predecodeUICL(sample), &traceB);
+
+    auto t0 = Clock::now();
+    QLProgram program = predecodeUICL(uicl);
+    double decodeSecs = Secs(Clock::now() - t0).count();
+
+    int64_t accStrings = 0, accProgram = 0;
+    t0 = Clock::now();
+    for (int r = 0; r < runs; ++r) accStrings += interpretUICLStrings(uicl, nullptr);
+    double stringSecs = Secs(Clock::now() - t0).count();
+    t0 = Clock::now();
+    for (int r = 0; r < runs; ++r) accProgram += runProgram(program, nullptr);
+    double programSecs = Secs(Clock::now() - t0).count();
+
+    double total = double(ops) * runs;
+    std::cout << "[BENCH] interpreter ops: " << ops << " x " << runs << " runs\n";
+    std::cout << "[BENCH] string dispatch: " << total / stringSecs << " ops/s\n";
+    std::cout << "[BENCH] pre-decoded:     " << total / programSecs << " ops/s (decode once: " << decodeSecs * 1000 << " ms)\n";
+    std::cout << "[BENCH] speedup: " << stringSecs / programSecs << "x, amortised incl. decode: "
+              << stringSecs / (programSecs + decodeSecs) << "x\n";
+    std::cout << "[BENCH] traces and accumulators match: "
+              << (traceA.str() == traceB.str() && accStrings == accProgram ? "yes" : "NO") << "\n";
+}
+
+// Source to UICL through the whole front end; the engine's corpus benchmarks
+// and tests reach the front end through this. Statements that do not parse
+// are left out, since those callers only need code to run and optimize.
+std::vector<UICLOp> lowerQuarterSource(std::string source) {
+    std::vector<DCILInstruction> dcil = generateDCIL(lexQuarterLang(std::move(source))).instructions;
+    ASTArena arena;
+    return convertASTToUICL(parseDCILToAST(dcil, arena));
+}
+
+// Lowers small QuarterLang programs through the real front end, over both AST
+// layouts, and checks what they compute on the stack VM and in register mode
+// before and after optimization.
+bool runLoweringTest() {
+    struct Case {
+        const char* name;
+        const char* source;
+        int64_t expected;
+    };
+    // Literals are dozenal: 10 is twelve, 100 is 144 and 0X is ten.
+    const std::vector<Case> cases = {
+        { "fib", "func fib(n: int) {\n    when n <= 1: return n\n    return fib(n - 1) + fib(n - 2)\n}\nreturn fib(0X)\n", 55 },
+        { "default parameter", "func fact(x, acc = 1) {\n    when x <= 1:\n        return acc\n    else:\n        return fact(x - 1, x * acc)\n}\nreturn fact(5)\n", 120 },
+        { "while loop", "var total = 0\nvar i = 1\nwhile i <= 10:\n    total += i\n    i = i + 1\nreturn total\n", 78 },
+        { "elif chain", "func sign(x) {\n    if x < 0: return -1\n    elif x == 0: return 0\n    else: return 1\n}\nreturn sign(-7) * 100 + sign(0) * 10 + sign(3)\n", -143 },
+        { "comparisons", "val a = 3 > 2\nval b = 2 >= 3\nval c = 4 != 4\nreturn a * 100 + b * 10 + c\n", 144 },
+        { "when expression", "val x = 7\nreturn when x > 5: x * 2 else: 0\n", 14 },
+        { "surplus arguments", "func id(x) { return x }\nreturn id(4, 5, 6)\n", 4 },
+        { "wide literal", "val x = 1000000000\nreturn x - 100000000\n", 4729798656 },
+        // A tab is four columns: the last increment leaves the `if` body but stays in the loop.
+        { "tab indent", "var i = 0\nwhile i < 3:\n\tif i == 1:\n\t  i += 1\n  i += 1\nreturn i\n", 3 },
+    };
+    // Each must report one statement that does not parse rather than run without it.
+    const std::vector<const char*> rejected = {
+        "var i = 0\nwhile i < 10:\n    if i == 5: break\n    i += 1\nreturn i\n",
+        "val a = 10\nval b = a / 2\nreturn b + 1\n",
+        "val x = 1000000000000000000000\nreturn x\n",
+    };
+
+    bool pass = true;
+    for (const Case& c : cases) {
+        QLDCILResult parsed = generateDCIL(lexQuarterLang(std::string(c.source)));
+        const std::vector<DCILInstruction>& dcil = parsed.instructions;
+        ASTArena arena;
+        std::vector<UICLOp> uicl = convertASTToUICL(parseDCILToAST(dcil, arena));
+        std::vector<UICLOp> flat = convertASTToUICL(buildFlatAST(dcil));
+        QLVMModule module;
+        QLRegModule registers;
+        QLVMState state;
+        QLRegState regState;
+        std::string error;
+        int64_t stack = 0, reg = 0, optimized = 0;
+        bool ok = parsed.failed.empty() && sameUICL(uicl, flat) && loadVMModule(compileUICLToBytecode(uicl), module, error);
+        if (ok) {
+            stack = runVM(module, state);
+            ok = state.error.empty() && compileRegisterModule(module, registers, error);
+        }
+        if (ok) {
+            reg = runRegisterVM(registers, regState);
+            ok = regState.error.empty() && optimizeRegisterModule(registers, error);
+        }
+        if (ok) {
+            optimized = runRegisterVM(registers, regState);
+            ok = regState.error.empty() && stack == c.expected && reg == c.expected && optimized == c.expected;
+        }
+        if (!ok) {
+            std::cerr << "[TEST] lowering: " << c.name << " gave " << stack << "/" << reg << "/" << optimized << ", expected "
+                      << c.expected << (error.empty() ? "" : " (" + error + ")") << std::endl;
+        }
+        pass = pass && ok;
+    }
+    for (const char* source : rejected) {
+        QLTokenStream stream = lexQuarterLang(std::string(source));
+        std::vector<QLSpan> failed = generateDCIL(stream).failed;
+        if (failed.empty()) std::cerr << "[TEST] lowering: accepted a statement that does not parse in\n" << source << std::endl;
+        else if (DEBUG_MODE) printParseFailures(stream, failed, std::cerr);
+        pass = pass && !failed.empty();
+    }
+    std::cout << "[TEST] source lowering: " << (pass ? "PASS" : "FAIL") << " (" << cases.size() << " programs, "
+              << rejected.size() << " rejected)\n";
+    return pass;
+}
+
+// ======== Step 6: Generate Windows/Linux Executable ========
+void generateExecutable(const Bytecode& bc, const std::string& output_path) {
+    std::ofstream out(output_path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Failed to open output file." << std::endl;
+        return;
+    }
+#ifdef _WIN32
+    out.write("MZ", 2);
+#else
+    out.write("\x7F" "ELF", 4);
+#endif
+    for (auto byte : bc.code) out.put(static_cast<char>(byte));
+    out.close();
+}
+// ======== Front-End Benchmark Suite ========
+// Times every pipeline stage on a corpus assembled from the repository's own
+// .qtr sources at 1x/10x/100x and prints one JSON object per stage and scale
+// so runs can be diffed and tracked for regressions.
+size_t peakRSSKiB() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return static_cast<size_t>(usage.ru_maxrss) / 1024;
+#else
+        return static_cast<size_t>(usage.ru_maxrss);
+#endif
+    }
+#endif
+    return 0;
+}
+
+struct StageMeasurement {
+    double bestMs = 0;
+    size_t allocations = 0;
+    size_t allocatedBytes = 0;
+};
+
+// Runs stage `reps` times and keeps the fastest; allocation counts come from
+// the first run so caches warmed by later runs do not hide them.
+template <typename Stage>
+StageMeasurement measureStage(int reps, Stage&& stage) {
+    StageMeasurement m;
+    for (int r = 0; r < reps; ++r) {
+        size_t allocs = g_heapAllocations.load();
+        size_t bytes = g_heapBytes.load();
+        auto start = std::chrono::steady_clock::now();
+        stage();
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+        if (r == 0) {
+            m.allocations = g_heapAllocations.load() - allocs;
+            m.allocatedBytes = g_heapBytes.load() - bytes;
+            m.bestMs = ms.count();
+        }
+        m.bestMs = std::min(m.bestMs, ms.count());
+    }
+    return m;
+}
+
+bool runFrontEndBenchmark(const std::string& repoRoot, std::ostream& out, int reps = 3) {
+    std::string unit;
+    for (const char* file : { "recursion.qtr", "utils.qtr", "QuarterLang_Indexter.qtr", "QuarterLang_Lexer.qtr",
+                              "QuarterLang_Parser.qtr", "QuarterLang_SyntaxHighlighter.qtr", "InterpreterEngine.qtr", "stdlib.qtr" }) {
+        QLSourceBuffer source;
+        if (!source.load(repoRoot + "/" + file)) {
+            std::cerr << "[BENCH] missing corpus file: " << file << std::endl;
+            return false;
+        }
+        unit.append(source.data(), source.size());
+        unit += '\n';
+    }
+
+    for (int scale : { 1, 10, 100 }) {
+        std::string corpus;
+        corpus.reserve(unit.size() * scale);
+        for (int i = 0; i < scale; ++i) corpus += unit;
+        double mb = corpus.size() / (1024.0 * 1024.0);
+
+        auto report = [&](const char* stage, const StageMeasurement& m, size_t items) {
+            out << "{\"scale\":" << scale << ",\"stage\":\"" << stage << "\",\"bytes\":" << corpus.size()
+                << ",\"items\":" << items << ",\"ms\":" << m.bestMs
+                << ",\"mb_per_s\":" << mb / std::max(m.bestMs / 1000.0, 1e-9)
+                << ",\"allocations\":" << (QL_ALLOCATIONS_COUNTED ? std::to_string(m.allocations) : "null")
+                << ",\"allocated_bytes\":" << (QL_ALLOCATIONS_COUNTED ? std::to_string(m.allocatedBytes) : "null")
+                << ",\"peak_rss_kib\":" << peakRSSKiB() << "}\n";
+        };
+
+        // Each measurement is taken before report() reads the stage's output size.
+        std::vector<QLToken> legacyTokens;
+        StageMeasurement m = measureStage(reps, [&] { legacyTokens = tokenizeQuarterLang(corpus); });
+        report("tokenizeQuarterLang", m, legacyTokens.size());
+        legacyTokens = {};
+
+        QLTokenStream stream;
+        m = measureStage(reps, [&] { stream = lexQuarterLang(corpus); });
+        report("lexQuarterLang", m, stream.tokens.size());
+
+        std::vector<DCILInstruction> dcil;
+        m = measureStage(reps, [&] { dcil = generateDCIL(stream).instructions; });
+        report("generateDCIL", m, dcil.size());
+
+        ASTArena arena;
+        ASTNode* ast = nullptr;
+        m = measureStage(reps, [&] {
+            arena.reset();
+            ast = parseDCILToAST(dcil, arena);
+        });
+        report("parseDCILToAST", m, dcil.size() + 1);
+
+        std::vector<UICLOp> uicl;
+        m = measureStage(reps, [&] { uicl = convertASTToUICL(ast); });
+        report("convertASTToUICL", m, uicl.size());
+
+        Bytecode bytecode;
+        m = measureStage(reps, [&] { bytecode = compileUICLToBytecode(uicl); });
+        report("compileUICLToBytecode", m, bytecode.code.size());
     }
-#ifdef _WIN32
-    out.write("MZ", 2);
-#else
-    out.write("\x7FELF", 4);
-#endif
-    for (auto byte : bc.code) out.put(static_cast<char>(byte));
-    out.close();
+    return true;
 }
 
 // ======== Entry Point ========
 int main(int argc, char** argv) {
+    if (argc >= 2 && std::string(argv[1]) == "--bench-ast") {
+        runASTBenchmark(argc >= 3 ? std::stoul(argv[2]) : 1000000);
+        return 0;
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--bench-ast-walk") {
+        runASTTraversalBenchmark(argc >= 3 ? std::stoul(argv[2]) : 1000000);
+        return 0;
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--test-bytecode") {
+        return runBytecodeRoundTripTest() ? 0 : 1;
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--bench-bytecode") {
+        runBytecodeBenchmark(argc >= 3 ? std::stoul(argv[2]) : 1000000);
+        return 0;
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--bench-interp") {
+        runInterpreterBenchmark(argc >= 3 ? std::stoul(argv[2]) : 1000000);
+        return 0;
+    }
+    int status = 0;
+    if (runVMCommand(argc, argv, lowerQuarterSource, status)) return status;
+    if (argc >= 2 && std::string(argv[1]) == "--test-lowering") {
+        return runLoweringTest() ? 0 : 1;
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--repl") {
+        DEBUG_MODE = argc >= 3 && std::string(argv[2]) == "--debug";
+        runREPL();
+        return 0;
+    }
+    if (argc >= 3 && std::string(argv[1]) == "--bench-incremental") {
+        QLSourceBuffer corpus;
+        if (!corpus.load(argv[2])) {
+            std::cerr << "Failed to open benchmark corpus." << std::endl;
+            return 1;
+        }
+        runIncrementalBenchmark(std::string(corpus.view()), argc >= 4 ? std::stoul(argv[3]) : 50000);
+        return 0;
+    }
+    if (argc >= 3 && std::string(argv[1]) == "--bench-frontend") {
+        if (argc >= 4) {
+            std::ofstream out(argv[3]);
+            return runFrontEndBenchmark(argv[2], out) ? 0 : 1;
+        }
+        return runFrontEndBenchmark(argv[2], std::cout) ? 0 : 1;
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--bench-scan") {
+        return QuarterIndentLexer::runLexerScanBenchmark(argc >= 3 ? argv[2] : ".", argc >= 4 ? std::stoi(argv[3]) : 50) ? 0 : 1;
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--test-parallel-lexer") {
+        return QuarterIndentLexer::runParallelLexerDeterminismTest(argc >= 3 ? argv[2] : ".") ? 0 : 1;
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--bench-parallel-lexer") {
+        unsigned maxThreads = std::max(4u, std::thread::hardware_concurrency());
+        return QuarterIndentLexer::runParallelLexerBenchmark(argc >= 3 ? argv[2] : ".", argc >= 4 ? std::stoi(argv[3]) : 50, maxThreads) ? 0 : 1;
+    }
+    if (argc >= 3 && std::string(argv[1]) == "--bench-lexer") {
+        QLSourceBuffer corpus;
+        if (!corpus.load(argv[2])) {
+            std::cerr << "Failed to open benchmark corpus." << std::endl;
+            return 1;
+        }
+        runLexerBenchmark(std::string(corpus.view()));
+        return 0;
+    }
     if (argc < 3) {
-        std::cerr << "Usage: qtranspiler <input.ql> <output.exe> [--debug]" << std::endl;
+        std::cerr << "Usage: qtranspiler <input.ql> <output.exe> [--debug] [--stats] [--flat-ast] [--ast-dot <file.dot>] [--run] [--run-vm [--vm-checked] [--vm-tiered] [--vm-opt]]" << std::endl;
+        std::cerr << "       qtranspiler --repl [--debug]" << std::endl;
+        std::cerr << "       qtranspiler --test-bytecode" << std::endl;
+        std::cerr << "       qtranspiler --test-lowering" << std::endl;
+        std::cerr << "       qtranspiler --bench-bytecode [ops]" << std::endl;
+        std::cerr << "       qtranspiler --bench-interp [ops]" << std::endl;
+        printVMUsage(std::cerr, "qtranspiler");
+        std::cerr << "       qtranspiler --bench-lexer <corpus.qtr>" << std::endl;
+        std::cerr << "       qtranspiler --bench-scan [repo-root] [copies]" << std::endl;
+        std::cerr << "       qtranspiler --test-parallel-lexer [repo-root]" << std::endl;
+        std::cerr << "       qtranspiler --bench-parallel-lexer [repo-root] [copies]" << std::endl;
+        std::cerr << "       qtranspiler --bench-incremental <corpus.qtr> [lines]" << std::endl;
+        std::cerr << "       qtranspiler --bench-frontend <repo-root> [results.jsonl]" << std::endl;
+        std::cerr << "       qtranspiler --bench-ast [nodes]" << std::endl;
+        std::cerr << "       qtranspiler --bench-ast-walk [nodes]" << std::endl;
         return 1;
     }
-    if (argc >= 4 && std::string(argv[3]) == "--debug") {
-        DEBUG_MODE = true;
-    }
-
-    std::ifstream input(argv[1]);
-    if (!input) {
+    bool showStats = false;
+    bool flatAST = false;
+    bool runAfterCompile = false;
+    bool runOnVM = false;
+    QLVMRunOptions vmOptions;
+    std::string dotPath;
+    for (int i = 3; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--debug") DEBUG_MODE = true;
+        else if (flag == "--stats") showStats = true;
+        else if (flag == "--flat-ast") flatAST = true;
+        else if (flag == "--run") runAfterCompile = true;
+        else if (flag == "--run-vm") runOnVM = true;
+        else if (flag == "--vm-checked") vmOptions.checked = true;
+        else if (flag == "--vm-tiered") vmOptions.tiered = true;
+        else if (flag == "--vm-opt") vmOptions.optimize = true;
+        else if (flag == "--ast-dot" && i + 1 < argc) dotPath = argv[++i];
+    }
+
+    auto loadStart = std::chrono::steady_clock::now();
+    QLSourceBuffer source;
+    if (!source.load(argv[1])) {
         std::cerr << "Failed to open QuarterLang source." << std::endl;
         return 1;
     }
-
-    std::string code((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
-    auto tokens = tokenizeQuarterLang(code);
-    auto dcil = generateDCIL(tokens);
-    auto ast = parseDCILToAST(dcil);
-    auto uicl = convertASTToUICL(ast);
+    std::chrono::duration<double, std::milli> loadMs = std::chrono::steady_clock::now() - loadStart;
+    size_t sourceBytes = source.size();
+    bool sourceMapped = source.mapped();
+
+    auto lexStart = std::chrono::steady_clock::now();
+    auto tokens = lexQuarterLang(std::move(source));
+    std::chrono::duration<double, std::milli> lexMs = std::chrono::steady_clock::now() - lexStart;
+    QLDCILResult parsed = generateDCIL(tokens);
+    if (!parsed.failed.empty()) {
+        printParseFailures(tokens, parsed.failed, std::cerr);
+        std::cerr << "Compilation failed: " << parsed.failed.size() << " statement(s) do not parse." << std::endl;
+        return 1;
+    }
+    const std::vector<DCILInstruction>& dcil = parsed.instructions;
+    std::vector<UICLOp> uicl;
+    ASTArena astArena;
+    if (flatAST || !dotPath.empty()) {
+        FlatAST ast = buildFlatAST(dcil);
+        if (!dotPath.empty()) {
+            std::ofstream dot(dotPath);
+            writeASTDot(ast, dot);
+        }
+        uicl = convertASTToUICL(ast);
+    }
+    else {
+        uicl = convertASTToUICL(parseDCILToAST(dcil, astArena));
+    }
     auto bytecode = compileUICLToBytecode(uicl);
     generateExecutable(bytecode, argv[2]);
+    if (runAfterCompile) {
+        QLProgram program;
+        std::string error;
+        if (!predecodeBytecode(bytecode, program, error)) {
+            std::cerr << "Bytecode decode failed: " << error << std::endl;
+            return 1;
+        }
+        runProgram(program, &std::cout);
+    }
+    if (runOnVM && !runBytecodeOnVM(bytecode, vmOptions)) return 1;
 
+    if (showStats) {
+        std::cout << "[STATS] load: " << loadMs.count() << " ms, "
+                  << sourceBytes << " bytes " << (sourceMapped ? "mapped" : "read") << "\n";
+        std::cout << "[STATS] lex:  " << lexMs.count() << " ms, " << tokens.tokens.size() << " tokens\n";
+    }
     std::cout << "Compilation complete: " << argv[2] << std::endl;
     return 0;
 }
@@ -3222,6 +5824,7 @@ void loadLambdaMacrosFromFile(const std::string& path) {
 #include <functional>
 #include <memory>
 #include <stdexcept>
+#include "QuarterArena.hpp"
 
         // --- QuarterLang Primitive Types ---
         enum class QType { INT, STRING, DG, VOID };
@@ -3884,7 +6487,12 @@ end
     class Parser {
         std::vector<Token> tokens;
         size_t pos;
+        ASTArena& arena;   // owns every ExprNode built by this parser
+
+    public:
+        Parser(std::vector<Token> toks, ASTArena& a) : tokens(std::move(toks)), pos(0), arena(a) {}
 
+    private:
         int getPrecedence(TokenType tok) {
             switch (tok) {
             case TokenType::PLUS: return 10;
@@ -3908,7 +6516,7 @@ end
                 consume();
                 ExprNode* right = parseExpression(tokPrec + 1);
 
-                left = new BinaryOpNode(tok.type, left, right);
+                left = arena.make<BinaryOpNode>(tok.type, left, right);
             }
             return left;
         }
@@ -3967,175 +6575,21 @@ end
     };
 
 #include <iostream>
+#include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <stack>
 #include <cctype>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+#include "QuarterKeywords.hpp"
+#include "QuarterIndentLexer.hpp"
 
-    enum class TokenType {
-        STAR, END, VAL, VAR, ENUM, STRUCT, FUNC, DEFINE, LOOP, MATCH,
-        CASE, WHEN, RETURN, EXTERN, ASM, PLUGIN, IDENTIFIER,
-        INT_LITERAL, STRING_LITERAL, DG_LITERAL,
-        INDENT, DEDENT, NEWLINE, EOF_TOKEN,
-        PLUS, MINUS, MUL, DIV, LT, GT, EQ, NEQ, AND, OR,
-        COLON, COMMA, LPAREN, RPAREN, LBRACE, RBRACE,
-        UNKNOWN
-    };
-
-    struct Token {
-        TokenType type;
-        std::string text;
-        int line, col;
-    };
-
-    class Lexer {
-        std::istream& input;
-        std::string currentLine;
-        int lineNum = 0;
-        int pos = 0;
-        std::stack<int> indentStack{ 0 };
-
-    public:
-        Lexer(std::istream& in) : input(in) {}
-
-        std::vector<Token> tokenize() {
-            std::vector<Token> tokens;
-            while (getline(input, currentLine)) {
-                lineNum++;
-                pos = 0;
-                int indent = countIndent(currentLine);
-                handleIndentation(indent, tokens);
-                while (pos < (int)currentLine.size()) {
-                    if (isspace(currentLine[pos])) { pos++; continue; }
-                    Token tok = nextToken();
-                    tokens.push_back(tok);
-                }
-                tokens.push_back({ TokenType::NEWLINE, "\n", lineNum, pos });
-            }
-            while (indentStack.size() > 1) {
-                indentStack.pop();
-                tokens.push_back({ TokenType::DEDENT, "", lineNum, 0 });
-            }
-            tokens.push_back({ TokenType::EOF_TOKEN, "", lineNum, 0 });
-            return tokens;
-        }
-
-    private:
-        int countIndent(const std::string& line) {
-            int count = 0;
-            for (char c : line) {
-                if (c == ' ') count++;
-                else break;
-            }
-            return count;
-        }
-
-        void handleIndentation(int indent, std::vector<Token>& tokens) {
-            if (indent > indentStack.top()) {
-                indentStack.push(indent);
-                tokens.push_back({ TokenType::INDENT, "", lineNum, 0 });
-            }
-            else {
-                while (indent < indentStack.top()) {
-                    indentStack.pop();
-                    tokens.push_back({ TokenType::DEDENT, "", lineNum, 0 });
-                }
-            }
-        }
-
-        Token nextToken() {
-            char c = currentLine[pos];
-            int start = pos;
-
-            // Single char tokens
-            switch (c) {
-            case '+': pos++; return { TokenType::PLUS, "+", lineNum, start };
-            case '-': pos++; return { TokenType::MINUS, "-", lineNum, start };
-            case '*': pos++; return { TokenType::MUL, "*", lineNum, start };
-            case '/': pos++; return { TokenType::DIV, "/", lineNum, start };
-            case '(': pos++; return { TokenType::LPAREN, "(", lineNum, start };
-            case ')': pos++; return { TokenType::RPAREN, ")", lineNum, start };
-            case ':': pos++; return { TokenType::COLON, ":", lineNum, start };
-            case ',': pos++; return { TokenType::COMMA, ",", lineNum, start };
-            case '<': pos++; return { TokenType::LT, "<", lineNum, start };
-            case '>': pos++; return { TokenType::GT, ">", lineNum, start };
-            case '=':
-                pos++;
-                if (pos < (int)currentLine.size() && currentLine[pos] == '=') {
-                    pos++;
-                    return { TokenType::EQ, "==", lineNum, start };
-                }
-                return { TokenType::EQ, "=", lineNum, start };
-            default:
-                break;
-            }
-
-            // Identifiers or keywords
-            if (isalpha(c) || c == '_') {
-                while (pos < (int)currentLine.size() && (isalnum(currentLine[pos]) || currentLine[pos] == '_')) {
-                    pos++;
-                }
-                std::string text = currentLine.substr(start, pos - start);
-                // Map keywords
-                if (text == "star") return { TokenType::STAR, text, lineNum, start };
-                if (text == "end") return { TokenType::END, text, lineNum, start };
-                if (text == "val") return { TokenType::VAL, text, lineNum, start };
-                if (text == "var") return { TokenType::VAR, text, lineNum, start };
-                if (text == "enum") return { TokenType::ENUM, text, lineNum, start };
-                if (text == "struct") return { TokenType::STRUCT, text, lineNum, start };
-                if (text == "func" || text == "define") return { TokenType::FUNC, text, lineNum, start };
-                if (text == "loop") return { TokenType::LOOP, text, lineNum, start };
-                if (text == "match") return { TokenType::MATCH, text, lineNum, start };
-                if (text == "case") return { TokenType::CASE, text, lineNum, start };
-                if (text == "when") return { TokenType::WHEN, text, lineNum, start };
-                if (text == "return") return { TokenType::RETURN, text, lineNum, start };
-                if (text == "extern") return { TokenType::EXTERN, text, lineNum, start };
-                if (text == "asm") return { TokenType::ASM, text, lineNum, start };
-                if (text == "plugin") return { TokenType::PLUGIN, text, lineNum, start };
-                return { TokenType::IDENTIFIER, text, lineNum, start };
-            }
-
-            // Integer literals
-            if (isdigit(c)) {
-                while (pos < (int)currentLine.size() && isdigit(currentLine[pos])) pos++;
-                return { TokenType::INT_LITERAL, currentLine.substr(start, pos - start), lineNum, start };
-            }
-
-            // String literal: "..."
-            if (c == '"') {
-                pos++;
-                std::string str;
-                while (pos < (int)currentLine.size() && currentLine[pos] != '"') {
-                    if (currentLine[pos] == '\\' && pos + 1 < (int)currentLine.size()) {
-                        pos++;
-                        switch (currentLine[pos]) {
-                        case 'n': str += '\n'; break;
-                        case 't': str += '\t'; break;
-                        default: str += currentLine[pos]; break;
-                        }
-                    }
-                    else {
-                        str += currentLine[pos];
-                    }
-                    pos++;
-                }
-                pos++; // consume closing "
-                return { TokenType::STRING_LITERAL, str, lineNum, start };
-            }
-
-            // DG literals (Hex base-12: digits 0-9,X,Y)
-            if (c >= '0' && c <= '9' || c == 'X' || c == 'Y') {
-                while (pos < (int)currentLine.size() &&
-                    (isdigit(currentLine[pos]) || currentLine[pos] == 'X' || currentLine[pos] == 'Y')) {
-                    pos++;
-                }
-                return { TokenType::DG_LITERAL, currentLine.substr(start, pos - start), lineNum, start };
-            }
-
-            pos++;
-            return { TokenType::UNKNOWN, std::string(1,c), lineNum, start };
-        }
-    };
+    using namespace QuarterIndentLexer;
 
 #include <memory>
 #include <map>
@@ -4693,7 +7147,7 @@ end
             return 1;
         }
         // Tokenize the code block
-        Lexer lexer(std::istringstream(code_block));
+        Lexer lexer(code_block);
         auto tokens = lexer.tokenize();
 		// Parse the tokens into an AST and evaluate it
         try {
@@ -7412,11 +9866,13 @@ public:
 };
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cctype>
 #include <stdexcept>
 #include <iostream>
 #include <stack>
+#include "QuarterKeywords.hpp"
 
 enum class TokenType {
     IDENTIFIER, INT_LITERAL, STRING_LITERAL,
@@ -7544,31 +10000,29 @@ private:
         return makeToken(type, text);
     }
 
-    TokenType keywordToToken(const std::string& word) {
-        static const std::unordered_map<std::string, TokenType> keywords = {
-            {"star", TokenType::STAR},
-            {"end", TokenType::END},
-            {"val", TokenType::VAL},
-            {"var", TokenType::VAR},
-            {"as", TokenType::AS},
-            {"enum", TokenType::ENUM},
-            {"struct", TokenType::STRUCT},
-            {"define", TokenType::DEFINE},
-            {"return", TokenType::RETURN},
-            {"loop", TokenType::LOOP},
-            {"match", TokenType::MATCH},
-            {"case", TokenType::CASE},
-            {"when", TokenType::WHEN},
-            {"plugin", TokenType::PLUGIN},
-            {"load", TokenType::LOAD},
-            {"extern", TokenType::EXTERN},
-            {"func", TokenType::FUNC},
-            {"asm", TokenType::ASM},
-            // add more as needed
-        };
-        auto it = keywords.find(word);
-        if (it != keywords.end()) return it->second;
-        return TokenType::IDENTIFIER;
+    TokenType keywordToToken(std::string_view word) {
+        using QuarterKeywords::id;
+        switch (QuarterKeywords::lookup(word)) {
+        case id("star"): return TokenType::STAR;
+        case id("end"): return TokenType::END;
+        case id("val"): return TokenType::VAL;
+        case id("var"): return TokenType::VAR;
+        case id("as"): return TokenType::AS;
+        case id("enum"): return TokenType::ENUM;
+        case id("struct"): return TokenType::STRUCT;
+        case id("define"): return TokenType::DEFINE;
+        case id("return"): return TokenType::RETURN;
+        case id("loop"): return TokenType::LOOP;
+        case id("match"): return TokenType::MATCH;
+        case id("case"): return TokenType::CASE;
+        case id("when"): return TokenType::WHEN;
+        case id("plugin"): return TokenType::PLUGIN;
+        case id("load"): return TokenType::LOAD;
+        case id("extern"): return TokenType::EXTERN;
+        case id("func"): return TokenType::FUNC;
+        case id("asm"): return TokenType::ASM;
+        default: return TokenType::IDENTIFIER;
+        }
     }
 
     Token numberLiteral() {
@@ -8548,7 +11002,7 @@ namespace ScrollLog {
 #pragma once
 #include <string>
 #include <vector>
-#include <unordered_map>
+#include "QuarterKeywords.hpp"
 
 enum class TokenType {
     Keyword,
@@ -8568,11 +11022,9 @@ struct Token {
 
 class QuarterSyntaxHighlighter {
 public:
-    QuarterSyntaxHighlighter();
     std::vector<Token> tokenize(const std::string& line);
 
 private:
-    std::unordered_map<std::string, TokenType> keywords;
     bool isIdentifierStart(char c);
     bool isIdentifierChar(char c);
     bool isDigit(char c);
@@ -8581,22 +11033,6 @@ private:
 #include "QuarterSyntaxHighlighter.hpp"
 #include <cctype>
 
-QuarterSyntaxHighlighter::QuarterSyntaxHighlighter() {
-    keywords = {
-        {"import", TokenType::Keyword},
-        {"func", TokenType::Keyword},
-        {"var", TokenType::Keyword},
-        {"end", TokenType::Keyword},
-        {"fn", TokenType::Keyword},
-        {"if", TokenType::Keyword},
-        {"else", TokenType::Keyword},
-        {"for", TokenType::Keyword},
-        {"return", TokenType::Keyword},
-        {"true", TokenType::Keyword},
-        {"false", TokenType::Keyword},
-    };
-}
-
 bool QuarterSyntaxHighlighter::isIdentifierStart(char c) {
     return std::isalpha(c) || c == '_';
 }
@@ -8639,10 +11075,9 @@ std::vector<Token> QuarterSyntaxHighlighter::tokenize(const std::string& line) {
         else if (isIdentifierStart(c)) {
             size_t start = i;
             while (i < line.length() && isIdentifierChar(line[i])) ++i;
-            std::string word = line.substr(start, i - start);
-            auto it = keywords.find(word);
-            TokenType type = (it != keywords.end()) ? it->second : TokenType::Identifier;
-            tokens.push_back({ type, word });
+            std::string_view word(line.data() + start, i - start);
+            TokenType type = QuarterKeywords::isKeyword(word) ? TokenType::Keyword : TokenType::Identifier;
+            tokens.push_back({ type, std::string(word) });
         }
         else if (std::string("+-=*/:<>,.[]()").find(c) != std::string::npos) {
             tokens.push_back({ TokenType::Operator, std::string(1, c) });
@@ -8679,10 +11114,11 @@ for (const auto& token : tokens) {
 
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
 #include <tuple>
 #include <regex>
+#include "QuarterKeywords.hpp"
 
 enum class QTokenType {
     Keyword, Identifier, String, Number, Comment,
@@ -8696,21 +11132,16 @@ struct QToken {
     size_t column;
 };
 
-struct QKeywordInfo {
-    std::string purpose;
-    std::string example;
-};
+// Purpose/example rows come straight from the shared keyword chart table.
+using QKeywordInfo = QuarterKeywords::Entry;
 
 class QuarterLangHighlighter {
 public:
-    QuarterLangHighlighter();
     std::vector<QToken> tokenize(const std::string& source);
-    QTokenType classify(const std::string& word) const;
-    const QKeywordInfo* get_info(const std::string& keyword) const;
+    QTokenType classify(std::string_view word) const;
+    const QKeywordInfo* get_info(std::string_view keyword) const;
 
 private:
-    std::unordered_map<std::string, QKeywordInfo> keyword_db;
-
     bool is_identifier_start(char c);
     bool is_identifier(char c);
     bool is_digit(char c);
@@ -8721,92 +11152,6 @@ private:
 #include <cctype>
 #include <sstream>
 
-QuarterLangHighlighter::QuarterLangHighlighter() {
-    keyword_db = {
-        {"val", {"Declare immutable variable", "val x as int: 5"}},
-        {"var", {"Declare mutable variable", "var score as float: 0.0"}},
-        {"bool", {"Declare a boolean value", "val is_valid as bool: true"}},
-        {"truths", {"Declare foundational truths for logic/proof", "truths: identity, motion"}},
-        {"proofs", {"Declare verifiable logical constructs", "proofs validate gravity against mass"}},
-        {"types", {"Define or annotate data types", "val t as types: numeric"}},
-        {"primatives", {"Declare raw values or low-level types", "val id as primative: 42"}},
-        {"dodecagrams", {"Declare DG values (base-12 SIMD symbols)", "val id as dodecagram: 9A3"}},
-        {"dg", {"Shorthand for DG declaration", "val x as dg: A9B"}},
-        {"dgvec", {"SIMD vector of DodecaGrams", "val v as dgvec: [9A1, 9A2, 9A3]"}},
-        {"loop", {"Create bounded loop", "loop from 1 to 10:"}},
-        {"while", {"Loop while condition is true", "while x < 10:"}},
-        {"when", {"Conditional branch", "when score > 90:"}},
-        {"else", {"Else branch", "else:"}},
-        {"elif", {"Else-if condition", "elif score == 80:"}},
-        {"stop", {"Immediate halt of program", "stop"}},
-        {"match", {"Pattern match multiple values", "match status:"}},
-        {"case", {"Case inside match", "case 200:"}},
-        {"say", {"Output to console or stdout", R"(say "Running")"}},
-        {"define", {"Named function definition", "define compute(x y):"}},
-        {"fn", {"Anonymous inline function", "fn a b -> a + b"}},
-        {"procedure", {"Side-effect driven named block", "procedure setup()"}},
-        {"yield", {"Yield from coroutine or generator", "yield data"}},
-        {"return", {"Return value from function", "return result: ok x"}},
-        {"thread", {"Launch parallel thread", "thread update_UI()"}},
-        {"spawn", {"Spawn new thread or unit", "spawn indexer()"}},
-        {"async", {"Define asynchronous task", "async define fetch_data()"}},
-        {"await", {"Await async result", "val output: await fetch_data()"}},
-        {"lock", {"Lock shared resource", "lock file_handler:"}},
-        {"sync", {"Synchronize threads or scopes", "sync:"}},
-        {"inline", {"Inline function or logic", "inline multiply()"}},
-        {"nest", {"Create encapsulated block", "nest config:"}},
-        {"pipe", {"Direct data stream", R"(val log as pipe: "debug.log")"}},
-        {"map", {"Transform collections", "map items with fn x -> x * 2"}},
-        {"filter", {"Filter collection by predicate", "filter nums with fn x -> x > 0"}},
-        {"reduce", {"Reduce collection to single result", "reduce nums with fn acc x -> acc + x"}},
-        {"bind", {"Bind value or result", "bind total to sum(x, y)"}},
-        {"derive", {"Create transformation of value", "derive z from x by 2"}},
-        {"from", {"Specify source in derivation/import", "derive b from a:"}},
-        {"by", {"Modifier in transformation", "derive size from area by 2"}},
-        {"entry", {"Insert key-value into table/map", R"(entry users: 101 => "admin")"}},
-        {"table", {"Declare associative map", "table lookup as map[int, string]:"}},
-        {"scope", {"Create a local isolated block", "scope buffer:"}},
-        {"decorate", {"Attach metadata to functions or types", "@trace define render()"}},
-        {"decorators", {"Define reusable annotations", "decorators: @trace, @inline"}},
-        {"class", {"Define a reusable object blueprint", "class Window:"}},
-        {"object", {"Instantiate or reference a class", "val main as Window: new()"}},
-        {"structs", {"Define structured record types", "struct Point: x as int, y as int"}},
-        {"module", {"Declare self-contained namespace", "module geometry:"}},
-        {"import", {"Import external module", "import crypto.qtr"}},
-        {"include", {"Include file into current source", R"(include "mathlib.qtr")"}},
-        {"textures", {"Reference graphical assets", R"(val tex as texture: "skin1.png")"}},
-        {"update", {"Declare update logic loop", "procedure update_state()"}},
-        {"frame", {"Single tick unit in rendering or sim loop", "frame render()"}},
-        {"tick", {"Frame timing & scheduling", "tickrate: 60hz"}},
-        {"unit", {"Declare atomic isolated operation", "unit ClearMemory:"}},
-        {"cycle", {"Timed loop or system trigger", "cycle heartbeat every 100ms:"}},
-        {"ref", {"Reference alias to variable", "ref current to settings.main:"}},
-        {"mutate", {"Explicit variable mutation", "mutate balance with fn x -> x - 5"}},
-        {"mirror", {"Reflect or observe structure", "mirror payload:"}},
-        {"lens", {"View/edit subset of structure", "lens position from obj:"}},
-        {"nodes", {"Declare DAG or graph-like node units", "node filter_gate:"}},
-        {"controls", {"Master flow-control structures", "controls: loop, match"}},
-        {"keywords", {"Inspect or print language keywords", "say keywords"}},
-        {"nasm", {"Inline NASM injection", "nasm { mov rdi, rax }"}},
-        {"hex", {"Inline hexadecimal encoding", "hex: 0x48 0x89 0xC7"}},
-        {"asm", {"Inline assembly block", "asm { mov rax, 5 }"}},
-        {"profile", {"Mark block for benchmarking", R"(profile "parser_speed":)"}},
-        {"assert", {"Runtime assertion check", "assert x == 5"}},
-        {"test", {"Declare unit test", R"(test "math add":)"}},
-        {"option", {"Optional value container", "val name as option[string]: none"}},
-        {"result", {"Success/error union result", "return result: ok 42"}},
-        {"error", {"Return error in union", R"(return result: error "bad op")"}},
-        {"try", {"Handle exceptions", "try: ... catch e:"}},
-        {"catch", {"Catch exception", "catch e:"}},
-        {"finally", {"Cleanup block", "finally:"}},
-        {"guard", {"Protected block", "guard:"}},
-        {"track", {"Monitor value at runtime", "track packet_id"}},
-        {"override", {"Override method in class/trait", "override define toString()"}},
-        {"implements", {"Satisfy contract/trait", "define draw(obj) implements Drawable"}},
-        {"concept", {"Define behavior constraint", "concept Equatable:"}}
-    };
-}
-
 bool QuarterLangHighlighter::is_identifier_start(char c) {
     return std::isalpha(c) || c == '_';
 }
@@ -8871,61 +11216,194 @@ std::vector<QToken> QuarterLangHighlighter::tokenize(const std::string& src) {
     return tokens;
 }
 
-QTokenType QuarterLangHighlighter::classify(const std::string& word) const {
-    return keyword_db.count(word) ? QTokenType::Keyword : QTokenType::Identifier;
+QTokenType QuarterLangHighlighter::classify(std::string_view word) const {
+    return QuarterKeywords::isKeyword(word) ? QTokenType::Keyword : QTokenType::Identifier;
 }
 
-const QKeywordInfo* QuarterLangHighlighter::get_info(const std::string& keyword) const {
-    auto it = keyword_db.find(keyword);
-    return (it != keyword_db.end()) ? &it->second : nullptr;
+const QKeywordInfo* QuarterLangHighlighter::get_info(std::string_view keyword) const {
+    uint8_t i = QuarterKeywords::lookup(keyword);
+    return i != QuarterKeywords::NONE ? &QuarterKeywords::ENTRIES[i] : nullptr;
 }
 
-#include <llvm/ExecutionEngine/ExecutionEngine.h>
-#include <llvm/ExecutionEngine/MCJIT.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SHA1.h>
 #include <llvm/Support/TargetSelect.h>
-#include <llvm/Support/SourceMgr.h>
 #include <llvm/Support/Error.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/IRBuilder.h>
-#include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Verifier.h>
-#include <llvm/IR/LegacyPassManager.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// Every module handed to compile() is built for one tier; each tier runs
+// its own pass pipeline, in the textual form `opt -passes=` accepts.
+enum class QuarterJITTier : unsigned { Baseline, Optimized, Count };
+
+struct QuarterJITConfig {
+    unsigned compileThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::string pipelines[static_cast<unsigned>(QuarterJITTier::Count)] = {
+        "function(sroa,early-cse,instcombine,simplifycfg)",
+        "default<O2>",
+    };
+    std::string cacheDirectory;  // on-disk object cache; empty disables it
+};
+
+// Objects on disk, keyed by a hash of a partition's IR before optimization
+// plus its pipeline and host. The key is computed in the transform layer and
+// reaches the compiler as named metadata, so a hit skips both the pass
+// pipeline and code generation, in this process or a later one. The transform
+// layer reads the object itself before skipping the passes; the compiler then
+// takes that buffer, so a file that vanishes or fails to read in between can
+// never leave unoptimized code to be compiled and cached under the key.
+class QuarterObjectCache : public llvm::ObjectCache {
+    std::string directory;
+    std::atomic<size_t> hitCount{ 0 };
+    std::mutex loadedMutex;
+    std::unordered_map<std::string, std::unique_ptr<llvm::MemoryBuffer>> loaded;  // read by load(), not yet taken
+public:
+    explicit QuarterObjectCache(std::string dir) : directory(std::move(dir)) {
+        llvm::sys::fs::create_directories(directory);
+    }
+    static std::string key(const llvm::Module& M) {
+        const llvm::NamedMDNode* node = M.getNamedMetadata("quarter.cache_key");
+        if (!node || node->getNumOperands() == 0) return {};
+        auto* str = llvm::dyn_cast<llvm::MDString>(node->getOperand(0)->getOperand(0));
+        return str ? str->getString().str() : std::string();
+    }
+    // Reads the object for `key` and holds it for getObject; false if there is none.
+    bool load(const std::string& key) {
+        auto buffer = llvm::MemoryBuffer::getFile(path(key));
+        if (!buffer) return false;
+        std::lock_guard<std::mutex> lock(loadedMutex);
+        loaded[key] = std::move(*buffer);
+        return true;
+    }
+    size_t hits() const { return hitCount; }
+    void notifyObjectCompiled(const llvm::Module* M, llvm::MemoryBufferRef object) override {
+        std::string k = key(*M);
+        if (k.empty()) return;
+        // Write a private file and rename it, so concurrent compiles and other
+        // processes never map a partial object.
+        int fd;
+        llvm::SmallString<128> tmp;
+        if (llvm::sys::fs::createUniqueFile(path(k) + "-%%%%%%.tmp", fd, tmp)) return;
+        llvm::raw_fd_ostream out(fd, true);
+        out << object.getBuffer();
+        out.close();
+        if (out.has_error() || llvm::sys::fs::rename(tmp, path(k))) {
+            out.clear_error();
+            llvm::sys::fs::remove(tmp);
+        }
+    }
+    std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* M) override {
+        std::string k = key(*M);
+        if (k.empty()) return nullptr;
+        {
+            std::lock_guard<std::mutex> lock(loadedMutex);
+            auto held = loaded.find(k);
+            if (held != loaded.end()) {
+                std::unique_ptr<llvm::MemoryBuffer> object = std::move(held->second);
+                loaded.erase(held);
+                ++hitCount;
+                return object;
+            }
+        }
+        // Optimized in this process, so any file under the key is optimized too.
+        auto buffer = llvm::MemoryBuffer::getFile(path(k));
+        if (!buffer) return nullptr;
+        ++hitCount;
+        return std::move(*buffer);
+    }
+private:
+    std::string path(const std::string& key) const { return directory + "/" + key + ".o"; }
+};
+
+// Functions are compiled on first call: compile() only registers the module
+// behind lazy reexports, and each call stub emits the partition holding its
+// function through the tier's pipeline on the session's compile threads.
 class QuarterLangJIT {
-    llvm::LLVMContext context;
+    QuarterJITConfig config;
+    std::unique_ptr<QuarterObjectCache> cache;
+    std::unique_ptr<llvm::orc::LLLazyJIT> jit;
+    std::unique_ptr<llvm::LLVMContext> context;  // fresh per compile(), owned by the JIT afterwards
     std::unique_ptr<llvm::Module> module;
-	std::unique_ptr<llvm::ExecutionEngine> engine;
+    unsigned moduleCount = 0;
     public:
-    QuarterLangJIT() {
+    explicit QuarterLangJIT(QuarterJITConfig cfg = {}) : config(std::move(cfg)) {
         llvm::InitializeNativeTarget();
         llvm::InitializeNativeTargetAsmPrinter();
         llvm::InitializeNativeTargetAsmParser();
-        module = std::make_unique<llvm::Module>("QuarterLangModule", context);
+        if (!config.cacheDirectory.empty()) cache = std::make_unique<QuarterObjectCache>(config.cacheDirectory);
+        llvm::orc::LLLazyJITBuilder builder;
+        builder.setNumCompileThreads(config.compileThreads);
+        builder.setCompileFunctionCreator([this](llvm::orc::JITTargetMachineBuilder jtmb)
+            -> llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+            return std::make_unique<llvm::orc::ConcurrentIRCompiler>(std::move(jtmb), cache.get());
+        });
+        auto created = builder.create();
+        if (!created) {
+            throw std::runtime_error("Failed to create LLJIT: " + llvm::toString(created.takeError()));
+        }
+        jit = std::move(*created);
+        auto process = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(jit->getDataLayout().getGlobalPrefix());
+        if (!process) {
+            throw std::runtime_error("Failed to expose process symbols: " + llvm::toString(process.takeError()));
+        }
+        jit->getMainJITDylib().addGenerator(std::move(*process));
+        jit->getIRTransformLayer().setTransform([this](llvm::orc::ThreadSafeModule tsm, llvm::orc::MaterializationResponsibility&)
+            -> llvm::Expected<llvm::orc::ThreadSafeModule> {
+            if (llvm::Error err = tsm.withModuleDo([this](llvm::Module& M) { return optimize(M); })) return err;
+            return tsm;
+        });
+        newModule();
     }
+    llvm::LLVMContext& getContext() { return *context; }
+    llvm::Module& getModule() { return *module; }
+    size_t cacheHits() const { return cache ? cache->hits() : 0; }
     void addFunction(const std::string& name, llvm::FunctionType* type) {
         llvm::Function::Create(type, llvm::Function::ExternalLinkage, name, module.get());
     }
-    void compile() {
+    // Hands the module built so far to the JIT for `tier` and starts a new
+    // one; nothing is compiled until a function is called.
+    void compile(QuarterJITTier tier = QuarterJITTier::Baseline) {
         std::string error;
-        engine = std::unique_ptr<llvm::ExecutionEngine>(
-            llvm::EngineBuilder(std::move(module))
-                .setErrorStr(&error)
-                .setOptLevel(llvm::CodeGenOptLevel::Default)
-                .create()
-        );
-        if (!engine) {
-            throw std::runtime_error("Failed to create ExecutionEngine: " + error);
+        llvm::raw_string_ostream os(error);
+        if (llvm::verifyModule(*module, &os)) {
+            throw std::runtime_error("Invalid module: " + os.str());
+        }
+        module->addModuleFlag(llvm::Module::Error, "quarter.tier", static_cast<uint32_t>(tier));
+        module->setDataLayout(jit->getDataLayout());
+        llvm::orc::ThreadSafeModule tsm(std::move(module), std::move(context));
+        if (llvm::Error err = jit->addLazyIRModule(std::move(tsm))) {
+            throw std::runtime_error("Failed to add module: " + llvm::toString(std::move(err)));
         }
+        newModule();
     }
     void* getFunctionPointer(const std::string& name) {
-        return engine->getFunctionAddress(name);
+        auto symbol = jit->lookup(name);
+        if (!symbol) {
+            llvm::consumeError(symbol.takeError());
+            return nullptr;
+        }
+        return reinterpret_cast<void*>(static_cast<uintptr_t>(symbol->getAddress()));
 	}
     template<typename FuncType>
-    FuncType getFunction(const std::string& name) {
+    FuncType* getFunction(const std::string& name) {
         void* ptr = getFunctionPointer(name);
         if (!ptr) throw std::runtime_error("Function not found: " + name);
-        return reinterpret_cast<FuncType>(ptr);
+        return reinterpret_cast<FuncType*>(ptr);
 	}
     void runFunction(const std::string& name) {
         auto func = getFunction<void()>(name);
@@ -8956,8 +11434,7 @@ class QuarterLangJIT {
         std::vector<uint8_t> compressedData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
         size_t compressedSize = compressedData.size();
         // Decompress logic would go here (stubbed for now)
-		outData.resize(compre
-            ssedSize); // For now, just copy the compressed data
+		outData.resize(compressedSize); // For now, just copy the compressed data
         std::copy(compressedData.begin(), compressedData.end(), outData.begin());
         return true;
     }
@@ -8969,7 +11446,45 @@ class QuarterLangJIT {
         }
         file.write(reinterpret_cast<const char*>(data.data()), data.size());
 	}
-}
+private:
+    void newModule() {
+        context = std::make_unique<llvm::LLVMContext>();
+        module = std::make_unique<llvm::Module>("QuarterLangModule." + std::to_string(moduleCount++), *context);
+    }
+    // Runs on a compile thread with the partition's context locked.
+    llvm::Error optimize(llvm::Module& M) {
+        unsigned tier = 0;
+        if (auto* flag = llvm::mdconst::extract_or_null<llvm::ConstantInt>(M.getModuleFlag("quarter.tier"))) {
+            tier = static_cast<unsigned>(flag->getZExtValue());
+        }
+        const std::string& pipeline = config.pipelines[std::min(tier, static_cast<unsigned>(QuarterJITTier::Count) - 1)];
+        if (cache) {
+            llvm::SmallVector<char, 0> bits;
+            llvm::raw_svector_ostream os(bits);
+            llvm::WriteBitcodeToFile(M, os);
+            os << pipeline << '\0' << jit->getTargetTriple().str() << '\0' << llvm::sys::getHostCPUName();
+            std::string key = llvm::toHex(llvm::SHA1::hash(llvm::arrayRefFromStringRef(os.str())), true);
+            llvm::LLVMContext& ctx = M.getContext();
+            M.getOrInsertNamedMetadata("quarter.cache_key")->addOperand(llvm::MDNode::get(ctx, llvm::MDString::get(ctx, key)));
+            if (cache->load(key)) return llvm::Error::success();
+        }
+        if (pipeline.empty()) return llvm::Error::success();
+        llvm::LoopAnalysisManager lam;
+        llvm::FunctionAnalysisManager fam;
+        llvm::CGSCCAnalysisManager cgam;
+        llvm::ModuleAnalysisManager mam;
+        llvm::PassBuilder pb;
+        pb.registerModuleAnalyses(mam);
+        pb.registerCGSCCAnalyses(cgam);
+        pb.registerFunctionAnalyses(fam);
+        pb.registerLoopAnalyses(lam);
+        pb.crossRegisterProxies(lam, fam, cgam, mam);
+        llvm::ModulePassManager mpm;
+        if (llvm::Error err = pb.parsePassPipeline(mpm, pipeline)) return err;
+        mpm.run(M, mam);
+        return llvm::Error::success();
+    }
+};
 #include <iostream>
 #include <vector>
 #include <string>
@@ -12031,6 +14546,7 @@ var π = 3.14
 #include <chrono>
 #include <ctime>
 #include <algorithm>
+#include "QuarterSource.hpp"
 
     class ErrorHandler {
     public:
@@ -12062,14 +14578,12 @@ var π = 3.14
                 ErrorHandler::error(301, "Missing path to file");
                 return "";
             }
-            std::ifstream file(path, std::ios::in | std::ios::binary);
-            if (!file) {
+            std::string contents;
+            if (!QuarterSource::readFile(path, contents)) {
                 ErrorHandler::error(303, "Cannot open file for reading: " + path);
                 return "";
             }
-            std::ostringstream contents;
-            contents << file.rdbuf();
-            return contents.str();
+            return contents;
         }
 
         static void write_file(const std::string& path, const std::string& data) {
@@ -12366,15 +14880,14 @@ var π = 3.14
 #include <unordered_map>
 #include <ctime>
 #include <vector>
+#include "QuarterSource.hpp"
 
     // --- Stub IO and Parser modules -- replace with actual implementations ---
     namespace IO {
         std::string read_file(const std::string& path) {
-            std::ifstream file(path, std::ios::in | std::ios::binary);
-            if (!file) return "";
-            std::ostringstream contents;
-            contents << file.rdbuf();
-            return contents.str();
+            std::string contents;
+            QuarterSource::readFile(path, contents);
+            return contents;
         }
 
         void log(const std::string& level, const std::string& message) {
@@ -12581,6 +15094,7 @@ var π = 3.14
 #include <ctime>
 #include <cstdlib>  // for std::exit
 #include <functional>
+#include "QuarterSource.hpp"
 
     // --- ErrorHandler Module ---
     namespace ErrorHandler {
@@ -12602,11 +15116,9 @@ var π = 3.14
     // --- Stub IO Module ---
     namespace IO {
         std::string read_file(const std::string& path) {
-            std::ifstream file(path, std::ios::in | std::ios::binary);
-            if (!file) return "";
-            std::ostringstream contents;
-            contents << file.rdbuf();
-            return contents.str();
+            std::string contents;
+            QuarterSource::readFile(path, contents);
+            return contents;
         }
 
         void println(const std::string& text) {
@@ -14214,6 +16726,7 @@ var π = 3.14
 #include <optional>
 #include <iostream>
 #include <unordered_map>
+#include "QuarterArena.hpp"
 
     // Forward declarations
     struct ASTNode;
@@ -14240,27 +16753,29 @@ var π = 3.14
     };
 
     // --- ASTNode ---
+    // Nodes are owned by an ASTArena for the lifetime of the compilation unit;
+    // every link below is a plain non-owning pointer into that arena.
     struct ASTNode {
         std::string kind;
 
         // The following fields are optional depending on kind
         std::string name;  // For declarations and identifiers
-        std::vector<std::shared_ptr<ASTNode>> statements;  // Program, Block
-        std::vector<std::shared_ptr<ASTNode>> params;      // FunctionDecl params
-        std::shared_ptr<ASTNode> body;                      // FunctionDecl body or Block
-        std::shared_ptr<ASTNode> value;                     // Let value
-        std::shared_ptr<ASTNode> target;                    // Call target
-        std::vector<std::shared_ptr<ASTNode>> arguments;   // Call arguments
-        std::shared_ptr<ASTNode> condition;                 // If, While
-        std::shared_ptr<ASTNode> then_branch;               // If
-        std::shared_ptr<ASTNode> else_branch;               // If
-        std::shared_ptr<ASTNode> left;                       // BinaryOp
-        std::shared_ptr<ASTNode> right;                      // BinaryOp
+        std::vector<ASTNode*> statements;       // Program, Block
+        std::vector<ASTNode*> params;           // FunctionDecl params
+        ASTNode* body = nullptr;                // FunctionDecl body or Block
+        ASTNode* value = nullptr;               // Let value
+        ASTNode* target = nullptr;              // Call target
+        std::vector<ASTNode*> arguments;        // Call arguments
+        ASTNode* condition = nullptr;           // If, While
+        ASTNode* then_branch = nullptr;         // If
+        ASTNode* else_branch = nullptr;         // If
+        ASTNode* left = nullptr;                // BinaryOp
+        ASTNode* right = nullptr;               // BinaryOp
 
         std::optional<SourceLocation> location;
 
         // For symbol binding, store a pointer to resolved declaration node (if any)
-        std::shared_ptr<ASTNode> resolved_symbol;
+        ASTNode* resolved_symbol = nullptr;
 
         ASTNode(std::string k) : kind(std::move(k)) {}
     };
@@ -14273,7 +16788,7 @@ var π = 3.14
         }
 
         // Define a symbol; returns false if already defined
-        bool define(const std::string& name, std::shared_ptr<ASTNode> node) {
+        bool define(const std::string& name, ASTNode* node) {
             if (symbols_.find(name) != symbols_.end()) {
                 return false;  // already defined in this scope
             }
@@ -14282,7 +16797,7 @@ var π = 3.14
         }
 
         // Resolve symbol searching up through parent scopes
-        std::shared_ptr<ASTNode> resolve(const std::string& name) const {
+        ASTNode* resolve(const std::string& name) const {
             auto it = symbols_.find(name);
             if (it != symbols_.end()) {
                 return it->second;
@@ -14294,7 +16809,7 @@ var π = 3.14
         }
 
     private:
-        std::unordered_map<std::string, std::shared_ptr<ASTNode>> symbols_;
+        std::unordered_map<std::string, ASTNode*> symbols_;
         std::shared_ptr<SymbolTable> parent_;
     };
 
@@ -14313,14 +16828,14 @@ var π = 3.14
     // --- Binder functions ---
 
     // Forward declaration for recursion
-    std::shared_ptr<ASTNode> bind_node(std::shared_ptr<ASTNode> node, BindingContext& ctx);
+    ASTNode* bind_node(ASTNode* node, BindingContext& ctx);
 
-    std::shared_ptr<ASTNode> bind(std::shared_ptr<ASTNode> ast, std::shared_ptr<SymbolTable> table) {
+    ASTNode* bind(ASTNode* ast, std::shared_ptr<SymbolTable> table) {
         BindingContext ctx(table);
         return bind_node(ast, ctx);
     }
 
-    std::shared_ptr<ASTNode> bind_node(std::shared_ptr<ASTNode> node, BindingContext& ctx) {
+    ASTNode* bind_node(ASTNode* node, BindingContext& ctx) {
         if (!node) return node;
 
         const std::string& kind = node->kind;
@@ -14411,6 +16926,7 @@ var π = 3.14
 #include <filesystem>
 #include <cstdio>
 #include <cstdlib>
+#include "QuarterSource.hpp"
 
     // Platform detection
 #if defined(_WIN32) || defined(_WIN64)
@@ -14459,11 +16975,9 @@ var π = 3.14
 
         // Read file contents into string
         std::string read_file(const std::string& path) {
-            std::ifstream ifs(path, std::ios::binary);
-            if (!ifs) return "";
-            std::ostringstream oss;
-            oss << ifs.rdbuf();
-            return oss.str();
+            std::string contents;
+            QuarterSource::readFile(path, contents);
+            return contents;
         }
 
         // Check if file exists
@@ -15325,6 +17839,7 @@ var π = 3.14
 #include <string>
 #include <filesystem>
     #include <cstdlib>
+#include "QuarterSource.hpp"
     namespace BinaryEmitter {
         // Error handling
         void error(const std::string& context, const std::string& message) {
@@ -15351,13 +17866,9 @@ var π = 3.14
         }
         // Read file content
         std::string read_file(const std::string& path) {
-			std::ifstream
-                ifs(path, std::ios::binary);
-            if (!ifs) return "";
-            std::ostringstream oss;
-            oss << ifs.rdbuf();
-            ifs.close();
-            return oss.str();
+            std::string content;
+            QuarterSource::readFile(path, content);
+            return content;
         }
         // Check if file exists
         bool file_exists(const std::string& path) {
@@ -19386,9 +21897,11 @@ n";
 
 // Forward declarations or includes of all subsystems
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <iostream>
+#include "QuarterKeywords.hpp"
 
     namespace QuarterLang {
 
@@ -19694,7 +22207,13 @@ n";
         namespace CodeCompletionAgent {
             class CompletionEngine {
             public:
-                void complete() {/*...*/ }
+                // Keyword candidates for the identifier being typed, taken from
+                // the shared keyword table.
+                std::vector<const QuarterKeywords::Entry*> complete(std::string_view prefix) const {
+                    std::vector<const QuarterKeywords::Entry*> matches;
+                    QuarterKeywords::complete(prefix, [&](const QuarterKeywords::Entry& e) { matches.push_back(&e); });
+                    return matches;
+                }
             };
         }
 